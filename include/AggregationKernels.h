@@ -0,0 +1,69 @@
+#ifndef AGGREGATIONKERNELS_H
+#define AGGREGATIONKERNELS_H
+
+#include "TimeSeriesQuery.h"
+
+/**
+ * @brief 时间桶聚合内核
+ *
+ * 对连续存放的时间戳/数值数组做一次遍历，输出每个时间桶的
+ * 最小值、最大值、总和、数量以及首尾值。时间戳必须递增，
+ * 桶由bucketCount+1个递增的边界给出（与TimeBucketer::boundaries()一致）。
+ *
+ * 提供AVX2向量化实现和标量实现，运行时根据CPU能力自动选择。
+ * 结果合并到输出数组中已有的聚合值之后，因此可以逐块调用。
+ */
+class AggregationKernels
+{
+public:
+    /**
+     * @brief 内核实现类型
+     */
+    enum Implementation {
+        Scalar,  // 标量实现（所有平台可用）
+        Avx2     // AVX2向量化实现
+    };
+
+    /**
+     * @brief 按当前选择的实现聚合样本
+     * @param timestamps 时间戳数组（毫秒，递增）
+     * @param values 数值数组
+     * @param count 样本数量
+     * @param boundaries 桶边界数组，长度为bucketCount+1
+     * @param bucketCount 桶数量
+     * @param out 输出的聚合值数组，长度为bucketCount
+     * @return 落在桶范围内的样本数
+     */
+    static qint64 aggregate(const qint64 *timestamps, const double *values, qint64 count,
+                            const qint64 *boundaries, int bucketCount, BucketAggregate *out);
+
+    /**
+     * @brief 使用指定实现聚合样本（用于测试和基准对比）
+     * @param implementation 内核实现，不受支持时退回标量实现
+     */
+    static qint64 aggregate(Implementation implementation,
+                            const qint64 *timestamps, const double *values, qint64 count,
+                            const qint64 *boundaries, int bucketCount, BucketAggregate *out);
+
+    /**
+     * @brief 判断当前CPU是否支持指定实现
+     * @param implementation 内核实现
+     * @return 支持时返回true
+     */
+    static bool isSupported(Implementation implementation);
+
+    /**
+     * @brief 获取运行时选择的实现
+     * @return 当前CPU支持的最快实现
+     */
+    static Implementation activeImplementation();
+
+    /**
+     * @brief 获取实现的名称
+     * @param implementation 内核实现
+     * @return 名称字符串
+     */
+    static const char *implementationName(Implementation implementation);
+};
+
+#endif // AGGREGATIONKERNELS_H
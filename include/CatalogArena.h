@@ -0,0 +1,136 @@
+#ifndef CATALOGARENA_H
+#define CATALOGARENA_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <cstddef>
+
+/**
+ * @brief 内存区中的字符串（不拥有数据）
+ *
+ * 指向CatalogArena中的UTF-16数据，只在内存区存活期间有效。查找时可以
+ * 用view()比较，需要长期保存时用toString()复制出拥有数据的QString。
+ */
+struct ArenaString {
+    const QChar *data;  // 字符数据（在内存区中）
+    int size;           // 字符数
+
+    ArenaString() : data(nullptr), size(0) {}
+    ArenaString(const QChar *text, int length) : data(text), size(length) {}
+
+    bool isEmpty() const { return size == 0; }
+
+    /**
+     * @brief 获取不复制数据的视图
+     */
+    QStringView view() const { return QStringView(data, size); }
+
+    /**
+     * @brief 复制为拥有数据的QString
+     */
+    QString toString() const { return isEmpty() ? QString() : QString(data, size); }
+
+    bool operator==(const ArenaString &other) const { return view() == other.view(); }
+    bool operator!=(const ArenaString &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 单调递增的内存区
+ *
+ * 从大块内存中依次切分，单个分配不能释放，全部内容在release()或析构时
+ * 一起释放，耗时与块数成正比。解析目录文件时的字符串数据、子设备下标
+ * 数组和记录表都从内存区分配，重新加载时不再产生大量零碎的堆分配。
+ *
+ * 内存区不是线程安全的；并行解析时每个线程使用自己的内存区。分配的
+ * 内存不调用构造和析构函数，只能存放平凡类型。
+ */
+class CatalogArena
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param blockSize 每块的字节数，超过块大小的分配单独占一块
+     */
+    explicit CatalogArena(int blockSize = 256 * 1024);
+
+    /**
+     * @brief 析构函数，释放所有块
+     */
+    ~CatalogArena();
+
+    /**
+     * @brief 分配内存
+     * @param size 字节数
+     * @param alignment 对齐字节数（2的幂）
+     * @return 内存地址，内容未初始化
+     */
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief 分配数组（平凡类型，内容未初始化）
+     * @param count 元素个数
+     */
+    template <typename T>
+    T *allocateArray(int count)
+    {
+        return static_cast<T *>(allocate(sizeof(T) * static_cast<size_t>(count), alignof(T)));
+    }
+
+    /**
+     * @brief 把UTF-8文本解码到内存区
+     *
+     * 无效的字节序列解码为U+FFFD。
+     *
+     * @param utf8 UTF-8数据
+     * @param size 字节数
+     * @return 内存区中的字符串，空输入返回空字符串
+     */
+    ArenaString copyUtf8(const char *utf8, int size);
+
+    /**
+     * @brief 把字符串复制到内存区
+     * @param text 字符串
+     * @return 内存区中的副本
+     */
+    ArenaString copy(QStringView text);
+
+    /**
+     * @brief 释放所有块，之后可以继续分配
+     */
+    void release();
+
+    /**
+     * @brief 获取已分配的块数
+     */
+    int blockCount() const { return m_blocks.size(); }
+
+    /**
+     * @brief 获取所有块的总字节数
+     */
+    qint64 reservedBytes() const { return m_reservedBytes; }
+
+    /**
+     * @brief 获取已分配出去的字节数（含对齐填充）
+     */
+    qint64 usedBytes() const { return m_usedBytes; }
+
+private:
+    CatalogArena(const CatalogArena &) = delete;
+    CatalogArena &operator=(const CatalogArena &) = delete;
+
+    /**
+     * @brief 新开一块，至少能容纳指定字节数
+     */
+    void addBlock(size_t minimumSize);
+
+private:
+    QVector<char *> m_blocks;   // 已分配的块
+    char *m_cursor;             // 当前块的下一个可用位置
+    char *m_end;                // 当前块的末尾
+    size_t m_blockSize;         // 默认块大小
+    qint64 m_reservedBytes;     // 所有块的总字节数
+    qint64 m_usedBytes;         // 已分配出去的字节数
+};
+
+#endif // CATALOGARENA_H
@@ -0,0 +1,251 @@
+#ifndef CATALOGLOADER_H
+#define CATALOGLOADER_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "CatalogArena.h"
+#include "DeviceInfo.h"
+
+class DeviceManager;
+class CatalogBuilder;
+
+/**
+ * @brief 目录文件中的一条设备记录
+ *
+ * 字符串和子设备下标数组都在所属CatalogData的内存区中。
+ */
+struct CatalogRecord {
+    ArenaString id;         // 设备ID
+    ArenaString parentId;   // 父设备ID，空为顶层
+    ArenaString type;       // 设备类型
+    ArenaString name;       // 设备名称
+    bool isGroup;           // 是否为设备组
+    uint contentHash;       // 内容哈希（名称、类型、分组标志）
+    uint idHash;            // 设备ID的哈希
+    int line;               // 在文件中的行号
+    int parent;             // 父设备的下标，顶层为-1
+    int childCount;         // 子设备数
+    const int *children;    // 子设备的下标（文件顺序）
+};
+
+/**
+ * @brief 从目录文件解析出的设备目录
+ *
+ * 设备记录按文件中的顺序保存，每个设备的子设备按文件顺序列出。记录表、
+ * 字符串数据、子设备下标数组和ID索引都从内存区分配（并行解析时每个
+ * 分块的字符串在各自的内存区中），目录销毁时按块一起释放，重新加载
+ * 不会留下大量零碎的堆分配。复制CatalogData只复制指针，副本共用同样
+ * 的（只读的）内存区。内容哈希在解析时（后台线程）一并计算，差异比较
+ * 时只需比较哈希。
+ *
+ * 内存区只用于解析和差异比较：CatalogBuilder构建快照时把需要保存的
+ * 字符串复制到Qt容器中，快照不引用内存区，解析结果释放后内存区随之释放。
+ */
+class CatalogData
+{
+public:
+    CatalogData();
+
+    /**
+     * @brief 获取设备数
+     */
+    int deviceCount() const { return m_count; }
+
+    bool isEmpty() const { return m_count == 0; }
+
+    /**
+     * @brief 获取设备记录
+     * @param index 下标（文件顺序）
+     */
+    const CatalogRecord &record(int index) const { return m_records[index]; }
+
+    /**
+     * @brief 根据设备ID查找下标
+     * @param id 设备ID
+     * @return 下标，不存在时返回-1
+     */
+    int indexOf(QStringView id) const;
+    int indexOf(const QString &id) const { return indexOf(QStringView(id)); }
+
+    bool contains(const QString &id) const { return indexOf(id) >= 0; }
+
+    /**
+     * @brief 生成拥有数据的设备信息（包括子设备ID）
+     * @param index 下标
+     */
+    DeviceInfo device(int index) const;
+
+    /**
+     * @brief 获取顶层设备数
+     */
+    int rootCount() const { return m_rootCount; }
+
+    /**
+     * @brief 获取顶层设备的下标
+     * @param row 在顶层中的位置（文件顺序）
+     */
+    int rootAt(int row) const { return m_roots[row]; }
+
+    /**
+     * @brief 获取顶层设备ID（文件顺序）
+     */
+    QStringList rootIds() const;
+
+    /**
+     * @brief 获取出现的设备类型（首次出现的顺序）
+     */
+    QStringList types() const { return m_types; }
+
+    /**
+     * @brief 获取目录使用的内存区数（并行解析时每个分块一个）
+     */
+    int arenaCount() const { return m_arenas.size(); }
+
+    /**
+     * @brief 获取所有内存区的总字节数
+     */
+    qint64 reservedBytes() const;
+
+private:
+    friend class CatalogLoader;
+
+    QVector<std::shared_ptr<CatalogArena>> m_arenas;  // 记录和字符串所在的内存区（[0]存放记录表和索引）
+    CatalogRecord *m_records;                         // 记录表（文件顺序）
+    int m_count;                                      // 记录数
+    int *m_roots;                                     // 顶层设备的下标
+    int m_rootCount;                                  // 顶层设备数
+    int *m_idTable;                                   // 开放寻址的ID索引（-1为空位）
+    int m_idMask;                                     // ID索引的大小减一（大小为2的幂）
+    QStringList m_types;                              // 出现的设备类型
+};
+
+Q_DECLARE_METATYPE(CatalogData)
+
+/**
+ * @brief 把目录应用到设备管理器时的变更统计
+ */
+struct CatalogDiffStats {
+    int added;    // 新增的设备数
+    int removed;  // 删除的设备数（包括随父设备删除的子设备）
+    int moved;    // 父设备或位置变化的设备数
+    int changed;  // 名称、类型或分组标志变化的设备数
+
+    CatalogDiffStats() : added(0), removed(0), moved(0), changed(0) {}
+
+    /**
+     * @brief 获取变更总数
+     */
+    int total() const { return added + removed + moved + changed; }
+};
+
+Q_DECLARE_METATYPE(CatalogDiffStats)
+
+/**
+ * @brief 设备目录文件的解析和差异应用
+ *
+ * 目录文件为UTF-8文本，每行一个设备：
+ *
+ *     设备ID,父设备ID,类型,是否分组(0/1),名称
+ *
+ * 父设备ID为空表示顶层设备；名称是最后一个字段，可以包含逗号。空行和
+ * 以'#'开头的行被忽略。子设备的顺序即文件中的顺序，父设备可以出现在
+ * 子设备之后。
+ *
+ * 大文件可以并行解析：输入在行边界处切成若干分块，各线程把分块解析到
+ * 自己的内存区，再按文件顺序合并并建立ID索引，查找父设备也按分块并行
+ * 进行。结果和错误信息与单线程解析完全相同。
+ */
+class CatalogLoader
+{
+public:
+    enum {
+        ParallelChunkBytes = 1024 * 1024  // 并行解析时每个分块的最小字节数
+    };
+
+    /**
+     * @brief 目录文件的读取方式
+     */
+    enum ReadMode {
+        MapFile,          // 映射到内存后直接解析，不复制文件内容
+        ReadIntoMemory    // 整体读入内存，解析期间文件被截断或改写也不受影响
+    };
+
+    /**
+     * @brief 解析目录文件内容
+     * @param data 文件内容
+     * @param catalog 输出的目录
+     * @param error 失败时的错误信息（可为空）
+     * @return 成功返回true；出现重复ID、缺失字段、未知父设备或循环时返回false
+     */
+    static bool parse(const QByteArray &data, CatalogData &catalog, QString *error = nullptr);
+
+    /**
+     * @brief 用多个线程解析目录文件内容
+     *
+     * 每个分块至少ParallelChunkBytes字节，较小的输入仍在调用线程上解析。
+     *
+     * @param data 文件内容（可以是映射的文件）
+     * @param size 字节数
+     * @param catalog 输出的目录
+     * @param threadCount 线程数，小于等于0时使用CPU核心数
+     * @param error 失败时的错误信息（可为空）
+     * @return 成功返回true
+     */
+    static bool parse(const char *data, qint64 size, CatalogData &catalog, int threadCount, QString *error = nullptr);
+
+    /**
+     * @brief 读取并解析目录文件
+     *
+     * 默认把文件映射到内存后直接解析，不复制文件内容；无法映射时整体读入。
+     * 映射期间文件若被其他进程截断，访问超出新长度的页会触发SIGBUS，
+     * 因此文件可能正在被改写时（如热加载）应使用ReadIntoMemory。
+     *
+     * @param filePath 文件路径
+     * @param catalog 输出的目录
+     * @param error 失败时的错误信息（可为空）
+     * @param threadCount 解析线程数，1为单线程，小于等于0时使用CPU核心数
+     * @param mode 读取方式
+     * @return 成功返回true
+     */
+    static bool loadFile(const QString &filePath, CatalogData &catalog, QString *error = nullptr,
+                         int threadCount = 1, ReadMode mode = MapFile);
+
+    /**
+     * @brief 计算设备内容（名称、类型、分组标志）的哈希，不含层级关系
+     * @param device 设备信息
+     * @return 内容哈希
+     */
+    static uint contentHash(const DeviceInfo &device);
+
+    /**
+     * @brief 计算设备内容的哈希（与contentHash(const DeviceInfo &)一致）
+     */
+    static uint contentHash(QStringView name, QStringView type, bool isGroup);
+
+    /**
+     * @brief 把目录与快照副本的内容比较，只应用差异
+     *
+     * 按新目录的先序遍历一次：新设备被添加，父设备或位置变化的设备被
+     * 移动，内容哈希变化的设备被更新；遍历后仍不在新目录中的设备被删除。
+     * 未变化的设备不产生变更记录。耗时为一次线性的哈希比较加上与变更数
+     * 成正比的修改。只访问builder，可以在后台线程上调用。
+     *
+     * @param builder 基于当前快照的修改对象
+     * @param catalog 新目录（须由parse()生成）
+     * @return 变更统计
+     */
+    static CatalogDiffStats applyDiff(CatalogBuilder &builder, const CatalogData &catalog);
+
+    /**
+     * @brief 把目录与设备管理器的当前内容比较，在一个事务中只应用差异
+     * @param manager 设备管理器
+     * @param catalog 新目录（须由parse()生成）
+     * @return 变更统计
+     */
+    static CatalogDiffStats applyDiff(DeviceManager &manager, const CatalogData &catalog);
+};
+
+#endif // CATALOGLOADER_H
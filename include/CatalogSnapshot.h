@@ -0,0 +1,463 @@
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "DeviceInfo.h"
+#include "DeviceTypeRegistry.h"
+
+class DeviceQueryCache;
+class CatalogBuilder;
+class CatalogData;
+class StringPool;
+
+/**
+ * @brief 一个目录快照的内存占用（估算）
+ */
+struct CatalogMemoryUsage {
+    qint64 structureBytes;     // 哈希表、子设备列表和句柄表
+    qint64 stringBytes;        // 本目录独有的字符串数据
+    qint64 sharedStringBytes;  // 引用的驻留字符串（属于字符串池，可能与其他目录共用）
+
+    CatalogMemoryUsage() : structureBytes(0), stringBytes(0), sharedStringBytes(0) {}
+
+    /**
+     * @brief 获取本目录独占的字节数（不含驻留字符串）
+     */
+    qint64 total() const { return structureBytes + stringBytes; }
+};
+
+/**
+ * @brief 设备目录的不可变快照
+ *
+ * 快照发布后不再修改，取得后可以在任意线程上直接读取，不需要加锁；修改目录时由
+ * CatalogBuilder在副本上修改后生成新快照，再由设备管理器原子地替换
+ * 当前快照。持有旧快照的读者不受影响，最后一个引用释放时旧快照才被
+ * 销毁。每个快照带有版本号，缓存以版本号为键，不同版本的结果互不混用。
+ *
+ * 设备类型和父设备ID映射为小整数原子（0为空字符串），父设备原子按
+ * 句柄保存，父设备比较只需比较整数。父设备原子按引用它的设备计数，
+ * 没有设备引用时释放，空位留给之后出现的字符串；仍被引用的原子在同一
+ * 目录的各个版本中保持不变。设备类型的原子随类型注册表一直保留。设备
+ * 类型另外在类型注册表中有自己的连续ID，按句柄保存，类型过滤按类型ID进行。
+ */
+class CatalogSnapshot
+{
+public:
+    /**
+     * @brief 构造空快照
+     * @param stringPool 驻留设备类型的字符串池（不拥有），为空时不驻留
+     */
+    explicit CatalogSnapshot(StringPool *stringPool = nullptr)
+        : m_atoms(1), m_atomRefs(1), m_version(0), m_stringPool(stringPool) {}
+
+    /**
+     * @brief 获取快照版本号
+     */
+    quint64 version() const { return m_version; }
+
+    /**
+     * @brief 获取设备数量
+     */
+    int deviceCount() const { return m_devices.size(); }
+
+    /**
+     * @brief 检查设备是否存在
+     * @param id 设备ID
+     */
+    bool contains(const QString &id) const { return m_devices.contains(id); }
+
+    /**
+     * @brief 根据ID获取设备信息
+     * @param id 设备ID
+     * @return 设备信息，不存在时返回无效的DeviceInfo
+     */
+    DeviceInfo device(const QString &id) const { return m_devices.value(id); }
+
+    /**
+     * @brief 获取设备类型列表（注册顺序）
+     */
+    QStringList deviceTypes() const { return m_types.typeNames(); }
+
+    /**
+     * @brief 获取设备类型注册表
+     */
+    const DeviceTypeRegistry &types() const { return m_types; }
+
+    /**
+     * @brief 获取所有设备（句柄顺序）
+     */
+    QList<DeviceInfo> allDevices() const;
+
+    /**
+     * @brief 获取子设备列表
+     * @param parentId 父设备ID
+     * @return 子设备列表（目录顺序）
+     */
+    QList<DeviceInfo> childDevices(const QString &parentId) const;
+
+    /**
+     * @brief 获取子设备ID
+     * @param parentId 父设备ID，空字符串表示顶层
+     */
+    QStringList childIds(const QString &parentId) const;
+
+    /**
+     * @brief 获取父设备子列表中指定位置的设备ID
+     * @param parentId 父设备ID，空字符串表示顶层
+     * @param row 位置
+     * @return 设备ID，位置无效时返回空字符串
+     */
+    QString childIdAt(const QString &parentId, int row) const;
+
+    /**
+     * @brief 获取设备在父设备子列表中的位置
+     * @param id 设备ID
+     * @return 位置，设备不存在时返回-1
+     */
+    int deviceRow(const QString &id) const;
+
+    /**
+     * @brief 根据设备ID获取句柄
+     * @return 设备句柄，不存在时返回-1
+     */
+    int deviceHandle(const QString &id) const { return m_handleIndex.value(id, -1); }
+
+    /**
+     * @brief 根据句柄获取设备ID
+     * @return 设备ID，句柄无效或设备已删除时返回空字符串
+     */
+    QString deviceIdForHandle(int handle) const { return m_handleIds.value(handle); }
+
+    /**
+     * @brief 获取句柄总数（包括已删除设备留下的空位，空位过多时发布会压缩，
+     *        见CatalogBuilder::renumberedHandles()）
+     */
+    int handleCount() const { return m_handleIds.size(); }
+
+    /**
+     * @brief 获取字符串对应的原子
+     * @param text 设备类型或父设备ID
+     * @return 原子，空字符串为0，目录中没有的字符串为-1
+     */
+    int atom(const QString &text) const { return text.isEmpty() ? 0 : m_atomIndex.value(text, -1); }
+
+    /**
+     * @brief 获取原子对应的字符串
+     */
+    QString atomString(int atom) const { return m_atoms.value(atom); }
+
+    /**
+     * @brief 获取原子表的大小（包括已释放的空位）
+     */
+    int atomCount() const { return m_atoms.size(); }
+
+    /**
+     * @brief 获取设备的类型ID
+     * @param handle 设备句柄
+     * @return 类型ID（没有类型的设备为DeviceTypeRegistry::AllTypes），
+     *         句柄无效或设备已删除时返回-1
+     */
+    int typeId(int handle) const { return m_typeIds.value(handle, -1); }
+
+    /**
+     * @brief 获取父设备ID的原子
+     * @param handle 设备句柄
+     * @return 父设备原子（顶层设备为0），句柄无效或设备已删除时返回-1
+     */
+    int parentAtom(int handle) const { return m_parentAtoms.value(handle, -1); }
+
+    /**
+     * @brief 查询匹配的设备句柄
+     * @param typeId 设备类型ID，DeviceTypeRegistry::AllTypes表示所有类型
+     * @param keyword 名称/ID搜索关键字，空字符串表示不过滤
+     * @param cache 查询缓存（可为空），只有与快照版本一致时才会命中和写入
+     * @return 匹配设备的句柄数组，按句柄顺序排列；类型ID无效时为空
+     */
+    QVector<int> queryHandles(int typeId, const QString &keyword,
+                              DeviceQueryCache *cache = nullptr) const;
+
+    /**
+     * @brief 按类型名称查询匹配的设备句柄
+     * @param type 设备类型，空字符串表示所有类型
+     */
+    QVector<int> queryHandles(const QString &type, const QString &keyword,
+                              DeviceQueryCache *cache = nullptr) const
+    {
+        return queryHandles(m_types.typeId(type), keyword, cache);
+    }
+
+    /**
+     * @brief 将句柄数组转换为设备列表
+     * @param handles 设备句柄数组（须来自本快照）
+     * @return 设备列表
+     */
+    QList<DeviceInfo> devicesForHandles(const QVector<int> &handles) const;
+
+    /**
+     * @brief 获取字符串池，基于本快照的修改沿用同一个池
+     */
+    StringPool *stringPool() const { return m_stringPool; }
+
+    /**
+     * @brief 估算快照的内存占用
+     *
+     * 多个快照隐式共享的数据分别计入各个快照。
+     */
+    CatalogMemoryUsage memoryUsage() const;
+
+private:
+    friend class CatalogBuilder;
+
+    QHash<QString, DeviceInfo> m_devices;  // 设备ID到设备信息的映射
+    QStringList m_rootIds;                 // 顶层设备ID（目录顺序）
+    DeviceTypeRegistry m_types;            // 设备类型注册表
+    QVector<QString> m_handleIds;          // 句柄到设备ID的映射（已删除的为空）
+    QHash<QString, int> m_handleIndex;     // 设备ID到句柄的映射
+    QVector<QString> m_atoms;              // 原子到字符串（0为空字符串）
+    QHash<QString, int> m_atomIndex;       // 字符串到原子
+    QVector<int> m_atomRefs;               // 按原子的父设备引用数
+    QVector<int> m_freeAtoms;              // 已释放可复用的原子
+    QVector<int> m_typeIds;                // 按句柄的类型ID（已删除的为-1）
+    QVector<int> m_parentAtoms;            // 按句柄的父设备原子（已删除的为-1）
+    quint64 m_version;                     // 快照版本号
+    StringPool *m_stringPool;              // 字符串池（不拥有）
+};
+
+/**
+ * @brief 共享的只读快照指针
+ */
+typedef std::shared_ptr<const CatalogSnapshot> CatalogSnapshotPtr;
+
+Q_DECLARE_METATYPE(CatalogSnapshotPtr)
+
+/**
+ * @brief 一次目录修改产生的变更记录
+ */
+struct CatalogChange {
+    enum Kind { Inserted, Removed, Changed, Moved };
+    Kind kind;                 // 变更类型
+    QString parentId;          // 父设备ID（移动时为原父设备）
+    int first;                 // 第一个位置
+    int last;                  // 最后一个位置
+    QString destinationId;     // 移动的新父设备ID
+    int destinationRow;        // 移动后的位置
+    QStringList deviceIds;     // 涉及的设备ID
+};
+
+/**
+ * @brief 在快照副本上修改目录并生成新快照
+ *
+ * 构造时复制基础快照只增加引用计数；第一次修改时设备哈希表和按句柄
+ * 索引的数组各自整体分离复制，代价与目录规模成正比（O(n)），同一个
+ * 构造器上之后的修改不再复制。连续的多个修改应在同一个构造器（即同一个
+ * 事务）中完成，只付一次复制的代价。修改不影响基础快照，因此可以在
+ * 后台线程上进行。设备类型和父设备ID记入原子表；设备类型另外在基础
+ * 快照的字符串池中驻留，并在类型注册表中登记、维护各类型的设备数量。
+ * 父设备ID随设备增删而变化，只保存在本目录的原子表中，不进入字符串池，
+ * 否则池会随目录的修改无限增长；最后一个引用它的设备删除或移走时原子
+ * 随之释放，整体替换时原子表从现有设备重建。修改过程中记录变更，相邻的同类变更
+ * 合并为一个范围，发布新快照时设备管理器按顺序发出对应的信号。
+ */
+class CatalogBuilder
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param base 基础快照，为空时从空目录开始
+     */
+    explicit CatalogBuilder(const CatalogSnapshotPtr &base = CatalogSnapshotPtr());
+
+    /**
+     * @brief 获取基础快照的版本号
+     */
+    quint64 baseVersion() const { return m_baseVersion; }
+
+    /**
+     * @brief 获取修改中的目录内容
+     */
+    const CatalogSnapshot &current() const { return m_data; }
+
+    /**
+     * @brief 用一组设备替换全部内容
+     *
+     * 建立层级关系（顶层先列出设备组）并校验父子关系，句柄按哈希表
+     * 遍历顺序重新分配。已登记的类型保留原来的ID，设备数量重新统计。
+     * 整体替换不记录变更。
+     *
+     * @param devices 设备ID到设备信息的映射
+     * @param types 设备类型列表
+     * @return 成功返回true，层级关系无效时返回false
+     */
+    bool assign(const QHash<QString, DeviceInfo> &devices, const QStringList &types);
+
+    /**
+     * @brief 用解析出的目录替换全部内容
+     *
+     * 层级关系已由CatalogLoader::parse()校验，不再重复校验。顶层设备、
+     * 子设备和句柄都按文件顺序排列。字符串从目录的内存区复制出来，类型
+     * 和父设备ID先按原子表查找，只有新出现的字符串才复制。已登记的类型
+     * 保留原来的ID。整体替换不记录变更。
+     *
+     * @param catalog 解析出的目录
+     * @return 成功返回true
+     */
+    bool assign(const CatalogData &catalog);
+
+    /**
+     * @brief 添加设备
+     * @param device 设备信息（parentId为空表示顶层，children被忽略）
+     * @param row 在父设备子列表中的位置，-1表示末尾
+     * @return 成功返回true，失败时可通过lastError()获取原因
+     */
+    bool addDevice(const DeviceInfo &device, int row = -1);
+
+    /**
+     * @brief 更新设备的名称、类型和分组标志
+     * @param device 设备信息
+     * @return 成功返回true
+     */
+    bool updateDevice(const DeviceInfo &device);
+
+    /**
+     * @brief 删除设备及其所有子设备
+     * @param id 设备ID
+     * @return 成功返回true
+     */
+    bool removeDevice(const QString &id);
+
+    /**
+     * @brief 把设备（连同子设备）移动到新的父设备下
+     * @param id 设备ID
+     * @param newParentId 新的父设备ID，空字符串表示顶层
+     * @param row 在新父设备子列表中的位置，-1表示末尾
+     * @return 成功返回true
+     */
+    bool moveDevice(const QString &id, const QString &newParentId, int row = -1);
+
+    /**
+     * @brief 设置设备类型的显示名称
+     * @param typeId 类型ID（可以是DeviceTypeRegistry::AllTypes）
+     * @param displayName 显示名称，空字符串恢复为类型名称
+     * @return 成功返回true，类型ID无效时返回false
+     */
+    bool setTypeDisplayName(int typeId, const QString &displayName);
+
+    /**
+     * @brief 获取合并后的变更记录
+     */
+    const QVector<CatalogChange> &changes() const { return m_changes; }
+
+    /**
+     * @brief 是否出现了新的设备类型或类型的显示名称被修改
+     */
+    bool typesChanged() const { return m_typesChanged; }
+
+    /**
+     * @brief 是否有需要发布的修改
+     */
+    bool hasChanges() const { return !m_changes.isEmpty() || m_typesChanged; }
+
+    /**
+     * @brief 获取最后的错误信息
+     */
+    QString lastError() const { return m_lastError; }
+
+    /**
+     * @brief 生成快照时句柄的重新编号
+     *
+     * 删除设备的句柄保留为空位，其他句柄不变；空位超过句柄总数的一半时，
+     * 生成的快照压缩句柄表，存活设备按原来的顺序重新编号，按句柄保存的
+     * 状态须按映射改写。
+     * @return 旧句柄到新句柄的映射（已删除的为-1），不重新编号时为空
+     */
+    QVector<int> renumberedHandles() const;
+
+    /**
+     * @brief 生成新快照
+     * @param version 新快照的版本号
+     * @return 新快照，句柄按renumberedHandles()重新编号
+     */
+    CatalogSnapshotPtr build(quint64 version) const;
+
+private:
+    /**
+     * @brief 校验父子关系的完整性
+     */
+    bool validateHierarchy();
+
+    /**
+     * @brief 检查设备层级中是否存在循环引用
+     */
+    bool hasCircularReference(const QString &deviceId, QStringList &visited) const;
+
+    /**
+     * @brief 记录一个变更，能与上一个变更连成范围时合并
+     */
+    void recordChange(const CatalogChange &change);
+
+    /**
+     * @brief 获取父设备的子列表（空ID为顶层列表）
+     */
+    QStringList &childList(const QString &parentId);
+
+    /**
+     * @brief 收集设备及其所有子设备的ID（先序）
+     */
+    void collectSubtree(const QString &id, QStringList &ids) const;
+
+    /**
+     * @brief 为新设备分配句柄
+     */
+    void assignHandle(const QString &id);
+
+    /**
+     * @brief 获取字符串的原子，新字符串追加到原子表
+     * @param text 设备类型或父设备ID
+     * @param pooled 新字符串是否在字符串池中驻留（只用于设备类型）
+     */
+    int internAtom(const QString &text, bool pooled = false);
+
+    /**
+     * @brief 获取父设备ID的原子并增加引用数
+     */
+    int acquireAtom(const QString &parentId);
+
+    /**
+     * @brief 减少父设备原子的引用数，没有引用且不是设备类型时释放
+     */
+    void releaseAtom(int atom);
+
+    /**
+     * @brief 清空原子表，只保留已登记的设备类型
+     */
+    void resetAtoms();
+
+    /**
+     * @brief 获取设备类型的ID，新类型登记到注册表
+     */
+    int registerType(const QString &type);
+
+    /**
+     * @brief 驻留父设备ID，返回与原子表共享数据的副本
+     */
+    QString intern(const QString &text) { return m_data.m_atoms.at(internAtom(text)); }
+
+    /**
+     * @brief 驻留设备类型，返回与原子表和字符串池共享数据的副本
+     */
+    QString internType(const QString &type) { return m_data.m_atoms.at(internAtom(type, true)); }
+
+private:
+    CatalogSnapshot m_data;              // 修改中的目录内容
+    quint64 m_baseVersion;               // 基础快照的版本号
+    QVector<CatalogChange> m_changes;    // 合并后的变更记录
+    bool m_typesChanged;                 // 是否出现了新类型或显示名称被修改
+    QString m_lastError;                 // 最后的错误信息
+};
+
+#endif // CATALOGSNAPSHOT_H
@@ -0,0 +1,155 @@
+#ifndef CATALOGWATCHER_H
+#define CATALOGWATCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include "CatalogLoader.h"
+#include "CatalogSnapshot.h"
+
+class DeviceManager;
+
+/**
+ * @brief 共享的目录修改对象，在线程间传递差异比较的结果
+ */
+typedef std::shared_ptr<CatalogBuilder> CatalogBuilderPtr;
+
+Q_DECLARE_METATYPE(CatalogBuilderPtr)
+
+/**
+ * @brief 在后台线程上解析目录文件并与快照比较的工作对象（由CatalogWatcher内部使用）
+ */
+class CatalogParser : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    /**
+     * @brief 读取并解析目录文件，在基础快照的副本上应用差异
+     * @param filePath 文件路径
+     * @param base 比较的基础快照
+     * @param generation 重新加载序号，原样随结果返回
+     */
+    void parse(const QString &filePath, const CatalogSnapshotPtr &base, quint64 generation);
+
+signals:
+    void finished(const CatalogBuilderPtr &builder, const CatalogDiffStats &stats,
+                  const QString &error, quint64 generation);
+};
+
+/**
+ * @brief 目录文件热加载
+ *
+ * 用QFileSystemWatcher监视目录文件（以及所在目录，以便发现原子替换和
+ * 新建的文件）。文件变化一个稳定周期后在后台线程重新解析，并与设备
+ * 管理器的当前快照比较，在快照副本上应用差异；结果回到本对象所在线程
+ * 后只需发布，因此设备树按行增量更新，选择、展开、滚动位置和搜索状态
+ * 都保持不变。比较期间目录被其他修改者改动时，基于新快照重新比较。
+ * 解析期间文件再次变化时，当前解析完成后再解析一次。
+ */
+class CatalogWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param manager 设备管理器（不拥有）
+     * @param filePath 目录文件路径
+     * @param parent 父对象
+     */
+    CatalogWatcher(DeviceManager *manager, const QString &filePath, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，停止后台线程
+     */
+    ~CatalogWatcher();
+
+    /**
+     * @brief 获取默认的目录文件路径（应用数据目录下的device_catalog.csv）
+     */
+    static QString defaultFilePath();
+
+    QString filePath() const { return m_filePath; }
+
+    /**
+     * @brief 开始监视，文件存在时立即加载一次
+     */
+    void start();
+
+    /**
+     * @brief 停止监视
+     */
+    void stop();
+
+    /**
+     * @brief 立即重新加载（不等待稳定周期）
+     */
+    void reload();
+
+    /**
+     * @brief 设置文件变化后的稳定周期
+     * @param msec 毫秒
+     */
+    void setSettleInterval(int msec);
+    int settleInterval() const { return m_settleTimer.interval(); }
+
+    /**
+     * @brief 是否有解析正在进行
+     */
+    bool isBusy() const { return m_inFlight; }
+
+    quint64 reloadCount() const { return m_reloadCount; }
+
+    /**
+     * @brief 获取最后的错误信息
+     */
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    /**
+     * @brief 目录重新加载并应用完成信号
+     * @param stats 应用的变更统计
+     */
+    void catalogReloaded(const CatalogDiffStats &stats);
+
+    /**
+     * @brief 目录文件解析失败信号（当前目录保持不变）
+     * @param error 错误信息
+     */
+    void reloadFailed(const QString &error);
+
+    /**
+     * @brief 请求后台线程解析（内部使用）
+     */
+    void parseRequested(const QString &filePath, const CatalogSnapshotPtr &base, quint64 generation);
+
+private slots:
+    void onFileChanged();
+    void onDirectoryChanged();
+    void onParseFinished(const CatalogBuilderPtr &builder, const CatalogDiffStats &stats,
+                         const QString &error, quint64 generation);
+
+private:
+    /**
+     * @brief 重新添加监视路径（文件被替换或新建后监视会丢失）
+     */
+    void updateWatchedPaths();
+
+private:
+    DeviceManager *m_manager;         // 设备管理器（不拥有）
+    QString m_filePath;               // 目录文件路径
+    QFileSystemWatcher m_watcher;     // 文件监视器
+    QTimer m_settleTimer;             // 文件变化的稳定周期定时器
+    QThread m_workerThread;           // 解析文件的后台线程
+    CatalogParser *m_parser;          // 后台线程上的工作对象
+
+    bool m_inFlight;                  // 是否有解析正在进行
+    bool m_reloadPending;             // 解析期间文件是否再次变化
+    quint64 m_generation;             // 重新加载序号
+    quint64 m_reloadCount;            // 成功应用的次数
+    QString m_lastError;              // 最后的错误信息
+};
+
+#endif // CATALOGWATCHER_H
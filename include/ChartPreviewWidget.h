@@ -0,0 +1,190 @@
+#ifndef CHARTPREVIEWWIDGET_H
+#define CHARTPREVIEWWIDGET_H
+
+#include <QWidget>
+#include <QPolygonF>
+#include <QPoint>
+#include "SeriesDecimator.h"
+
+class QPaintEvent;
+class QResizeEvent;
+class QWheelEvent;
+class QMouseEvent;
+
+/**
+ * @brief 选中数据的预览图控件
+ *
+ * 把查询结果中每个设备的序列绘制为折线。序列先按像素列降采样
+ * （见SeriesDecimator），绘制开销只取决于控件宽度。
+ *
+ * 每个设备的降采样结果以数据坐标的折线缓存，覆盖可见范围及其左右
+ * 各一屏。平移时只改变绘制变换，超出缓存范围或缩放改变了每像素的
+ * 时间跨度时才重新降采样；部分结果到达时只为新设备生成折线。
+ *
+ * 滚轮以光标为中心缩放，左键拖动平移，双击恢复到完整范围。
+ */
+class ChartPreviewWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父窗口
+     */
+    explicit ChartPreviewWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief 设置要显示的查询结果
+     *
+     * 分桶与当前数据相同时（如部分结果之后到达的完整结果）保留当前视图，
+     * 否则视图恢复到完整范围。
+     * @param result 查询结果
+     */
+    void setData(const TimeSeriesQueryResult &result);
+
+    /**
+     * @brief 设置实时窗口滑动后的查询结果，保留用户的缩放
+     *
+     * 视图为完整范围时跟随新范围；视图贴着右端时随新数据平移；
+     * 否则保持原时间范围，超出新数据范围时限制在范围内。
+     * 粒度改变时等同于setData()。
+     * @param result 滑动后的查询结果
+     */
+    void advanceData(const TimeSeriesQueryResult &result);
+
+    /**
+     * @brief 追加部分结果中新完成的设备，保留当前视图
+     * @param partial 部分结果
+     */
+    void addSeries(const PartialQueryResult &partial);
+
+    /**
+     * @brief 清空数据
+     */
+    void clear();
+
+    /**
+     * @brief 设置降采样方式
+     * @param mode 降采样方式
+     */
+    void setDecimationMode(SeriesDecimator::Mode mode);
+    SeriesDecimator::Mode decimationMode() const { return m_mode; }
+
+    /**
+     * @brief 设置可见时间范围（限制在数据范围内）
+     * @param startMs 开始时间（毫秒时间戳）
+     * @param endMs 结束时间（毫秒时间戳）
+     */
+    void setViewRange(qint64 startMs, qint64 endMs);
+    qint64 viewStartMs() const { return m_viewStartMs; }
+    qint64 viewEndMs() const { return m_viewEndMs; }
+
+    /**
+     * @brief 恢复到数据的完整时间范围
+     */
+    void resetView();
+
+    /**
+     * @brief 以指定时间为中心缩放
+     * @param factor 缩放系数，大于1放大（可见范围变窄）
+     * @param anchorMs 缩放中心（毫秒时间戳），缩放前后位于同一像素
+     */
+    void zoom(double factor, qint64 anchorMs);
+
+    /**
+     * @brief 平移可见范围
+     * @param deltaMs 平移量（毫秒），正值向后
+     */
+    void pan(qint64 deltaMs);
+
+    /**
+     * @brief 获取设备数
+     */
+    int seriesCount() const { return m_series.size(); }
+
+    /**
+     * @brief 获取设备的缓存折线（数据坐标：x为相对缓存起点的毫秒数，y为数值）
+     * @param index 设备序号
+     * @return 折线，缓存未生成时为空
+     */
+    QPolygonF cachedPolyline(int index);
+
+    /**
+     * @brief 获取重新降采样的次数（用于验证平移不重建缓存）
+     */
+    int cacheRebuildCount() const { return m_cacheRebuildCount; }
+
+signals:
+    /**
+     * @brief 可见范围变化信号
+     * @param startMs 开始时间（毫秒时间戳）
+     * @param endMs 结束时间（毫秒时间戳）
+     */
+    void viewRangeChanged(qint64 startMs, qint64 endMs);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    /**
+     * @brief 获取绘图区域（去掉坐标轴标签的边距）
+     */
+    QRect plotRect() const;
+
+    /**
+     * @brief 保证缓存覆盖当前视图且分辨率一致，否则重新降采样
+     */
+    void ensureCache();
+
+    /**
+     * @brief 按当前缓存参数为一个设备生成折线
+     */
+    QPolygonF buildPolyline(const DeviceSeries &series) const;
+
+    /**
+     * @brief 把新序列的数值范围并入纵轴范围
+     */
+    void extendValueRange(const QVector<DeviceSeries> &series);
+
+    /**
+     * @brief 使缓存失效，下一次绘制时重建
+     */
+    void invalidateCache();
+
+    /**
+     * @brief 像素横坐标换算为时间
+     */
+    qint64 timeAt(int x) const;
+
+private:
+    TimeBucketer m_bucketer;             // 数据使用的时间分桶
+    QVector<DeviceSeries> m_series;      // 各设备的聚合序列
+    SeriesDecimator::Mode m_mode;        // 降采样方式
+
+    qint64 m_viewStartMs;                // 可见范围起点
+    qint64 m_viewEndMs;                  // 可见范围终点
+    double m_minValue;                   // 纵轴下限
+    double m_maxValue;                   // 纵轴上限
+
+    // 折线缓存
+    QVector<QPolygonF> m_polylines;      // 每个设备的降采样折线（数据坐标）
+    bool m_cacheValid;                   // 缓存是否有效
+    qint64 m_cacheStartMs;               // 缓存覆盖的起点（折线x的原点）
+    qint64 m_cacheEndMs;                 // 缓存覆盖的终点
+    double m_cacheMsPerPixel;            // 缓存的时间分辨率
+    int m_cacheRebuildCount;             // 重新降采样的次数
+
+    // 拖动状态
+    bool m_dragging;                     // 是否正在拖动
+    QPoint m_dragOrigin;                 // 拖动起点
+    qint64 m_dragViewStartMs;            // 拖动开始时的可见范围起点
+};
+
+#endif // CHARTPREVIEWWIDGET_H
@@ -0,0 +1,207 @@
+#ifndef DATAEXPORTER_H
+#define DATAEXPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include "QueryExecutor.h"
+
+class TimeSeriesStore;
+
+/**
+ * @brief 导出请求
+ */
+struct ExportRequest {
+    /**
+     * @brief 导出文件格式
+     */
+    enum Format {
+        Csv,       // 逗号分隔文本，每行一个样本或一个时间桶
+        Columnar   // 列式二进制，按块保存各列的定长数组
+    };
+
+    /**
+     * @brief 导出内容
+     */
+    enum Content {
+        Aggregated,  // 按查询颗粒度聚合的非空时间桶
+        RawSamples   // 时间范围内的原始样本
+    };
+
+    TimeSeriesQuery query;   // 设备、时间范围与颗粒度
+    QString filePath;        // 目标文件路径
+    Format format;           // 文件格式
+    Content content;         // 导出内容
+    int blockRows;           // 每块的最大行数，决定导出期间的内存占用
+
+    ExportRequest() : format(Csv), content(Aggregated), blockRows(65536) {}
+
+    /**
+     * @brief 判断请求是否有效
+     * @return 查询有效且指定了目标文件时返回true
+     */
+    bool isValid() const { return query.isValid() && !filePath.isEmpty() && blockRows > 0; }
+};
+
+/**
+ * @brief 导出进度与吞吐统计
+ */
+struct ExportStats {
+    qint64 rowsWritten;      // 已写入的行数
+    qint64 bytesWritten;     // 已写入的字节数
+    qint64 elapsedUs;        // 已用时间（微秒）
+    int completedDevices;    // 已导出完的设备数
+    int totalDevices;        // 设备总数
+    double completeness;     // 完成度 0.0 - 1.0（含当前设备已导出的时间比例）
+    bool finished;           // 是否已结束
+    bool cancelled;          // 是否被取消（目标文件保持不变）
+    QString error;           // 失败原因，成功时为空
+
+    ExportStats()
+        : rowsWritten(0), bytesWritten(0), elapsedUs(0), completedDevices(0), totalDevices(0),
+          completeness(0.0), finished(false), cancelled(false) {}
+
+    /**
+     * @brief 判断导出是否成功完成
+     */
+    bool succeeded() const { return finished && !cancelled && error.isEmpty(); }
+
+    /**
+     * @brief 获取写入吞吐量
+     * @return MB/s（1 MB = 1024 × 1024字节），尚未计时返回0
+     */
+    double megabytesPerSecond() const {
+        return elapsedUs > 0 ? bytesWritten / (1024.0 * 1024.0) / (elapsedUs / 1000000.0) : 0.0;
+    }
+};
+
+Q_DECLARE_METATYPE(ExportRequest)
+Q_DECLARE_METATYPE(ExportStats)
+
+/**
+ * @brief 在后台线程上执行导出的工作对象（由DataExporter内部使用）
+ */
+class ExportRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ExportRunner(TimeSeriesStore *store) : m_store(store) {}
+
+    /**
+     * @brief 同步执行导出
+     * @param request 导出请求
+     * @param token 取消令牌，每写完一块检查一次
+     * @return 最终统计
+     */
+    ExportStats exportData(const ExportRequest &request, const QueryCancelToken &token);
+
+public slots:
+    /**
+     * @brief 执行导出并发出finished信号
+     */
+    void run(const ExportRequest &request, const QueryCancelToken &token);
+
+signals:
+    void progressChanged(const ExportStats &stats);
+    void finished(const ExportStats &stats);
+
+private:
+    TimeSeriesStore *m_store; // 时间序列存储
+};
+
+/**
+ * @brief 数据导出器
+ *
+ * 把"选中设备 × 时间范围"的聚合值或原始样本导出为CSV或列式二进制文件。
+ * 导出在后台线程上流式进行：聚合数据按块查询时间桶，原始样本逐个
+ * 数据块内存映射读取，每块编码后立即写出，内存占用只取决于
+ * ExportRequest::blockRows，与导出的总行数无关。
+ *
+ * 文件经QSaveFile写入，完成后才替换目标文件；取消或失败时目标文件
+ * 保持不变。
+ *
+ * 列式二进制格式（本机字节序，与数据块文件相同）：
+ * - 文件头：8字节标识"TSCOLEXP"、quint32版本（当前为1）、quint32内容类型、
+ *   qint32颗粒度、quint32设备数，随后每个设备一个quint16长度加UTF-8设备ID；
+ * - 数据块：quint32设备序号、quint32行数，随后各列依次存放行数个元素。
+ *   原始样本为timestamp(qint64)、value(double)两列；聚合数据为
+ *   bucket_start(qint64)、count(qint64)、sum、min、max、first、last(double)七列；
+ * - 文件尾：8字节标识"TSCOLEND"、quint64总行数、quint64块数。
+ */
+class DataExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param store 时间序列存储（不拥有，须比导出器存活更久）
+     * @param parent 父对象
+     */
+    explicit DataExporter(TimeSeriesStore *store, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，取消正在进行的导出并停止后台线程
+     */
+    ~DataExporter();
+
+    /**
+     * @brief 在后台线程上开始导出
+     * @param request 导出请求
+     * @return 已开始返回true；请求无效或已有导出在进行时返回false
+     */
+    bool start(const ExportRequest &request);
+
+    /**
+     * @brief 取消正在进行的导出
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有导出在进行
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief 获取最近一次导出的统计（进行中时为最新进度）
+     */
+    ExportStats lastStats() const { return m_lastStats; }
+
+    /**
+     * @brief 获取最后的错误信息
+     * @return 错误信息字符串
+     */
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    /**
+     * @brief 导出进度信号（每写完若干块发出一次）
+     * @param stats 当前统计
+     */
+    void progressChanged(const ExportStats &stats);
+
+    /**
+     * @brief 导出结束信号（成功、失败或取消）
+     * @param stats 最终统计
+     */
+    void finished(const ExportStats &stats);
+
+    /**
+     * @brief 请求后台线程执行导出（内部使用）
+     */
+    void runRequested(const ExportRequest &request, const QueryCancelToken &token);
+
+private slots:
+    void onRunProgress(const ExportStats &stats);
+    void onRunFinished(const ExportStats &stats);
+
+private:
+    QThread m_workerThread;          // 执行导出的后台线程
+    ExportRunner *m_runner;          // 后台线程上的工作对象
+    QueryCancelToken m_token;        // 当前导出的取消令牌
+    bool m_running;                  // 是否有导出在进行
+    ExportStats m_lastStats;         // 最近一次导出的统计
+    QString m_lastError;             // 最后的错误信息
+};
+
+#endif // DATAEXPORTER_H
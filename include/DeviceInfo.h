@@ -13,7 +13,7 @@
 struct DeviceInfo {
     QString id;           // 设备唯一标识符
     QString name;         // 设备显示名称
-    QString type;         // 设备类型（如"全部模型"、"根模型"等）
+    QString type;         // 设备类型（如"根模型"、"传感器"等）
     QString parentId;     // 父设备ID，用于构建层级结构
     bool isGroup;         // 是否为设备组（容器节点）
     QStringList children; // 子设备ID列表
@@ -2,15 +2,32 @@
 #define DEVICEMANAGER_H
 
 #include <QObject>
+#include <QFuture>
 #include <QHash>
+#include <QMutex>
+#include <QScopedPointer>
 #include <QStringList>
+#include "CatalogSnapshot.h"
 #include "DeviceInfo.h"
+#include "DeviceQueryCache.h"
+#include "QueryExecutor.h"
+
+class StringPool;
+class WorkStealingThreadPool;
 
 /**
  * @brief 设备数据管理器
  * 
- * 单例模式的设备数据管理类，负责设备数据的加载、存储和查询
+ * 设备目录的管理类，负责设备数据的加载、存储和查询
  * 提供设备类型分类、层级结构管理等功能
+ *
+ * 每个实例是一个独立的目录，instance()返回默认目录。多个目录可以共用
+ * 一个字符串池，相同的设备类型只保存一份。
+ *
+ * 目录内容保存在不可变的CatalogSnapshot中，修改时生成新快照并原子地
+ * 替换。除snapshot()、带快照参数的queryDeviceHandles()和异步查询外，
+ * 其余方法和信号只能在管理器所在线程上使用；其他线程先取得快照再在
+ * 快照上查询，不需要加锁，也不受同时进行的修改影响。
  */
 class DeviceManager : public QObject
 {
@@ -18,8 +35,27 @@ class DeviceManager : public QObject
 
 public:
     /**
-     * @brief 获取单例实例
-     * @return DeviceManager单例引用
+     * @brief 构造函数，创建一个空目录（使用全局字符串池）
+     * @param parent 父对象
+     */
+    explicit DeviceManager(QObject *parent = nullptr);
+
+    /**
+     * @brief 构造函数，创建一个空目录
+     * @param stringPool 驻留设备类型的字符串池（不拥有，须比目录存活更久），
+     *        为空时不驻留
+     * @param parent 父对象
+     */
+    DeviceManager(StringPool *stringPool, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数
+     */
+    ~DeviceManager();
+
+    /**
+     * @brief 获取默认目录
+     * @return 进程内默认的DeviceManager实例
      */
     static DeviceManager& instance();
     
@@ -28,6 +64,18 @@ public:
      * 从配置文件或数据源加载设备信息
      */
     void loadDeviceData();
+
+    /**
+     * @brief 用解析出的目录整体替换当前内容
+     *
+     * 与loadDeviceData()一样发出loadingStateChanged()和dataLoaded()，
+     * 句柄按文件顺序重新分配，已登记的类型保留原来的ID。只需应用差异时
+     * 使用CatalogLoader::applyDiff()。
+     *
+     * @param catalog 由CatalogLoader::parse()生成的目录
+     * @return 成功返回true；正在加载或处于事务中时返回false
+     */
+    bool loadCatalog(const CatalogData &catalog);
     
     /**
      * @brief 根据类型获取设备列表
@@ -35,12 +83,40 @@ public:
      * @return 指定类型的设备列表
      */
     QList<DeviceInfo> getDevicesByType(const QString &type) const;
+
+    /**
+     * @brief 根据类型ID获取设备列表
+     * @param typeId 设备类型ID，DeviceTypeRegistry::AllTypes表示所有类型
+     * @return 指定类型的设备列表，类型ID无效时为空
+     */
+    QList<DeviceInfo> getDevicesByType(int typeId) const;
     
     /**
      * @brief 获取所有设备类型
      * @return 设备类型列表
      */
     QStringList getDeviceTypes() const;
+
+    /**
+     * @brief 获取设备类型注册表（类型ID、显示名称和各类型的设备数量）
+     * @return 当前目录的类型注册表
+     */
+    DeviceTypeRegistry deviceTypeRegistry() const { return current().types(); }
+
+    /**
+     * @brief 获取设备类型的ID
+     * @param type 设备类型，空字符串表示所有类型
+     * @return 类型ID，未知类型返回DeviceTypeRegistry::UnknownType
+     */
+    int deviceTypeId(const QString &type) const { return current().types().typeId(type); }
+
+    /**
+     * @brief 设置设备类型的显示名称，成功后发出deviceTypesChanged信号
+     * @param typeId 类型ID（可以是DeviceTypeRegistry::AllTypes）
+     * @param displayName 显示名称，空字符串恢复为类型名称
+     * @return 成功返回true
+     */
+    bool setDeviceTypeDisplayName(int typeId, const QString &displayName);
     
     /**
      * @brief 根据ID获取设备信息
@@ -69,6 +145,240 @@ public:
      */
     QList<DeviceInfo> getChildDevices(const QString &parentId) const;
 
+    /**
+     * @brief 异步搜索设备
+     *
+     * 异步查询在调用时取得的快照上执行，结果与调用时的目录一致，不受
+     * 之后的修改影响。查询在专用的线程池中运行，可以在任意线程调用；
+     * 界面线程可用QFutureWatcher在完成时得到通知。
+     *
+     * @param keyword 搜索关键字
+     * @param token 取消令牌，也可以调用返回值的cancel()；取消后尚未
+     *        开始的查询被跳过，已完成的查询不再报告结果
+     * @return 匹配的设备列表，被取消时isCanceled()为true且没有结果
+     */
+    QFuture<QList<DeviceInfo>> searchDevicesAsync(const QString &keyword,
+                                                  const QueryCancelToken &token = QueryCancelToken()) const;
+
+    /**
+     * @brief 异步获取指定类型的设备列表（执行方式同searchDevicesAsync()）
+     * @param type 设备类型
+     * @param token 取消令牌
+     * @return 指定类型的设备列表
+     */
+    QFuture<QList<DeviceInfo>> getDevicesByTypeAsync(const QString &type,
+                                                     const QueryCancelToken &token = QueryCancelToken()) const;
+
+    /**
+     * @brief 按类型ID异步获取设备列表（执行方式同searchDevicesAsync()）
+     * @param typeId 设备类型ID
+     * @param token 取消令牌
+     * @return 指定类型的设备列表
+     */
+    QFuture<QList<DeviceInfo>> getDevicesByTypeAsync(int typeId,
+                                                     const QueryCancelToken &token = QueryCancelToken()) const;
+
+    /**
+     * @brief 异步获取子设备列表（执行方式同searchDevicesAsync()）
+     * @param parentId 父设备ID
+     * @param token 取消令牌
+     * @return 子设备列表
+     */
+    QFuture<QList<DeviceInfo>> getChildDevicesAsync(const QString &parentId,
+                                                    const QueryCancelToken &token = QueryCancelToken()) const;
+
+    /**
+     * @brief 获取子设备ID（按目录中的顺序）
+     * @param parentId 父设备ID，空字符串表示顶层
+     * @return 子设备ID列表
+     */
+    QStringList childIds(const QString &parentId) const;
+
+    /**
+     * @brief 获取父设备子列表中指定位置的设备ID
+     * @param parentId 父设备ID，空字符串表示顶层
+     * @param row 位置
+     * @return 设备ID，位置无效时返回空字符串
+     */
+    QString childIdAt(const QString &parentId, int row) const;
+
+    /**
+     * @brief 获取设备在父设备子列表中的位置
+     * @param id 设备ID
+     * @return 位置，设备不存在时返回-1
+     */
+    int deviceRow(const QString &id) const;
+
+    /**
+     * @brief 获取当前发布的目录快照（线程安全）
+     *
+     * 快照在持有期间保持不变；事务中未提交的修改不在其中。
+     *
+     * 经std::atomic_load读取。libstdc++对shared_ptr的原子操作使用按地址
+     * 散列的全局互斥锁池，因此读取并不是无锁的；但临界区只有指针复制和
+     * 引用计数加一，读者不会等待修改者构建新快照。
+     *
+     * @return 当前快照
+     */
+    CatalogSnapshotPtr snapshot() const;
+
+    /**
+     * @brief 发布在快照副本上完成的修改
+     *
+     * 生成版本号加一的新快照并原子地替换当前快照，然后按顺序发出
+     * 修改对应的变更信号。修改者可以在后台线程上用snapshot()构造
+     * CatalogBuilder，完成后回到管理器所在线程发布。
+     *
+     * @param builder 修改后的目录
+     * @return 成功返回true；事务进行中，或构造builder之后目录已被修改
+     *         （基础版本号不是当前版本号）时返回false，此时应基于新快照重做
+     */
+    bool publish(const CatalogBuilder &builder);
+
+    /**
+     * @brief 开始一个目录事务
+     *
+     * 事务内的修改立即对本对象的查询方法可见，但新快照和变更信号暂存到
+     * commitTransaction()时才发布，相邻的同类变更合并为一个范围。事务
+     * 可以嵌套，最外层提交时才发布。不在事务中的单个修改自动作为一个
+     * 事务提交，每个事务都要复制一次目录（O(n)，见CatalogBuilder），
+     * 连续的多个修改应放在一个事务中。
+     */
+    void beginTransaction();
+
+    /**
+     * @brief 提交目录事务并发出合并后的变更信号
+     */
+    void commitTransaction();
+
+    /**
+     * @brief 检查是否在事务中
+     */
+    bool inTransaction() const { return m_transactionDepth > 0; }
+
+    /**
+     * @brief 获取事务中修改目录的对象，不在事务中时返回空指针
+     */
+    CatalogBuilder *transactionBuilder() { return m_builder.data(); }
+
+    /**
+     * @brief 添加设备
+     * @param device 设备信息（parentId为空表示顶层，children被忽略）
+     * @param row 在父设备子列表中的位置，-1表示末尾
+     * @return 成功返回true，失败时可通过getLastError()获取原因
+     */
+    bool addDevice(const DeviceInfo &device, int row = -1);
+
+    /**
+     * @brief 更新设备的名称、类型和分组标志（层级关系用moveDevice修改）
+     * @param device 设备信息
+     * @return 成功返回true
+     */
+    bool updateDevice(const DeviceInfo &device);
+
+    /**
+     * @brief 删除设备及其所有子设备
+     * @param id 设备ID
+     * @return 成功返回true
+     */
+    bool removeDevice(const QString &id);
+
+    /**
+     * @brief 把设备（连同子设备）移动到新的父设备下
+     * @param id 设备ID
+     * @param newParentId 新的父设备ID，空字符串表示顶层
+     * @param row 在新父设备子列表中的位置，-1表示末尾
+     * @return 成功返回true
+     */
+    bool moveDevice(const QString &id, const QString &newParentId, int row = -1);
+
+    /**
+     * @brief 查询匹配的设备句柄（带结果缓存）
+     * @param typeId 设备类型ID，DeviceTypeRegistry::AllTypes表示所有类型
+     * @param keyword 名称/ID搜索关键字，空字符串表示不过滤
+     * @return 匹配设备的句柄数组，按目录顺序排列
+     */
+    QVector<int> queryDeviceHandles(int typeId, const QString &keyword) const;
+
+    /**
+     * @brief 按类型名称查询匹配的设备句柄
+     * @param type 设备类型，空字符串表示所有类型
+     * @param keyword 名称/ID搜索关键字，空字符串表示不过滤
+     */
+    QVector<int> queryDeviceHandles(const QString &type, const QString &keyword) const
+    {
+        return queryDeviceHandles(deviceTypeId(type), keyword);
+    }
+
+    /**
+     * @brief 在指定快照上查询匹配的设备句柄（线程安全，与管理器共用结果缓存）
+     * @param snapshot 目录快照，旧版本的快照不会命中或写入缓存
+     * @param typeId 设备类型ID（须来自该快照的类型注册表）
+     * @param keyword 名称/ID搜索关键字，空字符串表示不过滤
+     * @return 匹配设备的句柄数组
+     */
+    QVector<int> queryDeviceHandles(const CatalogSnapshot &snapshot, int typeId,
+                                    const QString &keyword) const;
+
+    /**
+     * @brief 在指定快照上按类型名称查询匹配的设备句柄
+     */
+    QVector<int> queryDeviceHandles(const CatalogSnapshot &snapshot, const QString &type,
+                                    const QString &keyword) const
+    {
+        return queryDeviceHandles(snapshot, snapshot.types().typeId(type), keyword);
+    }
+
+    /**
+     * @brief 根据设备ID获取句柄
+     * @param id 设备ID
+     * @return 设备句柄，不存在时返回-1
+     */
+    int deviceHandle(const QString &id) const { return current().deviceHandle(id); }
+
+    /**
+     * @brief 根据句柄获取设备ID
+     * @param handle 设备句柄
+     * @return 设备ID，句柄无效或设备已删除时返回空字符串
+     */
+    QString deviceIdForHandle(int handle) const { return current().deviceIdForHandle(handle); }
+
+    /**
+     * @brief 根据句柄获取设备的类型ID
+     * @param handle 设备句柄
+     * @return 类型ID，句柄无效或设备已删除时返回-1
+     */
+    int deviceTypeIdForHandle(int handle) const { return current().typeId(handle); }
+
+    /**
+     * @brief 获取当前目录中的设备句柄总数
+     * @return 句柄数量
+     */
+    int deviceHandleCount() const { return current().handleCount(); }
+
+    /**
+     * @brief 获取目录版本号（当前快照的版本号），每次成功加载数据或提交修改后递增
+     * @return 目录版本号
+     */
+    quint64 catalogVersion() const { return m_snapshot->version(); }
+
+    /**
+     * @brief 获取查询结果缓存（用于统计命中率）
+     * @return 查询缓存
+     */
+    const DeviceQueryCache &queryCache() const { return m_queryCache; }
+
+    /**
+     * @brief 获取字符串池
+     */
+    StringPool *stringPool() const { return m_snapshot->stringPool(); }
+
+    /**
+     * @brief 估算当前目录的内存占用
+     * @return 内存占用，驻留字符串单独计算
+     */
+    CatalogMemoryUsage memoryUsage() const { return current().memoryUsage(); }
+
     /**
      * @brief 检查数据是否已加载
      * @return 如果数据已加载返回true
@@ -99,12 +409,67 @@ signals:
      */
     void loadingStateChanged(bool loading);
 
-private:
     /**
-     * @brief 私有构造函数（单例模式）
+     * @brief 设备插入信号
+     * @param parentId 父设备ID，空字符串表示顶层
+     * @param first 插入后第一个设备在父设备子列表中的位置
+     * @param last 插入后最后一个设备的位置
+     * @param deviceIds 插入的设备ID
      */
-    explicit DeviceManager(QObject *parent = nullptr);
-    
+    void devicesInserted(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备删除信号（删除的设备包括其子设备，均已不在目录中）
+     * @param parentId 父设备ID
+     * @param first 删除前第一个设备的位置
+     * @param last 删除前最后一个设备的位置
+     * @param deviceIds 删除的设备ID，包括所有子设备
+     */
+    void devicesRemoved(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备信息变化信号
+     * @param parentId 父设备ID
+     * @param first 第一个变化设备的位置
+     * @param last 最后一个变化设备的位置
+     * @param deviceIds 变化的设备ID
+     */
+    void devicesChanged(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备移动信号
+     * @param sourceParentId 原父设备ID
+     * @param sourceFirst 移动前第一个设备的位置
+     * @param sourceLast 移动前最后一个设备的位置
+     * @param destinationParentId 新父设备ID
+     * @param destinationRow 移动后第一个设备的位置
+     * @param deviceIds 移动的设备ID（子设备随之移动）
+     */
+    void devicesMoved(const QString &sourceParentId, int sourceFirst, int sourceLast,
+                      const QString &destinationParentId, int destinationRow, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备类型列表变化信号（新设备引入了新类型，或类型的显示名称被修改）
+     * @param types 新的设备类型列表
+     */
+    void deviceTypesChanged(const QStringList &types);
+
+    /**
+     * @brief 设备句柄重新编号信号
+     *
+     * 删除设备留下的空位过多时，发布的快照压缩句柄表。信号在替换快照后、
+     * 本次提交的其他变更信号之前发出，按句柄保存状态的对象须按映射改写。
+     * @param handles 旧句柄到新句柄的映射，已删除设备为-1
+     */
+    void handlesRenumbered(const QVector<int> &handles);
+
+    /**
+     * @brief 目录修改提交信号，在本次提交的所有变更信号之后发出
+     * @param version 新的目录版本号
+     */
+    void catalogChanged(quint64 version);
+
+private:
     /**
      * @brief 禁用拷贝构造函数
      */
@@ -117,33 +482,50 @@ private:
     
     /**
      * @brief 初始化示例设备数据
+     * @param devices 输出的设备
+     * @param types 输出的设备类型
      */
-    void initializeSampleData();
-    
+    static void initializeSampleData(QHash<QString, DeviceInfo> &devices, QStringList &types);
+
     /**
-     * @brief 构建设备层级关系
+     * @brief 获取查询使用的目录内容：事务中为修改中的内容，否则为当前快照
      */
-    void buildDeviceHierarchy();
-    
+    const CatalogSnapshot &current() const;
+
     /**
-     * @brief 验证设备层级关系的完整性
+     * @brief 原子地替换当前快照并使查询缓存失效
      */
-    void validateDeviceHierarchy();
-    
+    void setSnapshot(const CatalogSnapshotPtr &snapshot);
+
+    /**
+     * @brief 在隐式事务中执行一个修改，失败时记录错误信息
+     */
+    template <typename Mutation>
+    bool mutate(Mutation mutation);
+
     /**
-     * @brief 检查设备层级中是否存在循环引用
-     * @param deviceId 要检查的设备ID
-     * @param visited 已访问的设备ID列表
-     * @return 如果存在循环引用返回true
+     * @brief 在当前快照上异步执行查询
      */
-    bool hasCircularReference(const QString &deviceId, QStringList &visited) const;
+    template <typename Query>
+    QFuture<QList<DeviceInfo>> runAsync(const QueryCancelToken &token, Query query) const;
+
+    /**
+     * @brief 获取异步查询线程池，首次使用时创建
+     */
+    WorkStealingThreadPool *queryPool() const;
 
 private:
-    QHash<QString, DeviceInfo> m_devices;  // 设备ID到设备信息的映射
-    QStringList m_deviceTypes;             // 设备类型列表
+    CatalogSnapshotPtr m_snapshot;         // 当前发布的快照（跨线程读写经std::atomic_load/store）
     bool m_dataLoaded;                     // 数据是否已加载标志
     QString m_lastError;                   // 最后的错误信息
     bool m_isLoading;                      // 是否正在加载数据
+    mutable DeviceQueryCache m_queryCache; // 查询结果缓存（以快照版本号为键）
+    mutable QScopedPointer<WorkStealingThreadPool> m_queryPool; // 异步查询线程池
+    mutable QMutex m_queryPoolMutex;       // 保护线程池的创建
+    
+    // 事务
+    int m_transactionDepth;                // 事务嵌套深度
+    QScopedPointer<CatalogBuilder> m_builder; // 事务中修改目录的对象
 };
 
 #endif // DEVICEMANAGER_H
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef DEVICEQUERYCACHE_H
+#define DEVICEQUERYCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 设备查询缓存键
+ *
+ * 由目录版本号、设备类型ID和规范化（小写）后的查询关键字组成
+ */
+struct DeviceQueryKey {
+    quint64 catalogVersion;  // 目录版本号
+    int typeId;              // 设备类型ID，0表示所有类型
+    QString query;           // 规范化后的查询关键字，空字符串表示不过滤
+
+    DeviceQueryKey() : catalogVersion(0), typeId(0) {}
+
+    DeviceQueryKey(quint64 version, int deviceTypeId, const QString &normalizedQuery)
+        : catalogVersion(version), typeId(deviceTypeId), query(normalizedQuery) {}
+
+    bool operator==(const DeviceQueryKey &other) const {
+        return catalogVersion == other.catalogVersion &&
+               typeId == other.typeId &&
+               query == other.query;
+    }
+};
+
+inline uint qHash(const DeviceQueryKey &key, uint seed = 0)
+{
+    return qHash(key.catalogVersion, seed) ^ qHash(key.typeId, seed) ^ (qHash(key.query, seed) * 31u);
+}
+
+/**
+ * @brief 设备查询结果缓存
+ *
+ * 有界LRU缓存，以设备句柄数组（目录中的设备下标）紧凑地保存
+ * searchDevices / getDevicesByType / filterDevices 的查询结果。
+ * 缓存键包含目录版本号，目录快照变化时自动失效。所有方法都是线程
+ * 安全的，后台线程在目录快照上的查询可以与界面线程共用同一个缓存。
+ */
+class DeviceQueryCache
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param maxBytes 缓存占用的最大字节数
+     */
+    explicit DeviceQueryCache(int maxBytes = 4 * 1024 * 1024);
+
+    /**
+     * @brief 查找缓存的查询结果
+     * @param key 查询键
+     * @param handles 输出的设备句柄数组
+     * @return 命中返回true
+     */
+    bool lookup(const DeviceQueryKey &key, QVector<int> &handles);
+
+    /**
+     * @brief 插入查询结果
+     * @param key 查询键
+     * @param handles 设备句柄数组
+     */
+    void insert(const DeviceQueryKey &key, const QVector<int> &handles);
+
+    /**
+     * @brief 通知目录版本变化，旧版本的条目全部失效
+     * @param version 新的目录版本号
+     */
+    void setCatalogVersion(quint64 version);
+
+    /**
+     * @brief 清空缓存（命中统计保留）
+     */
+    void clear();
+
+    /**
+     * @brief 设置缓存容量
+     * @param maxBytes 最大字节数
+     */
+    void setMaxBytes(int maxBytes);
+
+    int maxBytes() const;
+    int usedBytes() const;
+    int entryCount() const;
+    quint64 hitCount() const;
+    quint64 missCount() const;
+
+    /**
+     * @brief 获取缓存命中率
+     * @return 命中率（0.0 - 1.0），尚无查询时返回0
+     */
+    double hitRate() const;
+
+private:
+    /**
+     * @brief 计算条目的缓存开销
+     */
+    static int costOf(const DeviceQueryKey &key, const QVector<int> &handles);
+
+private:
+    QCache<DeviceQueryKey, QVector<int>> m_cache;  // LRU结果缓存
+    quint64 m_catalogVersion;                      // 当前目录版本号
+    quint64 m_hits;                                // 命中次数
+    quint64 m_misses;                              // 未命中次数
+    mutable QMutex m_mutex;                        // 保护以上成员
+};
+
+#endif // DEVICEQUERYCACHE_H
@@ -0,0 +1,251 @@
+#ifndef DEVICESTATUSFEED_H
+#define DEVICESTATUSFEED_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QHash>
+#include <QVector>
+#include <atomic>
+
+class DeviceManager;
+
+/**
+ * @brief 一条设备状态更新
+ *
+ * 来源能直接得到设备句柄时填写handle；只有设备ID时handle为-1，
+ * 由GUI线程按ID解析句柄（设备管理器不是线程安全的）。
+ */
+struct DeviceStatusUpdate {
+    int handle;          // 设备句柄，-1表示按deviceId解析
+    quint8 status;       // DeviceStatusFeed::Status
+    QString deviceId;    // 设备ID（handle为-1时使用）
+
+    DeviceStatusUpdate() : handle(-1), status(0) {}
+    DeviceStatusUpdate(int h, quint8 s) : handle(h), status(s) {}
+    DeviceStatusUpdate(const QString &id, quint8 s) : handle(-1), status(s), deviceId(id) {}
+};
+
+/**
+ * @brief 单生产者单消费者的无锁环形队列
+ *
+ * 生产者（来源的工作线程）只写尾指针，消费者（GUI线程）只写头指针，
+ * 两端都不加锁。容量固定，队列满时tryPush返回false，由生产者自行合并
+ * 暂存。
+ */
+class DeviceStatusQueue
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 容量，向上取整为2的幂
+     */
+    explicit DeviceStatusQueue(int capacity = 65536);
+
+    /**
+     * @brief 入队（仅生产者线程调用）
+     * @return 队列已满时返回false
+     */
+    bool tryPush(const DeviceStatusUpdate &update);
+
+    /**
+     * @brief 出队（仅消费者线程调用）
+     * @return 队列为空时返回false
+     */
+    bool tryPop(DeviceStatusUpdate &update);
+
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+    /**
+     * @brief 获取近似的元素个数（另一端可能同时在读写）
+     */
+    int sizeApprox() const;
+
+private:
+    QVector<DeviceStatusUpdate> m_slots;  // 环形存储
+    quint32 m_mask;                       // 容量减一
+    alignas(64) std::atomic<quint32> m_head;  // 下一个出队位置（消费者写）
+    alignas(64) std::atomic<quint32> m_tail;  // 下一个入队位置（生产者写）
+};
+
+/**
+ * @brief 设备状态来源基类
+ *
+ * 来源运行在状态汇集器的工作线程中，每个来源拥有一个单生产者队列。
+ * 队列满时更新按设备合并暂存，之后优先写入，因此每个设备的最终状态
+ * 不会丢失。
+ */
+class DeviceStatusSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceStatusSource(QObject *parent = nullptr);
+
+    /**
+     * @brief 获取来源的队列（由状态汇集器消费）
+     */
+    DeviceStatusQueue *queue() { return &m_queue; }
+
+    /**
+     * @brief 获取已发布的更新数（含合并前的暂存更新）
+     */
+    quint64 publishedCount() const { return m_publishedCount.load(std::memory_order_relaxed); }
+
+public slots:
+    /**
+     * @brief 开始产生状态（在工作线程中调用）
+     */
+    virtual void start() = 0;
+
+    /**
+     * @brief 停止产生状态
+     */
+    virtual void stop() = 0;
+
+protected:
+    /**
+     * @brief 发布一条状态更新（仅在来源所在线程调用）
+     */
+    void publish(const DeviceStatusUpdate &update);
+
+    /**
+     * @brief 把暂存的更新写入队列
+     * @return 暂存是否已清空
+     */
+    bool flushPending();
+
+private:
+    DeviceStatusQueue m_queue;                // 到GUI线程的队列
+    QHash<int, quint8> m_pendingHandles;      // 队列满时按句柄合并的暂存
+    QHash<QString, quint8> m_pendingIds;      // 队列满时按设备ID合并的暂存
+    std::atomic<quint64> m_publishedCount;    // 已发布的更新数
+};
+
+/**
+ * @brief 设备状态汇集器
+ *
+ * 状态来源在后台线程中写入各自的无锁队列；GUI线程每帧（默认16ms）
+ * 取空所有队列，同一设备在一帧内的多次更新只保留最后一次，状态真正
+ * 变化的设备以一次statusesChanged信号通知。界面据此发出最小范围的
+ * dataChanged，状态风暴不会引起模型重置或逐项信号。目录的句柄重新
+ * 编号时，已保存的状态按映射移到新句柄；目录整体重新加载（所有句柄
+ * 重新分配）或换用其他目录时，已保存的状态清空。
+ */
+class DeviceStatusFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 设备状态
+     */
+    enum Status {
+        Unknown = 0,    // 未收到状态
+        Online,         // 在线
+        Offline,        // 离线
+        Alarm           // 告警
+    };
+
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit DeviceStatusFeed(QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，停止所有来源
+     */
+    ~DeviceStatusFeed();
+
+    /**
+     * @brief 设置解析设备ID和句柄所用的目录
+     * @param manager 设备目录（不拥有），默认为DeviceManager::instance()
+     */
+    void setDeviceManager(const DeviceManager *manager);
+    const DeviceManager *deviceManager() const { return m_manager; }
+
+    /**
+     * @brief 添加状态来源并在工作线程中启动（取得所有权）
+     * @param source 状态来源
+     */
+    void addSource(DeviceStatusSource *source);
+
+    /**
+     * @brief 添加状态来源，由调用方在当前线程中驱动（用于测试，不取得所有权）
+     * @param source 状态来源
+     */
+    void attachSource(DeviceStatusSource *source);
+
+    /**
+     * @brief 设置合并周期
+     * @param msec 周期（毫秒）
+     */
+    void setFrameInterval(int msec);
+
+    /**
+     * @brief 获取设备的当前状态
+     * @param handle 设备句柄
+     * @return 状态，未收到时为Unknown
+     */
+    Status status(int handle) const;
+
+    /**
+     * @brief 取空所有队列并应用一帧的更新
+     * @return 状态发生变化的设备句柄
+     */
+    QVector<int> drain();
+
+    /**
+     * @brief 解析状态名称（online/offline/alarm或对应数字）
+     * @param text 状态名称
+     * @param ok 是否解析成功（可为空）
+     */
+    static Status statusFromString(const QString &text, bool *ok = nullptr);
+
+    // 统计
+    quint64 receivedCount() const { return m_receivedCount; }
+    quint64 changedCount() const { return m_changedCount; }
+    quint64 frameCount() const { return m_frameCount; }
+
+signals:
+    /**
+     * @brief 一帧内状态变化的设备
+     * @param handles 设备句柄
+     */
+    void statusesChanged(const QVector<int> &handles);
+
+private slots:
+    /**
+     * @brief 帧定时器槽函数
+     */
+    void onFrameTimeout();
+
+    /**
+     * @brief 目录整体重新加载槽函数，清空按旧句柄保存的状态
+     */
+    void onCatalogReloaded();
+
+    /**
+     * @brief 句柄重新编号槽函数，把已保存的状态移到新句柄
+     * @param handles 旧句柄到新句柄的映射
+     */
+    void onHandlesRenumbered(const QVector<int> &handles);
+
+private:
+    const DeviceManager *m_manager;           // 设备目录（不拥有）
+    QThread m_workerThread;                   // 来源所在的工作线程
+    QVector<DeviceStatusSource*> m_sources;   // 所有来源
+    QTimer m_frameTimer;                      // 每帧取空队列的定时器
+
+    QVector<quint8> m_statuses;               // 按句柄保存的当前状态
+    QVector<quint32> m_touchedFrame;          // 每个句柄最近一次被更新的帧号
+    QVector<int> m_touched;                   // 本帧更新过的句柄
+    QVector<quint8> m_touchedPrevious;        // 本帧更新前的状态
+
+    quint64 m_receivedCount;                  // 收到的更新数
+    quint64 m_changedCount;                   // 状态实际变化的次数
+    quint64 m_frameCount;                     // 取空队列的帧数
+};
+
+#endif // DEVICESTATUSFEED_H
@@ -0,0 +1,126 @@
+#ifndef DEVICESTATUSSOURCES_H
+#define DEVICESTATUSSOURCES_H
+
+#include "DeviceStatusFeed.h"
+#include <QRandomGenerator>
+
+/**
+ * @brief 模拟的设备状态来源
+ *
+ * 以固定速率随机改变设备状态（大部分为在线），用于在没有真实设备时
+ * 测试状态风暴下的界面表现。
+ */
+class DeviceStatusSimulator : public DeviceStatusSource
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param deviceCount 设备句柄范围[0, deviceCount)
+     * @param updatesPerSecond 每秒产生的更新数
+     * @param parent 父对象
+     */
+    DeviceStatusSimulator(int deviceCount, int updatesPerSecond, QObject *parent = nullptr);
+
+    /**
+     * @brief 立即产生一批更新
+     * @param count 更新数
+     */
+    void generate(int count);
+
+    /**
+     * @brief 设置随机种子（用于可重复的测试）
+     */
+    void setSeed(quint32 seed) { m_random.seed(seed); }
+
+public slots:
+    void start() override;
+    void stop() override;
+
+private slots:
+    /**
+     * @brief 定时产生一批更新
+     */
+    void onTick();
+
+private:
+    int m_deviceCount;           // 设备数
+    int m_updatesPerSecond;      // 每秒更新数
+    QTimer *m_timer;             // 产生更新的定时器
+    QRandomGenerator m_random;   // 随机数生成器
+};
+
+/**
+ * @brief 从追加写入的文本文件读取设备状态
+ *
+ * 外部采集程序向文件追加"设备ID,状态"格式的行（状态为online、offline、
+ * alarm或对应数字1-3），该来源定时读取新增的完整行。文件被截断或替换
+ * 时从头开始读取。
+ *
+ * 状态文件只追加不清理，第一次读取时只从文件末尾的一段开始，不把全部
+ * 历史读入内存重放。之后按固定大小的块读取，每次轮询读取的总量有上限，
+ * 超长的行丢弃，内存占用与文件大小无关。
+ */
+class DeviceStatusFileTail : public DeviceStatusSource
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param filePath 状态文件路径
+     * @param parent 父对象
+     */
+    explicit DeviceStatusFileTail(const QString &filePath, QObject *parent = nullptr);
+
+    /**
+     * @brief 获取默认的状态文件路径
+     */
+    static QString defaultFilePath();
+
+    QString filePath() const { return m_filePath; }
+
+    /**
+     * @brief 读取文件新增的内容
+     * @return 本次解析的行数
+     */
+    int poll();
+
+    /**
+     * @brief 第一次读取时从文件末尾往前读取的字节数
+     */
+    static qint64 initialTailBytes();
+
+    /**
+     * @brief 获取无法解析的行数
+     */
+    int invalidLineCount() const { return m_invalidLines; }
+
+public slots:
+    void start() override;
+    void stop() override;
+
+private:
+    /**
+     * @brief 解析一块数据中的完整行，剩余部分留作半行
+     * @return 发布的更新数
+     */
+    int parseChunk(const QByteArray &chunk);
+
+    /**
+     * @brief 解析一行并发布更新
+     * @return 行有效时返回true，空行和注释返回false
+     */
+    bool parseLine(const QByteArray &line);
+
+private:
+    QString m_filePath;          // 状态文件路径
+    qint64 m_offset;             // 已读取到的位置，-1表示尚未开始读取
+    QByteArray m_partialLine;    // 尚未读到换行符的半行
+    bool m_discardLine;          // 是否丢弃到下一个换行符（从行中间开始读取或行过长）
+    int m_invalidLines;          // 无法解析的行数
+    QTimer *m_timer;             // 轮询定时器
+};
+
+#endif // DEVICESTATUSSOURCES_H
@@ -0,0 +1,87 @@
+#ifndef DEVICETREEMODEL_H
+#define DEVICETREEMODEL_H
+
+#include <QStandardItemModel>
+#include <QPixmap>
+#include <QPointer>
+
+class DeviceStatusFeed;
+
+/**
+ * @brief 设备树的数据模型
+ *
+ * 在QStandardItemModel之上提供设备的实时状态：状态不写入项目（每次
+ * setData都会发出一个itemChanged），而是在data()中按设备句柄从状态
+ * 汇集器读取，以状态图标显示在设备名称前。状态变化时把设备按父节点
+ * 和连续行合并，只发出覆盖这些行的dataChanged。设备句柄到项目的索引
+ * 随行的插入和删除增量维护，句柄重新编号时整体重建。
+ */
+class DeviceTreeModel : public QStandardItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 设备树项目的数据角色
+     */
+    enum Roles {
+        DeviceIdRole = Qt::UserRole,          // 设备ID
+        DeviceHandleRole = Qt::UserRole + 1,  // 设备句柄
+        DeviceStatusRole = Qt::UserRole + 2   // 设备状态（DeviceStatusFeed::Status）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit DeviceTreeModel(QObject *parent = nullptr);
+
+    /**
+     * @brief 设置状态来源
+     * @param feed 状态汇集器（不拥有），为空时不显示状态
+     */
+    void setStatusFeed(const DeviceStatusFeed *feed);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 重建设备句柄到项目的索引
+     */
+    void rebuildHandleIndex();
+
+    /**
+     * @brief 按新编号改写所有项目保存的句柄并重建索引
+     * @param handles 旧句柄到新句柄的映射（见DeviceManager::handlesRenumbered）
+     */
+    void remapHandles(const QVector<int> &handles);
+
+    /**
+     * @brief 通知设备状态已变化
+     * @param handles 状态变化的设备句柄
+     * @return 发出的dataChanged次数
+     */
+    int notifyStatusChanged(const QVector<int> &handles);
+
+private:
+    /**
+     * @brief 登记或移除插入/删除的行（连同子项目）的句柄
+     */
+    void updateRowsIndex(const QModelIndex &parent, int first, int last, bool indexed);
+
+    /**
+     * @brief 登记或移除项目及其子项目的句柄
+     */
+    void updateItemIndex(QStandardItem *item, bool indexed);
+
+    /**
+     * @brief 改写项目及其子项目保存的句柄
+     */
+    void remapItemHandles(QStandardItem *item, const QVector<int> &handles);
+
+private:
+    QPointer<const DeviceStatusFeed> m_feed;  // 状态汇集器
+    QVector<QStandardItem*> m_itemsByHandle;  // 设备句柄到项目
+    QVector<QPixmap> m_statusIcons;           // 各状态的图标（设置状态来源时生成）
+};
+
+#endif // DEVICETREEMODEL_H
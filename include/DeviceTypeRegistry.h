@@ -0,0 +1,120 @@
+#ifndef DEVICETYPEREGISTRY_H
+#define DEVICETYPEREGISTRY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 设备类型注册表
+ *
+ * 为目录中的每种设备类型分配一个整数ID（按注册顺序从1开始），并记录
+ * 显示名称和该类型的设备数量。ID 0 表示所有类型（显示为"全部模型"），
+ * -1 表示未知类型。类型只追加不删除，设备全部删除后ID仍然保留，因此
+ * 同一目录的各个版本中ID保持不变，标签页和查询缓存可以用ID代替类型名。
+ *
+ * 注册表随目录快照保存，隐式共享，复制的开销很小。
+ */
+class DeviceTypeRegistry
+{
+public:
+    enum {
+        AllTypes = 0,      // 所有类型
+        UnknownType = -1   // 未注册的类型
+    };
+
+    DeviceTypeRegistry();
+
+    /**
+     * @brief 获取类型的ID
+     * @param name 类型名称
+     * @return 类型ID，空字符串为AllTypes，未注册的类型为UnknownType
+     */
+    int typeId(const QString &name) const;
+
+    /**
+     * @brief 获取类型名称
+     * @param typeId 类型ID
+     * @return 类型名称，AllTypes和无效ID返回空字符串
+     */
+    QString typeName(int typeId) const;
+
+    /**
+     * @brief 获取类型的显示名称
+     * @param typeId 类型ID
+     * @return 显示名称，未设置时为类型名称；无效ID返回空字符串
+     */
+    QString displayName(int typeId) const;
+
+    /**
+     * @brief 获取类型的设备数量
+     * @param typeId 类型ID，AllTypes返回设备总数
+     * @return 设备数量，无效ID返回0
+     */
+    int deviceCount(int typeId) const;
+
+    /**
+     * @brief 检查ID是否有效（AllTypes或已注册的类型）
+     */
+    bool isValid(int typeId) const { return typeId >= 0 && typeId < m_entries.size(); }
+
+    /**
+     * @brief 获取已注册的类型数量（不含AllTypes）
+     */
+    int count() const { return m_entries.size() - 1; }
+
+    /**
+     * @brief 获取所有类型ID（注册顺序，不含AllTypes）
+     */
+    QVector<int> typeIds() const;
+
+    /**
+     * @brief 获取所有类型名称（注册顺序）
+     */
+    QStringList typeNames() const;
+
+    /**
+     * @brief 注册类型
+     * @param name 类型名称，不能为空
+     * @return 类型ID，已注册时返回原来的ID
+     */
+    int registerType(const QString &name);
+
+    /**
+     * @brief 设置类型的显示名称
+     * @param typeId 类型ID（可以是AllTypes）
+     * @param displayName 显示名称，空字符串恢复为类型名称
+     * @return ID无效时返回false
+     */
+    bool setDisplayName(int typeId, const QString &displayName);
+
+    /**
+     * @brief 调整类型的设备数量（设备总数同时调整）
+     * @param typeId 类型ID，AllTypes只调整总数
+     * @param delta 增加的数量，可以为负
+     */
+    void adjustCount(int typeId, int delta);
+
+    /**
+     * @brief 把所有设备数量清零（类型和ID保留）
+     */
+    void resetCounts();
+
+    /**
+     * @brief 估算注册表占用的字节数（不含字符串数据）
+     */
+    qint64 structureBytes() const;
+
+private:
+    struct Entry {
+        QString name;          // 类型名称
+        QString displayName;   // 显示名称（空为类型名称）
+        int count;             // 设备数量（AllTypes为设备总数）
+    };
+
+    QVector<Entry> m_entries;      // 类型ID到条目（0为AllTypes）
+    QHash<QString, int> m_index;   // 类型名称到类型ID
+};
+
+#endif // DEVICETYPEREGISTRY_H
@@ -3,16 +3,23 @@
 
 #include <QWidget>
 #include <QStringList>
+#include <QHash>
 
 class QTabWidget;
 class QLineEdit;
 class QTreeView;
-class QStandardItemModel;
+class DeviceTreeModel;
 class QStandardItem;
 class QLabel;
 class QVBoxLayout;
 class QHBoxLayout;
 class QCheckBox;
+class QBitArray;
+class SparklineBuffer;
+class SparklineDelegate;
+class DeviceStatusFeed;
+class DeviceManager;
+struct DeviceInfo;
 
 /**
  * @brief 设备控件类
@@ -26,11 +33,29 @@ class DeviceWidget : public QWidget
 
 public:
     /**
-     * @brief 构造函数
+     * @brief 构造函数，显示默认目录DeviceManager::instance()
      * @param parent 父窗口
      */
     explicit DeviceWidget(QWidget *parent = nullptr);
 
+    /**
+     * @brief 构造函数
+     * @param manager 显示的设备目录（不拥有，须比控件存活更久）
+     * @param parent 父窗口
+     */
+    explicit DeviceWidget(DeviceManager *manager, QWidget *parent = nullptr);
+
+    /**
+     * @brief 获取显示的设备目录
+     */
+    DeviceManager *deviceManager() const { return m_manager; }
+
+    /**
+     * @brief 获取当前标签页的设备类型ID
+     * @return 类型ID，"全部模型"标签页为DeviceTypeRegistry::AllTypes
+     */
+    int currentTypeId() const { return m_currentTypeId; }
+
     /**
      * @brief 获取已选择的设备ID列表
      * @return 设备ID列表
@@ -60,6 +85,34 @@ public:
      */
     void setSearchText(const QString &text);
 
+    /**
+     * @brief 设置迷你折线图的数值来源
+     * @param buffer 设备最近数值的环形缓冲区（不拥有），为空时折线图列不绘制内容
+     */
+    void setSparklineBuffer(SparklineBuffer *buffer);
+
+    /**
+     * @brief 设置是否显示迷你折线图列
+     * @param visible 是否显示
+     */
+    void setSparklinesVisible(bool visible);
+    bool sparklinesVisible() const { return m_sparklinesVisible; }
+
+    /**
+     * @brief 获取迷你折线图列的绘制代理
+     * @return 绘制代理，未设置数值来源时为空
+     */
+    SparklineDelegate *sparklineDelegate() const { return m_sparklineDelegate; }
+
+    /**
+     * @brief 设置设备实时状态的来源，状态以图标显示在设备名称前
+     *
+     * 汇集器改为按本控件显示的目录解析设备ID和句柄。
+     *
+     * @param feed 状态汇集器（不拥有），为空时不显示状态
+     */
+    void setStatusFeed(DeviceStatusFeed *feed);
+
 signals:
     /**
      * @brief 设备选择变化信号
@@ -127,6 +180,62 @@ private slots:
      */
     void onDataLoadError(const QString &error);
 
+    /**
+     * @brief 设备数值更新槽函数，重绘可见的折线图
+     * @param deviceIds 更新的设备ID
+     */
+    void onSparklineSamplesAppended(const QStringList &deviceIds);
+
+    /**
+     * @brief 设备插入槽函数，在对应位置插入新行
+     * @param parentId 父设备ID
+     * @param first 第一个插入设备的位置
+     * @param last 最后一个插入设备的位置
+     * @param deviceIds 插入的设备ID
+     */
+    void onDevicesInserted(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备删除槽函数，删除对应的行并从选择中移除
+     * @param parentId 父设备ID
+     * @param first 第一个删除设备的位置
+     * @param last 最后一个删除设备的位置
+     * @param deviceIds 删除的设备ID（包括子设备）
+     */
+    void onDevicesRemoved(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备信息变化槽函数，更新名称或按类型过滤结果显示/隐藏行
+     * @param parentId 父设备ID
+     * @param first 第一个变化设备的位置
+     * @param last 最后一个变化设备的位置
+     * @param deviceIds 变化的设备ID
+     */
+    void onDevicesChanged(const QString &parentId, int first, int last, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备移动槽函数，把行（连同子行）移动到新位置
+     */
+    void onDevicesMoved(const QString &sourceParentId, int sourceFirst, int sourceLast,
+                        const QString &destinationParentId, int destinationRow, const QStringList &deviceIds);
+
+    /**
+     * @brief 设备类型变化槽函数，为新类型添加标签页并更新显示名称
+     * @param types 设备类型列表
+     */
+    void onDeviceTypesChanged(const QStringList &types);
+
+    /**
+     * @brief 设备句柄重新编号槽函数，改写项目保存的句柄
+     * @param handles 旧句柄到新句柄的映射
+     */
+    void onHandlesRenumbered(const QVector<int> &handles);
+
+    /**
+     * @brief 目录修改提交槽函数，重新应用搜索过滤并更新选择显示和各类型的设备数量
+     */
+    void onCatalogChanged();
+
 private:
     /**
      * @brief 设置用户界面
@@ -139,15 +248,37 @@ private:
     void setupDeviceTree();
     
     /**
-     * @brief 创建标签页
+     * @brief 按类型注册表重建标签页，保持当前类型不变
      */
     void createTabs();
+
+    /**
+     * @brief 插入一个类型标签页，标签页数据为类型ID
+     * @param index 插入位置
+     * @param typeId 设备类型ID
+     */
+    void insertTypeTab(int index, int typeId);
+
+    /**
+     * @brief 按类型注册表增删标签页，并更新名称和设备数量提示
+     *
+     * 只有有设备的类型显示标签页。当前类型已没有设备时回到"全部模型"。
+     *
+     * @return 当前类型因此改变时返回true
+     */
+    bool updateTabs();
+
+    /**
+     * @brief 获取标签页的设备类型ID
+     * @param index 标签页索引
+     */
+    int typeIdForTab(int index) const;
     
     /**
      * @brief 加载设备数据到模型
-     * @param deviceType 设备类型，空字符串表示所有类型
+     * @param typeId 设备类型ID，DeviceTypeRegistry::AllTypes表示所有类型
      */
-    void loadDeviceData(const QString &deviceType = QString());
+    void loadDeviceData(int typeId);
     
     /**
      * @brief 根据关键字过滤设备
@@ -176,6 +307,66 @@ private:
      * @return 创建的标准项目
      */
     QStandardItem* createDeviceItem(const QString &deviceId);
+
+    /**
+     * @brief 创建设备树的一行（显示折线图列时附加折线图单元格）
+     * @param item 设备名称项目
+     * @return 该行的项目
+     */
+    QList<QStandardItem*> createDeviceRow(QStandardItem *item) const;
+
+    /**
+     * @brief 检查设备是否属于当前类型标签页
+     * @param device 设备信息
+     * @return 属于当前标签页返回true
+     */
+    bool isDeviceShown(const DeviceInfo &device) const;
+
+    /**
+     * @brief 按目录顺序递归添加设备及其子设备（加载设备数据时使用）
+     * @param deviceId 设备ID
+     * @param typeId 设备类型ID，DeviceTypeRegistry::AllTypes表示所有类型
+     */
+    void appendDeviceTree(const QString &deviceId, int typeId);
+
+    /**
+     * @brief 获取设备行应放入的父项目
+     *
+     * 父设备在树中时为父设备的项目，否则（顶层设备或父设备被类型过滤）
+     * 为根项目。
+     */
+    QStandardItem *parentItemFor(const DeviceInfo &device) const;
+
+    /**
+     * @brief 计算设备行在父项目中的插入位置
+     *
+     * 放在目录中后面第一个已显示的兄弟设备之前，没有时追加到末尾。
+     */
+    int itemRowFor(const DeviceInfo &device, QStandardItem *parentItem) const;
+
+    /**
+     * @brief 为设备创建并插入一行，并恢复其选中状态
+     * @param device 设备信息
+     * @return 插入的项目
+     */
+    QStandardItem *insertDeviceItem(const DeviceInfo &device);
+
+    /**
+     * @brief 删除设备行，被类型过滤时其子行移到顶层
+     * @param item 设备项目
+     */
+    void takeDeviceItem(QStandardItem *item);
+
+    /**
+     * @brief 从设备ID索引中移除项目及其所有子项目
+     * @param item 项目
+     */
+    void unregisterItems(QStandardItem *item);
+
+    /**
+     * @brief 设置表头标签和列宽
+     */
+    void updateTreeColumns();
     
     /**
      * @brief 递归设置项目选中状态
@@ -207,10 +398,10 @@ private:
     /**
      * @brief 递归过滤项目
      * @param item 项目
-     * @param filter 过滤关键字
+     * @param matches 匹配设备的句柄位图
      * @return 是否应该显示该项目
      */
-    bool filterItemRecursive(QStandardItem *item, const QString &filter);
+    bool filterItemRecursive(QStandardItem *item, const QBitArray &matches);
     
     /**
      * @brief 递归清除所有项目选择
@@ -256,7 +447,7 @@ private:
     QTabWidget *m_tabWidget;              // 设备类型标签页
     QLineEdit *m_searchEdit;              // 搜索输入框
     QTreeView *m_deviceTree;              // 设备树形视图
-    QStandardItemModel *m_deviceModel;    // 设备数据模型
+    DeviceTreeModel *m_deviceModel;       // 设备数据模型
     QCheckBox *m_selectAllCheckBox;       // 全选复选框
     QLabel *m_selectedCountLabel;         // 已选择数量标签
     QLabel *m_noResultLabel;              // 无结果提示标签
@@ -269,9 +460,19 @@ private:
     QHBoxLayout *m_statusLayout;          // 状态布局
     
     // 状态
-    QString m_currentDeviceType;          // 当前设备类型
+    int m_currentTypeId;                  // 当前标签页的设备类型ID
     QStringList m_selectedDeviceIds;      // 已选择的设备ID
     bool m_updatingSelection;             // 是否正在更新选择状态（防止递归）
+    QHash<QString, QStandardItem*> m_itemsById; // 设备ID到树项目（增量更新时定位行）
+    
+    // 迷你折线图
+    SparklineBuffer *m_sparklineBuffer;       // 设备最近数值（不拥有）
+    SparklineDelegate *m_sparklineDelegate;   // 折线图列的绘制代理
+    bool m_sparklinesVisible;                 // 是否显示折线图列
+    
+    // 实时状态
+    DeviceStatusFeed *m_statusFeed;           // 设备状态汇集器（不拥有）
+    DeviceManager *m_manager;                 // 显示的设备目录（不拥有）
 };
 
 #endif // DEVICEWIDGET_H
\ No newline at end of file
@@ -0,0 +1,153 @@
+#ifndef LIVEQUERYWINDOW_H
+#define LIVEQUERYWINDOW_H
+
+#include <QObject>
+#include <QThread>
+#include "TimeSeriesQuery.h"
+
+class TimeSeriesStore;
+
+/**
+ * @brief 实时窗口的增量更新
+ *
+ * 应用方式：每个设备的序列先从头部移除droppedHeadBuckets个过期桶，
+ * 再截断到firstUpdatedBucket个桶，最后追加tail中对应设备的聚合值。
+ */
+struct LiveWindowDelta {
+    TimeBucketer bucketer;         // 滚动后窗口的分桶器
+    int droppedHeadBuckets;        // 从头部移除的过期桶数
+    int firstUpdatedBucket;        // 新窗口中从该桶起的聚合值被替换或追加
+    QVector<DeviceSeries> tail;    // 每个设备从firstUpdatedBucket到末尾的聚合值
+    qint64 samplesScanned;         // 本次更新扫描的原始样本数
+    qint64 elapsedUs;              // 尾部聚合耗时（微秒）
+
+    LiveWindowDelta() : droppedHeadBuckets(0), firstUpdatedBucket(0), samplesScanned(0), elapsedUs(0) {}
+
+    /**
+     * @brief 判断增量是否有效（默认构造的增量无效）
+     */
+    bool isValid() const { return bucketer.isValid(); }
+};
+
+Q_DECLARE_METATYPE(LiveWindowDelta)
+
+/**
+ * @brief 在后台线程上聚合实时窗口尾部的工作对象（由LiveQueryWindow内部使用）
+ */
+class LiveTailRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LiveTailRunner(TimeSeriesStore *store) : m_store(store) {}
+
+public slots:
+    /**
+     * @brief 聚合增量的尾部
+     * @param request 已确定窗口几何的增量，tail中只有设备ID
+     * @param generation 窗口序号，原样随结果返回
+     */
+    void run(const LiveWindowDelta &request, quint64 generation);
+
+signals:
+    void finished(const LiveWindowDelta &delta, quint64 generation);
+
+private:
+    TimeSeriesStore *m_store; // 时间序列存储
+};
+
+/**
+ * @brief 实时查询窗口
+ *
+ * 以一次完整查询的结果为起点，窗口随时间向前滚动时只聚合新出现的
+ * 时间桶：最后一个桶在滚动前可能仍在累积样本，因此与新桶一起重新
+ * 聚合；移出窗口的头部桶直接丢弃。每次滚动产生一个增量而不是完整的
+ * 新结果。
+ *
+ * 尾部聚合在后台线程上执行，完成后回到窗口所在线程应用增量并发出
+ * windowAdvanced。同一时刻最多有一次聚合在执行，期间到来的滚动请求
+ * 只保留最后一个；reset()或stop()之前发出的聚合结果被丢弃。
+ */
+class LiveQueryWindow : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param store 时间序列存储（不拥有）
+     * @param parent 父对象
+     */
+    explicit LiveQueryWindow(TimeSeriesStore *store, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，等待正在执行的尾部聚合结束并停止后台线程
+     */
+    ~LiveQueryWindow();
+
+    /**
+     * @brief 以完整查询结果启动实时窗口
+     * @param result 当前窗口的完整查询结果
+     * @param spanMs 窗口长度（毫秒）
+     */
+    void reset(const TimeSeriesQueryResult &result, qint64 spanMs);
+
+    /**
+     * @brief 停止实时窗口，之后的滚动请求被忽略
+     */
+    void stop();
+
+    bool isActive() const { return m_active; }
+    qint64 spanMs() const { return m_spanMs; }
+
+    /**
+     * @brief 是否有尾部聚合正在执行或等待执行
+     */
+    bool isBusy() const { return m_inFlight || m_hasPending; }
+
+    /**
+     * @brief 获取应用全部增量后的当前结果
+     */
+    const TimeSeriesQueryResult &result() const { return m_result; }
+
+    /**
+     * @brief 请求把窗口终点滚动到指定时间，增量通过windowAdvanced异步发出
+     * @param nowMs 新的窗口终点（毫秒时间戳）
+     * @return 是否接受请求，未启动时返回false
+     */
+    bool advanceTo(qint64 nowMs);
+
+signals:
+    /**
+     * @brief 窗口滚动信号（增量已应用到result()）
+     * @param delta 本次滚动的增量
+     */
+    void windowAdvanced(const LiveWindowDelta &delta);
+
+    /**
+     * @brief 请求后台线程聚合尾部（内部使用）
+     */
+    void runRequested(const LiveWindowDelta &request, quint64 generation);
+
+private slots:
+    void onRunFinished(const LiveWindowDelta &delta, quint64 generation);
+
+private:
+    /**
+     * @brief 按当前结果计算滚动到nowMs的窗口几何并派发尾部聚合
+     */
+    void dispatch(qint64 nowMs);
+
+private:
+    QThread m_workerThread;           // 执行尾部聚合的后台线程
+    LiveTailRunner *m_runner;         // 后台线程上的工作对象
+    TimeSeriesQueryResult m_result;   // 当前窗口的结果
+    qint64 m_spanMs;                  // 窗口长度（毫秒）
+    bool m_active;                    // 是否已启动
+    bool m_inFlight;                  // 是否有尾部聚合正在执行
+    bool m_hasPending;                // 执行期间是否有新的滚动请求
+    qint64 m_pendingNowMs;            // 等待执行的窗口终点
+    quint64 m_generation;             // 窗口序号，reset()和stop()时递增
+};
+
+#endif // LIVEQUERYWINDOW_H
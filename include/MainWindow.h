@@ -4,14 +4,47 @@
 #include <QMainWindow>
 #include <QDateTime>
 #include <QStringList>
+#include <QScopedPointer>
+#include "TimeSeriesQuery.h"
+#include "QueryCostEstimator.h"
+#include "LiveQueryWindow.h"
+#include "DataExporter.h"
 
 class QResizeEvent;
+class QPushButton;
+class QProgressDialog;
 
 class TimeWidget;
 class DeviceWidget;
+class ChartPreviewWidget;
+class TimeSeriesStore;
+class QueryResultCache;
+class QueryExecutor;
+class QueryScheduler;
+class QueryPrefetcher;
+class SparklineBuffer;
+class DeviceStatusFeed;
+class CatalogWatcher;
 class QVBoxLayout;
 class QHBoxLayout;
 
+/**
+ * @brief 主窗口使用的本地数据路径
+ *
+ * 存储目录必须指定；目录文件或状态文件为空时不热加载目录、不读取状态。
+ * defaults()指向用户数据目录下的实际数据，只应由应用程序入口使用。
+ */
+struct MainWindowPaths {
+    QString storeRootPath;      // 时间序列存储的根目录
+    QString catalogFilePath;    // 设备目录文件（热加载到DeviceManager::instance()），为空时不监视
+    QString statusFilePath;     // 设备状态文件（采集程序追加写入），为空时不读取
+
+    /**
+     * @brief 获取用户数据目录下的默认路径
+     */
+    static MainWindowPaths defaults();
+};
+
 /**
  * @brief 主窗口类
  * 
@@ -25,9 +58,10 @@ class MainWindow : public QMainWindow
 public:
     /**
      * @brief 构造函数
+     * @param paths 存储、目录文件和状态文件的路径
      * @param parent 父窗口
      */
-    explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const MainWindowPaths &paths, QWidget *parent = nullptr);
     
     /**
      * @brief 析构函数
@@ -54,6 +88,101 @@ public:
      */
     QString getCurrentSearchText() const;
     
+    /**
+     * @brief 获取当前时间颗粒度
+     * @return 时间颗粒度
+     */
+    TimeWidget::TimeGranularity getCurrentGranularity() const;
+    
+    /**
+     * @brief 获取当前选择（设备 × 时间范围 × 颗粒度）的查询结果
+     * @return 最近一次查询结果
+     */
+    const TimeSeriesQueryResult &getCurrentData() const;
+    
+    /**
+     * @brief 获取当前查询结果的完成度
+     * @return 0.0 - 1.0，查询尚在流式返回时小于1
+     */
+    double getDataCompleteness() const;
+    
+    /**
+     * @brief 获取本地时间序列存储
+     * @return 时间序列存储
+     */
+    TimeSeriesStore *dataStore() const;
+    
+    /**
+     * @brief 获取查询调度器（可读取合并丢弃与取消的查询数）
+     * @return 查询调度器
+     */
+    QueryScheduler *queryScheduler() const;
+    
+    /**
+     * @brief 获取查询预取器（可读取预取命中统计）
+     * @return 查询预取器
+     */
+    QueryPrefetcher *queryPrefetcher() const;
+    
+    /**
+     * @brief 获取实时查询窗口（实时模式下增量维护getCurrentData()）
+     * @return 实时查询窗口
+     */
+    LiveQueryWindow *liveWindow() const;
+    
+    /**
+     * @brief 获取数据导出器（可读取最近一次导出的统计）
+     * @return 数据导出器
+     */
+    DataExporter *dataExporter() const;
+    
+    /**
+     * @brief 获取设备树迷你折线图使用的最近数值缓冲区
+     * @return 最近数值缓冲区
+     */
+    SparklineBuffer *sparklineBuffer() const;
+    
+    /**
+     * @brief 获取设备实时状态汇集器
+     * @return 设备状态汇集器
+     */
+    DeviceStatusFeed *statusFeed() const;
+    
+    /**
+     * @brief 获取设备目录文件的热加载监视器
+     * @return 目录监视器，未指定目录文件时为空
+     */
+    CatalogWatcher *catalogWatcher() const;
+    
+    /**
+     * @brief 在后台把当前选择（设备 × 时间范围 × 颗粒度）导出到文件
+     * @param filePath 目标文件路径
+     * @param format 文件格式
+     * @param content 导出聚合值或原始样本
+     * @return 已开始返回true，没有选择或已有导出在进行时返回false
+     */
+    bool exportCurrentSelection(const QString &filePath, ExportRequest::Format format,
+                                ExportRequest::Content content);
+    
+    /**
+     * @brief 获取当前选择的查询开销估算
+     * @return 开销估算值
+     */
+    QueryCostEstimate getCurrentEstimate() const;
+    
+    /**
+     * @brief 获取查询开销估算器（可调整预算）
+     * @return 查询开销估算器
+     */
+    QueryCostEstimator *costEstimator();
+    
+    /**
+     * @brief 设置查询超出预算时是否自动切换到更粗的颗粒度
+     * @param enabled 为false时只提示，由用户决定是否切换
+     */
+    void setAutoCoarsenEnabled(bool enabled);
+    bool isAutoCoarsenEnabled() const;
+    
     /**
      * @brief 设置时间范围（程序化设置）
      * @param start 开始时间
@@ -92,6 +221,48 @@ signals:
      * @param selectedDevices 选中的设备列表
      */
     void deviceSelectionUpdated(const QStringList &selectedDevices);
+    
+    /**
+     * @brief 当前选择的数据更新信号
+     * @param result 按颗粒度聚合后的查询结果
+     */
+    void dataUpdated(const TimeSeriesQueryResult &result);
+    
+    /**
+     * @brief 部分数据到达信号（查询仍在进行）
+     * @param partial 本批次新完成的设备序列，已合并进getCurrentData()
+     */
+    void dataPartiallyUpdated(const PartialQueryResult &partial);
+    
+    /**
+     * @brief 实时窗口滚动信号，只携带新增和更新的时间桶
+     * @param delta 增量，已应用到getCurrentData()
+     */
+    void dataAdvanced(const LiveWindowDelta &delta);
+    
+    /**
+     * @brief 当前选择的查询超出开销预算信号
+     * @param estimate 开销估算值
+     * @param suggested 建议的时间颗粒度
+     */
+    void queryBudgetExceeded(const QueryCostEstimate &estimate, TimeWidget::TimeGranularity suggested);
+    
+    /**
+     * @brief 导出结束信号（成功、失败或取消）
+     * @param stats 导出统计，含吞吐量
+     */
+    void exportFinished(const ExportStats &stats);
+
+public slots:
+    /**
+     * @brief 切换到估算器建议的时间颗粒度
+     */
+    void applySuggestedGranularity();
+    
+    /**
+     * @brief 选择目标文件并导出当前选择
+     */
+    void showExportDialog();
 
 private slots:
     /**
@@ -112,6 +283,61 @@ private slots:
      * @param text 搜索文本
      */
     void onSearchTextChanged(const QString &text);
+    
+    /**
+     * @brief 时间颗粒度变化槽函数
+     * @param granularity 时间颗粒度
+     */
+    void onGranularityChanged(TimeWidget::TimeGranularity granularity);
+    
+    /**
+     * @brief 查询结果就绪槽函数
+     * @param result 查询结果
+     */
+    void onQueryResultReady(const TimeSeriesQueryResult &result);
+    
+    /**
+     * @brief 查询开始执行槽函数
+     * @param query 查询参数
+     */
+    void onQueryStarted(const TimeSeriesQuery &query);
+    
+    /**
+     * @brief 部分查询结果到达槽函数
+     * @param partial 部分结果
+     */
+    void onPartialResultReady(const PartialQueryResult &partial);
+    
+    /**
+     * @brief 实时模式切换槽函数
+     * @param enabled 是否开启
+     */
+    void onLiveModeChanged(bool enabled);
+    
+    /**
+     * @brief 实时窗口滚动槽函数，只聚合新增的时间桶
+     * @param start 新的开始时间
+     * @param end 新的结束时间
+     */
+    void onLiveWindowAdvanced(const QDateTime &start, const QDateTime &end);
+    
+    /**
+     * @brief 实时窗口增量到达槽函数，更新折线图和图表
+     * @param delta 已应用到实时窗口结果的增量
+     */
+    void onLiveDeltaReady(const LiveWindowDelta &delta);
+    
+    /**
+     * @brief 导出进度槽函数
+     * @param stats 当前统计
+     */
+    void onExportProgress(const ExportStats &stats);
+    
+    /**
+     * @brief 导出结束槽函数
+     * @param stats 最终统计
+     */
+    void onExportFinished(const ExportStats &stats);
 
 private:
     /**
@@ -149,6 +375,11 @@ private:
      * @brief 更新布局边距以适应窗口大小
      */
     void updateLayoutMargins();
+    
+    /**
+     * @brief 按当前选择向查询调度器提交查询，结果就绪后发出dataUpdated信号
+     */
+    void refreshData();
 
 protected:
     /**
@@ -160,7 +391,11 @@ protected:
 private:
     TimeWidget *m_timeWidget;      // 时间控件
     DeviceWidget *m_deviceWidget;  // 设备控件
+    ChartPreviewWidget *m_chartPreview; // 选中数据的预览图
     QWidget *m_centralWidget;      // 中央窗口部件
+    QPushButton *m_coarsenButton;  // 状态栏中切换到建议颗粒度的按钮
+    QPushButton *m_exportButton;   // 状态栏中的导出按钮
+    QProgressDialog *m_exportProgress; // 导出进度对话框
     QVBoxLayout *m_mainLayout;     // 主布局
     
     // 当前状态
@@ -168,6 +403,28 @@ private:
     QDateTime m_currentEndTime;    // 当前结束时间
     QStringList m_selectedDevices; // 当前选中的设备
     QString m_searchText;          // 当前搜索文本
+    TimeWidget::TimeGranularity m_currentGranularity; // 当前时间颗粒度
+    
+    // 数据
+    QScopedPointer<QueryResultCache> m_resultCache; // 查询结果缓存（先于存储构造、后于存储析构）
+    QScopedPointer<TimeSeriesStore> m_dataStore; // 本地时间序列存储
+    QScopedPointer<QueryExecutor> m_queryExecutor; // 并行查询执行器
+    QScopedPointer<QueryScheduler> m_queryScheduler; // 查询调度器（先于执行器析构）
+    QScopedPointer<QueryPrefetcher> m_queryPrefetcher; // 空闲时预取相邻时间窗口
+    QScopedPointer<LiveQueryWindow> m_liveWindow; // 实时模式下增量维护的查询窗口
+    QScopedPointer<DataExporter> m_dataExporter; // 后台流式导出（先于存储析构）
+    QScopedPointer<SparklineBuffer> m_sparklineBuffer; // 每个设备最近的桶平均值
+    QScopedPointer<DeviceStatusFeed> m_statusFeed; // 设备实时状态（来源在其工作线程中运行）
+    QScopedPointer<CatalogWatcher> m_catalogWatcher; // 目录文件热加载
+    TimeSeriesQueryResult m_currentData;         // 当前选择的查询结果
+    double m_dataCompleteness;                   // 当前查询结果的完成度
+    
+    // 查询开销
+    QueryCostEstimator m_costEstimator;          // 查询开销估算器
+    QueryCostEstimate m_currentEstimate;         // 当前选择的开销估算
+    bool m_overBudget;                           // 当前选择是否超出预算
+    TimeWidget::TimeGranularity m_suggestedGranularity; // 超出预算时建议的颗粒度
+    bool m_autoCoarsen;                          // 超出预算时是否自动切换颗粒度
     
     // 状态同步标志
     bool m_isInitialized;          // 是否已初始化完成
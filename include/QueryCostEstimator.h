@@ -0,0 +1,102 @@
+#ifndef QUERYCOSTESTIMATOR_H
+#define QUERYCOSTESTIMATOR_H
+
+#include <QMetaType>
+#include <QString>
+#include "TimeSeriesQuery.h"
+
+/**
+ * @brief 查询开销估算值
+ */
+struct QueryCostEstimate {
+    int deviceCount;    // 设备数
+    int bucketCount;    // 每个设备的时间桶数
+    qint64 rows;        // 结果行数（设备数 × 桶数）
+    qint64 bytes;       // 结果占用的内存（字节）
+    double latencyMs;   // 预计查询耗时（毫秒）
+
+    QueryCostEstimate() : deviceCount(0), bucketCount(0), rows(0), bytes(0), latencyMs(0.0) {}
+};
+
+Q_DECLARE_METATYPE(QueryCostEstimate)
+
+/**
+ * @brief 查询开销预算
+ */
+struct QueryBudget {
+    qint64 maxRows;       // 最大结果行数
+    qint64 maxBytes;      // 最大结果内存（字节）
+    double maxLatencyMs;  // 最大预计耗时（毫秒）
+
+    QueryBudget() : maxRows(1000000), maxBytes(64 * 1024 * 1024), maxLatencyMs(500.0) {}
+};
+
+/**
+ * @brief 查询开销估算器
+ *
+ * 查询的结果规模在执行前即可精确得出：设备数 × TimeBucketer给出的
+ * 桶数。估算器据此计算结果行数和内存占用，并用线性模型（固定开销 +
+ * 每行耗时）估计查询延迟；每行耗时根据实际执行的查询结果做指数
+ * 滑动平均校准。校准只计从原始样本聚合的行，大部分行命中结果缓存
+ * 或预聚合层的结果不参与校准，估计值对应未命中时的耗时。
+ *
+ * 查询超出预算时，估算器给出仍满足预算的最细时间颗粒度。
+ */
+class QueryCostEstimator
+{
+public:
+    QueryCostEstimator();
+
+    /**
+     * @brief 估算查询开销
+     * @param query 查询参数
+     * @return 开销估算值，无效查询返回全零
+     */
+    QueryCostEstimate estimate(const TimeSeriesQuery &query) const;
+
+    /**
+     * @brief 设置查询开销预算
+     * @param budget 预算
+     */
+    void setBudget(const QueryBudget &budget) { m_budget = budget; }
+    QueryBudget budget() const { return m_budget; }
+
+    /**
+     * @brief 判断估算值是否超出预算
+     * @param estimate 开销估算值
+     * @return 行数、内存或耗时任一超出预算时返回true
+     */
+    bool exceedsBudget(const QueryCostEstimate &estimate) const;
+
+    /**
+     * @brief 为超出预算的查询建议颗粒度
+     * @param query 查询参数
+     * @return 不细于查询颗粒度且满足预算的最细颗粒度，都不满足时返回1天
+     */
+    TimeWidget::TimeGranularity suggestGranularity(const TimeSeriesQuery &query) const;
+
+    /**
+     * @brief 用实际执行的查询校准延迟模型
+     * @param result 完整的查询结果（被取消或大部分行未从原始样本聚合的结果会被忽略）
+     */
+    void recordExecution(const TimeSeriesQueryResult &result);
+
+    /**
+     * @brief 获取当前的每行耗时估计
+     * @return 微秒
+     */
+    double microsecondsPerRow() const { return m_usPerRow; }
+
+    /**
+     * @brief 格式化估算值，例如"35.0k rows, 1.6 MB, ~9 ms"
+     * @param estimate 开销估算值
+     * @return 显示用字符串
+     */
+    static QString formatEstimate(const QueryCostEstimate &estimate);
+
+private:
+    QueryBudget m_budget;  // 查询开销预算
+    double m_usPerRow;     // 每行耗时（微秒）
+};
+
+#endif // QUERYCOSTESTIMATOR_H
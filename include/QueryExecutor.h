@@ -0,0 +1,131 @@
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+
+#include <QMutex>
+#include <QObject>
+#include <QScopedPointer>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include "TimeSeriesQuery.h"
+
+class TimeSeriesStore;
+class WorkStealingThreadPool;
+
+/**
+ * @brief 查询取消令牌
+ *
+ * 副本共享同一个取消标志，可在任意线程调用cancel()。执行器中的
+ * 任务在开始前检查标志，已取消时直接跳过（协作式取消）。需要主动
+ * 让出CPU的后台任务用waitForCancel()代替休眠，取消时立即被唤醒。
+ */
+class QueryCancelToken
+{
+public:
+    QueryCancelToken() : m_state(std::make_shared<State>()) {}
+
+    void cancel() const;
+    bool isCancelled() const { return m_state->cancelled.load(); }
+
+    /**
+     * @brief 等待取消或超时
+     * @param usecs 最长等待时间（微秒）
+     * @return 是否已取消
+     */
+    bool waitForCancel(qint64 usecs) const;
+
+private:
+    /**
+     * @brief 副本之间共享的取消状态
+     */
+    struct State {
+        std::atomic<bool> cancelled;  // 取消标志
+        QMutex mutex;                 // 配合等待条件使用
+        QWaitCondition condition;     // 取消时唤醒等待者
+
+        State() : cancelled(false) {}
+    };
+
+    std::shared_ptr<State> m_state;   // 共享的取消状态
+};
+
+Q_DECLARE_METATYPE(QueryCancelToken)
+
+/**
+ * @brief 并行查询执行器
+ *
+ * 将选中设备的查询拆分为任务并在工作窃取线程池上执行：选中设备较多时
+ * 每个设备一个任务；设备数少于线程数时，把每个设备缺失的时间桶
+ * 再按时间切片，使少量设备的长时间范围查询也能用满所有核心。
+ * 各任务写入结果中互不重叠的位置，完成后无需额外合并。
+ *
+ * 执行期间已完成的设备按流式间隔分批通过partialResultReady发出，
+ * 第一个完成的设备立即发出，之后每个间隔最多发出一批。
+ */
+class QueryExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param store 时间序列存储（不拥有，须比执行器存活更久）
+     * @param threadCount 工作线程数，小于等于0时使用CPU核心数
+     * @param parent 父对象
+     */
+    explicit QueryExecutor(TimeSeriesStore *store, int threadCount = 0, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数
+     */
+    ~QueryExecutor();
+
+    /**
+     * @brief 设置工作线程数（重建线程池）
+     * @param threadCount 线程数，小于等于0时使用CPU核心数
+     */
+    void setThreadCount(int threadCount);
+
+    /**
+     * @brief 获取工作线程数
+     * @return 线程数
+     */
+    int threadCount() const;
+
+    /**
+     * @brief 设置部分结果的最小发送间隔
+     * @param msec 毫秒，默认16（约一帧）
+     */
+    void setStreamInterval(int msec) { m_streamIntervalMs = qMax(0, msec); }
+    int streamInterval() const { return m_streamIntervalMs; }
+
+    /**
+     * @brief 并行执行查询，阻塞直到全部设备完成或被取消
+     * @param query 查询参数
+     * @param token 取消令牌，取消后尚未开始的任务被跳过
+     * @return 查询结果，设备顺序与query.deviceIds一致；被取消时cancelled为true
+     */
+    TimeSeriesQueryResult execute(const TimeSeriesQuery &query,
+                                  const QueryCancelToken &token = QueryCancelToken());
+
+signals:
+    /**
+     * @brief 查询进度信号（在工作线程中发出）
+     * @param completed 已完成的任务数
+     * @param total 任务总数
+     */
+    void progressChanged(int completed, int total);
+
+    /**
+     * @brief 部分结果信号（在工作线程中发出，接收方应使用排队连接）
+     * @param partial 本批次新完成的设备序列
+     */
+    void partialResultReady(const PartialQueryResult &partial);
+
+private:
+    TimeSeriesStore *m_store;                        // 时间序列存储
+    QScopedPointer<WorkStealingThreadPool> m_pool;   // 工作窃取线程池
+    int m_streamIntervalMs;                          // 部分结果的发送间隔
+};
+
+#endif // QUERYEXECUTOR_H
@@ -0,0 +1,193 @@
+#ifndef QUERYPREFETCHER_H
+#define QUERYPREFETCHER_H
+
+#include <QObject>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+#include "QueryExecutor.h"
+
+class TimeSeriesStore;
+class QueryScheduler;
+
+/**
+ * @brief 在低优先级后台线程上预取查询窗口的工作对象（由QueryPrefetcher内部使用）
+ */
+class PrefetchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PrefetchRunner(TimeSeriesStore *store) : m_store(store) {}
+
+public slots:
+    /**
+     * @brief 依次预取窗口，把结果写入存储的查询结果缓存
+     * @param windows 预测的查询窗口
+     * @param token 取消令牌，用户查询到来时被取消
+     * @param cpuBudget CPU占用上限（百分比）
+     * @param byteCap 本次最多写入缓存的字节数，达到后停止预取
+     */
+    void run(const QVector<TimeSeriesQuery> &windows, const QueryCancelToken &token,
+             int cpuBudget, int byteCap);
+
+signals:
+    /**
+     * @brief 预取结束信号
+     * @param completedWindows 完整预取的窗口
+     * @param insertedBytes 本次写入缓存的字节数
+     */
+    void finished(const QVector<TimeSeriesQuery> &completedWindows, int insertedBytes);
+
+private:
+    TimeSeriesStore *m_store; // 时间序列存储
+};
+
+/**
+ * @brief 查询预取器
+ *
+ * 用户的下一步操作通常可以预测：向前翻一个周期、点击"前三天"、
+ * 或切换到更粗的时间颗粒度。每次查询完成并空闲一段时间后，预取器
+ * 在低优先级线程上为这些窗口预热查询结果缓存。
+ *
+ * 预取受CPU占用比例和预取写入缓存的字节上限约束；用户提交新查询时
+ * 立即取消正在进行的预取（在每个空档之前检查，让出CPU的等待也会被
+ * 唤醒）。预取器记录完成的窗口，据此统计完整覆盖用户查询的比例。
+ */
+class QueryPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param store 时间序列存储（不拥有，须已设置查询结果缓存）
+     * @param scheduler 用户查询调度器（不拥有）
+     * @param parent 父对象
+     */
+    QueryPrefetcher(TimeSeriesStore *store, QueryScheduler *scheduler, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，取消预取并停止后台线程
+     */
+    ~QueryPrefetcher();
+
+    /**
+     * @brief 根据当前查询预测下一步可能的查询窗口
+     * @param query 当前查询
+     * @return 前一个周期、三天超集（当前范围短于三天时）和更粗颗粒度的窗口
+     */
+    static QVector<TimeSeriesQuery> predictNextQueries(const TimeSeriesQuery &query);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief 设置开始预取前的空闲等待时间
+     * @param msec 毫秒
+     */
+    void setIdleDelay(int msec) { m_idleTimer.setInterval(qMax(0, msec)); }
+    int idleDelay() const { return m_idleTimer.interval(); }
+
+    /**
+     * @brief 设置预取线程的CPU占用上限
+     * @param percent 1 - 100
+     */
+    void setCpuBudget(int percent) { m_cpuBudget = qBound(1, percent, 100); }
+    int cpuBudget() const { return m_cpuBudget; }
+
+    /**
+     * @brief 设置预取可使用的缓存容量比例
+     * @param fraction 0.0 - 1.0，预取写入的字节超过该比例后不再预取
+     */
+    void setMemoryBudget(double fraction) { m_memoryBudget = qBound(0.0, fraction, 1.0); }
+    double memoryBudget() const { return m_memoryBudget; }
+
+    /**
+     * @brief 是否正在预取
+     */
+    bool isRunning() const { return m_running; }
+
+    quint64 windowsPrefetched() const { return m_windowsPrefetched; }
+    quint64 windowsPreempted() const { return m_windowsPreempted; }
+    quint64 userQueryCount() const { return m_userQueries; }
+
+    /**
+     * @brief 获取被已预取窗口完整覆盖的用户查询数
+     */
+    quint64 hitCount() const { return m_hits; }
+
+    /**
+     * @brief 获取预取写入缓存且可能仍在缓存中的字节数
+     */
+    qint64 prefetchedBytes() const { return m_prefetchedBytes; }
+
+    /**
+     * @brief 获取预取命中率
+     * @return 命中的用户查询比例（0.0 - 1.0）
+     */
+    double hitRate() const;
+
+signals:
+    /**
+     * @brief 预取开始信号
+     * @param windowCount 预取的窗口数
+     */
+    void prefetchStarted(int windowCount);
+
+    /**
+     * @brief 预取结束信号
+     * @param completedWindows 完整预取的窗口数
+     */
+    void prefetchFinished(int completedWindows);
+
+    /**
+     * @brief 请求后台线程执行预取（内部使用）
+     */
+    void runRequested(const QVector<TimeSeriesQuery> &windows, const QueryCancelToken &token,
+                      int cpuBudget, int byteCap);
+
+private slots:
+    void onUserQuerySubmitted(const TimeSeriesQuery &query);
+    void onUserResultReady(const TimeSeriesQueryResult &result);
+    void onIdleTimeout();
+    void onRunFinished(const QVector<TimeSeriesQuery> &completedWindows, int insertedBytes);
+
+private:
+    /**
+     * @brief 已预取完成的窗口（按全局桶序号记录）
+     */
+    struct PrefetchedWindow {
+        TimeWidget::TimeGranularity granularity;
+        qint64 firstOrdinal;
+        qint64 endOrdinal;
+        QSet<QString> deviceIds;
+    };
+
+    void cancelRunning();
+
+private:
+    TimeSeriesStore *m_store;                 // 时间序列存储
+    QThread m_workerThread;                   // 低优先级预取线程
+    PrefetchRunner *m_runner;                 // 预取线程上的工作对象
+    QTimer m_idleTimer;                       // 空闲等待定时器
+
+    bool m_enabled;                           // 是否启用预取
+    int m_cpuBudget;                          // CPU占用上限（百分比）
+    double m_memoryBudget;                    // 缓存容量比例上限
+
+    TimeSeriesQuery m_lastQuery;              // 最近一次用户查询
+    QueryCancelToken m_runningToken;          // 正在进行的预取的取消令牌
+    int m_runningWindows;                     // 正在预取的窗口数
+    bool m_running;                           // 是否正在预取
+    QVector<PrefetchedWindow> m_prefetched;   // 最近预取完成的窗口
+
+    // 统计
+    quint64 m_windowsPrefetched;              // 完整预取的窗口数
+    quint64 m_windowsPreempted;               // 被用户查询打断的窗口数
+    quint64 m_userQueries;                    // 用户查询数
+    quint64 m_hits;                           // 命中预取窗口的用户查询数
+    qint64 m_prefetchedBytes;                 // 预取写入缓存的字节数
+};
+
+#endif // QUERYPREFETCHER_H
@@ -0,0 +1,159 @@
+#ifndef QUERYRESULTCACHE_H
+#define QUERYRESULTCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "TimeSeriesQuery.h"
+
+/**
+ * @brief 查询结果缓存键（设备 × 时间颗粒度）
+ */
+struct QueryCacheKey {
+    QString deviceId;                         // 设备ID
+    TimeWidget::TimeGranularity granularity;  // 时间颗粒度
+
+    QueryCacheKey() : granularity(TimeWidget::Hour1) {}
+    QueryCacheKey(const QString &id, TimeWidget::TimeGranularity timeGranularity)
+        : deviceId(id), granularity(timeGranularity) {}
+
+    bool operator==(const QueryCacheKey &other) const {
+        return granularity == other.granularity && deviceId == other.deviceId;
+    }
+};
+
+inline uint qHash(const QueryCacheKey &key, uint seed = 0)
+{
+    return qHash(key.deviceId, seed) ^ (static_cast<uint>(key.granularity) * 0x9e3779b9u);
+}
+
+/**
+ * @brief 查询结果缓存
+ *
+ * 按（设备, 时间颗粒度）缓存已聚合的连续时间桶段（bucket run）。
+ * 新的查询范围被拆分为"已缓存的段"和"缺失的空档"，调用方只需
+ * 读取空档并写回缓存，移动时间窗口或扩大范围时可复用已有结果。
+ * 桶以TimeBucketer::firstOrdinal()定义的全局序号定位，因此不同
+ * 查询范围得到的桶可以直接拼接。
+ *
+ * 缓存有内存上限，按设备条目做LRU淘汰，并统计桶级命中率。
+ * 所有接口都是线程安全的。
+ */
+class QueryResultCache
+{
+public:
+    /**
+     * @brief 需要读取的缺失空档（查询分桶器中的桶序号区间）
+     */
+    struct Segment {
+        int firstBucket;  // 起始桶序号
+        int bucketCount;  // 桶数量
+
+        Segment() : firstBucket(0), bucketCount(0) {}
+        Segment(int first, int count) : firstBucket(first), bucketCount(count) {}
+    };
+
+    /**
+     * @brief 构造函数
+     * @param maxBytes 内存上限（字节）
+     */
+    explicit QueryResultCache(int maxBytes = 64 * 1024 * 1024);
+
+    /**
+     * @brief 查找缓存的桶并返回缺失的空档
+     * @param deviceId 设备ID
+     * @param bucketer 查询使用的时间分桶器
+     * @param buckets 输出数组，长度被调整为bucketer.bucketCount()，命中的桶被填入
+     * @param generation 可选输出，设备当前的失效代数，写回空档时传给insertIfCurrent()
+     * @return 按时间排序的缺失空档，为空表示完全命中
+     */
+    QVector<Segment> lookup(const QString &deviceId, const TimeBucketer &bucketer,
+                            QVector<BucketAggregate> &buckets, quint64 *generation = nullptr);
+
+    /**
+     * @brief 写入一段连续的桶，与已有的相邻或重叠段合并
+     * @param deviceId 设备ID
+     * @param bucketer 查询使用的时间分桶器
+     * @param firstBucket 第一个桶在分桶器中的序号
+     * @param buckets 聚合值
+     */
+    void insert(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                const QVector<BucketAggregate> &buckets);
+
+    /**
+     * @brief 设备自lookup()以来未失效时才写入
+     *
+     * 读取空档期间若有新样本写入，读到的聚合值可能已过期，
+     * 此时丢弃本次写入，避免把旧数据重新放回缓存
+     * @param deviceId 设备ID
+     * @param bucketer 查询使用的时间分桶器
+     * @param firstBucket 第一个桶在分桶器中的序号
+     * @param buckets 聚合值
+     * @param generation lookup()返回的失效代数
+     * @return 是否写入
+     */
+    bool insertIfCurrent(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                         const QVector<BucketAggregate> &buckets, quint64 generation);
+
+    /**
+     * @brief 使设备从指定时间起的缓存失效（新样本写入后调用）
+     * @param deviceId 设备ID
+     * @param fromMs 起始时间（毫秒时间戳）
+     */
+    void invalidateFrom(const QString &deviceId, qint64 fromMs);
+
+    /**
+     * @brief 清空缓存（统计保留）
+     */
+    void clear();
+
+    /**
+     * @brief 设置内存上限
+     * @param maxBytes 最大字节数
+     */
+    void setMaxBytes(int maxBytes);
+
+    int maxBytes() const;
+    int usedBytes() const;
+    int entryCount() const;
+    quint64 hitBuckets() const;
+    quint64 missBuckets() const;
+
+    /**
+     * @brief 获取桶级命中率
+     * @return 命中率（0.0 - 1.0），尚无查询时返回0
+     */
+    double hitRate() const;
+
+private:
+    /**
+     * @brief 一段连续的已缓存桶
+     */
+    struct BucketRun {
+        qint64 firstOrdinal;               // 第一个桶的全局序号
+        QVector<BucketAggregate> buckets;  // 聚合值
+
+        qint64 endOrdinal() const { return firstOrdinal + buckets.size(); }
+    };
+
+    typedef QVector<BucketRun> BucketRunList;  // 按序号排序且互不相邻的段
+
+    static int costOf(const BucketRunList &runs);
+
+    /**
+     * @brief 合并写入一段桶（调用方持有m_mutex）
+     */
+    void insertLocked(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                      const QVector<BucketAggregate> &buckets);
+
+private:
+    mutable QMutex m_mutex;                        // 保护以下成员
+    QCache<QueryCacheKey, BucketRunList> m_cache;  // LRU缓存
+    QHash<QString, quint64> m_generations;         // 设备失效代数，不随缓存条目淘汰
+    quint64 m_hitBuckets;                          // 命中的桶数
+    quint64 m_missBuckets;                         // 缺失的桶数
+};
+
+#endif // QUERYRESULTCACHE_H
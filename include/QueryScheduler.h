@@ -0,0 +1,159 @@
+#ifndef QUERYSCHEDULER_H
+#define QUERYSCHEDULER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include "QueryExecutor.h"
+
+/**
+ * @brief 在后台线程上执行查询的工作对象（由QueryScheduler内部使用）
+ */
+class QueryRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QueryRunner(QueryExecutor *executor) : m_executor(executor) {}
+
+public slots:
+    /**
+     * @brief 执行查询
+     * @param query 查询参数
+     * @param token 取消令牌
+     * @param generation 调度序号，原样随结果返回
+     */
+    void run(const TimeSeriesQuery &query, const QueryCancelToken &token, quint64 generation);
+
+signals:
+    void finished(const TimeSeriesQueryResult &result, quint64 generation);
+
+private:
+    QueryExecutor *m_executor; // 查询执行器
+};
+
+/**
+ * @brief 查询调度器
+ *
+ * 位于MainWindow的选择变化信号与查询后端之间：短时间内连续提交的
+ * 查询被合并，只有在提交停止一个稳定周期后才执行最后一次；新的查询
+ * 到来时取消仍在执行的旧查询。同一时刻最多只有一个查询在后台线程上
+ * 执行，结果通过排队信号回到调度器所在线程。
+ *
+ * 执行期间执行器分批发出的部分结果同样经排队信号转发，已取消查询的
+ * 部分结果会被丢弃。
+ */
+class QueryScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param executor 查询执行器（不拥有，须比调度器存活更久）
+     * @param parent 父对象
+     */
+    explicit QueryScheduler(QueryExecutor *executor, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数，取消正在执行的查询并停止后台线程
+     */
+    ~QueryScheduler();
+
+    /**
+     * @brief 设置合并查询的稳定周期
+     * @param msec 毫秒，0表示等到当前事件处理完毕即执行
+     */
+    void setSettleInterval(int msec);
+    int settleInterval() const { return m_settleTimer.interval(); }
+
+    /**
+     * @brief 提交查询，替换尚未执行的查询并取消已过时的执行中查询
+     * @param query 查询参数
+     */
+    void submit(const TimeSeriesQuery &query);
+
+    /**
+     * @brief 丢弃尚未执行的查询并取消执行中的查询
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有查询正在等待或执行
+     */
+    bool isBusy() const { return m_hasPending || m_inFlight; }
+
+    quint64 submittedCount() const { return m_submittedCount; }
+    quint64 executedCount() const { return m_executedCount; }
+
+    /**
+     * @brief 获取被合并丢弃（从未执行）的查询数
+     */
+    quint64 droppedCount() const { return m_droppedCount; }
+
+    /**
+     * @brief 获取执行中途被取消的查询数
+     */
+    quint64 cancelledCount() const { return m_cancelledCount; }
+
+signals:
+    /**
+     * @brief 查询提交信号（合并之前，每次submit都会发出）
+     * @param query 查询参数
+     */
+    void querySubmitted(const TimeSeriesQuery &query);
+
+    /**
+     * @brief 查询开始执行信号
+     * @param query 查询参数
+     */
+    void queryStarted(const TimeSeriesQuery &query);
+
+    /**
+     * @brief 最新查询完成信号（被取消的查询不会发出）
+     * @param result 查询结果
+     */
+    void resultReady(const TimeSeriesQueryResult &result);
+
+    /**
+     * @brief 当前查询的部分结果信号
+     * @param partial 本批次新完成的设备序列
+     */
+    void partialResultReady(const PartialQueryResult &partial);
+
+    /**
+     * @brief 请求后台线程执行查询（内部使用）
+     */
+    void runRequested(const TimeSeriesQuery &query, const QueryCancelToken &token, quint64 generation);
+
+private slots:
+    void onSettleTimeout();
+    void onRunFinished(const TimeSeriesQueryResult &result, quint64 generation);
+    void onPartialResult(const PartialQueryResult &partial);
+
+private:
+    /**
+     * @brief 把等待中的查询派发到后台线程
+     */
+    void dispatchPending();
+
+private:
+    QThread m_workerThread;          // 执行查询的后台线程
+    QueryRunner *m_runner;           // 后台线程上的工作对象
+    QTimer m_settleTimer;            // 合并查询的稳定周期定时器
+
+    TimeSeriesQuery m_pendingQuery;  // 等待执行的查询
+    bool m_hasPending;               // 是否有等待执行的查询
+    TimeSeriesQuery m_inFlightQuery; // 正在执行的查询
+    QueryCancelToken m_inFlightToken; // 正在执行的查询的取消令牌
+    bool m_inFlight;                 // 是否有查询正在执行
+    quint64 m_generation;            // 调度序号
+
+    // 统计
+    quint64 m_submittedCount;        // 提交的查询数
+    quint64 m_executedCount;         // 执行完成的查询数
+    quint64 m_droppedCount;          // 合并丢弃的查询数
+    quint64 m_cancelledCount;        // 执行中被取消的查询数
+};
+
+#endif // QUERYSCHEDULER_H
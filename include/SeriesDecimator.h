@@ -0,0 +1,56 @@
+#ifndef SERIESDECIMATOR_H
+#define SERIESDECIMATOR_H
+
+#include <QPointF>
+#include <QVector>
+#include "TimeSeriesQuery.h"
+
+/**
+ * @brief 时间序列降采样
+ *
+ * 把一段聚合序列降为与绘图宽度成正比的点数，使绘制开销只取决于
+ * 控件宽度而不是样本数。输出点的x为毫秒时间戳，y为数值，按x递增。
+ */
+class SeriesDecimator
+{
+public:
+    /**
+     * @brief 降采样方式
+     */
+    enum Mode {
+        MinMaxPerPixel,  // 每个像素列保留首值、最小值、最大值和尾值，不丢失尖峰
+        Lttb             // Largest-Triangle-Three-Buckets，保留视觉形状的平均值折线
+    };
+
+    /**
+     * @brief 对一段时间范围内的聚合序列降采样
+     *
+     * 只处理与[startMs, endMs)相交的非空时间桶。MinMaxPerPixel模式下
+     * 每列最多输出4个点，某列只有一个桶时输出该桶平均值；Lttb模式对
+     * 各桶平均值做LTTB，最多输出columns个点。
+     * @param mode 降采样方式
+     * @param bucketer 序列使用的时间分桶器
+     * @param buckets 与分桶器对齐的聚合值
+     * @param startMs 范围起点（毫秒时间戳）
+     * @param endMs 范围终点（毫秒时间戳，不含）
+     * @param columns 范围对应的像素列数
+     * @return 降采样后的点
+     */
+    static QVector<QPointF> decimate(Mode mode, const TimeBucketer &bucketer,
+                                     const QVector<BucketAggregate> &buckets,
+                                     qint64 startMs, qint64 endMs, int columns);
+
+    /**
+     * @brief Largest-Triangle-Three-Buckets降采样
+     *
+     * 保留首尾两点，中间的点平均分成threshold-2组，每组选出与前一个
+     * 选中点和下一组平均点构成最大三角形的点。
+     * @param points 按x递增的点
+     * @param count 点数
+     * @param threshold 输出点数，小于3或不小于count时原样返回
+     * @return 降采样后的点
+     */
+    static QVector<QPointF> largestTriangleThreeBuckets(const QPointF *points, int count, int threshold);
+};
+
+#endif // SERIESDECIMATOR_H
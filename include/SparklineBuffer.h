@@ -0,0 +1,114 @@
+#ifndef SPARKLINEBUFFER_H
+#define SPARKLINEBUFFER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+
+/**
+ * @brief 设备最近数值的环形缓冲区
+ *
+ * 每个设备保存固定个数的最近数值，写满后覆盖最旧的值，内存占用与
+ * 历史长度无关。NaN表示该位置没有数据（空时间桶），绘制时留出间隙。
+ *
+ * 每次写入递增设备的修订号，迷你折线图的绘制缓存以修订号判断是否
+ * 需要重新绘制。
+ */
+class SparklineBuffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 每个设备保存的数值个数
+     * @param parent 父对象
+     */
+    explicit SparklineBuffer(int capacity = 64, QObject *parent = nullptr);
+
+    int capacity() const { return m_capacity; }
+
+    /**
+     * @brief 追加一个数值
+     * @param deviceId 设备ID
+     * @param value 数值
+     */
+    void append(const QString &deviceId, double value);
+
+    /**
+     * @brief 追加一组数值（不发出信号，由调用方批量通知）
+     * @param deviceId 设备ID
+     * @param values 数值数组，从旧到新
+     * @param count 数值个数
+     * @param replaceLast 追加前先移除的最新数值个数（用于替换仍在累积的最后一个桶）
+     */
+    void appendValues(const QString &deviceId, const double *values, int count, int replaceLast = 0);
+
+    /**
+     * @brief 用一组数值替换设备的全部内容，只保留最后capacity个
+     * @param deviceId 设备ID
+     * @param values 数值，从旧到新
+     */
+    void assign(const QString &deviceId, const QVector<double> &values);
+
+    /**
+     * @brief 通知一批设备的数值已更新
+     * @param deviceIds 更新的设备ID
+     */
+    void notifyAppended(const QStringList &deviceIds);
+
+    /**
+     * @brief 获取设备的数值，从旧到新
+     * @param deviceId 设备ID
+     * @return 数值，设备不存在时为空
+     */
+    QVector<double> values(const QString &deviceId) const;
+
+    /**
+     * @brief 获取设备的修订号
+     * @param deviceId 设备ID
+     * @return 修订号，设备不存在时为0
+     */
+    quint64 revision(const QString &deviceId) const;
+
+    bool contains(const QString &deviceId) const { return m_rings.contains(deviceId); }
+    int deviceCount() const { return m_rings.size(); }
+
+    /**
+     * @brief 清空所有设备
+     */
+    void clear();
+
+signals:
+    /**
+     * @brief 数值更新信号
+     * @param deviceIds 更新的设备ID
+     */
+    void samplesAppended(const QStringList &deviceIds);
+
+private:
+    /**
+     * @brief 单个设备的环形缓冲区
+     */
+    struct Ring {
+        QVector<double> values;   // 固定容量的存储
+        int head;                 // 最旧数值的位置
+        int size;                 // 有效数值个数
+        quint64 revision;         // 修订号
+
+        Ring() : head(0), size(0), revision(0) {}
+    };
+
+    /**
+     * @brief 获取设备的缓冲区，不存在时创建
+     */
+    Ring &ring(const QString &deviceId);
+
+private:
+    int m_capacity;                 // 每个设备的容量
+    QHash<QString, Ring> m_rings;   // 设备ID到缓冲区
+    quint64 m_nextRevision;         // 全局递增的修订号，清空后重建的设备不会与旧缓存冲突
+};
+
+#endif // SPARKLINEBUFFER_H
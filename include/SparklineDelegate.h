@@ -0,0 +1,78 @@
+#ifndef SPARKLINEDELEGATE_H
+#define SPARKLINEDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QCache>
+#include <QPixmap>
+#include <QPointer>
+
+class SparklineBuffer;
+
+/**
+ * @brief 设备树中迷你折线图列的绘制代理
+ *
+ * 视图只对可见行调用paint，因此绘制开销与可见行数成正比而与设备总数
+ * 无关。每个设备的折线图绘制为位图缓存，只有设备的修订号、单元格大小
+ * 或选中状态变化时才重新绘制，滚动时只是复制位图。
+ *
+ * 设备ID从索引的Qt::UserRole读取。
+ */
+class SparklineDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param buffer 数值来源（不拥有）
+     * @param parent 父对象
+     */
+    explicit SparklineDelegate(const SparklineBuffer *buffer, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    /**
+     * @brief 设置缓存的最大位图数（超出时淘汰最久未使用的）
+     * @param count 位图数
+     */
+    void setCacheCapacity(int count);
+
+    /**
+     * @brief 清空位图缓存
+     */
+    void invalidate();
+
+    /**
+     * @brief 获取重新绘制位图的次数（用于验证滚动不重绘）
+     */
+    int renderCount() const { return m_renderCount; }
+
+    /**
+     * @brief 获取缓存中的位图数
+     */
+    int cachedCount() const { return m_cache.count(); }
+
+private:
+    /**
+     * @brief 缓存的折线图位图及其对应的状态
+     */
+    struct CachedSparkline {
+        QPixmap pixmap;       // 折线图位图
+        quint64 revision;     // 绘制时设备的修订号
+        bool selected;        // 绘制时是否选中
+    };
+
+    /**
+     * @brief 按数值绘制折线图位图
+     */
+    QPixmap render(const QVector<double> &values, const QSize &size, qreal ratio, const QColor &color) const;
+
+private:
+    QPointer<const SparklineBuffer> m_buffer;            // 数值来源（销毁后不再绘制）
+    mutable QCache<QString, CachedSparkline> m_cache;    // 设备ID到位图
+    mutable int m_renderCount;                           // 重新绘制位图的次数
+};
+
+#endif // SPARKLINEDELEGATE_H
@@ -0,0 +1,63 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief 字符串驻留池
+ *
+ * 相同内容的字符串只保留一份，intern()返回与池中副本共享数据的
+ * QString，多个目录中重复出现的设备类型因此只占一份内存。池中的
+ * 字符串在池销毁前一直保留，因此只用于取值有限的字符串；父设备ID
+ * 等随目录修改而变化的字符串不应驻留。所有方法都是线程安全的，可以在
+ * 后台解析线程上使用。
+ */
+class StringPool
+{
+public:
+    StringPool();
+
+    /**
+     * @brief 获取进程内默认的共享池
+     */
+    static StringPool &global();
+
+    /**
+     * @brief 驻留字符串
+     * @param text 字符串
+     * @return 与池中副本共享数据的字符串；空字符串原样返回
+     */
+    QString intern(const QString &text);
+
+    /**
+     * @brief 检查字符串是否就是池中的副本（共享同一份数据）
+     * @param text 字符串
+     */
+    bool owns(const QString &text) const;
+
+    /**
+     * @brief 获取池中的字符串数
+     */
+    int size() const;
+
+    /**
+     * @brief 获取池中字符串占用的字节数（估算）
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief 估算一个字符串数据块占用的字节数
+     * @param text 字符串
+     * @return 字节数，空字符串为0
+     */
+    static qint64 stringBytes(const QString &text);
+
+private:
+    mutable QMutex m_mutex;     // 保护以下成员
+    QSet<QString> m_strings;    // 驻留的字符串
+    qint64 m_bytes;             // 字符串占用的字节数
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,129 @@
+#ifndef TIMEBUCKETER_H
+#define TIMEBUCKETER_H
+
+#include <QVector>
+#include <QTimeZone>
+#include "TimeWidget.h"
+
+/**
+ * @brief 时间分桶器
+ *
+ * 将（开始时间, 结束时间, 时间颗粒度）转换为对齐的时间桶，全部基于
+ * 毫秒级Unix时间戳整数运算。15分钟和1小时颗粒度按本地时钟对齐的
+ * 固定宽度划分；1天颗粒度以本地零点为边界，借助预先计算的时区
+ * 跳变表正确处理夏令时（23/25小时的日期）。
+ *
+ * 桶序号与时间戳之间的相互转换均为O(1)（时区偏移查找只在极小的
+ * 跳变表上二分）。
+ */
+class TimeBucketer
+{
+public:
+    /**
+     * @brief 构造无效的分桶器
+     */
+    TimeBucketer();
+
+    /**
+     * @brief 构造函数
+     * @param startMs 开始时间（毫秒时间戳），向下对齐到桶边界
+     * @param endMs 结束时间（毫秒时间戳，不含），向上对齐到桶边界
+     * @param granularity 时间颗粒度
+     * @param zone 用于对齐的时区，默认使用系统时区
+     */
+    TimeBucketer(qint64 startMs, qint64 endMs,
+                 TimeWidget::TimeGranularity granularity,
+                 const QTimeZone &zone = QTimeZone::systemTimeZone());
+
+    /**
+     * @brief 获取颗粒度对应的标称桶宽度
+     * @param granularity 时间颗粒度
+     * @return 桶宽度（毫秒），1天颗粒度返回24小时
+     */
+    static qint64 granularityMs(TimeWidget::TimeGranularity granularity);
+
+    bool isValid() const { return m_bucketCount > 0; }
+    TimeWidget::TimeGranularity granularity() const { return m_granularity; }
+    int bucketCount() const { return m_bucketCount; }
+
+    /**
+     * @brief 获取对齐后的开始时间（第一个桶的起点）
+     */
+    qint64 startMs() const { return bucketStart(0); }
+
+    /**
+     * @brief 获取对齐后的结束时间（最后一个桶的终点）
+     */
+    qint64 endMs() const { return bucketStart(m_bucketCount); }
+
+    /**
+     * @brief 获取桶的开始时间
+     * @param index 桶序号，允许等于bucketCount()以获取最后一个桶的终点
+     * @return 毫秒时间戳
+     */
+    qint64 bucketStart(int index) const;
+
+    /**
+     * @brief 获取桶的结束时间（不含）
+     * @param index 桶序号
+     * @return 毫秒时间戳
+     */
+    qint64 bucketEnd(int index) const { return bucketStart(index + 1); }
+
+    /**
+     * @brief 获取时间戳所在的桶序号
+     * @param timestampMs 毫秒时间戳
+     * @return 桶序号，不在范围内时返回-1
+     */
+    int bucketIndex(qint64 timestampMs) const;
+
+    /**
+     * @brief 获取第一个桶在该颗粒度全局网格中的序号
+     *
+     * 同一颗粒度下，不同查询范围得到的桶共享同一网格，
+     * 全局序号 = firstOrdinal() + 桶序号，可用于跨查询复用结果。
+     * @return 全局桶序号（固定宽度桶为起点UTC时间戳除以桶宽，按天分桶为本地日序号）
+     */
+    qint64 firstOrdinal() const { return m_firstOrdinal; }
+
+    /**
+     * @brief 获取全部桶边界
+     * @return bucketCount()+1个边界时间戳
+     */
+    QVector<qint64> boundaries() const;
+
+    bool operator==(const TimeBucketer &other) const;
+    bool operator!=(const TimeBucketer &other) const { return !(*this == other); }
+
+private:
+    /**
+     * @brief 预先计算时区跳变表
+     */
+    void buildTransitionTable(const QTimeZone &zone, qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief 获取UTC时刻的时区偏移
+     * @param utcMs 毫秒时间戳
+     * @return 偏移（毫秒）
+     */
+    qint64 offsetAt(qint64 utcMs) const;
+
+    /**
+     * @brief 将本地墙上时间（以毫秒计）转换为UTC时间戳
+     */
+    qint64 localToUtc(qint64 localMs) const;
+
+    static qint64 floorDiv(qint64 value, qint64 divisor);
+
+private:
+    TimeWidget::TimeGranularity m_granularity; // 时间颗粒度
+    qint64 m_widthMs;                          // 固定桶宽度（毫秒）
+    qint64 m_originMs;                         // 第一个桶的开始时间
+    int m_bucketCount;                         // 桶数量
+    qint64 m_firstOrdinal;                     // 第一个桶的全局序号（按天分桶时为本地日序号）
+    QVector<qint64> m_dayStarts;               // 按天分桶时的全部边界
+    QVector<qint64> m_transitionsMs;           // 时区跳变时刻
+    QVector<qint64> m_offsetsMs;               // 每个跳变之后的偏移，m_offsetsMs[0]为首个跳变之前的偏移
+};
+
+#endif // TIMEBUCKETER_H
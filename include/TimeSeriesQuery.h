@@ -0,0 +1,166 @@
+#ifndef TIMESERIESQUERY_H
+#define TIMESERIESQUERY_H
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <limits>
+#include "TimeBucketer.h"
+
+/**
+ * @brief 时间桶聚合值
+ *
+ * 保存一个时间桶内样本的最小值、最大值、总和、数量以及首尾值
+ */
+struct BucketAggregate {
+    qint64 count;   // 样本数量
+    double sum;     // 样本总和
+    double min;     // 最小值
+    double max;     // 最大值
+    double first;   // 桶内第一个样本
+    double last;    // 桶内最后一个样本
+
+    /**
+     * @brief 默认构造函数（空桶）
+     */
+    BucketAggregate()
+        : count(0), sum(0.0),
+          min(std::numeric_limits<double>::infinity()),
+          max(-std::numeric_limits<double>::infinity()),
+          first(0.0), last(0.0) {}
+
+    /**
+     * @brief 判断桶是否为空
+     * @return 没有样本时返回true
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * @brief 获取平均值
+     * @return 平均值，空桶返回0
+     */
+    double average() const { return count > 0 ? sum / count : 0.0; }
+
+    /**
+     * @brief 累加一个样本（样本须按时间顺序加入）
+     * @param value 样本值
+     */
+    void add(double value) {
+        if (count == 0) {
+            first = value;
+        }
+        if (value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
+        }
+        sum += value;
+        last = value;
+        ++count;
+    }
+
+    /**
+     * @brief 合并时间上位于其后的另一个聚合值
+     * @param other 后续的聚合值
+     */
+    void merge(const BucketAggregate &other) {
+        if (other.count == 0) {
+            return;
+        }
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        count += other.count;
+        sum += other.sum;
+        min = qMin(min, other.min);
+        max = qMax(max, other.max);
+        last = other.last;
+    }
+};
+
+/**
+ * @brief 时间序列查询参数
+ *
+ * 对应界面上的"选中设备 × 时间范围 × 时间颗粒度"
+ */
+struct TimeSeriesQuery {
+    QStringList deviceIds;                    // 选中的设备ID
+    qint64 startMs;                           // 开始时间（毫秒时间戳）
+    qint64 endMs;                             // 结束时间（毫秒时间戳，不含）
+    TimeWidget::TimeGranularity granularity;  // 时间颗粒度
+
+    TimeSeriesQuery() : startMs(0), endMs(0), granularity(TimeWidget::Hour1) {}
+
+    TimeSeriesQuery(const QStringList &ids, qint64 start, qint64 end,
+                    TimeWidget::TimeGranularity timeGranularity)
+        : deviceIds(ids), startMs(start), endMs(end), granularity(timeGranularity) {}
+
+    /**
+     * @brief 判断查询是否有效
+     * @return 时间范围有效且至少选中一个设备时返回true
+     */
+    bool isValid() const { return endMs > startMs && !deviceIds.isEmpty(); }
+
+    bool operator==(const TimeSeriesQuery &other) const {
+        return startMs == other.startMs && endMs == other.endMs &&
+               granularity == other.granularity && deviceIds == other.deviceIds;
+    }
+    bool operator!=(const TimeSeriesQuery &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 单个设备的聚合序列
+ */
+struct DeviceSeries {
+    QString deviceId;                   // 设备ID
+    QVector<BucketAggregate> buckets;   // 与查询分桶器一一对应的聚合值
+
+    DeviceSeries() {}
+    DeviceSeries(const QString &id, const QVector<BucketAggregate> &values)
+        : deviceId(id), buckets(values) {}
+};
+
+/**
+ * @brief 时间序列查询结果
+ */
+struct TimeSeriesQueryResult {
+    TimeBucketer bucketer;          // 结果使用的时间分桶
+    QVector<DeviceSeries> series;   // 每个设备的聚合序列
+    qint64 samplesScanned;          // 扫描的原始样本数
+    qint64 bucketsScanned;          // 从原始样本聚合的桶数（命中缓存或预聚合层的不计入）
+    qint64 elapsedUs;               // 查询耗时（微秒）
+    bool cancelled;                 // 查询是否被取消（结果不完整）
+
+    TimeSeriesQueryResult() : samplesScanned(0), bucketsScanned(0), elapsedUs(0), cancelled(false) {}
+};
+
+/**
+ * @brief 流式返回的部分查询结果
+ *
+ * 查询执行期间按批次发送已完成设备的序列，界面可先行显示。
+ */
+struct PartialQueryResult {
+    TimeBucketer bucketer;          // 结果使用的时间分桶
+    QVector<DeviceSeries> series;   // 本批次新完成的设备序列
+    int completedDevices;           // 截至本批次已完成的设备总数
+    int totalDevices;               // 查询的设备总数
+
+    PartialQueryResult() : completedDevices(0), totalDevices(0) {}
+
+    /**
+     * @brief 获取完成度
+     * @return 0.0 - 1.0
+     */
+    double completeness() const {
+        return totalDevices > 0 ? static_cast<double>(completedDevices) / totalDevices : 1.0;
+    }
+};
+
+Q_DECLARE_METATYPE(TimeSeriesQuery)
+Q_DECLARE_METATYPE(TimeSeriesQueryResult)
+Q_DECLARE_METATYPE(PartialQueryResult)
+
+#endif // TIMESERIESQUERY_H
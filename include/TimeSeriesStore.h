@@ -0,0 +1,285 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "TimeSeriesQuery.h"
+
+class QueryResultCache;
+
+/**
+ * @brief 本地时间序列存储
+ *
+ * 基于文件的嵌入式时间序列库，无需外部数据库。每个设备一个目录，
+ * 样本按固定时间跨度（默认1天）分块，每块由两个列式文件组成：
+ * <块起点>.ts 保存qint64时间戳，<块起点>.val 保存double数值。
+ * 查询时以内存映射方式读取块文件，并按时间分桶聚合。
+ *
+ * 每个设备另外维护15分钟、1小时和1天三个预聚合层（rollup-<层>.bin），
+ * 保存按全局桶序号排序的定长聚合记录，写入时增量更新。查询规划选择
+ * 边界与查询桶对齐且不细于查询颗粒度的最粗一层，例如一年范围的1天
+ * 查询只读取365条记录，不触及原始样本；没有可用的层时回退到原始块。
+ *
+ * 写入为追加模式，同一设备的样本必须按时间递增写入。
+ * 查询接口可在多个线程上并发调用。
+ */
+class TimeSeriesStore
+{
+public:
+    /**
+     * @brief 查询可使用的存储层
+     */
+    enum StorageTier {
+        RawSamples,       // 原始样本块
+        Minutes15Rollup,  // 15分钟预聚合层
+        Hour1Rollup,      // 1小时预聚合层
+        Day1Rollup        // 1天预聚合层
+    };
+
+    /**
+     * @brief 构造函数
+     * @param rootPath 存储根目录，不存在时自动创建
+     * @param chunkSpanMs 每个数据块覆盖的时间跨度（毫秒）
+     */
+    explicit TimeSeriesStore(const QString &rootPath,
+                             qint64 chunkSpanMs = 24 * 60 * 60 * 1000LL);
+
+    /**
+     * @brief 获取默认的存储目录（应用数据目录下的timeseries）
+     * @return 目录路径
+     */
+    static QString defaultRootPath();
+
+    QString rootPath() const { return m_rootPath; }
+    qint64 chunkSpanMs() const { return m_chunkSpanMs; }
+
+    /**
+     * @brief 设置查询结果缓存
+     *
+     * 设置后查询只读取缓存中缺失的时间桶，追加样本时自动使受影响的
+     * 缓存失效。缓存的所有权不转移，可为空以关闭缓存。
+     * @param cache 查询结果缓存
+     */
+    void setResultCache(QueryResultCache *cache) { m_resultCache = cache; }
+    QueryResultCache *resultCache() const { return m_resultCache; }
+
+    /**
+     * @brief 设置查询是否使用预聚合层
+     *
+     * 只影响查询规划，写入时始终维护预聚合层。
+     * @param enabled 为false时所有查询都扫描原始样本
+     */
+    void setRollupsEnabled(bool enabled) { m_rollupsEnabled = enabled; }
+    bool rollupsEnabled() const { return m_rollupsEnabled; }
+
+    /**
+     * @brief 追加样本
+     * @param deviceId 设备ID
+     * @param timestamps 时间戳数组（毫秒，递增）
+     * @param values 数值数组
+     * @param count 样本数量
+     * @return 成功返回true，失败时可通过getLastError()获取原因
+     */
+    bool append(const QString &deviceId, const qint64 *timestamps, const double *values, int count);
+
+    /**
+     * @brief 追加单个样本
+     * @param deviceId 设备ID
+     * @param timestampMs 时间戳（毫秒）
+     * @param value 数值
+     * @return 成功返回true
+     */
+    bool append(const QString &deviceId, qint64 timestampMs, double value);
+
+    /**
+     * @brief 执行查询：对选中设备在时间范围内按颗粒度聚合
+     * @param query 查询参数
+     * @return 查询结果，每个设备一条与分桶器对齐的序列
+     */
+    TimeSeriesQueryResult query(const TimeSeriesQuery &query) const;
+
+    /**
+     * @brief 查询单个设备在分桶器全部范围内的聚合值（经过结果缓存）
+     * @param deviceId 设备ID
+     * @param bucketer 时间分桶器
+     * @param samplesScanned 输出扫描的样本数（可为空），命中缓存的部分不计入
+     * @param bucketsScanned 输出从原始样本聚合的桶数（可为空），命中缓存或使用预聚合层的桶不计入
+     * @return bucketer.bucketCount()个聚合值
+     */
+    QVector<BucketAggregate> queryDevice(const QString &deviceId, const TimeBucketer &bucketer,
+                                         qint64 *samplesScanned = nullptr, qint64 *bucketsScanned = nullptr) const;
+
+    /**
+     * @brief 聚合单个设备的一段连续时间桶
+     * @param deviceId 设备ID
+     * @param bucketer 时间分桶器
+     * @param firstBucket 起始桶序号
+     * @param bucketCount 桶数量
+     * @param samplesScanned 输出聚合的原始样本数（可为空），使用预聚合层时按其覆盖的样本计
+     * @param bucketsScanned 输出从原始样本聚合的桶数（可为空），使用预聚合层时为0
+     * @return bucketCount个聚合值
+     */
+    QVector<BucketAggregate> aggregateDevice(const QString &deviceId, const TimeBucketer &bucketer,
+                                             int firstBucket, int bucketCount,
+                                             qint64 *samplesScanned = nullptr, qint64 *bucketsScanned = nullptr) const;
+
+    /**
+     * @brief 获取查询规划为一段连续时间桶选择的存储层
+     * @param deviceId 设备ID
+     * @param bucketer 时间分桶器
+     * @param firstBucket 起始桶序号
+     * @param bucketCount 桶数量
+     * @return 可用的最粗预聚合层，没有可用的层时返回RawSamples
+     */
+    StorageTier selectTier(const QString &deviceId, const TimeBucketer &bucketer,
+                           int firstBucket, int bucketCount) const;
+
+    /**
+     * @brief 从原始样本重建设备的全部预聚合层
+     *
+     * 用于补建升级前写入的数据；追加样本时发现预聚合层缺失或无法
+     * 增量更新（如样本写入了更早的数据块）也会自动调用。
+     * @param deviceId 设备ID
+     * @return 成功返回true，失败时删除该设备的预聚合层并设置错误信息
+     */
+    bool rebuildRollups(const QString &deviceId);
+
+    /**
+     * @brief 原始样本访问回调
+     * @param timestamps 时间戳数组（毫秒，递增）
+     * @param values 数值数组
+     * @param count 样本数量
+     * @return 返回false时停止扫描
+     */
+    using SampleVisitor = std::function<bool(const qint64 *timestamps, const double *values, qint64 count)>;
+
+    /**
+     * @brief 按时间顺序扫描单个设备在时间范围内的原始样本
+     *
+     * 逐个数据块内存映射并回调，每次回调最多覆盖一个数据块，
+     * 指针只在回调期间有效。内存占用与扫描范围无关。
+     * @param deviceId 设备ID
+     * @param startMs 开始时间（毫秒时间戳）
+     * @param endMs 结束时间（毫秒时间戳，不含）
+     * @param visitor 样本访问回调
+     * @param error 数据块无法打开或读取时的错误信息（可为空），此时扫描停止
+     * @return 回调过的样本数
+     */
+    qint64 scanSamples(const QString &deviceId, qint64 startMs, qint64 endMs,
+                       const SampleVisitor &visitor, QString *error = nullptr) const;
+
+    /**
+     * @brief 获取设备已有数据块的起点
+     * @param deviceId 设备ID
+     * @return 按时间排序的块起点列表
+     */
+    QVector<qint64> chunkStarts(const QString &deviceId) const;
+
+    /**
+     * @brief 获取最后的错误信息
+     * @return 错误信息字符串
+     */
+    QString getLastError() const { return m_lastError; }
+
+private:
+    /**
+     * @brief 获取设备数据目录
+     */
+    QString deviceDirectory(const QString &deviceId) const;
+
+    /**
+     * @brief 获取数据块文件路径
+     * @param deviceId 设备ID
+     * @param chunkStart 块起点
+     * @param suffix 文件后缀（ts或val）
+     */
+    QString chunkPath(const QString &deviceId, qint64 chunkStart, const QString &suffix) const;
+
+    /**
+     * @brief 计算时间戳所属数据块的起点
+     */
+    qint64 chunkStartFor(qint64 timestampMs) const;
+
+    /**
+     * @brief 从磁盘扫描设备的数据块（带缓存）
+     */
+    QVector<qint64> loadChunkIndex(const QString &deviceId) const;
+
+    /**
+     * @brief 向单个数据块追加连续样本
+     */
+    bool appendToChunk(const QString &deviceId, qint64 chunkStart,
+                       const qint64 *timestamps, const double *values, int count);
+
+    /**
+     * @brief 读取数据块的最后一个时间戳
+     * @return 块为空或不存在时返回false
+     */
+    bool readLastTimestamp(const QString &deviceId, qint64 chunkStart, qint64 &timestampMs) const;
+
+    /**
+     * @brief 对内存映射的一个数据块做分桶聚合
+     * @param boundaries 桶边界数组，长度为bucketCount+1
+     * @return 落在桶范围内的样本数
+     */
+    qint64 aggregateChunk(const QString &deviceId, qint64 chunkStart,
+                          const qint64 *boundaries, int bucketCount,
+                          BucketAggregate *out) const;
+
+    /**
+     * @brief 获取预聚合层文件路径
+     * @param deviceId 设备ID
+     * @param tier 预聚合层的颗粒度
+     */
+    QString rollupPath(const QString &deviceId, TimeWidget::TimeGranularity tier) const;
+
+    /**
+     * @brief 把新追加的样本增量合并到各预聚合层
+     * @param hadSamples 追加之前设备是否已有样本
+     * @return 需要重建（层缺失、时区不符或样本早于已有记录）或写入失败时返回false
+     */
+    bool updateRollups(const QString &deviceId, const qint64 *timestamps, const double *values,
+                       int count, bool hadSamples);
+
+    /**
+     * @brief 删除设备的全部预聚合层，使查询回退到原始样本
+     */
+    void removeRollups(const QString &deviceId);
+
+    /**
+     * @brief 为一段查询桶选择预聚合层（调用方须持有m_rollupLock读锁）
+     * @param boundaries 桶边界数组，长度为bucketCount+1
+     * @param granularity 查询颗粒度
+     * @param tierBucketer 输出覆盖相同范围的预聚合层分桶器
+     * @param tierToBucket 输出每个层内桶所属的查询桶序号
+     * @return 选中的存储层
+     */
+    StorageTier planTier(const QString &deviceId, const qint64 *boundaries, int bucketCount,
+                         TimeWidget::TimeGranularity granularity,
+                         TimeBucketer &tierBucketer, QVector<int> &tierToBucket) const;
+
+    /**
+     * @brief 读取预聚合层记录并合并到查询桶（调用方须持有m_rollupLock读锁）
+     * @return 记录覆盖的原始样本数，层文件无效时返回-1
+     */
+    qint64 aggregateRollup(const QString &deviceId, TimeWidget::TimeGranularity tier,
+                           const TimeBucketer &tierBucketer, const QVector<int> &tierToBucket,
+                           BucketAggregate *out) const;
+
+private:
+    QString m_rootPath;                                // 存储根目录
+    qint64 m_chunkSpanMs;                              // 数据块时间跨度
+    QString m_lastError;                               // 最后的错误信息
+    QueryResultCache *m_resultCache;                   // 查询结果缓存（不拥有）
+    QTimeZone m_zone;                                  // 预聚合层对齐使用的时区
+    bool m_rollupsEnabled;                             // 查询是否使用预聚合层
+
+    mutable QReadWriteLock m_indexLock;                // 保护块索引
+    mutable QHash<QString, QVector<qint64>> m_chunkIndex; // 设备ID到已排序块起点的缓存
+    mutable QReadWriteLock m_rollupLock;               // 保护预聚合层文件
+};
+
+#endif // TIMESERIESSTORE_H
@@ -10,12 +10,15 @@ class QDateTimeEdit;
 class QVBoxLayout;
 class QHBoxLayout;
 class QLabel;
+class QPushButton;
+class QTimer;
 
 /**
  * @brief 时间控件类
  * 
  * 提供时间颗粒度选择、时间范围设置和快捷时间选择功能
  * 支持15分钟、1小时、1天的时间颗粒度，以及前一天、前三天的快捷选择
+ * 实时模式下时间窗口保持长度不变，随当前时间定时向前滚动
  */
 class TimeWidget : public QWidget
 {
@@ -61,6 +64,35 @@ public:
      * @param end 结束时间
      */
     void setTimeRange(const QDateTime &start, const QDateTime &end);
+    
+    /**
+     * @brief 设置时间颗粒度（颗粒度变化时发出granularityChanged信号）
+     * @param granularity 时间颗粒度
+     */
+    void setGranularity(TimeGranularity granularity);
+    
+    /**
+     * @brief 设置实时模式
+     *
+     * 开启时以当前时间范围的长度为窗口，终点对齐到当前时间（发出一次
+     * timeRangeChanged），之后每个周期发出liveWindowAdvanced；手动编辑
+     * 时间会退出实时模式。
+     * @param enabled 是否开启
+     */
+    void setLiveMode(bool enabled);
+    
+    /**
+     * @brief 是否处于实时模式
+     * @return 实时模式返回true
+     */
+    bool isLiveMode() const;
+    
+    /**
+     * @brief 设置实时模式的滚动周期
+     * @param msec 毫秒
+     */
+    void setLiveInterval(int msec);
+    int liveInterval() const;
 
 signals:
     /**
@@ -81,6 +113,19 @@ signals:
      * @param error 错误信息
      */
     void validationError(const QString &error);
+    
+    /**
+     * @brief 实时模式切换信号
+     * @param enabled 是否开启
+     */
+    void liveModeChanged(bool enabled);
+    
+    /**
+     * @brief 实时窗口向前滚动信号（不会同时发出timeRangeChanged）
+     * @param start 新的开始时间
+     * @param end 新的结束时间（当前时间）
+     */
+    void liveWindowAdvanced(const QDateTime &start, const QDateTime &end);
 
 private slots:
     /**
@@ -97,6 +142,11 @@ private slots:
      * @brief 日期时间变化槽函数
      */
     void onDateTimeChanged();
+    
+    /**
+     * @brief 实时模式定时器槽函数
+     */
+    void onLiveTimerTimeout();
 
 private:
     /**
@@ -162,6 +212,8 @@ private:
     QDateTimeEdit *m_endTimeEdit;        // 结束时间编辑器
     QLabel *m_titleLabel;                // 标题标签
     QLabel *m_errorLabel;                // 错误提示标签
+    QPushButton *m_liveButton;           // 实时模式按钮
+    QTimer *m_liveTimer;                 // 实时模式滚动定时器
     
     // 布局
     QVBoxLayout *m_mainLayout;           // 主布局
@@ -172,6 +224,7 @@ private:
     // 状态
     TimeGranularity m_currentGranularity; // 当前时间颗粒度
     bool m_updatingTime;                   // 是否正在更新时间（防止递归）
+    qint64 m_liveSpanMs;                   // 实时窗口长度（毫秒）
 };
 
 #endif // TIMEWIDGET_H
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef WORKSTEALINGTHREADPOOL_H
+#define WORKSTEALINGTHREADPOOL_H
+
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程拥有独立的任务队列：线程从自己队列的尾部取任务
+ * （后进先出，缓存局部性好），空闲时从其他线程队列的头部窃取任务，
+ * 使大小不均的任务也能在所有核心间自动均衡。
+ *
+ * 从工作线程内部提交的任务进入该线程自己的队列，外部提交的任务
+ * 轮流分配到各队列。
+ */
+class WorkStealingThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * @brief 构造函数
+     * @param threadCount 工作线程数，小于等于0时使用CPU核心数
+     */
+    explicit WorkStealingThreadPool(int threadCount = 0);
+
+    /**
+     * @brief 析构函数，等待已提交的任务执行完毕后停止线程
+     */
+    ~WorkStealingThreadPool();
+
+    int threadCount() const { return m_threads.size(); }
+
+    /**
+     * @brief 提交任务
+     * @param task 任务
+     */
+    void submit(Task task);
+
+    /**
+     * @brief 阻塞等待所有已提交的任务完成
+     *
+     * 不能在本线程池的工作线程中调用。
+     */
+    void waitForDone();
+
+    /**
+     * @brief 获取被其他线程窃取执行的任务数（用于统计负载均衡情况）
+     */
+    quint64 stolenTaskCount() const { return m_stolenTasks.load(); }
+
+private:
+    class Worker;
+
+    /**
+     * @brief 单个工作线程的任务队列
+     */
+    struct TaskQueue {
+        QMutex mutex;            // 保护任务队列
+        std::deque<Task> tasks;  // 任务（所有者取尾部，窃取者取头部）
+    };
+
+    void workerLoop(int index);
+    bool popLocal(int index, Task &task);
+    bool steal(int thief, Task &task);
+    void finishTask();
+
+private:
+    std::vector<std::unique_ptr<TaskQueue>> m_queues; // 每个线程一个任务队列
+    QVector<QThread *> m_threads;                     // 工作线程
+
+    QMutex m_stateMutex;             // 配合等待条件使用
+    QWaitCondition m_workAvailable;  // 有新任务
+    QWaitCondition m_allDone;        // 所有任务完成
+    bool m_stopping;                 // 是否正在停止
+
+    std::atomic<int> m_queuedTasks;     // 队列中尚未取出的任务数
+    std::atomic<int> m_pendingTasks;    // 已提交尚未完成的任务数
+    std::atomic<unsigned> m_nextQueue;  // 外部提交时轮流选择的队列
+    std::atomic<quint64> m_stolenTasks; // 被窃取的任务数
+};
+
+#endif // WORKSTEALINGTHREADPOOL_H
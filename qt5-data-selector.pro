@@ -15,7 +15,32 @@ SOURCES += \
     src/TimeWidget.cpp \
     src/DeviceManager.cpp \
     src/DeviceWidget.cpp \
-    src/CustomButton.cpp
+    src/CustomButton.cpp \
+    src/DeviceQueryCache.cpp \
+    src/TimeBucketer.cpp \
+    src/TimeSeriesStore.cpp \
+    src/AggregationKernels.cpp \
+    src/QueryResultCache.cpp \
+    src/WorkStealingThreadPool.cpp \
+    src/QueryExecutor.cpp \
+    src/QueryScheduler.cpp \
+    src/QueryPrefetcher.cpp \
+    src/QueryCostEstimator.cpp \
+    src/LiveQueryWindow.cpp \
+    src/DataExporter.cpp \
+    src/SeriesDecimator.cpp \
+    src/ChartPreviewWidget.cpp \
+    src/SparklineBuffer.cpp \
+    src/SparklineDelegate.cpp \
+    src/DeviceStatusFeed.cpp \
+    src/DeviceStatusSources.cpp \
+    src/DeviceTreeModel.cpp \
+    src/CatalogLoader.cpp \
+    src/CatalogWatcher.cpp \
+    src/CatalogSnapshot.cpp \
+    src/StringPool.cpp \
+    src/DeviceTypeRegistry.cpp \
+    src/CatalogArena.cpp
 
 # Header files
 HEADERS += \
@@ -24,7 +49,33 @@ HEADERS += \
     include/DeviceManager.h \
     include/DeviceInfo.h \
     include/DeviceWidget.h \
-    include/CustomButton.h
+    include/CustomButton.h \
+    include/DeviceQueryCache.h \
+    include/TimeBucketer.h \
+    include/TimeSeriesStore.h \
+    include/TimeSeriesQuery.h \
+    include/AggregationKernels.h \
+    include/QueryResultCache.h \
+    include/WorkStealingThreadPool.h \
+    include/QueryExecutor.h \
+    include/QueryScheduler.h \
+    include/QueryPrefetcher.h \
+    include/QueryCostEstimator.h \
+    include/LiveQueryWindow.h \
+    include/DataExporter.h \
+    include/SeriesDecimator.h \
+    include/ChartPreviewWidget.h \
+    include/SparklineBuffer.h \
+    include/SparklineDelegate.h \
+    include/DeviceStatusFeed.h \
+    include/DeviceStatusSources.h \
+    include/DeviceTreeModel.h \
+    include/CatalogLoader.h \
+    include/CatalogWatcher.h \
+    include/CatalogSnapshot.h \
+    include/StringPool.h \
+    include/DeviceTypeRegistry.h \
+    include/CatalogArena.h
 
 # Resources
 RESOURCES += resources.qrc
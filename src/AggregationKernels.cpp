@@ -0,0 +1,186 @@
+#include "AggregationKernels.h"
+#include <algorithm>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AGGREGATION_KERNELS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 一段连续数值的归约结果
+ */
+struct RangeReduction {
+    double sum;
+    double min;
+    double max;
+};
+
+RangeReduction reduceScalar(const double *values, qint64 count)
+{
+    RangeReduction result = { 0.0, std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity() };
+    for (qint64 i = 0; i < count; ++i) {
+        const double value = values[i];
+        result.sum += value;
+        if (value < result.min) {
+            result.min = value;
+        }
+        if (value > result.max) {
+            result.max = value;
+        }
+    }
+    return result;
+}
+
+#ifdef AGGREGATION_KERNELS_HAVE_AVX2
+__attribute__((target("avx2")))
+RangeReduction reduceAvx2(const double *values, qint64 count)
+{
+    // 两组累加器交错使用，隐藏加法延迟
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d min0 = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d min1 = min0;
+    __m256d max0 = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d max1 = max0;
+
+    // min/max的操作数顺序保证NaN被忽略，与标量实现一致
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256d a = _mm256_loadu_pd(values + i);
+        const __m256d b = _mm256_loadu_pd(values + i + 4);
+        sum0 = _mm256_add_pd(sum0, a);
+        sum1 = _mm256_add_pd(sum1, b);
+        min0 = _mm256_min_pd(a, min0);
+        min1 = _mm256_min_pd(b, min1);
+        max0 = _mm256_max_pd(a, max0);
+        max1 = _mm256_max_pd(b, max1);
+    }
+    for (; i + 4 <= count; i += 4) {
+        const __m256d a = _mm256_loadu_pd(values + i);
+        sum0 = _mm256_add_pd(sum0, a);
+        min0 = _mm256_min_pd(a, min0);
+        max0 = _mm256_max_pd(a, max0);
+    }
+
+    alignas(32) double sums[4];
+    alignas(32) double mins[4];
+    alignas(32) double maxs[4];
+    _mm256_store_pd(sums, _mm256_add_pd(sum0, sum1));
+    _mm256_store_pd(mins, _mm256_min_pd(min0, min1));
+    _mm256_store_pd(maxs, _mm256_max_pd(max0, max1));
+
+    RangeReduction result = reduceScalar(values + i, count - i);
+    for (int lane = 0; lane < 4; ++lane) {
+        result.sum += sums[lane];
+        result.min = std::min(result.min, mins[lane]);
+        result.max = std::max(result.max, maxs[lane]);
+    }
+    return result;
+}
+#endif
+
+typedef RangeReduction (*ReduceFunction)(const double *, qint64);
+
+/**
+ * @brief 通用的分桶遍历，归约部分由具体实现提供
+ */
+qint64 aggregateWith(ReduceFunction reduce,
+                     const qint64 *timestamps, const double *values, qint64 count,
+                     const qint64 *boundaries, int bucketCount, BucketAggregate *out)
+{
+    if (!timestamps || !values || count <= 0 || !boundaries || bucketCount <= 0 || !out) {
+        return 0;
+    }
+
+    const qint64 *end = timestamps + count;
+    const qint64 *cursor = std::lower_bound(timestamps, end, boundaries[0]);
+    qint64 consumed = 0;
+
+    for (int bucket = 0; bucket < bucketCount && cursor != end; ++bucket) {
+        // 时间戳有序，桶内样本是一段连续区间
+        const qint64 *bucketEnd = std::lower_bound(cursor, end, boundaries[bucket + 1]);
+        const qint64 first = cursor - timestamps;
+        const qint64 n = bucketEnd - cursor;
+        cursor = bucketEnd;
+
+        if (n == 0) {
+            continue;
+        }
+
+        const RangeReduction reduction = reduce(values + first, n);
+        BucketAggregate partial;
+        partial.count = n;
+        partial.sum = reduction.sum;
+        partial.min = reduction.min;
+        partial.max = reduction.max;
+        partial.first = values[first];
+        partial.last = values[first + n - 1];
+        out[bucket].merge(partial);
+        consumed += n;
+    }
+
+    return consumed;
+}
+
+bool cpuSupportsAvx2()
+{
+#ifdef AGGREGATION_KERNELS_HAVE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+qint64 AggregationKernels::aggregate(const qint64 *timestamps, const double *values, qint64 count,
+                                     const qint64 *boundaries, int bucketCount, BucketAggregate *out)
+{
+    return aggregate(activeImplementation(), timestamps, values, count, boundaries, bucketCount, out);
+}
+
+qint64 AggregationKernels::aggregate(Implementation implementation,
+                                     const qint64 *timestamps, const double *values, qint64 count,
+                                     const qint64 *boundaries, int bucketCount, BucketAggregate *out)
+{
+#ifdef AGGREGATION_KERNELS_HAVE_AVX2
+    if (implementation == Avx2 && cpuSupportsAvx2()) {
+        return aggregateWith(reduceAvx2, timestamps, values, count, boundaries, bucketCount, out);
+    }
+#else
+    Q_UNUSED(implementation);
+#endif
+    return aggregateWith(reduceScalar, timestamps, values, count, boundaries, bucketCount, out);
+}
+
+bool AggregationKernels::isSupported(Implementation implementation)
+{
+    switch (implementation) {
+    case Scalar:
+        return true;
+    case Avx2:
+        return cpuSupportsAvx2();
+    }
+    return false;
+}
+
+AggregationKernels::Implementation AggregationKernels::activeImplementation()
+{
+    return cpuSupportsAvx2() ? Avx2 : Scalar;
+}
+
+const char *AggregationKernels::implementationName(Implementation implementation)
+{
+    switch (implementation) {
+    case Scalar:
+        return "scalar";
+    case Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,160 @@
+#include "CatalogArena.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+// 超过块大小四分之一的分配单独占一块，不浪费当前块的剩余空间
+const size_t LargeAllocationDivisor = 4;
+
+/**
+ * @brief 把UTF-8解码为UTF-16
+ * @param utf8 UTF-8数据
+ * @param size 字节数
+ * @param out 输出缓冲区，至少size个字符
+ * @return 输出的字符数
+ */
+int decodeUtf8(const uchar *utf8, int size, QChar *out)
+{
+    int length = 0;
+    int i = 0;
+    while (i < size) {
+        uint code = utf8[i];
+        if (code < 0x80) {
+            out[length++] = QChar(ushort(code));
+            ++i;
+            continue;
+        }
+
+        int extra;
+        uint minimum;
+        if ((code & 0xE0) == 0xC0) {
+            extra = 1;
+            code &= 0x1F;
+            minimum = 0x80;
+        } else if ((code & 0xF0) == 0xE0) {
+            extra = 2;
+            code &= 0x0F;
+            minimum = 0x800;
+        } else if ((code & 0xF8) == 0xF0) {
+            extra = 3;
+            code &= 0x07;
+            minimum = 0x10000;
+        } else {
+            out[length++] = QChar(QChar::ReplacementCharacter);
+            ++i;
+            continue;
+        }
+
+        int consumed = 1;
+        while (consumed <= extra && i + consumed < size && (utf8[i + consumed] & 0xC0) == 0x80) {
+            code = (code << 6) | (utf8[i + consumed] & 0x3F);
+            ++consumed;
+        }
+        i += consumed;
+
+        // 截断、过长编码、代理区和超出范围的码点都视为无效
+        if (consumed <= extra || code < minimum || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+            out[length++] = QChar(QChar::ReplacementCharacter);
+        } else if (QChar::requiresSurrogates(code)) {
+            out[length++] = QChar(QChar::highSurrogate(code));
+            out[length++] = QChar(QChar::lowSurrogate(code));
+        } else {
+            out[length++] = QChar(ushort(code));
+        }
+    }
+    return length;
+}
+}
+
+CatalogArena::CatalogArena(int blockSize)
+    : m_cursor(nullptr)
+    , m_end(nullptr)
+    , m_blockSize(blockSize > 0 ? static_cast<size_t>(blockSize) : 4096)
+    , m_reservedBytes(0)
+    , m_usedBytes(0)
+{
+}
+
+CatalogArena::~CatalogArena()
+{
+    release();
+}
+
+void *CatalogArena::allocate(size_t size, size_t alignment)
+{
+    if (size == 0) {
+        size = 1;
+    }
+
+    // 大的分配单独占一块，插在当前块之前，当前块继续使用
+    if (size + alignment > m_blockSize / LargeAllocationDivisor) {
+        char *block = new char[size + alignment];
+        m_blocks.insert(m_blocks.isEmpty() ? 0 : m_blocks.size() - 1, block);
+        m_reservedBytes += static_cast<qint64>(size + alignment);
+        m_usedBytes += static_cast<qint64>(size);
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(block) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    if (!m_cursor || aligned + size > reinterpret_cast<uintptr_t>(m_end)) {
+        addBlock(m_blockSize);
+        aligned = (reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+
+    char *result = reinterpret_cast<char *>(aligned);
+    m_usedBytes += static_cast<qint64>(result + size - m_cursor);
+    m_cursor = result + size;
+    return result;
+}
+
+ArenaString CatalogArena::copyUtf8(const char *utf8, int size)
+{
+    if (size <= 0) {
+        return ArenaString();
+    }
+
+    // 按最坏情况（每个字节一个字符）分配，解码后把多余的部分还给当前块
+    QChar *text = allocateArray<QChar>(size);
+    const int length = decodeUtf8(reinterpret_cast<const uchar *>(utf8), size, text);
+    char *end = reinterpret_cast<char *>(text + length);
+    if (reinterpret_cast<char *>(text + size) == m_cursor) {
+        m_usedBytes -= static_cast<qint64>(m_cursor - end);
+        m_cursor = end;
+    }
+    return ArenaString(text, length);
+}
+
+ArenaString CatalogArena::copy(QStringView text)
+{
+    if (text.isEmpty()) {
+        return ArenaString();
+    }
+
+    const int length = static_cast<int>(text.size());
+    QChar *data = allocateArray<QChar>(length);
+    memcpy(data, text.data(), sizeof(QChar) * static_cast<size_t>(length));
+    return ArenaString(data, length);
+}
+
+void CatalogArena::release()
+{
+    for (char *block : m_blocks) {
+        delete[] block;
+    }
+    m_blocks.clear();
+    m_cursor = nullptr;
+    m_end = nullptr;
+    m_reservedBytes = 0;
+    m_usedBytes = 0;
+}
+
+void CatalogArena::addBlock(size_t minimumSize)
+{
+    const size_t size = minimumSize > m_blockSize ? minimumSize : m_blockSize;
+    char *block = new char[size];
+    m_blocks.append(block);
+    m_cursor = block;
+    m_end = block + size;
+    m_reservedBytes += static_cast<qint64>(size);
+}
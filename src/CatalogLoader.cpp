@@ -0,0 +1,566 @@
+#include "CatalogLoader.h"
+#include "CatalogSnapshot.h"
+#include "DeviceManager.h"
+#include "WorkStealingThreadPool.h"
+#include <QFile>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+
+namespace {
+// 每行的字段数：设备ID、父设备ID、类型、是否分组、名称
+const int FieldCount = 5;
+
+/**
+ * @brief 差异遍历中待处理的设备
+ */
+struct PendingDevice {
+    int index;        // 在新目录中的下标
+    int row;          // 在兄弟中的位置
+    int parentAtom;   // 新父设备ID在当前目录中的原子（尚无时为-1）
+};
+
+/**
+ * @brief 与QByteArray::trimmed()相同的空白字符
+ */
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief 去掉字段两端的空白
+ */
+inline void trim(const char *&begin, const char *&end)
+{
+    while (begin < end && isSpace(*begin)) {
+        ++begin;
+    }
+    while (end > begin && isSpace(end[-1])) {
+        --end;
+    }
+}
+
+inline bool fieldEquals(const char *begin, const char *end, const char *text)
+{
+    const size_t length = strlen(text);
+    return static_cast<size_t>(end - begin) == length && memcmp(begin, text, length) == 0;
+}
+
+/**
+ * @brief 让QString指向内存区中的字符串（不复制），只能用于查找
+ */
+inline const QString &rawString(QString &buffer, const ArenaString &text)
+{
+    buffer.setRawData(text.data, text.size);
+    return buffer;
+}
+
+/**
+ * @brief 在行边界处切出的一个分块
+ */
+struct ParseChunk {
+    const char *begin;       // 分块起点（行首）
+    const char *end;         // 分块终点（下一分块的行首）
+    int firstLine;           // 第一行的行号
+    int lineCount;           // 行数，即记录数的上限
+    CatalogRecord *records;  // 解析出的记录（在记录表中的一段）
+    int count;               // 解析出的记录数
+    QStringList types;       // 出现的设备类型（首次出现的顺序）
+    QString error;           // 错误信息，空为成功
+
+    ParseChunk()
+        : begin(nullptr), end(nullptr), firstLine(1), lineCount(0), records(nullptr), count(0) {}
+};
+
+int countLines(const char *begin, const char *end)
+{
+    int lines = 0;
+    for (const char *p = begin; (p = static_cast<const char *>(memchr(p, '\n', size_t(end - p)))); ++p) {
+        ++lines;
+    }
+    return lines;
+}
+
+/**
+ * @brief 把分块中的行解析为记录，字符串解码到内存区
+ *
+ * 只检查单行内的错误；重复ID和层级关系在合并后检查。出错时停在出错
+ * 的行，之前的记录保留。
+ */
+void parseChunk(ParseChunk &chunk, CatalogArena &arena)
+{
+    int lineNumber = chunk.firstLine - 1;
+    const char *lineStart = chunk.begin;
+    while (lineStart < chunk.end) {
+        const char *lineEnd = static_cast<const char *>(memchr(lineStart, '\n', size_t(chunk.end - lineStart)));
+        if (!lineEnd) {
+            lineEnd = chunk.end;
+        }
+        ++lineNumber;
+        const char *begin = lineStart;
+        const char *end = lineEnd;
+        lineStart = lineEnd + 1;
+        trim(begin, end);
+        if (begin == end || *begin == '#') {
+            continue;
+        }
+
+        // 前四个逗号分隔字段，名称取余下的全部内容
+        const char *fields[FieldCount + 1];
+        fields[0] = begin;
+        for (int i = 1; i < FieldCount; ++i) {
+            const char *separator = static_cast<const char *>(memchr(fields[i - 1], ',', size_t(end - fields[i - 1])));
+            if (!separator) {
+                chunk.error = QString("第%1行字段不足").arg(lineNumber);
+                return;
+            }
+            fields[i] = separator + 1;
+        }
+        fields[FieldCount] = end + 1;
+
+        // 字段i为[fields[i], fields[i + 1] - 1)，去掉两端空白
+        const char *fieldBegin[FieldCount];
+        const char *fieldEnd[FieldCount];
+        for (int i = 0; i < FieldCount; ++i) {
+            fieldBegin[i] = fields[i];
+            fieldEnd[i] = fields[i + 1] - 1;
+            trim(fieldBegin[i], fieldEnd[i]);
+        }
+
+        CatalogRecord &record = *new (chunk.records + chunk.count) CatalogRecord();
+        if (fieldEquals(fieldBegin[3], fieldEnd[3], "1") || fieldEquals(fieldBegin[3], fieldEnd[3], "true")) {
+            record.isGroup = true;
+        } else if (fieldEquals(fieldBegin[3], fieldEnd[3], "0") || fieldEquals(fieldBegin[3], fieldEnd[3], "false")) {
+            record.isGroup = false;
+        } else {
+            chunk.error = QString("第%1行分组标志无效: %2").arg(lineNumber)
+                .arg(QString::fromUtf8(fieldBegin[3], int(fieldEnd[3] - fieldBegin[3])));
+            return;
+        }
+
+        record.id = arena.copyUtf8(fieldBegin[0], int(fieldEnd[0] - fieldBegin[0]));
+        record.parentId = arena.copyUtf8(fieldBegin[1], int(fieldEnd[1] - fieldBegin[1]));
+        record.type = arena.copyUtf8(fieldBegin[2], int(fieldEnd[2] - fieldBegin[2]));
+        record.name = arena.copyUtf8(fieldBegin[4], int(fieldEnd[4] - fieldBegin[4]));
+        if (record.id.isEmpty() || record.name.isEmpty()) {
+            chunk.error = QString("第%1行缺少设备ID或名称").arg(lineNumber);
+            return;
+        }
+
+        // 类型很少，线性查找即可；通常与上一个设备相同，先比较最后一个
+        if (!record.type.isEmpty()) {
+            bool known = false;
+            for (int i = chunk.types.size() - 1; i >= 0 && !known; --i) {
+                known = QStringView(chunk.types.at(i)) == record.type.view();
+            }
+            if (!known) {
+                chunk.types.append(record.type.toString());
+            }
+        }
+        record.contentHash = CatalogLoader::contentHash(record.name.view(), record.type.view(), record.isGroup);
+        record.idHash = qHash(record.id.view());
+        record.line = lineNumber;
+        record.parent = -1;
+        record.childCount = 0;
+        record.children = nullptr;
+        ++chunk.count;
+    }
+}
+
+/**
+ * @brief 查找分块中各记录的父设备（只读访问ID索引，可以并行）
+ */
+void resolveParents(const CatalogData &catalog, ParseChunk &chunk)
+{
+    for (int i = 0; i < chunk.count; ++i) {
+        CatalogRecord &record = chunk.records[i];
+        if (record.parentId.isEmpty()) {
+            record.parent = -1;
+            continue;
+        }
+        record.parent = catalog.indexOf(record.parentId.view());
+        if (record.parent < 0) {
+            chunk.error = QString("设备 %1 的父设备不存在: %2").arg(record.id.toString()).arg(record.parentId.toString());
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 生成拥有数据的设备信息（不含子设备）
+ */
+DeviceInfo toDevice(const CatalogRecord &record)
+{
+    return DeviceInfo(record.id.toString(), record.name.toString(), record.type.toString(),
+                      record.parentId.toString(), record.isGroup);
+}
+}
+
+CatalogData::CatalogData()
+    : m_records(nullptr)
+    , m_count(0)
+    , m_roots(nullptr)
+    , m_rootCount(0)
+    , m_idTable(nullptr)
+    , m_idMask(0)
+{
+}
+
+int CatalogData::indexOf(QStringView id) const
+{
+    if (m_count == 0 || id.isEmpty()) {
+        return -1;
+    }
+    const uint hash = qHash(id);
+    for (uint slot = hash & uint(m_idMask);; slot = (slot + 1) & uint(m_idMask)) {
+        const int index = m_idTable[slot];
+        if (index < 0 || (m_records[index].idHash == hash && m_records[index].id.view() == id)) {
+            return index;
+        }
+    }
+}
+
+DeviceInfo CatalogData::device(int index) const
+{
+    const CatalogRecord &entry = m_records[index];
+    DeviceInfo info = toDevice(entry);
+    info.children.reserve(entry.childCount);
+    for (int i = 0; i < entry.childCount; ++i) {
+        info.children.append(m_records[entry.children[i]].id.toString());
+    }
+    return info;
+}
+
+QStringList CatalogData::rootIds() const
+{
+    QStringList ids;
+    ids.reserve(m_rootCount);
+    for (int row = 0; row < m_rootCount; ++row) {
+        ids.append(m_records[m_roots[row]].id.toString());
+    }
+    return ids;
+}
+
+qint64 CatalogData::reservedBytes() const
+{
+    qint64 bytes = 0;
+    for (const std::shared_ptr<CatalogArena> &arena : m_arenas) {
+        bytes += arena->reservedBytes();
+    }
+    return bytes;
+}
+
+bool CatalogLoader::parse(const QByteArray &data, CatalogData &catalog, QString *error)
+{
+    return parse(data.constData(), data.size(), catalog, 1, error);
+}
+
+bool CatalogLoader::parse(const char *data, qint64 size, CatalogData &catalog, int threadCount, QString *error)
+{
+    catalog = CatalogData();
+    auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount());
+    }
+    const int chunkCount = static_cast<int>(qBound<qint64>(1, size / ParallelChunkBytes, threadCount));
+
+    // 在行边界处切分：每个分块在估计位置之后的第一个换行符处结束
+    const char *const dataEnd = data + size;
+    QVector<ParseChunk> chunks(chunkCount);
+    ParseChunk *const chunkData = chunks.data();
+    const char *chunkStart = data;
+    for (int c = 0; c < chunkCount; ++c) {
+        const char *chunkEnd = dataEnd;
+        if (c + 1 < chunkCount) {
+            const char *target = std::max(chunkStart, data + size * (c + 1) / chunkCount);
+            const char *newline = static_cast<const char *>(memchr(target, '\n', size_t(dataEnd - target)));
+            chunkEnd = newline ? newline + 1 : dataEnd;
+        }
+        chunkData[c].begin = chunkStart;
+        chunkData[c].end = chunkEnd;
+        chunkStart = chunkEnd;
+    }
+
+    // 只有一个分块时在调用线程上完成，不启动线程
+    std::unique_ptr<WorkStealingThreadPool> pool;
+    if (chunkCount > 1) {
+        pool.reset(new WorkStealingThreadPool(chunkCount));
+    }
+    auto forEachChunk = [&pool, chunkCount](const std::function<void(int)> &task) {
+        if (!pool) {
+            task(0);
+            return;
+        }
+        for (int c = 0; c < chunkCount; ++c) {
+            pool->submit([&task, c]() { task(c); });
+        }
+        pool->waitForDone();
+    };
+
+    // 统计各分块的行数，确定行号和在记录表中的位置，记录表一次分配
+    forEachChunk([chunkData](int c) {
+        chunkData[c].lineCount = countLines(chunkData[c].begin, chunkData[c].end) + 1;
+    });
+    CatalogData result;
+    for (int c = 0; c < chunkCount; ++c) {
+        result.m_arenas.append(std::make_shared<CatalogArena>());
+    }
+    int capacity = 0;
+    for (int c = 0; c < chunkCount; ++c) {
+        chunkData[c].firstLine = c == 0 ? 1 : chunkData[c - 1].firstLine + chunkData[c - 1].lineCount - 1;
+        capacity += chunkData[c].lineCount;
+    }
+    CatalogRecord *records = result.m_arenas.at(0)->allocateArray<CatalogRecord>(capacity);
+    int offset = 0;
+    for (int c = 0; c < chunkCount; ++c) {
+        chunkData[c].records = records + offset;
+        offset += chunkData[c].lineCount;
+    }
+
+    // 各分块解析到自己的内存区
+    forEachChunk([chunkData, &result](int c) {
+        parseChunk(chunkData[c], *result.m_arenas.at(c));
+    });
+
+    // 按文件顺序合并：记录移到一起，插入ID索引，类型去重。分块出错时先
+    // 检查它之前的记录有没有重复ID，报告的总是文件中最早的错误
+    int recordCount = 0;
+    for (int c = 0; c < chunkCount; ++c) {
+        recordCount += chunkData[c].count;
+    }
+    int tableSize = 16;
+    while (tableSize < recordCount * 2) {
+        tableSize *= 2;
+    }
+    int *idTable = result.m_arenas.at(0)->allocateArray<int>(tableSize);
+    std::fill(idTable, idTable + tableSize, -1);
+    const uint mask = uint(tableSize - 1);
+
+    int count = 0;
+    for (int c = 0; c < chunkCount; ++c) {
+        ParseChunk &chunk = chunkData[c];
+        if (chunk.records != records + count) {
+            memmove(static_cast<void *>(records + count), chunk.records, sizeof(CatalogRecord) * size_t(chunk.count));
+            chunk.records = records + count;
+        }
+        for (int i = count; i < count + chunk.count; ++i) {
+            const CatalogRecord &record = records[i];
+            uint slot = record.idHash & mask;
+            while (idTable[slot] >= 0) {
+                const CatalogRecord &existing = records[idTable[slot]];
+                if (existing.idHash == record.idHash && existing.id == record.id) {
+                    return fail(QString("第%1行设备ID重复: %2").arg(record.line).arg(record.id.toString()));
+                }
+                slot = (slot + 1) & mask;
+            }
+            idTable[slot] = i;
+        }
+        count += chunk.count;
+
+        for (const QString &type : chunk.types) {
+            if (!result.m_types.contains(type)) {
+                result.m_types.append(type);
+            }
+        }
+        if (!chunk.error.isEmpty()) {
+            return fail(chunk.error);
+        }
+    }
+    result.m_records = records;
+    result.m_count = count;
+    result.m_idTable = idTable;
+    result.m_idMask = tableSize - 1;
+
+    // 父设备可能出现在子设备之后，全部读完后再建立层级。查找父设备是
+    // 建立层级的主要开销，按分块并行
+    forEachChunk([chunkData, &result](int c) {
+        resolveParents(result, chunkData[c]);
+    });
+    for (int c = 0; c < chunkCount; ++c) {
+        if (!chunkData[c].error.isEmpty()) {
+            return fail(chunkData[c].error);
+        }
+    }
+
+    // 统计每个设备的子设备数，再在一个下标数组中为各设备划出连续的一段，
+    // 按文件顺序填入
+    for (int i = 0; i < count; ++i) {
+        const int parent = records[i].parent;
+        if (parent < 0) {
+            ++result.m_rootCount;
+        } else {
+            ++records[parent].childCount;
+        }
+    }
+    int *indexes = result.m_arenas.at(0)->allocateArray<int>(count);
+    result.m_roots = indexes;
+    int *next = indexes + result.m_rootCount;
+    for (int i = 0; i < count; ++i) {
+        records[i].children = next;
+        next += records[i].childCount;
+        records[i].childCount = 0;
+    }
+    int rootCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const int parent = records[i].parent;
+        if (parent < 0) {
+            indexes[rootCount++] = i;
+        } else {
+            CatalogRecord &parentRecord = records[parent];
+            indexes[(parentRecord.children - indexes) + parentRecord.childCount++] = i;
+        }
+    }
+
+    // 从顶层无法到达的设备处在循环的父子关系中
+    int reachable = 0;
+    QVector<int> pending;
+    pending.reserve(result.m_rootCount);
+    for (int row = 0; row < result.m_rootCount; ++row) {
+        pending.append(result.m_roots[row]);
+    }
+    while (!pending.isEmpty()) {
+        const CatalogRecord &record = records[pending.takeLast()];
+        ++reachable;
+        for (int i = 0; i < record.childCount; ++i) {
+            pending.append(record.children[i]);
+        }
+    }
+    if (reachable != count) {
+        return fail("目录中存在循环的父子关系");
+    }
+
+    catalog = result;
+    return true;
+}
+
+bool CatalogLoader::loadFile(const QString &filePath, CatalogData &catalog, QString *error, int threadCount,
+                             ReadMode mode)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QString("无法打开目录文件: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    // 映射后直接解析，字符串都复制到内存区，解析完即可取消映射；
+    // 空文件、不支持映射的设备和要求读入内存时整体读入
+    const qint64 size = file.size();
+    uchar *mapped = (mode == MapFile && size > 0) ? file.map(0, size) : nullptr;
+    if (!mapped) {
+        const QByteArray data = file.readAll();
+        return parse(data.constData(), data.size(), catalog, threadCount, error);
+    }
+    const bool ok = parse(reinterpret_cast<const char *>(mapped), size, catalog, threadCount, error);
+    file.unmap(mapped);
+    return ok;
+}
+
+uint CatalogLoader::contentHash(const DeviceInfo &device)
+{
+    return contentHash(QStringView(device.name), QStringView(device.type), device.isGroup);
+}
+
+uint CatalogLoader::contentHash(QStringView name, QStringView type, bool isGroup)
+{
+    return qHash(name, qHash(type, isGroup ? 1u : 0u));
+}
+
+CatalogDiffStats CatalogLoader::applyDiff(CatalogBuilder &builder, const CatalogData &catalog)
+{
+    CatalogDiffStats stats;
+    const CatalogSnapshot &current = builder.current();
+
+    // 先序遍历新目录。处理到某个设备时，它的祖先都已在最终位置，排在它
+    // 前面的兄弟也已依次放在父设备子列表的前部，因此位置相同即无需移动，
+    // 移动时也不会形成循环
+    // 父设备的原子随栈传递，每个有子设备的设备只查一次，比较父设备时
+    // 只需比较整数。父设备ID尚不是原子时（-1），已有的子设备必然需要移动
+    // 查找时直接使用内存区中的字符串；交给builder保存的都是拥有数据的副本
+    QString id;
+    QString parentId;
+    QVector<PendingDevice> stack;
+    for (int row = catalog.rootCount() - 1; row >= 0; --row) {
+        const PendingDevice root = { catalog.rootAt(row), row, 0 };
+        stack.append(root);
+    }
+    while (!stack.isEmpty()) {
+        const PendingDevice entry = stack.takeLast();
+        const CatalogRecord &record = catalog.record(entry.index);
+        const int row = entry.row;
+        rawString(id, record.id);
+        rawString(parentId, record.parentId);
+
+        const int handle = current.deviceHandle(id);
+        if (handle < 0) {
+            builder.addDevice(toDevice(record), row);
+            ++stats.added;
+        } else {
+            if (current.parentAtom(handle) != entry.parentAtom
+                || current.childIdAt(parentId, row) != id) {
+                builder.moveDevice(current.deviceIdForHandle(handle), record.parentId.toString(), row);
+                ++stats.moved;
+            }
+            if (contentHash(current.device(id)) != record.contentHash) {
+                builder.updateDevice(toDevice(record));
+                ++stats.changed;
+            }
+        }
+
+        if (record.childCount == 0) {
+            continue;
+        }
+        const int parentAtom = current.atom(id);
+        for (int childRow = record.childCount - 1; childRow >= 0; --childRow) {
+            const PendingDevice child = { record.children[childRow], childRow, parentAtom };
+            stack.append(child);
+        }
+    }
+
+    // 不在新目录中的设备此时都排在各自父设备子列表的末尾；只需从保留的
+    // 父设备（或顶层）末尾依次删除，子设备随之删除
+    QStringList parents;
+    QSet<QString> seenParents;
+    for (int handle = 0; handle < current.handleCount(); ++handle) {
+        const QString removedId = current.deviceIdForHandle(handle);
+        if (removedId.isEmpty() || catalog.contains(removedId)) {
+            continue;
+        }
+        ++stats.removed;
+        const QString removedParentId = current.device(removedId).parentId;
+        if ((removedParentId.isEmpty() || catalog.contains(removedParentId)) && !seenParents.contains(removedParentId)) {
+            seenParents.insert(removedParentId);
+            parents.append(removedParentId);
+        }
+    }
+    for (const QString &keptParentId : parents) {
+        const int keptCount = keptParentId.isEmpty()
+            ? catalog.rootCount()
+            : catalog.record(catalog.indexOf(keptParentId)).childCount;
+        const QStringList children = current.childIds(keptParentId);
+        for (int row = children.size() - 1; row >= keptCount; --row) {
+            builder.removeDevice(children.at(row));
+        }
+    }
+
+    return stats;
+}
+
+CatalogDiffStats CatalogLoader::applyDiff(DeviceManager &manager, const CatalogData &catalog)
+{
+    manager.beginTransaction();
+    const CatalogDiffStats stats = applyDiff(*manager.transactionBuilder(), catalog);
+    manager.commitTransaction();
+    return stats;
+}
@@ -0,0 +1,732 @@
+#include "CatalogSnapshot.h"
+#include "CatalogLoader.h"
+#include "DeviceQueryCache.h"
+#include "StringPool.h"
+#include <QSet>
+
+namespace {
+// QHash节点的额外开销：next指针和哈希值
+const int HashNodeOverhead = sizeof(void *) + sizeof(uint);
+// 句柄表小于此大小时不压缩，避免小目录每次删除都重新编号
+const int MinCompactHandles = 64;
+}
+
+QList<DeviceInfo> CatalogSnapshot::allDevices() const
+{
+    // 按句柄顺序返回，与查询结果的顺序一致
+    QList<DeviceInfo> result;
+    result.reserve(m_devices.size());
+    for (const QString &id : m_handleIds) {
+        if (!id.isEmpty()) {
+            result.append(*m_devices.constFind(id));
+        }
+    }
+    return result;
+}
+
+QList<DeviceInfo> CatalogSnapshot::childDevices(const QString &parentId) const
+{
+    QList<DeviceInfo> result;
+
+    auto parent = m_devices.constFind(parentId);
+    if (parent == m_devices.constEnd()) {
+        return result;
+    }
+
+    for (const QString &childId : parent.value().children) {
+        auto child = m_devices.constFind(childId);
+        if (child != m_devices.constEnd()) {
+            result.append(child.value());
+        }
+    }
+
+    return result;
+}
+
+QStringList CatalogSnapshot::childIds(const QString &parentId) const
+{
+    if (parentId.isEmpty()) {
+        return m_rootIds;
+    }
+    return m_devices.value(parentId).children;
+}
+
+QString CatalogSnapshot::childIdAt(const QString &parentId, int row) const
+{
+    if (parentId.isEmpty()) {
+        return m_rootIds.value(row);
+    }
+    auto it = m_devices.constFind(parentId);
+    return it == m_devices.constEnd() ? QString() : it.value().children.value(row);
+}
+
+int CatalogSnapshot::deviceRow(const QString &id) const
+{
+    auto it = m_devices.constFind(id);
+    if (it == m_devices.constEnd()) {
+        return -1;
+    }
+    const QString &parentId = it.value().parentId;
+    if (parentId.isEmpty()) {
+        return m_rootIds.indexOf(id);
+    }
+    return m_devices.constFind(parentId).value().children.indexOf(id);
+}
+
+QVector<int> CatalogSnapshot::queryHandles(int typeId, const QString &keyword,
+                                           DeviceQueryCache *cache) const
+{
+    const QString lowerKeyword = keyword.toLower();
+    const DeviceQueryKey key(m_version, typeId, lowerKeyword);
+
+    QVector<int> handles;
+    if (cache && cache->lookup(key, handles)) {
+        return handles;
+    }
+
+    // 类型比较为整数比较；类型ID无效时结果为空
+    const bool validType = m_types.isValid(typeId);
+    for (int handle = 0; validType && handle < m_handleIds.size(); ++handle) {
+        // 已删除设备的句柄为空位，类型ID为-1
+        const int deviceType = m_typeIds.at(handle);
+        if (deviceType < 0 || (typeId != DeviceTypeRegistry::AllTypes && deviceType != typeId)) {
+            continue;
+        }
+
+        if (!lowerKeyword.isEmpty()) {
+            const DeviceInfo &device = *m_devices.constFind(m_handleIds.at(handle));
+            if (!device.name.toLower().contains(lowerKeyword) &&
+                !device.id.toLower().contains(lowerKeyword)) {
+                continue;
+            }
+        }
+
+        handles.append(handle);
+    }
+
+    if (cache) {
+        cache->insert(key, handles);
+    }
+    return handles;
+}
+
+QList<DeviceInfo> CatalogSnapshot::devicesForHandles(const QVector<int> &handles) const
+{
+    QList<DeviceInfo> result;
+    result.reserve(handles.size());
+
+    for (int handle : handles) {
+        result.append(*m_devices.constFind(m_handleIds.at(handle)));
+    }
+
+    return result;
+}
+
+CatalogMemoryUsage CatalogSnapshot::memoryUsage() const
+{
+    CatalogMemoryUsage usage;
+
+    // 哈希表的桶数组和节点，列表按指针数组计算
+    usage.structureBytes += static_cast<qint64>(m_devices.capacity()) * sizeof(void *)
+        + static_cast<qint64>(m_devices.size()) * (sizeof(QString) + sizeof(DeviceInfo) + HashNodeOverhead);
+    usage.structureBytes += static_cast<qint64>(m_handleIndex.capacity()) * sizeof(void *)
+        + static_cast<qint64>(m_handleIndex.size()) * (sizeof(QString) + sizeof(int) + HashNodeOverhead);
+    usage.structureBytes += static_cast<qint64>(m_handleIds.capacity()) * sizeof(QString);
+    usage.structureBytes += static_cast<qint64>(m_typeIds.capacity() + m_parentAtoms.capacity()) * sizeof(int);
+    usage.structureBytes += static_cast<qint64>(m_atoms.capacity()) * sizeof(QString)
+        + static_cast<qint64>(m_atomRefs.capacity() + m_freeAtoms.capacity()) * sizeof(int)
+        + static_cast<qint64>(m_atomIndex.capacity()) * sizeof(void *)
+        + static_cast<qint64>(m_atomIndex.size()) * (sizeof(QString) + sizeof(int) + HashNodeOverhead);
+    usage.structureBytes += static_cast<qint64>(m_rootIds.size()) * sizeof(void *) + m_types.structureBytes();
+
+    // 相同的数据块只计一次；驻留的字符串计入共享部分
+    QSet<const QChar *> counted;
+    auto countString = [this, &usage, &counted](const QString &text) {
+        if (text.isEmpty() || counted.contains(text.constData())) {
+            return;
+        }
+        counted.insert(text.constData());
+        if (m_stringPool && m_stringPool->owns(text)) {
+            usage.sharedStringBytes += StringPool::stringBytes(text);
+        } else {
+            usage.stringBytes += StringPool::stringBytes(text);
+        }
+    };
+
+    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
+        const DeviceInfo &device = it.value();
+        usage.structureBytes += static_cast<qint64>(device.children.size()) * sizeof(void *);
+        countString(it.key());
+        countString(device.id);
+        countString(device.name);
+        countString(device.type);
+        countString(device.parentId);
+        for (const QString &childId : device.children) {
+            countString(childId);
+        }
+    }
+    for (int typeId : m_types.typeIds()) {
+        countString(m_types.typeName(typeId));
+        countString(m_types.displayName(typeId));
+    }
+    for (const QString &text : m_atoms) {
+        countString(text);
+    }
+
+    return usage;
+}
+
+CatalogBuilder::CatalogBuilder(const CatalogSnapshotPtr &base)
+    : m_baseVersion(base ? base->version() : 0)
+    , m_typesChanged(false)
+{
+    if (base) {
+        m_data = *base;
+    }
+}
+
+bool CatalogBuilder::assign(const QHash<QString, DeviceInfo> &devices, const QStringList &types)
+{
+    m_data.m_devices = devices;
+    m_data.m_types.resetCounts();
+    resetAtoms();
+    for (const QString &type : types) {
+        registerType(type);
+    }
+    m_data.m_rootIds.clear();
+    m_changes.clear();
+
+    // 重复出现的类型和父设备ID共享原子表中的一份数据
+    for (auto it = m_data.m_devices.begin(); it != m_data.m_devices.end(); ++it) {
+        it.value().type = internType(it.value().type);
+        it.value().parentId = intern(it.value().parentId);
+    }
+
+    // 构建父子关系
+    QStringList rootDevices;
+    for (auto it = m_data.m_devices.begin(); it != m_data.m_devices.end(); ++it) {
+        DeviceInfo &device = it.value();
+
+        if (!device.parentId.isEmpty() && m_data.m_devices.contains(device.parentId)) {
+            DeviceInfo &parent = m_data.m_devices[device.parentId];
+            parent.addChild(device.id);
+        } else if (device.parentId.isEmpty()) {
+            // 顶层先列出设备组，再列出独立设备
+            if (device.isGroup) {
+                m_data.m_rootIds.append(device.id);
+            } else {
+                rootDevices.append(device.id);
+            }
+        }
+    }
+    m_data.m_rootIds += rootDevices;
+
+    if (!validateHierarchy()) {
+        return false;
+    }
+
+    // 句柄按哈希表遍历顺序分配，保证查询结果顺序与allDevices()一致
+    m_data.m_handleIds.clear();
+    m_data.m_handleIds.reserve(m_data.m_devices.size());
+    m_data.m_handleIndex.clear();
+    m_data.m_handleIndex.reserve(m_data.m_devices.size());
+    m_data.m_typeIds.clear();
+    m_data.m_typeIds.reserve(m_data.m_devices.size());
+    m_data.m_parentAtoms.clear();
+    m_data.m_parentAtoms.reserve(m_data.m_devices.size());
+    for (auto it = m_data.m_devices.constBegin(); it != m_data.m_devices.constEnd(); ++it) {
+        assignHandle(it.key());
+    }
+    m_typesChanged = false;
+    return true;
+}
+
+bool CatalogBuilder::assign(const CatalogData &catalog)
+{
+    const int count = catalog.deviceCount();
+    m_data.m_devices.clear();
+    m_data.m_devices.reserve(count);
+    m_data.m_types.resetCounts();
+    resetAtoms();
+    for (const QString &type : catalog.types()) {
+        registerType(type);
+    }
+    m_data.m_rootIds.clear();
+    m_data.m_rootIds.reserve(catalog.rootCount());
+    m_changes.clear();
+
+    // 设备ID只复制一次，设备表、子设备列表和句柄表共享这份数据
+    QVector<QString> ids(count);
+    for (int i = 0; i < count; ++i) {
+        ids[i] = catalog.record(i).id.toString();
+    }
+
+    // 类型和父设备ID大多已在原子表中（类型已登记，父设备ID在文件中
+    // 重复出现），用指向内存区的临时字符串查找，只有新字符串才复制
+    QString lookup;
+    auto internRecordString = [this, &lookup](const ArenaString &text, bool pooled) {
+        lookup.setRawData(text.data, text.size);
+        const int existing = m_data.atom(lookup);
+        return m_data.m_atoms.at(existing >= 0 ? existing : internAtom(text.toString(), pooled));
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const CatalogRecord &record = catalog.record(i);
+        DeviceInfo info;
+        info.id = ids.at(i);
+        info.name = record.name.toString();
+        info.type = internRecordString(record.type, true);
+        info.parentId = internRecordString(record.parentId, false);
+        info.isGroup = record.isGroup;
+        info.children.reserve(record.childCount);
+        for (int child = 0; child < record.childCount; ++child) {
+            info.children.append(ids.at(record.children[child]));
+        }
+        m_data.m_devices.insert(info.id, info);
+    }
+    for (int row = 0; row < catalog.rootCount(); ++row) {
+        m_data.m_rootIds.append(ids.at(catalog.rootAt(row)));
+    }
+
+    // 句柄按文件顺序分配
+    m_data.m_handleIds.clear();
+    m_data.m_handleIds.reserve(count);
+    m_data.m_handleIndex.clear();
+    m_data.m_handleIndex.reserve(count);
+    m_data.m_typeIds.clear();
+    m_data.m_typeIds.reserve(count);
+    m_data.m_parentAtoms.clear();
+    m_data.m_parentAtoms.reserve(count);
+    for (const QString &id : ids) {
+        assignHandle(id);
+    }
+    m_typesChanged = false;
+    return true;
+}
+
+bool CatalogBuilder::addDevice(const DeviceInfo &device, int row)
+{
+    QHash<QString, DeviceInfo> &devices = m_data.m_devices;
+    if (!device.isValid()) {
+        m_lastError = "设备ID和名称不能为空";
+        return false;
+    }
+    if (devices.contains(device.id)) {
+        m_lastError = QString("设备已存在: %1").arg(device.id);
+        return false;
+    }
+    if (!device.parentId.isEmpty() && !devices.contains(device.parentId)) {
+        m_lastError = QString("父设备不存在: %1").arg(device.parentId);
+        return false;
+    }
+
+    DeviceInfo info = device;
+    info.children.clear();
+    info.type = internType(info.type);
+    info.parentId = intern(info.parentId);
+    devices.insert(info.id, info);
+    assignHandle(info.id);
+
+    QStringList &siblings = childList(info.parentId);
+    const int position = (row < 0 || row > siblings.size()) ? siblings.size() : row;
+    siblings.insert(position, info.id);
+
+    CatalogChange change;
+    change.kind = CatalogChange::Inserted;
+    change.parentId = info.parentId;
+    change.first = position;
+    change.last = position;
+    change.destinationRow = -1;
+    change.deviceIds << info.id;
+    recordChange(change);
+    return true;
+}
+
+bool CatalogBuilder::updateDevice(const DeviceInfo &device)
+{
+    auto it = m_data.m_devices.find(device.id);
+    if (it == m_data.m_devices.end()) {
+        m_lastError = QString("设备不存在: %1").arg(device.id);
+        return false;
+    }
+    if (device.name.isEmpty()) {
+        m_lastError = "设备名称不能为空";
+        return false;
+    }
+
+    DeviceInfo &info = it.value();
+    if (info.name == device.name && info.type == device.type && info.isGroup == device.isGroup) {
+        return true;
+    }
+
+    info.name = device.name;
+    info.type = internType(device.type);
+    info.isGroup = device.isGroup;
+
+    // 设备数量从原类型转到新类型
+    int &typeId = m_data.m_typeIds[m_data.m_handleIndex.value(info.id)];
+    const int newTypeId = registerType(info.type);
+    if (newTypeId != typeId) {
+        m_data.m_types.adjustCount(typeId, -1);
+        m_data.m_types.adjustCount(newTypeId, 1);
+        typeId = newTypeId;
+    }
+
+    CatalogChange change;
+    change.kind = CatalogChange::Changed;
+    change.parentId = info.parentId;
+    change.first = change.last = childList(info.parentId).indexOf(info.id);
+    change.destinationRow = -1;
+    change.deviceIds << info.id;
+    recordChange(change);
+    return true;
+}
+
+bool CatalogBuilder::removeDevice(const QString &id)
+{
+    auto it = m_data.m_devices.constFind(id);
+    if (it == m_data.m_devices.constEnd()) {
+        m_lastError = QString("设备不存在: %1").arg(id);
+        return false;
+    }
+
+    const QString parentId = it.value().parentId;
+    QStringList &siblings = childList(parentId);
+    const int position = siblings.indexOf(id);
+    siblings.removeAt(position);
+
+    // 子设备随之删除，句柄保留为空位以保持其他句柄不变；空位过多时
+    // 在生成快照时压缩（见renumberedHandles）
+    CatalogChange change;
+    change.kind = CatalogChange::Removed;
+    change.parentId = parentId;
+    change.first = position;
+    change.last = position;
+    change.destinationRow = -1;
+    collectSubtree(id, change.deviceIds);
+    for (const QString &removedId : change.deviceIds) {
+        const int handle = m_data.m_handleIndex.take(removedId);
+        m_data.m_handleIds[handle].clear();
+        m_data.m_types.adjustCount(m_data.m_typeIds.at(handle), -1);
+        m_data.m_typeIds[handle] = -1;
+        releaseAtom(m_data.m_parentAtoms.at(handle));
+        m_data.m_parentAtoms[handle] = -1;
+        m_data.m_devices.remove(removedId);
+    }
+    recordChange(change);
+    return true;
+}
+
+bool CatalogBuilder::moveDevice(const QString &id, const QString &newParentId, int row)
+{
+    QHash<QString, DeviceInfo> &devices = m_data.m_devices;
+    auto it = devices.find(id);
+    if (it == devices.end()) {
+        m_lastError = QString("设备不存在: %1").arg(id);
+        return false;
+    }
+    if (!newParentId.isEmpty() && !devices.contains(newParentId)) {
+        m_lastError = QString("父设备不存在: %1").arg(newParentId);
+        return false;
+    }
+
+    // 不能移动到自身或子设备下
+    for (QString ancestor = newParentId; !ancestor.isEmpty(); ancestor = devices.value(ancestor).parentId) {
+        if (ancestor == id) {
+            m_lastError = QString("不能把设备 %1 移动到自身的子设备下").arg(id);
+            return false;
+        }
+    }
+
+    const QString oldParentId = it.value().parentId;
+    const int oldRow = childList(oldParentId).indexOf(id);
+    QStringList &destination = childList(newParentId);
+    int newRow = (row < 0 || row > destination.size()) ? destination.size() : row;
+    if (oldParentId == newParentId) {
+        // 同一父设备内，目标位置按移除后的列表计算
+        newRow = qMin(newRow, destination.size() - 1);
+        if (newRow == oldRow) {
+            return true;
+        }
+    }
+
+    childList(oldParentId).removeAt(oldRow);
+    childList(newParentId).insert(newRow, id);
+    devices[id].parentId = intern(newParentId);
+    int &parentAtom = m_data.m_parentAtoms[m_data.m_handleIndex.value(id)];
+    const int oldParentAtom = parentAtom;
+    parentAtom = acquireAtom(newParentId);
+    releaseAtom(oldParentAtom);
+
+    CatalogChange change;
+    change.kind = CatalogChange::Moved;
+    change.parentId = oldParentId;
+    change.first = oldRow;
+    change.last = oldRow;
+    change.destinationId = newParentId;
+    change.destinationRow = newRow;
+    change.deviceIds << id;
+    recordChange(change);
+    return true;
+}
+
+bool CatalogBuilder::setTypeDisplayName(int typeId, const QString &displayName)
+{
+    if (!m_data.m_types.isValid(typeId)) {
+        m_lastError = QString("设备类型不存在: %1").arg(typeId);
+        return false;
+    }
+    if (m_data.m_types.displayName(typeId) == displayName) {
+        return true;
+    }
+
+    m_data.m_types.setDisplayName(typeId, displayName);
+    m_typesChanged = true;
+    return true;
+}
+
+QVector<int> CatalogBuilder::renumberedHandles() const
+{
+    const int handleCount = m_data.m_handleIds.size();
+    const int deadCount = handleCount - m_data.m_devices.size();
+    if (handleCount < MinCompactHandles || deadCount * 2 <= handleCount) {
+        return QVector<int>();
+    }
+
+    QVector<int> handles(handleCount, -1);
+    int next = 0;
+    for (int handle = 0; handle < handleCount; ++handle) {
+        if (!m_data.m_handleIds.at(handle).isEmpty()) {
+            handles[handle] = next++;
+        }
+    }
+    return handles;
+}
+
+CatalogSnapshotPtr CatalogBuilder::build(quint64 version) const
+{
+    std::shared_ptr<CatalogSnapshot> snapshot = std::make_shared<CatalogSnapshot>(m_data);
+    snapshot->m_version = version;
+
+    // 空位过多时只在发布的副本上压缩，按句柄索引的数组按存活设备数重新生成
+    const QVector<int> renumbered = renumberedHandles();
+    if (!renumbered.isEmpty()) {
+        const int deviceCount = snapshot->m_devices.size();
+        QVector<QString> handleIds;
+        QVector<int> typeIds;
+        QVector<int> parentAtoms;
+        handleIds.reserve(deviceCount);
+        typeIds.reserve(deviceCount);
+        parentAtoms.reserve(deviceCount);
+        for (int handle = 0; handle < renumbered.size(); ++handle) {
+            if (renumbered.at(handle) >= 0) {
+                handleIds.append(m_data.m_handleIds.at(handle));
+                typeIds.append(m_data.m_typeIds.at(handle));
+                parentAtoms.append(m_data.m_parentAtoms.at(handle));
+            }
+        }
+        snapshot->m_handleIds = handleIds;
+        snapshot->m_typeIds = typeIds;
+        snapshot->m_parentAtoms = parentAtoms;
+        for (auto it = snapshot->m_handleIndex.begin(); it != snapshot->m_handleIndex.end(); ++it) {
+            it.value() = renumbered.at(it.value());
+        }
+    }
+    return snapshot;
+}
+
+bool CatalogBuilder::validateHierarchy()
+{
+    const QHash<QString, DeviceInfo> &devices = m_data.m_devices;
+    for (auto it = devices.constBegin(); it != devices.constEnd(); ++it) {
+        const DeviceInfo &device = it.value();
+
+        // 检查父设备是否存在
+        if (!device.parentId.isEmpty() && !devices.contains(device.parentId)) {
+            m_lastError = QString("Device %1 references non-existent parent %2").arg(device.id, device.parentId);
+            return false;
+        }
+
+        // 检查子设备是否存在
+        for (const QString &childId : device.children) {
+            if (!devices.contains(childId)) {
+                m_lastError = QString("Device %1 references non-existent child %2").arg(device.id, childId);
+                return false;
+            }
+        }
+
+        // 检查循环引用
+        QStringList visited;
+        if (hasCircularReference(device.id, visited)) {
+            m_lastError = QString("Circular reference detected in device hierarchy starting from %1").arg(device.id);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CatalogBuilder::hasCircularReference(const QString &deviceId, QStringList &visited) const
+{
+    if (visited.contains(deviceId)) {
+        return true;
+    }
+
+    auto it = m_data.m_devices.constFind(deviceId);
+    if (it == m_data.m_devices.constEnd()) {
+        return false;
+    }
+
+    visited.append(deviceId);
+    for (const QString &childId : it.value().children) {
+        if (hasCircularReference(childId, visited)) {
+            return true;
+        }
+    }
+
+    visited.removeLast();
+    return false;
+}
+
+void CatalogBuilder::recordChange(const CatalogChange &change)
+{
+    if (!m_changes.isEmpty()) {
+        CatalogChange &previous = m_changes.last();
+        if (previous.kind == change.kind && previous.parentId == change.parentId) {
+            const int count = change.last - change.first + 1;
+            switch (change.kind) {
+            case CatalogChange::Inserted:
+                // 紧接在上一段之后插入
+                if (change.first == previous.last + 1) {
+                    previous.last += count;
+                    previous.deviceIds += change.deviceIds;
+                    return;
+                }
+                break;
+            case CatalogChange::Removed:
+                // 连续删除同一位置（后面的设备前移）或紧邻的前一个位置
+                if (change.first == previous.first) {
+                    previous.last += count;
+                    previous.deviceIds += change.deviceIds;
+                    return;
+                }
+                if (change.last + 1 == previous.first) {
+                    previous.first = change.first;
+                    previous.deviceIds = change.deviceIds + previous.deviceIds;
+                    return;
+                }
+                break;
+            case CatalogChange::Changed:
+                // 重叠或相邻的范围取并集
+                if (change.first <= previous.last + 1 && change.last + 1 >= previous.first) {
+                    previous.first = qMin(previous.first, change.first);
+                    previous.last = qMax(previous.last, change.last);
+                    for (const QString &id : change.deviceIds) {
+                        if (!previous.deviceIds.contains(id)) {
+                            previous.deviceIds.append(id);
+                        }
+                    }
+                    return;
+                }
+                break;
+            case CatalogChange::Moved:
+                break;
+            }
+        }
+    }
+    m_changes.append(change);
+}
+
+QStringList &CatalogBuilder::childList(const QString &parentId)
+{
+    return parentId.isEmpty() ? m_data.m_rootIds : m_data.m_devices[parentId].children;
+}
+
+void CatalogBuilder::collectSubtree(const QString &id, QStringList &ids) const
+{
+    ids.append(id);
+    for (const QString &childId : m_data.m_devices.value(id).children) {
+        collectSubtree(childId, ids);
+    }
+}
+
+void CatalogBuilder::assignHandle(const QString &id)
+{
+    const DeviceInfo &device = *m_data.m_devices.constFind(id);
+    m_data.m_handleIndex.insert(id, m_data.m_handleIds.size());
+    m_data.m_handleIds.append(id);
+    const int typeId = registerType(device.type);
+    m_data.m_typeIds.append(typeId);
+    m_data.m_parentAtoms.append(acquireAtom(device.parentId));
+    m_data.m_types.adjustCount(typeId, 1);
+}
+
+int CatalogBuilder::internAtom(const QString &text, bool pooled)
+{
+    const int existing = m_data.atom(text);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    // 新的设备类型在字符串池中驻留，与其他目录共享数据；池中的字符串
+    // 不会释放，父设备ID随设备增删而变化，只记入本目录的原子表
+    const QString interned = (pooled && m_data.m_stringPool) ? m_data.m_stringPool->intern(text) : text;
+    int atom;
+    if (m_data.m_freeAtoms.isEmpty()) {
+        atom = m_data.m_atoms.size();
+        m_data.m_atoms.append(interned);
+        m_data.m_atomRefs.append(0);
+    } else {
+        atom = m_data.m_freeAtoms.takeLast();
+        m_data.m_atoms[atom] = interned;
+    }
+    m_data.m_atomIndex.insert(interned, atom);
+    return atom;
+}
+
+int CatalogBuilder::acquireAtom(const QString &parentId)
+{
+    const int atom = internAtom(parentId);
+    if (atom > 0) {
+        ++m_data.m_atomRefs[atom];
+    }
+    return atom;
+}
+
+void CatalogBuilder::releaseAtom(int atom)
+{
+    if (atom <= 0 || --m_data.m_atomRefs[atom] > 0) {
+        return;
+    }
+
+    // 设备类型的原子随注册表保留；只作为父设备ID的原子释放，空位复用
+    const QString text = m_data.m_atoms.at(atom);
+    if (m_data.m_types.typeId(text) != DeviceTypeRegistry::UnknownType) {
+        return;
+    }
+    m_data.m_atomIndex.remove(text);
+    m_data.m_atoms[atom].clear();
+    m_data.m_freeAtoms.append(atom);
+}
+
+void CatalogBuilder::resetAtoms()
+{
+    m_data.m_atoms.resize(1);
+    m_data.m_atomRefs.fill(0, 1);
+    m_data.m_atomIndex.clear();
+    m_data.m_freeAtoms.clear();
+    for (int typeId : m_data.m_types.typeIds()) {
+        internAtom(m_data.m_types.typeName(typeId));
+    }
+}
+
+int CatalogBuilder::registerType(const QString &type)
+{
+    const int existing = m_data.m_types.typeId(type);
+    if (existing != DeviceTypeRegistry::UnknownType) {
+        return existing;
+    }
+
+    // 新类型追加到注册表末尾，已有类型的ID不变
+    m_typesChanged = true;
+    return m_data.m_types.registerType(internType(type));
+}
@@ -0,0 +1,166 @@
+#include "CatalogWatcher.h"
+#include "DeviceManager.h"
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+// 默认稳定周期：导出工具分多次写入时避免解析到一半的文件
+const int DefaultSettleIntervalMs = 300;
+}
+
+void CatalogParser::parse(const QString &filePath, const CatalogSnapshotPtr &base, quint64 generation)
+{
+    CatalogData catalog;
+    QString error;
+    CatalogBuilderPtr builder;
+    CatalogDiffStats stats;
+    // 大文件按CPU核心数并行解析，小文件仍在本线程上解析；
+    // 外部工具随时可能截断并改写文件，读入内存而不映射，避免SIGBUS
+    if (CatalogLoader::loadFile(filePath, catalog, &error, 0, CatalogLoader::ReadIntoMemory)) {
+        builder = std::make_shared<CatalogBuilder>(base);
+        stats = CatalogLoader::applyDiff(*builder, catalog);
+    }
+    emit finished(builder, stats, error, generation);
+}
+
+CatalogWatcher::CatalogWatcher(DeviceManager *manager, const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_filePath(filePath)
+    , m_parser(new CatalogParser())
+    , m_inFlight(false)
+    , m_reloadPending(false)
+    , m_generation(0)
+    , m_reloadCount(0)
+{
+    qRegisterMetaType<CatalogSnapshotPtr>("CatalogSnapshotPtr");
+    qRegisterMetaType<CatalogBuilderPtr>("CatalogBuilderPtr");
+    qRegisterMetaType<CatalogDiffStats>("CatalogDiffStats");
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(DefaultSettleIntervalMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &CatalogWatcher::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &CatalogWatcher::onFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &CatalogWatcher::onDirectoryChanged);
+
+    m_parser->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_parser, &QObject::deleteLater);
+    connect(this, &CatalogWatcher::parseRequested, m_parser, &CatalogParser::parse, Qt::QueuedConnection);
+    connect(m_parser, &CatalogParser::finished, this, &CatalogWatcher::onParseFinished, Qt::QueuedConnection);
+
+    m_workerThread.setObjectName("CatalogWatcher");
+    m_workerThread.start();
+}
+
+CatalogWatcher::~CatalogWatcher()
+{
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+QString CatalogWatcher::defaultFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/device_catalog.csv";
+}
+
+void CatalogWatcher::start()
+{
+    updateWatchedPaths();
+    if (QFileInfo::exists(m_filePath)) {
+        reload();
+    }
+}
+
+void CatalogWatcher::stop()
+{
+    m_settleTimer.stop();
+    m_reloadPending = false;
+    // 停止前已开始的解析结果被丢弃
+    ++m_generation;
+    if (!m_watcher.files().isEmpty()) {
+        m_watcher.removePaths(m_watcher.files());
+    }
+    if (!m_watcher.directories().isEmpty()) {
+        m_watcher.removePaths(m_watcher.directories());
+    }
+}
+
+void CatalogWatcher::reload()
+{
+    m_settleTimer.stop();
+
+    // 同一时刻只解析一次，期间的变化在完成后合并为一次重新解析
+    if (m_inFlight) {
+        m_reloadPending = true;
+        return;
+    }
+
+    m_inFlight = true;
+    emit parseRequested(m_filePath, m_manager->snapshot(), ++m_generation);
+}
+
+void CatalogWatcher::setSettleInterval(int msec)
+{
+    m_settleTimer.setInterval(qMax(0, msec));
+}
+
+void CatalogWatcher::onFileChanged()
+{
+    // 文件被替换时监视随旧文件丢失，新文件存在时重新添加
+    updateWatchedPaths();
+    if (QFileInfo::exists(m_filePath)) {
+        m_settleTimer.start();
+    }
+}
+
+void CatalogWatcher::onDirectoryChanged()
+{
+    // 只关心目录文件的新建，其他文件的变化不触发重新加载
+    if (QFileInfo::exists(m_filePath) && !m_watcher.files().contains(m_filePath)) {
+        updateWatchedPaths();
+        m_settleTimer.start();
+    }
+}
+
+void CatalogWatcher::onParseFinished(const CatalogBuilderPtr &builder, const CatalogDiffStats &stats,
+                                     const QString &error, quint64 generation)
+{
+    m_inFlight = false;
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (!error.isEmpty()) {
+        m_lastError = error;
+        qDebug() << "Catalog reload failed:" << error;
+        emit reloadFailed(error);
+    } else if (!m_manager->publish(*builder)) {
+        // 比较期间目录被修改，差异基于旧快照，需基于新快照重新比较
+        qDebug() << "Catalog changed during reload, retrying:" << m_manager->getLastError();
+        m_reloadPending = true;
+    } else {
+        m_lastError.clear();
+        ++m_reloadCount;
+        qDebug() << "Catalog reloaded:" << stats.added << "added," << stats.removed << "removed,"
+                 << stats.moved << "moved," << stats.changed << "changed";
+        emit catalogReloaded(stats);
+    }
+
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        reload();
+    }
+}
+
+void CatalogWatcher::updateWatchedPaths()
+{
+    const QFileInfo info(m_filePath);
+    const QString directory = info.absolutePath();
+    if (QFileInfo::exists(directory) && !m_watcher.directories().contains(directory)) {
+        m_watcher.addPath(directory);
+    }
+    if (info.exists() && !m_watcher.files().contains(m_filePath)) {
+        m_watcher.addPath(m_filePath);
+    }
+}
@@ -0,0 +1,407 @@
+#include "ChartPreviewWidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QDateTime>
+#include <QtMath>
+#include <limits>
+
+namespace {
+// 绘图区域的边距（左侧留给数值标签，底部留给时间标签）
+const int LeftMargin = 64;
+const int TopMargin = 8;
+const int RightMargin = 8;
+const int BottomMargin = 20;
+// 每个滚轮刻度的缩放系数
+const double WheelZoomStep = 1.25;
+
+// 与界面主题一致的序列颜色，按设备序号循环使用
+const QColor SeriesColors[] = {
+    QColor(74, 158, 255),   // #4a9eff
+    QColor(255, 167, 38),   // #ffa726
+    QColor(102, 187, 106),  // #66bb6a
+    QColor(239, 83, 80),    // #ef5350
+    QColor(171, 71, 188),   // #ab47bc
+    QColor(38, 198, 218),   // #26c6da
+    QColor(255, 238, 88),   // #ffee58
+    QColor(141, 110, 99)    // #8d6e63
+};
+const int SeriesColorCount = sizeof(SeriesColors) / sizeof(SeriesColors[0]);
+}
+
+ChartPreviewWidget::ChartPreviewWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_mode(SeriesDecimator::MinMaxPerPixel)
+    , m_viewStartMs(0)
+    , m_viewEndMs(0)
+    , m_minValue(std::numeric_limits<double>::infinity())
+    , m_maxValue(-std::numeric_limits<double>::infinity())
+    , m_cacheValid(false)
+    , m_cacheStartMs(0)
+    , m_cacheEndMs(0)
+    , m_cacheMsPerPixel(0.0)
+    , m_cacheRebuildCount(0)
+    , m_dragging(false)
+    , m_dragViewStartMs(0)
+{
+    setMinimumHeight(160);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setToolTip("滚轮缩放，拖动平移，双击恢复完整范围");
+}
+
+void ChartPreviewWidget::setData(const TimeSeriesQueryResult &result)
+{
+    // 同一分桶的结果（如部分结果之后的完整结果）保留当前视图
+    const bool keepView = result.bucketer == m_bucketer && m_viewEndMs > m_viewStartMs;
+
+    m_bucketer = result.bucketer;
+    m_series = result.series;
+    m_minValue = std::numeric_limits<double>::infinity();
+    m_maxValue = -std::numeric_limits<double>::infinity();
+    extendValueRange(m_series);
+    invalidateCache();
+
+    if (keepView) {
+        update();
+    } else {
+        resetView();
+    }
+}
+
+void ChartPreviewWidget::advanceData(const TimeSeriesQueryResult &result)
+{
+    if (!m_bucketer.isValid() || !result.bucketer.isValid() ||
+        result.bucketer.granularity() != m_bucketer.granularity() || m_viewEndMs <= m_viewStartMs) {
+        setData(result);
+        return;
+    }
+
+    const qint64 viewStart = m_viewStartMs;
+    const qint64 viewEnd = m_viewEndMs;
+    const bool fullView = viewStart == m_bucketer.startMs() && viewEnd == m_bucketer.endMs();
+    const bool followTail = viewEnd >= m_bucketer.endMs();
+    const qint64 shift = result.bucketer.endMs() - m_bucketer.endMs();
+
+    m_bucketer = result.bucketer;
+    m_series = result.series;
+    m_minValue = std::numeric_limits<double>::infinity();
+    m_maxValue = -std::numeric_limits<double>::infinity();
+    extendValueRange(m_series);
+    invalidateCache();
+
+    if (fullView) {
+        resetView();
+    } else if (followTail) {
+        setViewRange(viewStart + shift, viewEnd + shift);
+    } else {
+        setViewRange(viewStart, viewEnd);
+    }
+    update();
+}
+
+void ChartPreviewWidget::addSeries(const PartialQueryResult &partial)
+{
+    if (partial.bucketer != m_bucketer) {
+        TimeSeriesQueryResult result;
+        result.bucketer = partial.bucketer;
+        result.series = partial.series;
+        setData(result);
+        return;
+    }
+
+    m_series += partial.series;
+    extendValueRange(partial.series);
+
+    // 纵轴范围只影响绘制变换，已有折线无需重建
+    if (m_cacheValid) {
+        for (const DeviceSeries &series : partial.series) {
+            m_polylines.append(buildPolyline(series));
+        }
+    }
+    update();
+}
+
+void ChartPreviewWidget::clear()
+{
+    setData(TimeSeriesQueryResult());
+}
+
+void ChartPreviewWidget::setDecimationMode(SeriesDecimator::Mode mode)
+{
+    if (m_mode != mode) {
+        m_mode = mode;
+        invalidateCache();
+        update();
+    }
+}
+
+void ChartPreviewWidget::setViewRange(qint64 startMs, qint64 endMs)
+{
+    qint64 start = startMs;
+    qint64 end = endMs;
+    if (m_bucketer.isValid()) {
+        // 最小可见范围为一个时间桶，最大为完整数据范围
+        const qint64 dataSpan = m_bucketer.endMs() - m_bucketer.startMs();
+        const qint64 minSpan = qMin(dataSpan, TimeBucketer::granularityMs(m_bucketer.granularity()));
+        const qint64 span = qBound(minSpan, end - start, dataSpan);
+        start = qBound(m_bucketer.startMs(), start, m_bucketer.endMs() - span);
+        end = start + span;
+    } else {
+        start = 0;
+        end = 0;
+    }
+
+    if (start == m_viewStartMs && end == m_viewEndMs) {
+        return;
+    }
+
+    m_viewStartMs = start;
+    m_viewEndMs = end;
+    update();
+    emit viewRangeChanged(m_viewStartMs, m_viewEndMs);
+}
+
+void ChartPreviewWidget::resetView()
+{
+    if (m_bucketer.isValid()) {
+        setViewRange(m_bucketer.startMs(), m_bucketer.endMs());
+    } else {
+        setViewRange(0, 0);
+    }
+    update();
+}
+
+void ChartPreviewWidget::zoom(double factor, qint64 anchorMs)
+{
+    const qint64 span = m_viewEndMs - m_viewStartMs;
+    if (span <= 0 || factor <= 0.0) {
+        return;
+    }
+
+    const double ratio = static_cast<double>(anchorMs - m_viewStartMs) / span;
+    const qint64 newSpan = qMax<qint64>(1, qRound64(span / factor));
+    const qint64 newStart = anchorMs - qRound64(ratio * newSpan);
+    setViewRange(newStart, newStart + newSpan);
+}
+
+void ChartPreviewWidget::pan(qint64 deltaMs)
+{
+    setViewRange(m_viewStartMs + deltaMs, m_viewEndMs + deltaMs);
+}
+
+QPolygonF ChartPreviewWidget::cachedPolyline(int index)
+{
+    ensureCache();
+    return m_polylines.value(index);
+}
+
+QRect ChartPreviewWidget::plotRect() const
+{
+    return rect().adjusted(LeftMargin, TopMargin, -RightMargin, -BottomMargin);
+}
+
+void ChartPreviewWidget::ensureCache()
+{
+    const QRect plot = plotRect();
+    const qint64 span = m_viewEndMs - m_viewStartMs;
+    if (plot.width() <= 0 || span <= 0 || m_series.isEmpty()) {
+        invalidateCache();
+        return;
+    }
+
+    // 分辨率不变且视图仍在缓存范围内时，平移只需改变绘制变换
+    const double msPerPixel = static_cast<double>(span) / plot.width();
+    if (m_cacheValid && qFuzzyCompare(msPerPixel, m_cacheMsPerPixel) &&
+        m_viewStartMs >= m_cacheStartMs && m_viewEndMs <= m_cacheEndMs) {
+        return;
+    }
+
+    m_cacheStartMs = qMax(m_bucketer.startMs(), m_viewStartMs - span);
+    m_cacheEndMs = qMin(m_bucketer.endMs(), m_viewEndMs + span);
+    m_cacheMsPerPixel = msPerPixel;
+
+    m_polylines.clear();
+    m_polylines.reserve(m_series.size());
+    for (const DeviceSeries &series : m_series) {
+        m_polylines.append(buildPolyline(series));
+    }
+    m_cacheValid = true;
+    ++m_cacheRebuildCount;
+}
+
+QPolygonF ChartPreviewWidget::buildPolyline(const DeviceSeries &series) const
+{
+    const int columns = qMax(1, qRound((m_cacheEndMs - m_cacheStartMs) / m_cacheMsPerPixel));
+    const QVector<QPointF> points = SeriesDecimator::decimate(m_mode, m_bucketer, series.buckets,
+                                                              m_cacheStartMs, m_cacheEndMs, columns);
+
+    // 以缓存起点为原点，避免毫秒时间戳在绘制变换中损失精度
+    QPolygonF polyline;
+    polyline.reserve(points.size());
+    for (const QPointF &point : points) {
+        polyline.append(QPointF(point.x() - m_cacheStartMs, point.y()));
+    }
+    return polyline;
+}
+
+void ChartPreviewWidget::extendValueRange(const QVector<DeviceSeries> &series)
+{
+    for (const DeviceSeries &deviceSeries : series) {
+        for (const BucketAggregate &bucket : deviceSeries.buckets) {
+            if (!bucket.isEmpty()) {
+                m_minValue = qMin(m_minValue, bucket.min);
+                m_maxValue = qMax(m_maxValue, bucket.max);
+            }
+        }
+    }
+}
+
+void ChartPreviewWidget::invalidateCache()
+{
+    m_cacheValid = false;
+    m_polylines.clear();
+}
+
+qint64 ChartPreviewWidget::timeAt(int x) const
+{
+    const QRect plot = plotRect();
+    if (plot.width() <= 0) {
+        return m_viewStartMs;
+    }
+    return m_viewStartMs + qRound64(static_cast<double>(x - plot.left()) * (m_viewEndMs - m_viewStartMs) / plot.width());
+}
+
+void ChartPreviewWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(26, 35, 50)); // #1a2332
+
+    const QRect plot = plotRect();
+    painter.setPen(QColor(58, 68, 81)); // #3a4451
+    painter.drawRect(plot.adjusted(0, 0, -1, -1));
+
+    const bool hasValues = m_minValue <= m_maxValue;
+    if (m_series.isEmpty() || !hasValues || m_viewEndMs <= m_viewStartMs) {
+        painter.setPen(QColor(136, 146, 160));
+        painter.drawText(plot, Qt::AlignCenter, "选择设备和时间范围后显示数据预览");
+        return;
+    }
+
+    ensureCache();
+
+    // 所有值相同时上下各留出一个单位
+    double minValue = m_minValue;
+    double maxValue = m_maxValue;
+    if (maxValue - minValue <= 0.0) {
+        minValue -= 1.0;
+        maxValue += 1.0;
+    }
+
+    // 坐标轴标签
+    painter.setPen(QColor(136, 146, 160));
+    const QRect leftLabels(0, plot.top(), LeftMargin - 6, plot.height());
+    painter.drawText(leftLabels, Qt::AlignRight | Qt::AlignTop, QString::number(maxValue, 'g', 6));
+    painter.drawText(leftLabels, Qt::AlignRight | Qt::AlignBottom, QString::number(minValue, 'g', 6));
+    const QRect bottomLabels(plot.left(), plot.bottom() + 2, plot.width(), BottomMargin - 2);
+    const QString timeFormat = "MM-dd hh:mm";
+    painter.drawText(bottomLabels, Qt::AlignLeft | Qt::AlignVCenter,
+                     QDateTime::fromMSecsSinceEpoch(m_viewStartMs).toString(timeFormat));
+    painter.drawText(bottomLabels, Qt::AlignRight | Qt::AlignVCenter,
+                     QDateTime::fromMSecsSinceEpoch(m_viewEndMs).toString(timeFormat));
+
+    // 数据坐标到像素坐标的变换：平移和纵轴范围变化只改变这里
+    QTransform transform;
+    transform.translate(plot.left(), plot.top());
+    transform.scale(static_cast<double>(plot.width()) / (m_viewEndMs - m_viewStartMs),
+                    -plot.height() / (maxValue - minValue));
+    transform.translate(static_cast<double>(m_cacheStartMs - m_viewStartMs), -maxValue);
+
+    painter.setClipRect(plot);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setTransform(transform);
+    for (int i = 0; i < m_polylines.size(); ++i) {
+        QPen pen(SeriesColors[i % SeriesColorCount]);
+        pen.setCosmetic(true);
+        pen.setWidthF(1.5);
+        painter.setPen(pen);
+        painter.drawPolyline(m_polylines.at(i));
+    }
+}
+
+void ChartPreviewWidget::resizeEvent(QResizeEvent *event)
+{
+    // 宽度变化改变了每像素的时间跨度，下一次绘制时重新降采样
+    QWidget::resizeEvent(event);
+    update();
+}
+
+void ChartPreviewWidget::wheelEvent(QWheelEvent *event)
+{
+    const double steps = event->angleDelta().y() / 120.0;
+    if (steps == 0.0) {
+        QWidget::wheelEvent(event);
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const int x = qRound(event->position().x());
+#else
+    const int x = event->pos().x();
+#endif
+    zoom(qPow(WheelZoomStep, steps), timeAt(x));
+    event->accept();
+}
+
+void ChartPreviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && plotRect().contains(event->pos())) {
+        m_dragging = true;
+        m_dragOrigin = event->pos();
+        m_dragViewStartMs = m_viewStartMs;
+        setCursor(Qt::ClosedHandCursor);
+        event->accept();
+        return;
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void ChartPreviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging) {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+
+    const QRect plot = plotRect();
+    const qint64 span = m_viewEndMs - m_viewStartMs;
+    if (plot.width() > 0) {
+        const qint64 deltaMs = qRound64(static_cast<double>(m_dragOrigin.x() - event->pos().x()) * span / plot.width());
+        setViewRange(m_dragViewStartMs + deltaMs, m_dragViewStartMs + deltaMs + span);
+    }
+    event->accept();
+}
+
+void ChartPreviewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_dragging && event->button() == Qt::LeftButton) {
+        m_dragging = false;
+        unsetCursor();
+        event->accept();
+        return;
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void ChartPreviewWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        resetView();
+        event->accept();
+        return;
+    }
+    QWidget::mouseDoubleClickEvent(event);
+}
@@ -0,0 +1,368 @@
+#include "DataExporter.h"
+#include "TimeSeriesStore.h"
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+// 列式文件标识与版本
+const char ColumnarMagic[8] = {'T', 'S', 'C', 'O', 'L', 'E', 'X', 'P'};
+const char ColumnarFooterMagic[8] = {'T', 'S', 'C', 'O', 'L', 'E', 'N', 'D'};
+const quint32 ColumnarVersion = 1;
+// 进度信号的最小间隔，避免大量小块时刷屏
+const int ProgressIntervalMs = 100;
+
+template <typename T>
+void appendValue(QByteArray &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void appendColumn(QByteArray &out, const T *values, int count)
+{
+    out.append(reinterpret_cast<const char *>(values), static_cast<int>(count * sizeof(T)));
+}
+
+/**
+ * @brief 按RFC 4180转义CSV字段（含逗号、引号或换行时加引号）
+ */
+QByteArray csvField(const QString &text)
+{
+    QByteArray field = text.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r')) {
+        field.replace("\"", "\"\"");
+        field.prepend('"');
+        field.append('"');
+    }
+    return field;
+}
+
+/**
+ * @brief 以最短往返精度格式化数值
+ */
+void appendNumber(QByteArray &out, double value)
+{
+    out.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+}
+
+QByteArray fileHeader(const ExportRequest &request)
+{
+    QByteArray header;
+    if (request.format == ExportRequest::Csv) {
+        header = request.content == ExportRequest::RawSamples
+            ? "device_id,timestamp_ms,value\n"
+            : "device_id,bucket_start_ms,count,min,max,avg,first,last\n";
+        return header;
+    }
+
+    header.append(ColumnarMagic, sizeof(ColumnarMagic));
+    appendValue(header, ColumnarVersion);
+    appendValue(header, static_cast<quint32>(request.content));
+    appendValue(header, static_cast<qint32>(request.query.granularity));
+    appendValue(header, static_cast<quint32>(request.query.deviceIds.size()));
+    for (const QString &deviceId : request.query.deviceIds) {
+        const QByteArray id = deviceId.toUtf8().left(0xFFFF);
+        appendValue(header, static_cast<quint16>(id.size()));
+        header.append(id);
+    }
+    return header;
+}
+
+QByteArray fileFooter(const ExportRequest &request, quint64 rows, quint64 blocks)
+{
+    QByteArray footer;
+    if (request.format == ExportRequest::Columnar) {
+        footer.append(ColumnarFooterMagic, sizeof(ColumnarFooterMagic));
+        appendValue(footer, rows);
+        appendValue(footer, blocks);
+    }
+    return footer;
+}
+
+/**
+ * @brief 编码一块原始样本
+ */
+void encodeSamples(QByteArray &out, const ExportRequest &request, int deviceIndex, const QByteArray &deviceField,
+                   const qint64 *timestamps, const double *values, int count)
+{
+    if (request.format == ExportRequest::Columnar) {
+        appendValue(out, static_cast<quint32>(deviceIndex));
+        appendValue(out, static_cast<quint32>(count));
+        appendColumn(out, timestamps, count);
+        appendColumn(out, values, count);
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        out.append(deviceField);
+        out.append(',');
+        out.append(QByteArray::number(timestamps[i]));
+        out.append(',');
+        appendNumber(out, values[i]);
+        out.append('\n');
+    }
+}
+
+/**
+ * @brief 编码一块非空时间桶
+ */
+void encodeBuckets(QByteArray &out, const ExportRequest &request, int deviceIndex, const QByteArray &deviceField,
+                   const QVector<qint64> &starts, const QVector<BucketAggregate> &buckets)
+{
+    const int count = starts.size();
+    if (request.format == ExportRequest::Columnar) {
+        appendValue(out, static_cast<quint32>(deviceIndex));
+        appendValue(out, static_cast<quint32>(count));
+        appendColumn(out, starts.constData(), count);
+        // 聚合值按字段转置为列
+        QVector<double> column(count);
+        QVector<qint64> counts(count);
+        for (int i = 0; i < count; ++i) {
+            counts[i] = buckets.at(i).count;
+        }
+        appendColumn(out, counts.constData(), count);
+        double BucketAggregate::*fields[] = {
+            &BucketAggregate::sum, &BucketAggregate::min, &BucketAggregate::max,
+            &BucketAggregate::first, &BucketAggregate::last
+        };
+        for (double BucketAggregate::*field : fields) {
+            for (int i = 0; i < count; ++i) {
+                column[i] = buckets.at(i).*field;
+            }
+            appendColumn(out, column.constData(), count);
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const BucketAggregate &bucket = buckets.at(i);
+        out.append(deviceField);
+        out.append(',');
+        out.append(QByteArray::number(starts.at(i)));
+        out.append(',');
+        out.append(QByteArray::number(bucket.count));
+        out.append(',');
+        appendNumber(out, bucket.min);
+        out.append(',');
+        appendNumber(out, bucket.max);
+        out.append(',');
+        appendNumber(out, bucket.average());
+        out.append(',');
+        appendNumber(out, bucket.first);
+        out.append(',');
+        appendNumber(out, bucket.last);
+        out.append('\n');
+    }
+}
+}
+
+ExportStats ExportRunner::exportData(const ExportRequest &request, const QueryCancelToken &token)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    ExportStats stats;
+    stats.totalDevices = request.query.deviceIds.size();
+
+    auto finish = [&stats, &timer](const QString &error) {
+        stats.elapsedUs = timer.nsecsElapsed() / 1000;
+        stats.finished = true;
+        stats.error = error;
+        return stats;
+    };
+
+    const TimeBucketer bucketer(request.query.startMs, request.query.endMs, request.query.granularity);
+    if (!m_store || !request.isValid() || !bucketer.isValid()) {
+        return finish("无效的导出请求");
+    }
+
+    QSaveFile file(request.filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return finish(QString("无法创建导出文件: %1").arg(file.errorString()));
+    }
+
+    QString error;
+    quint64 blocks = 0;
+    auto write = [&file, &stats, &error](const QByteArray &data) {
+        if (file.write(data) != data.size()) {
+            error = QString("写入导出文件失败: %1").arg(file.errorString());
+            return false;
+        }
+        stats.bytesWritten += data.size();
+        return true;
+    };
+
+    // 每写完一块更新进度并检查取消，返回false时停止导出
+    auto blockWritten = [&](int rows, double deviceFraction) {
+        ++blocks;
+        stats.rowsWritten += rows;
+        stats.completeness = (stats.completedDevices + qBound(0.0, deviceFraction, 1.0)) / stats.totalDevices;
+        if (progressTimer.elapsed() >= ProgressIntervalMs) {
+            progressTimer.restart();
+            stats.elapsedUs = timer.nsecsElapsed() / 1000;
+            emit progressChanged(stats);
+        }
+        return !token.isCancelled();
+    };
+
+    bool ok = write(fileHeader(request));
+    QByteArray buffer;
+    QVector<qint64> starts;
+    QVector<BucketAggregate> buckets;
+
+    for (int deviceIndex = 0; ok && deviceIndex < stats.totalDevices && !token.isCancelled(); ++deviceIndex) {
+        const QString &deviceId = request.query.deviceIds.at(deviceIndex);
+        const QByteArray deviceField = csvField(deviceId);
+
+        if (request.content == ExportRequest::RawSamples) {
+            const double span = static_cast<double>(request.query.endMs - request.query.startMs);
+            QString scanError;
+            m_store->scanSamples(deviceId, request.query.startMs, request.query.endMs,
+                                 [&](const qint64 *timestamps, const double *values, qint64 count) {
+                // 一个数据块可能超过块行数，再切分以限制编码缓冲区
+                for (qint64 offset = 0; ok && offset < count; offset += request.blockRows) {
+                    const int rows = static_cast<int>(qMin<qint64>(request.blockRows, count - offset));
+                    buffer.clear();
+                    encodeSamples(buffer, request, deviceIndex, deviceField,
+                                  timestamps + offset, values + offset, rows);
+                    ok = write(buffer) &&
+                         blockWritten(rows, (timestamps[offset + rows - 1] - request.query.startMs) / span);
+                }
+                return ok;
+            }, &scanError);
+            // 数据块读取失败时停止导出，不生成缺少样本的文件
+            if (ok && !scanError.isEmpty()) {
+                error = scanError;
+                ok = false;
+            }
+        } else {
+            const int bucketCount = bucketer.bucketCount();
+            for (int first = 0; ok && first < bucketCount && !token.isCancelled(); first += request.blockRows) {
+                const int count = qMin(request.blockRows, bucketCount - first);
+                const QVector<BucketAggregate> aggregates = m_store->aggregateDevice(deviceId, bucketer, first, count);
+
+                // 只导出非空桶
+                starts.clear();
+                buckets.clear();
+                for (int i = 0; i < aggregates.size(); ++i) {
+                    if (!aggregates.at(i).isEmpty()) {
+                        starts.append(bucketer.bucketStart(first + i));
+                        buckets.append(aggregates.at(i));
+                    }
+                }
+                if (starts.isEmpty()) {
+                    continue;
+                }
+
+                buffer.clear();
+                encodeBuckets(buffer, request, deviceIndex, deviceField, starts, buckets);
+                ok = write(buffer) &&
+                     blockWritten(starts.size(), static_cast<double>(first + count) / bucketCount);
+            }
+        }
+
+        if (ok) {
+            ++stats.completedDevices;
+        }
+    }
+
+    if (token.isCancelled()) {
+        file.cancelWriting();
+        stats.cancelled = true;
+        return finish(QString());
+    }
+
+    if (!error.isEmpty() || !write(fileFooter(request, stats.rowsWritten, blocks)) || !file.commit()) {
+        if (error.isEmpty()) {
+            error = QString("保存导出文件失败: %1").arg(file.errorString());
+        }
+        file.cancelWriting();
+        return finish(error);
+    }
+
+    stats.completeness = 1.0;
+    finish(QString());
+    qDebug() << "Exported" << stats.rowsWritten << "rows," << stats.bytesWritten << "bytes in"
+             << stats.elapsedUs << "us (" << stats.megabytesPerSecond() << "MB/s ) to" << request.filePath;
+    return stats;
+}
+
+void ExportRunner::run(const ExportRequest &request, const QueryCancelToken &token)
+{
+    emit finished(exportData(request, token));
+}
+
+DataExporter::DataExporter(TimeSeriesStore *store, QObject *parent)
+    : QObject(parent)
+    , m_runner(new ExportRunner(store))
+    , m_running(false)
+{
+    qRegisterMetaType<ExportRequest>("ExportRequest");
+    qRegisterMetaType<ExportStats>("ExportStats");
+    qRegisterMetaType<QueryCancelToken>("QueryCancelToken");
+
+    m_runner->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_runner, &QObject::deleteLater);
+    connect(this, &DataExporter::runRequested, m_runner, &ExportRunner::run, Qt::QueuedConnection);
+    connect(m_runner, &ExportRunner::progressChanged, this, &DataExporter::onRunProgress, Qt::QueuedConnection);
+    connect(m_runner, &ExportRunner::finished, this, &DataExporter::onRunFinished, Qt::QueuedConnection);
+
+    m_workerThread.setObjectName("DataExporter");
+    m_workerThread.start();
+}
+
+DataExporter::~DataExporter()
+{
+    cancel();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+bool DataExporter::start(const ExportRequest &request)
+{
+    if (m_running) {
+        m_lastError = "已有导出正在进行";
+        return false;
+    }
+    if (!request.isValid()) {
+        m_lastError = "没有可导出的设备或时间范围";
+        return false;
+    }
+
+    m_lastError.clear();
+    m_token = QueryCancelToken();
+    m_running = true;
+    m_lastStats = ExportStats();
+    m_lastStats.totalDevices = request.query.deviceIds.size();
+    emit runRequested(request, m_token);
+    return true;
+}
+
+void DataExporter::cancel()
+{
+    if (m_running) {
+        m_token.cancel();
+    }
+}
+
+void DataExporter::onRunProgress(const ExportStats &stats)
+{
+    // 结束后才到达的排队进度不再覆盖最终统计
+    if (!m_running) {
+        return;
+    }
+    m_lastStats = stats;
+    emit progressChanged(stats);
+}
+
+void DataExporter::onRunFinished(const ExportStats &stats)
+{
+    m_running = false;
+    m_lastStats = stats;
+    m_lastError = stats.error;
+    emit finished(stats);
+}
@@ -1,5 +1,10 @@
 #include "DeviceManager.h"
+#include "CatalogLoader.h"
+#include "StringPool.h"
+#include "WorkStealingThreadPool.h"
 #include <QDebug>
+#include <QFutureInterface>
+#include <atomic>
 
 DeviceManager& DeviceManager::instance()
 {
@@ -8,11 +13,21 @@ DeviceManager& DeviceManager::instance()
 }
 
 DeviceManager::DeviceManager(QObject *parent)
-    : QObject(parent), m_dataLoaded(false), m_isLoading(false)
+    : DeviceManager(&StringPool::global(), parent)
+{
+}
+
+DeviceManager::DeviceManager(StringPool *stringPool, QObject *parent)
+    : QObject(parent), m_snapshot(std::make_shared<CatalogSnapshot>(stringPool))
+    , m_dataLoaded(false), m_isLoading(false), m_transactionDepth(0)
 {
     // 构造函数中不加载数据，由外部调用loadDeviceData()
 }
 
+DeviceManager::~DeviceManager()
+{
+}
+
 void DeviceManager::loadDeviceData()
 {
     if (m_dataLoaded || m_isLoading) {
@@ -24,37 +39,37 @@ void DeviceManager::loadDeviceData()
     emit loadingStateChanged(true);
     
     try {
-        // 清空现有数据
-        m_devices.clear();
-        m_deviceTypes.clear();
+        // 在新的目录上构建，成功后整体替换当前快照
+        QHash<QString, DeviceInfo> devices;
+        QStringList types;
         
-        // 模拟数据加载过程中可能的错误
-        if (m_devices.isEmpty() && m_deviceTypes.isEmpty()) {
-            // 初始化示例数据
-            initializeSampleData();
-            
-            // 验证数据完整性
-            if (m_devices.isEmpty()) {
-                throw std::runtime_error("No device data available");
-            }
-            
-            if (m_deviceTypes.isEmpty()) {
-                throw std::runtime_error("No device types defined");
-            }
-            
-            // 构建设备层级关系
-            buildDeviceHierarchy();
-            
-            // 验证层级关系
-            validateDeviceHierarchy();
+        // 初始化示例数据
+        initializeSampleData(devices, types);
+        
+        // 验证数据完整性
+        if (devices.isEmpty()) {
+            throw std::runtime_error("No device data available");
         }
         
+        if (types.isEmpty()) {
+            throw std::runtime_error("No device types defined");
+        }
+        
+        // 构建并验证设备层级关系
+        CatalogBuilder builder(m_snapshot);
+        if (!builder.assign(devices, types)) {
+            throw std::runtime_error(builder.lastError().toStdString());
+        }
+        
+        // 目录已变化，发布新快照并使缓存失效
+        setSnapshot(builder.build(m_snapshot->version() + 1));
+        
         m_dataLoaded = true;
         m_isLoading = false;
         emit loadingStateChanged(false);
         emit dataLoaded();
         
-        qDebug() << "Device data loaded successfully:" << m_devices.size() << "devices," << m_deviceTypes.size() << "types";
+        qDebug() << "Device data loaded successfully:" << devices.size() << "devices," << types.size() << "types";
         
     } catch (const std::exception &e) {
         m_lastError = QString("设备数据加载失败: %1").arg(e.what());
@@ -73,182 +88,339 @@ void DeviceManager::loadDeviceData()
     }
 }
 
+bool DeviceManager::loadCatalog(const CatalogData &catalog)
+{
+    if (m_isLoading || m_builder) {
+        m_lastError = "正在加载或修改目录，无法替换";
+        return false;
+    }
+
+    m_isLoading = true;
+    m_lastError.clear();
+    emit loadingStateChanged(true);
+
+    CatalogBuilder builder(m_snapshot);
+    builder.assign(catalog);
+    setSnapshot(builder.build(m_snapshot->version() + 1));
+
+    m_dataLoaded = true;
+    m_isLoading = false;
+    emit loadingStateChanged(false);
+    emit dataLoaded();
+
+    qDebug() << "Device catalog loaded:" << catalog.deviceCount() << "devices," << catalog.types().size() << "types";
+    return true;
+}
+
 QList<DeviceInfo> DeviceManager::getDevicesByType(const QString &type) const
 {
-    QList<DeviceInfo> result;
-    
-    if (type.isEmpty()) {
+    return getDevicesByType(deviceTypeId(type));
+}
+
+QList<DeviceInfo> DeviceManager::getDevicesByType(int typeId) const
+{
+    if (typeId == DeviceTypeRegistry::AllTypes) {
         // 返回所有设备
         return getAllDevices();
     }
     
-    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
-        if (it.value().type == type) {
-            result.append(it.value());
-        }
-    }
-    
-    return result;
+    return current().devicesForHandles(queryDeviceHandles(typeId, QString()));
 }
 
 QStringList DeviceManager::getDeviceTypes() const
 {
-    return m_deviceTypes;
+    return current().deviceTypes();
 }
 
 DeviceInfo DeviceManager::getDevice(const QString &id) const
 {
-    return m_devices.value(id, DeviceInfo());
+    return current().device(id);
 }
 
 QList<DeviceInfo> DeviceManager::getAllDevices() const
 {
-    return m_devices.values();
+    return current().allDevices();
 }
 
 QList<DeviceInfo> DeviceManager::searchDevices(const QString &keyword) const
 {
-    QList<DeviceInfo> result;
-    
     if (keyword.isEmpty()) {
         return getAllDevices();
     }
     
-    QString lowerKeyword = keyword.toLower();
-    
-    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
-        const DeviceInfo &device = it.value();
-        if (device.name.toLower().contains(lowerKeyword) ||
-            device.id.toLower().contains(lowerKeyword)) {
-            result.append(device);
-        }
-    }
-    
-    return result;
+    return current().devicesForHandles(queryDeviceHandles(QString(), keyword));
 }
 
 QList<DeviceInfo> DeviceManager::getChildDevices(const QString &parentId) const
 {
-    QList<DeviceInfo> result;
-    
-    if (!m_devices.contains(parentId)) {
-        return result;
+    return current().childDevices(parentId);
+}
+
+QStringList DeviceManager::childIds(const QString &parentId) const
+{
+    return current().childIds(parentId);
+}
+
+QString DeviceManager::childIdAt(const QString &parentId, int row) const
+{
+    return current().childIdAt(parentId, row);
+}
+
+int DeviceManager::deviceRow(const QString &id) const
+{
+    return current().deviceRow(id);
+}
+
+QFuture<QList<DeviceInfo>> DeviceManager::searchDevicesAsync(const QString &keyword,
+                                                             const QueryCancelToken &token) const
+{
+    return runAsync(token, [this, keyword](const CatalogSnapshot &snapshot) {
+        if (keyword.isEmpty()) {
+            return snapshot.allDevices();
+        }
+        return snapshot.devicesForHandles(queryDeviceHandles(snapshot, QString(), keyword));
+    });
+}
+
+QFuture<QList<DeviceInfo>> DeviceManager::getDevicesByTypeAsync(const QString &type,
+                                                                const QueryCancelToken &token) const
+{
+    // 类型名称在查询所用的快照上转换为ID
+    return runAsync(token, [this, type](const CatalogSnapshot &snapshot) {
+        if (type.isEmpty()) {
+            return snapshot.allDevices();
+        }
+        return snapshot.devicesForHandles(queryDeviceHandles(snapshot, type, QString()));
+    });
+}
+
+QFuture<QList<DeviceInfo>> DeviceManager::getDevicesByTypeAsync(int typeId,
+                                                                const QueryCancelToken &token) const
+{
+    return runAsync(token, [this, typeId](const CatalogSnapshot &snapshot) {
+        if (typeId == DeviceTypeRegistry::AllTypes) {
+            return snapshot.allDevices();
+        }
+        return snapshot.devicesForHandles(queryDeviceHandles(snapshot, typeId, QString()));
+    });
+}
+
+QFuture<QList<DeviceInfo>> DeviceManager::getChildDevicesAsync(const QString &parentId,
+                                                               const QueryCancelToken &token) const
+{
+    return runAsync(token, [parentId](const CatalogSnapshot &snapshot) {
+        return snapshot.childDevices(parentId);
+    });
+}
+
+CatalogSnapshotPtr DeviceManager::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+bool DeviceManager::publish(const CatalogBuilder &builder)
+{
+    if (inTransaction()) {
+        m_lastError = "事务进行中，不能发布目录修改";
+        return false;
     }
-    
-    const DeviceInfo &parent = m_devices[parentId];
-    for (const QString &childId : parent.children) {
-        if (m_devices.contains(childId)) {
-            result.append(m_devices[childId]);
+    if (builder.baseVersion() != m_snapshot->version()) {
+        m_lastError = QString("目录已被修改（版本 %1，修改基于版本 %2）")
+                          .arg(m_snapshot->version()).arg(builder.baseVersion());
+        return false;
+    }
+    if (!builder.hasChanges()) {
+        return true;
+    }
+
+    // 先替换快照再发信号，信号处理中的查询看到的是新目录；句柄重新编号
+    // 最先通知，之后的变更信号中的句柄都是新编号
+    const QVector<int> renumbered = builder.renumberedHandles();
+    const CatalogSnapshotPtr published = builder.build(m_snapshot->version() + 1);
+    setSnapshot(published);
+
+    if (!renumbered.isEmpty()) {
+        emit handlesRenumbered(renumbered);
+    }
+
+    if (builder.typesChanged()) {
+        emit deviceTypesChanged(published->deviceTypes());
+    }
+    for (const CatalogChange &change : builder.changes()) {
+        switch (change.kind) {
+        case CatalogChange::Inserted:
+            emit devicesInserted(change.parentId, change.first, change.last, change.deviceIds);
+            break;
+        case CatalogChange::Removed:
+            emit devicesRemoved(change.parentId, change.first, change.last, change.deviceIds);
+            break;
+        case CatalogChange::Changed:
+            emit devicesChanged(change.parentId, change.first, change.last, change.deviceIds);
+            break;
+        case CatalogChange::Moved:
+            emit devicesMoved(change.parentId, change.first, change.last,
+                              change.destinationId, change.destinationRow, change.deviceIds);
+            break;
         }
     }
-    
-    return result;
+    emit catalogChanged(published->version());
+    return true;
+}
+
+void DeviceManager::beginTransaction()
+{
+    if (m_transactionDepth++ == 0) {
+        m_builder.reset(new CatalogBuilder(m_snapshot));
+    }
+}
+
+void DeviceManager::commitTransaction()
+{
+    if (m_transactionDepth <= 0 || --m_transactionDepth > 0) {
+        return;
+    }
+
+    QScopedPointer<CatalogBuilder> builder(m_builder.take());
+    publish(*builder);
+}
+
+template <typename Mutation>
+bool DeviceManager::mutate(Mutation mutation)
+{
+    beginTransaction();
+    const bool ok = mutation(*m_builder);
+    if (!ok) {
+        m_lastError = m_builder->lastError();
+    }
+    commitTransaction();
+    return ok;
+}
+
+bool DeviceManager::addDevice(const DeviceInfo &device, int row)
+{
+    return mutate([&](CatalogBuilder &builder) { return builder.addDevice(device, row); });
+}
+
+bool DeviceManager::updateDevice(const DeviceInfo &device)
+{
+    return mutate([&](CatalogBuilder &builder) { return builder.updateDevice(device); });
+}
+
+bool DeviceManager::removeDevice(const QString &id)
+{
+    return mutate([&](CatalogBuilder &builder) { return builder.removeDevice(id); });
+}
+
+bool DeviceManager::moveDevice(const QString &id, const QString &newParentId, int row)
+{
+    return mutate([&](CatalogBuilder &builder) { return builder.moveDevice(id, newParentId, row); });
 }
 
-void DeviceManager::initializeSampleData()
+bool DeviceManager::setDeviceTypeDisplayName(int typeId, const QString &displayName)
 {
-    // 设备类型
-    m_deviceTypes << "全部模型" << "根模型" << "子模型" << "传感器";
+    return mutate([&](CatalogBuilder &builder) { return builder.setTypeDisplayName(typeId, displayName); });
+}
+
+QVector<int> DeviceManager::queryDeviceHandles(int typeId, const QString &keyword) const
+{
+    // 事务中的内容尚未发布，不使用缓存
+    if (m_builder) {
+        return m_builder->current().queryHandles(typeId, keyword);
+    }
+    return m_snapshot->queryHandles(typeId, keyword, &m_queryCache);
+}
+
+QVector<int> DeviceManager::queryDeviceHandles(const CatalogSnapshot &snapshot, int typeId,
+                                               const QString &keyword) const
+{
+    return snapshot.queryHandles(typeId, keyword, &m_queryCache);
+}
+
+void DeviceManager::initializeSampleData(QHash<QString, DeviceInfo> &devices, QStringList &types)
+{
+    // 设备类型（"全部模型"由类型注册表的AllTypes表示，不是设备类型）
+    types << "根模型" << "子模型" << "传感器";
     
     // 创建示例设备数据
     // 根模型组
     DeviceInfo rootGroup("root_group", "根模型", "根模型", "", true);
-    m_devices.insert(rootGroup.id, rootGroup);
+    devices.insert(rootGroup.id, rootGroup);
     
     // 根模型设备
     DeviceInfo root1("root_001", "主控制器", "根模型", "root_group");
     DeviceInfo root2("root_002", "备用控制器", "根模型", "root_group");
-    m_devices.insert(root1.id, root1);
-    m_devices.insert(root2.id, root2);
+    devices.insert(root1.id, root1);
+    devices.insert(root2.id, root2);
     
     // 子模型组
     DeviceInfo childGroup("child_group", "子模型", "子模型", "", true);
-    m_devices.insert(childGroup.id, childGroup);
+    devices.insert(childGroup.id, childGroup);
     
     // 子模型设备
     DeviceInfo child1("child_001", "温度模块", "子模型", "child_group");
     DeviceInfo child2("child_002", "湿度模块", "子模型", "child_group");
     DeviceInfo child3("child_003", "压力模块", "子模型", "child_group");
-    m_devices.insert(child1.id, child1);
-    m_devices.insert(child2.id, child2);
-    m_devices.insert(child3.id, child3);
+    devices.insert(child1.id, child1);
+    devices.insert(child2.id, child2);
+    devices.insert(child3.id, child3);
     
     // 传感器组
     DeviceInfo sensorGroup("sensor_group", "传感器", "传感器", "", true);
-    m_devices.insert(sensorGroup.id, sensorGroup);
+    devices.insert(sensorGroup.id, sensorGroup);
     
     // 传感器设备
     DeviceInfo sensor1("sensor_001", "温度传感器A", "传感器", "sensor_group");
     DeviceInfo sensor2("sensor_002", "温度传感器B", "传感器", "sensor_group");
     DeviceInfo sensor3("sensor_003", "湿度传感器A", "传感器", "sensor_group");
     DeviceInfo sensor4("sensor_004", "压力传感器A", "传感器", "sensor_group");
-    m_devices.insert(sensor1.id, sensor1);
-    m_devices.insert(sensor2.id, sensor2);
-    m_devices.insert(sensor3.id, sensor3);
-    m_devices.insert(sensor4.id, sensor4);
+    devices.insert(sensor1.id, sensor1);
+    devices.insert(sensor2.id, sensor2);
+    devices.insert(sensor3.id, sensor3);
+    devices.insert(sensor4.id, sensor4);
 }
 
-void DeviceManager::buildDeviceHierarchy()
+template <typename Query>
+QFuture<QList<DeviceInfo>> DeviceManager::runAsync(const QueryCancelToken &token, Query query) const
 {
-    // 构建父子关系
-    for (auto it = m_devices.begin(); it != m_devices.end(); ++it) {
-        DeviceInfo &device = it.value();
-        
-        if (!device.parentId.isEmpty() && m_devices.contains(device.parentId)) {
-            DeviceInfo &parent = m_devices[device.parentId];
-            parent.addChild(device.id);
+    auto promise = std::make_shared<QFutureInterface<QList<DeviceInfo>>>();
+    promise->reportStarted();
+    const QFuture<QList<DeviceInfo>> future = promise->future();
+
+    // 在调用线程上固定快照，查询结果与调用时的目录一致
+    const CatalogSnapshotPtr pinned = snapshot();
+    queryPool()->submit([promise, pinned, token, query]() {
+        if (token.isCancelled() || promise->isCanceled()) {
+            promise->cancel();
+        } else {
+            const QList<DeviceInfo> result = query(*pinned);
+            if (token.isCancelled()) {
+                promise->cancel();
+            } else {
+                promise->reportResult(result);
+            }
         }
-    }
+        promise->reportFinished();
+    });
+    return future;
 }
 
-void DeviceManager::validateDeviceHierarchy()
+WorkStealingThreadPool *DeviceManager::queryPool() const
 {
-    // 验证父子关系的完整性
-    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
-        const DeviceInfo &device = it.value();
-        
-        // 检查父设备是否存在
-        if (!device.parentId.isEmpty() && !m_devices.contains(device.parentId)) {
-            throw std::runtime_error(QString("Device %1 references non-existent parent %2")
-                                    .arg(device.id, device.parentId).toStdString());
-        }
-        
-        // 检查子设备是否存在
-        for (const QString &childId : device.children) {
-            if (!m_devices.contains(childId)) {
-                throw std::runtime_error(QString("Device %1 references non-existent child %2")
-                                        .arg(device.id, childId).toStdString());
-            }
-        }
-        
-        // 检查循环引用
-        QStringList visited;
-        if (hasCircularReference(device.id, visited)) {
-            throw std::runtime_error(QString("Circular reference detected in device hierarchy starting from %1")
-                                    .arg(device.id).toStdString());
-        }
+    QMutexLocker locker(&m_queryPoolMutex);
+    if (!m_queryPool) {
+        m_queryPool.reset(new WorkStealingThreadPool());
     }
+    return m_queryPool.data();
 }
 
-bool DeviceManager::hasCircularReference(const QString &deviceId, QStringList &visited) const
+const CatalogSnapshot &DeviceManager::current() const
 {
-    if (visited.contains(deviceId)) {
-        return true;
-    }
-    
-    if (!m_devices.contains(deviceId)) {
-        return false;
-    }
-    
-    visited.append(deviceId);
-    const DeviceInfo &device = m_devices[deviceId];
-    
-    for (const QString &childId : device.children) {
-        if (hasCircularReference(childId, visited)) {
-            return true;
-        }
-    }
-    
-    visited.removeLast();
-    return false;
-}
\ No newline at end of file
+    // 快照只在本线程上替换，这里不需要原子读取
+    return m_builder ? m_builder->current() : *m_snapshot;
+}
+
+void DeviceManager::setSnapshot(const CatalogSnapshotPtr &snapshot)
+{
+    std::atomic_store(&m_snapshot, snapshot);
+    m_queryCache.setCatalogVersion(snapshot->version());
+}
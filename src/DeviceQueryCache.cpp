@@ -0,0 +1,102 @@
+#include "DeviceQueryCache.h"
+
+DeviceQueryCache::DeviceQueryCache(int maxBytes)
+    : m_cache(maxBytes), m_catalogVersion(0), m_hits(0), m_misses(0)
+{
+}
+
+bool DeviceQueryCache::lookup(const DeviceQueryKey &key, QVector<int> &handles)
+{
+    QMutexLocker locker(&m_mutex);
+    if (key.catalogVersion != m_catalogVersion) {
+        ++m_misses;
+        return false;
+    }
+
+    // QCache::object() 同时会把条目移到LRU队首
+    QVector<int> *cached = m_cache.object(key);
+    if (!cached) {
+        ++m_misses;
+        return false;
+    }
+
+    handles = *cached;
+    ++m_hits;
+    return true;
+}
+
+void DeviceQueryCache::insert(const DeviceQueryKey &key, const QVector<int> &handles)
+{
+    QMutexLocker locker(&m_mutex);
+    if (key.catalogVersion != m_catalogVersion) {
+        return;
+    }
+
+    // 超过容量的结果不缓存，QCache会直接丢弃它
+    m_cache.insert(key, new QVector<int>(handles), costOf(key, handles));
+}
+
+void DeviceQueryCache::setCatalogVersion(quint64 version)
+{
+    QMutexLocker locker(&m_mutex);
+    if (version != m_catalogVersion) {
+        m_cache.clear();
+        m_catalogVersion = version;
+    }
+}
+
+void DeviceQueryCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+void DeviceQueryCache::setMaxBytes(int maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(maxBytes);
+}
+
+int DeviceQueryCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+int DeviceQueryCache::usedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}
+
+int DeviceQueryCache::entryCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}
+
+quint64 DeviceQueryCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+quint64 DeviceQueryCache::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+double DeviceQueryCache::hitRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 total = m_hits + m_misses;
+    return total == 0 ? 0.0 : static_cast<double>(m_hits) / static_cast<double>(total);
+}
+
+int DeviceQueryCache::costOf(const DeviceQueryKey &key, const QVector<int> &handles)
+{
+    return static_cast<int>(sizeof(DeviceQueryKey) + sizeof(QVector<int>)
+                            + key.query.size() * sizeof(QChar)
+                            + handles.size() * sizeof(int));
+}
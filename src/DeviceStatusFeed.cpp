@@ -0,0 +1,275 @@
+#include "DeviceStatusFeed.h"
+#include "DeviceManager.h"
+#include <QMetaObject>
+#include <QDebug>
+
+namespace {
+// 默认合并周期，约等于60Hz刷新率下的一帧
+const int DefaultFrameIntervalMs = 16;
+// 每帧每个来源最多取出的更新数，避免持续的风暴长时间占用GUI线程
+const int MaxUpdatesPerFrame = 262144;
+
+quint32 roundUpToPowerOfTwo(int value)
+{
+    quint32 result = 2;
+    while (result < static_cast<quint32>(value) && result < (1u << 30)) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+DeviceStatusQueue::DeviceStatusQueue(int capacity)
+    : m_slots(static_cast<int>(roundUpToPowerOfTwo(capacity)))
+    , m_mask(static_cast<quint32>(m_slots.size()) - 1)
+    , m_head(0)
+    , m_tail(0)
+{
+}
+
+bool DeviceStatusQueue::tryPush(const DeviceStatusUpdate &update)
+{
+    const quint32 tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+        return false;
+    }
+
+    // 先写槽位，再以release发布尾指针，消费者看到新尾指针时槽位已写完
+    m_slots[static_cast<int>(tail & m_mask)] = update;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool DeviceStatusQueue::tryPop(DeviceStatusUpdate &update)
+{
+    const quint32 head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    DeviceStatusUpdate &slot = m_slots[static_cast<int>(head & m_mask)];
+    update.handle = slot.handle;
+    update.status = slot.status;
+    update.deviceId.swap(slot.deviceId);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+int DeviceStatusQueue::sizeApprox() const
+{
+    return static_cast<int>(m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire));
+}
+
+DeviceStatusSource::DeviceStatusSource(QObject *parent)
+    : QObject(parent)
+    , m_publishedCount(0)
+{
+}
+
+void DeviceStatusSource::publish(const DeviceStatusUpdate &update)
+{
+    m_publishedCount.fetch_add(1, std::memory_order_relaxed);
+
+    // 有暂存时新更新也进入暂存，保证同一设备的先后顺序
+    if (flushPending() && m_queue.tryPush(update)) {
+        return;
+    }
+    if (update.handle >= 0) {
+        m_pendingHandles.insert(update.handle, update.status);
+    } else {
+        m_pendingIds.insert(update.deviceId, update.status);
+    }
+}
+
+bool DeviceStatusSource::flushPending()
+{
+    for (auto it = m_pendingHandles.begin(); it != m_pendingHandles.end(); ) {
+        if (!m_queue.tryPush(DeviceStatusUpdate(it.key(), it.value()))) {
+            return false;
+        }
+        it = m_pendingHandles.erase(it);
+    }
+    for (auto it = m_pendingIds.begin(); it != m_pendingIds.end(); ) {
+        if (!m_queue.tryPush(DeviceStatusUpdate(it.key(), it.value()))) {
+            return false;
+        }
+        it = m_pendingIds.erase(it);
+    }
+    return true;
+}
+
+DeviceStatusFeed::DeviceStatusFeed(QObject *parent)
+    : QObject(parent)
+    , m_manager(nullptr)
+    , m_receivedCount(0)
+    , m_changedCount(0)
+    , m_frameCount(0)
+{
+    qRegisterMetaType<QVector<int>>("QVector<int>");
+    setDeviceManager(&DeviceManager::instance());
+
+    m_frameTimer.setInterval(DefaultFrameIntervalMs);
+    connect(&m_frameTimer, &QTimer::timeout, this, &DeviceStatusFeed::onFrameTimeout);
+
+    m_workerThread.setObjectName("DeviceStatusFeed");
+    m_workerThread.start();
+}
+
+DeviceStatusFeed::~DeviceStatusFeed()
+{
+    // 工作线程结束时删除其中的来源
+    m_frameTimer.stop();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+void DeviceStatusFeed::setDeviceManager(const DeviceManager *manager)
+{
+    if (manager == m_manager) {
+        return;
+    }
+    if (m_manager) {
+        disconnect(m_manager, nullptr, this, nullptr);
+    }
+
+    // 句柄只在同一个目录中有意义
+    m_manager = manager;
+    onCatalogReloaded();
+    if (m_manager) {
+        connect(m_manager, &DeviceManager::dataLoaded, this, &DeviceStatusFeed::onCatalogReloaded);
+        connect(m_manager, &DeviceManager::handlesRenumbered, this, &DeviceStatusFeed::onHandlesRenumbered);
+    }
+}
+
+void DeviceStatusFeed::addSource(DeviceStatusSource *source)
+{
+    if (!source) {
+        return;
+    }
+
+    source->setParent(nullptr);
+    source->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, source, &QObject::deleteLater);
+    m_sources.append(source);
+    QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+    m_frameTimer.start();
+}
+
+void DeviceStatusFeed::attachSource(DeviceStatusSource *source)
+{
+    if (source && !m_sources.contains(source)) {
+        m_sources.append(source);
+        connect(source, &QObject::destroyed, this, [this, source]() {
+            m_sources.removeAll(source);
+        });
+    }
+}
+
+void DeviceStatusFeed::setFrameInterval(int msec)
+{
+    m_frameTimer.setInterval(qMax(1, msec));
+}
+
+DeviceStatusFeed::Status DeviceStatusFeed::status(int handle) const
+{
+    if (handle < 0 || handle >= m_statuses.size()) {
+        return Unknown;
+    }
+    return static_cast<Status>(m_statuses.at(handle));
+}
+
+QVector<int> DeviceStatusFeed::drain()
+{
+    ++m_frameCount;
+    const quint32 frame = static_cast<quint32>(m_frameCount);
+    m_touched.clear();
+    m_touchedPrevious.clear();
+
+    const DeviceManager &manager = *m_manager;
+    DeviceStatusUpdate update;
+    for (DeviceStatusSource *source : qAsConst(m_sources)) {
+        DeviceStatusQueue *queue = source->queue();
+        for (int i = 0; i < MaxUpdatesPerFrame && queue->tryPop(update); ++i) {
+            ++m_receivedCount;
+            const int handle = update.handle >= 0 ? update.handle : manager.deviceHandle(update.deviceId);
+            if (handle < 0 || update.status > Alarm) {
+                continue;
+            }
+
+            if (handle >= m_statuses.size()) {
+                const int size = qMax(handle + 1, qMax(manager.deviceHandleCount(), m_statuses.size() * 2));
+                m_statuses.resize(size);
+                m_touchedFrame.resize(size);
+            }
+
+            // 同一帧内只记录第一次更新前的状态，之后的更新直接覆盖
+            if (m_touchedFrame.at(handle) != frame) {
+                m_touchedFrame[handle] = frame;
+                m_touched.append(handle);
+                m_touchedPrevious.append(m_statuses.at(handle));
+            }
+            m_statuses[handle] = update.status;
+        }
+    }
+
+    QVector<int> changed;
+    for (int i = 0; i < m_touched.size(); ++i) {
+        const int handle = m_touched.at(i);
+        if (m_statuses.at(handle) != m_touchedPrevious.at(i)) {
+            changed.append(handle);
+        }
+    }
+
+    if (!changed.isEmpty()) {
+        m_changedCount += changed.size();
+        emit statusesChanged(changed);
+    }
+    return changed;
+}
+
+DeviceStatusFeed::Status DeviceStatusFeed::statusFromString(const QString &text, bool *ok)
+{
+    const QString name = text.trimmed().toLower();
+    Status status = Unknown;
+    bool valid = true;
+    if (name == "online" || name == "1") {
+        status = Online;
+    } else if (name == "offline" || name == "2") {
+        status = Offline;
+    } else if (name == "alarm" || name == "3") {
+        status = Alarm;
+    } else if (name != "unknown" && name != "0") {
+        valid = false;
+    }
+
+    if (ok) {
+        *ok = valid;
+    }
+    return status;
+}
+
+void DeviceStatusFeed::onFrameTimeout()
+{
+    drain();
+}
+
+void DeviceStatusFeed::onCatalogReloaded()
+{
+    // 整体加载按新目录重新分配全部句柄，旧状态会落到其他设备上
+    m_statuses.clear();
+    m_touchedFrame.clear();
+}
+
+void DeviceStatusFeed::onHandlesRenumbered(const QVector<int> &handles)
+{
+    // 按新编号的句柄数重新分配；帧号只用于帧内去重，改写后从零开始
+    QVector<quint8> statuses(m_manager->deviceHandleCount());
+    for (int handle = 0; handle < m_statuses.size() && handle < handles.size(); ++handle) {
+        const int renumbered = handles.at(handle);
+        if (renumbered >= 0 && renumbered < statuses.size()) {
+            statuses[renumbered] = m_statuses.at(handle);
+        }
+    }
+    m_statuses = statuses;
+    m_touchedFrame.fill(0, statuses.size());
+}
@@ -0,0 +1,183 @@
+#include "DeviceStatusSources.h"
+#include <QFile>
+#include <QStandardPaths>
+
+namespace {
+// 模拟来源的产生周期
+const int SimulatorTickMs = 10;
+// 状态文件的轮询周期
+const int FileTailPollMs = 50;
+// 第一次读取状态文件时只读取末尾的这一段
+const qint64 InitialTailBytes = 256 * 1024;
+// 每次从状态文件读取的块大小
+const qint64 ReadChunkBytes = 64 * 1024;
+// 每次轮询最多读取的字节数，其余留到下一次轮询
+const qint64 MaxPollBytes = 4 * 1024 * 1024;
+// 超过此长度仍没有换行符的行视为无效
+const int MaxLineBytes = 4096;
+}
+
+DeviceStatusSimulator::DeviceStatusSimulator(int deviceCount, int updatesPerSecond, QObject *parent)
+    : DeviceStatusSource(parent)
+    , m_deviceCount(qMax(1, deviceCount))
+    , m_updatesPerSecond(qMax(1, updatesPerSecond))
+    , m_timer(new QTimer(this))
+    , m_random(QRandomGenerator::securelySeeded())
+{
+    m_timer->setInterval(SimulatorTickMs);
+    connect(m_timer, &QTimer::timeout, this, &DeviceStatusSimulator::onTick);
+}
+
+void DeviceStatusSimulator::generate(int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const int handle = static_cast<int>(m_random.bounded(static_cast<quint32>(m_deviceCount)));
+
+        // 约90%在线，其余离线或告警
+        const quint32 roll = m_random.bounded(100u);
+        const quint8 status = roll < 90 ? DeviceStatusFeed::Online
+                            : roll < 97 ? DeviceStatusFeed::Offline
+                                        : DeviceStatusFeed::Alarm;
+        publish(DeviceStatusUpdate(handle, status));
+    }
+    flushPending();
+}
+
+void DeviceStatusSimulator::start()
+{
+    m_timer->start();
+}
+
+void DeviceStatusSimulator::stop()
+{
+    m_timer->stop();
+}
+
+void DeviceStatusSimulator::onTick()
+{
+    generate(qMax(1, m_updatesPerSecond * SimulatorTickMs / 1000));
+}
+
+DeviceStatusFileTail::DeviceStatusFileTail(const QString &filePath, QObject *parent)
+    : DeviceStatusSource(parent)
+    , m_filePath(filePath)
+    , m_offset(-1)
+    , m_discardLine(false)
+    , m_invalidLines(0)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(FileTailPollMs);
+    connect(m_timer, &QTimer::timeout, this, &DeviceStatusFileTail::poll);
+}
+
+QString DeviceStatusFileTail::defaultFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/device_status.log";
+}
+
+qint64 DeviceStatusFileTail::initialTailBytes()
+{
+    return InitialTailBytes;
+}
+
+int DeviceStatusFileTail::poll()
+{
+    // 队列满时暂存的更新先写入
+    flushPending();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    const qint64 size = file.size();
+    if (m_offset < 0) {
+        // 第一次读取只从末尾的一段开始，从行中间开始时丢弃第一个不完整的行
+        m_offset = qMax<qint64>(0, size - InitialTailBytes);
+        m_discardLine = m_offset > 0;
+    } else if (size < m_offset) {
+        // 文件被截断或替换后从头读取
+        m_offset = 0;
+        m_partialLine.clear();
+        m_discardLine = false;
+    }
+    if (size == m_offset || !file.seek(m_offset)) {
+        return 0;
+    }
+
+    // 按块读取，单次轮询的读取量有上限
+    int lines = 0;
+    const qint64 end = qMin(size, m_offset + MaxPollBytes);
+    while (m_offset < end) {
+        const QByteArray chunk = file.read(qMin(ReadChunkBytes, end - m_offset));
+        if (chunk.isEmpty()) {
+            break;
+        }
+        m_offset += chunk.size();
+        lines += parseChunk(chunk);
+    }
+    return lines;
+}
+
+int DeviceStatusFileTail::parseChunk(const QByteArray &chunk)
+{
+    int lines = 0;
+    int lineStart = 0;
+    for (int newline = chunk.indexOf('\n'); newline >= 0; newline = chunk.indexOf('\n', lineStart)) {
+        QByteArray line = chunk.mid(lineStart, newline - lineStart);
+        lineStart = newline + 1;
+        if (m_discardLine) {
+            m_discardLine = false;
+            continue;
+        }
+        if (!m_partialLine.isEmpty()) {
+            line.prepend(m_partialLine);
+            m_partialLine.clear();
+        }
+        if (parseLine(line.trimmed())) {
+            ++lines;
+        }
+    }
+
+    if (!m_discardLine) {
+        m_partialLine += chunk.mid(lineStart);
+        if (m_partialLine.size() > MaxLineBytes) {
+            // 过长的行不可能是状态行，丢弃到下一个换行符
+            m_partialLine.clear();
+            m_discardLine = true;
+            ++m_invalidLines;
+        }
+    }
+    return lines;
+}
+
+bool DeviceStatusFileTail::parseLine(const QByteArray &line)
+{
+    if (line.isEmpty() || line.startsWith('#')) {
+        return false;
+    }
+
+    const int comma = line.lastIndexOf(',');
+    bool ok = false;
+    const DeviceStatusFeed::Status status = comma > 0
+        ? DeviceStatusFeed::statusFromString(QString::fromUtf8(line.mid(comma + 1)), &ok)
+        : DeviceStatusFeed::Unknown;
+    if (!ok) {
+        ++m_invalidLines;
+        return false;
+    }
+
+    publish(DeviceStatusUpdate(QString::fromUtf8(line.left(comma).trimmed()), static_cast<quint8>(status)));
+    return true;
+}
+
+void DeviceStatusFileTail::start()
+{
+    poll();
+    m_timer->start();
+}
+
+void DeviceStatusFileTail::stop()
+{
+    m_timer->stop();
+}
@@ -0,0 +1,180 @@
+#include "DeviceTreeModel.h"
+#include "DeviceStatusFeed.h"
+#include <QPainter>
+#include <QMap>
+#include <algorithm>
+
+namespace {
+// 状态图标的边长（像素）
+const int StatusIconSize = 10;
+
+QPixmap statusIcon(const QColor &color)
+{
+    QPixmap pixmap(StatusIconSize, StatusIconSize);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(color);
+    painter.drawEllipse(QRectF(1, 1, StatusIconSize - 2, StatusIconSize - 2));
+    return pixmap;
+}
+}
+
+DeviceTreeModel::DeviceTreeModel(QObject *parent)
+    : QStandardItemModel(parent)
+    , m_feed(nullptr)
+{
+    // 索引随行的插入和删除增量维护，项目被删除前移出索引，避免通知时
+    // 访问已删除的项目
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+        m_itemsByHandle.clear();
+    });
+    connect(this, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex &parent, int first, int last) {
+        updateRowsIndex(parent, first, last, true);
+    });
+    connect(this, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this](const QModelIndex &parent, int first, int last) {
+        updateRowsIndex(parent, first, last, false);
+    });
+}
+
+void DeviceTreeModel::setStatusFeed(const DeviceStatusFeed *feed)
+{
+    m_feed = feed;
+    if (m_feed && m_statusIcons.isEmpty()) {
+        m_statusIcons.resize(DeviceStatusFeed::Alarm + 1);
+        m_statusIcons[DeviceStatusFeed::Online] = statusIcon(QColor("#4caf50"));
+        m_statusIcons[DeviceStatusFeed::Offline] = statusIcon(QColor("#808080"));
+        m_statusIcons[DeviceStatusFeed::Alarm] = statusIcon(QColor("#f44336"));
+    }
+    rebuildHandleIndex();
+}
+
+QVariant DeviceTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (m_feed && index.column() == 0 && (role == Qt::DecorationRole || role == DeviceStatusRole)) {
+        bool hasHandle = false;
+        const int handle = QStandardItemModel::data(index, DeviceHandleRole).toInt(&hasHandle);
+        const DeviceStatusFeed::Status status = hasHandle ? m_feed->status(handle) : DeviceStatusFeed::Unknown;
+        if (role == DeviceStatusRole) {
+            return static_cast<int>(status);
+        }
+        if (status != DeviceStatusFeed::Unknown) {
+            return m_statusIcons.at(status);
+        }
+    }
+    return QStandardItemModel::data(index, role);
+}
+
+void DeviceTreeModel::rebuildHandleIndex()
+{
+    m_itemsByHandle.clear();
+    if (m_feed) {
+        updateRowsIndex(QModelIndex(), 0, rowCount() - 1, true);
+    }
+}
+
+void DeviceTreeModel::remapHandles(const QVector<int> &handles)
+{
+    for (int row = 0; row < rowCount(); ++row) {
+        if (QStandardItem *child = item(row)) {
+            remapItemHandles(child, handles);
+        }
+    }
+    rebuildHandleIndex();
+}
+
+int DeviceTreeModel::notifyStatusChanged(const QVector<int> &handles)
+{
+    if (m_itemsByHandle.isEmpty()) {
+        return 0;
+    }
+
+    // 按父节点收集变化的行
+    QMap<QStandardItem*, QVector<int>> rowsByParent;
+    for (int handle : handles) {
+        QStandardItem *item = handle >= 0 && handle < m_itemsByHandle.size() ? m_itemsByHandle.at(handle) : nullptr;
+        if (item) {
+            QStandardItem *parent = item->parent() ? item->parent() : invisibleRootItem();
+            rowsByParent[parent].append(item->row());
+        }
+    }
+
+    // 连续的行合并为一个范围
+    const QVector<int> roles({Qt::DecorationRole, DeviceStatusRole});
+    int ranges = 0;
+    for (auto it = rowsByParent.begin(); it != rowsByParent.end(); ++it) {
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+        const QModelIndex parentIndex = it.key() == invisibleRootItem() ? QModelIndex() : it.key()->index();
+
+        int first = rows.first();
+        int last = first;
+        for (int i = 1; i <= rows.size(); ++i) {
+            if (i < rows.size() && rows.at(i) <= last + 1) {
+                last = qMax(last, rows.at(i));
+                continue;
+            }
+            emit dataChanged(index(first, 0, parentIndex), index(last, 0, parentIndex), roles);
+            ++ranges;
+            if (i < rows.size()) {
+                first = rows.at(i);
+                last = first;
+            }
+        }
+    }
+    return ranges;
+}
+
+void DeviceTreeModel::updateRowsIndex(const QModelIndex &parent, int first, int last, bool indexed)
+{
+    if (!m_feed) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        QStandardItem *item = itemFromIndex(index(row, 0, parent));
+        if (item) {
+            updateItemIndex(item, indexed);
+        }
+    }
+}
+
+void DeviceTreeModel::updateItemIndex(QStandardItem *item, bool indexed)
+{
+    bool hasHandle = false;
+    const int handle = item->data(DeviceHandleRole).toInt(&hasHandle);
+    if (hasHandle && handle >= 0) {
+        if (indexed) {
+            if (handle >= m_itemsByHandle.size()) {
+                m_itemsByHandle.resize(handle + 1);
+            }
+            m_itemsByHandle[handle] = item;
+        } else if (handle < m_itemsByHandle.size() && m_itemsByHandle.at(handle) == item) {
+            m_itemsByHandle[handle] = nullptr;
+        }
+    }
+
+    for (int row = 0; row < item->rowCount(); ++row) {
+        if (QStandardItem *child = item->child(row)) {
+            updateItemIndex(child, indexed);
+        }
+    }
+}
+
+void DeviceTreeModel::remapItemHandles(QStandardItem *item, const QVector<int> &handles)
+{
+    bool hasHandle = false;
+    const int handle = item->data(DeviceHandleRole).toInt(&hasHandle);
+    if (hasHandle && handle >= 0) {
+        item->setData(handles.value(handle, -1), DeviceHandleRole);
+    }
+
+    for (int row = 0; row < item->rowCount(); ++row) {
+        if (QStandardItem *child = item->child(row)) {
+            remapItemHandles(child, handles);
+        }
+    }
+}
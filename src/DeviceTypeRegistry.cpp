@@ -0,0 +1,108 @@
+#include "DeviceTypeRegistry.h"
+
+DeviceTypeRegistry::DeviceTypeRegistry()
+{
+    Entry all;
+    all.displayName = "全部模型";
+    all.count = 0;
+    m_entries.append(all);
+}
+
+int DeviceTypeRegistry::typeId(const QString &name) const
+{
+    return name.isEmpty() ? int(AllTypes) : m_index.value(name, UnknownType);
+}
+
+QString DeviceTypeRegistry::typeName(int typeId) const
+{
+    return isValid(typeId) ? m_entries.at(typeId).name : QString();
+}
+
+QString DeviceTypeRegistry::displayName(int typeId) const
+{
+    if (!isValid(typeId)) {
+        return QString();
+    }
+    const Entry &entry = m_entries.at(typeId);
+    return entry.displayName.isEmpty() ? entry.name : entry.displayName;
+}
+
+int DeviceTypeRegistry::deviceCount(int typeId) const
+{
+    return isValid(typeId) ? m_entries.at(typeId).count : 0;
+}
+
+QVector<int> DeviceTypeRegistry::typeIds() const
+{
+    QVector<int> ids;
+    ids.reserve(count());
+    for (int id = 1; id < m_entries.size(); ++id) {
+        ids.append(id);
+    }
+    return ids;
+}
+
+QStringList DeviceTypeRegistry::typeNames() const
+{
+    QStringList names;
+    names.reserve(count());
+    for (int id = 1; id < m_entries.size(); ++id) {
+        names.append(m_entries.at(id).name);
+    }
+    return names;
+}
+
+int DeviceTypeRegistry::registerType(const QString &name)
+{
+    if (name.isEmpty()) {
+        return AllTypes;
+    }
+
+    const int existing = m_index.value(name, UnknownType);
+    if (existing != UnknownType) {
+        return existing;
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.count = 0;
+    const int id = m_entries.size();
+    m_entries.append(entry);
+    m_index.insert(name, id);
+    return id;
+}
+
+bool DeviceTypeRegistry::setDisplayName(int typeId, const QString &displayName)
+{
+    if (!isValid(typeId)) {
+        return false;
+    }
+    m_entries[typeId].displayName = displayName;
+    return true;
+}
+
+void DeviceTypeRegistry::adjustCount(int typeId, int delta)
+{
+    if (!isValid(typeId)) {
+        return;
+    }
+    if (typeId != AllTypes) {
+        m_entries[typeId].count += delta;
+    }
+    m_entries[AllTypes].count += delta;
+}
+
+void DeviceTypeRegistry::resetCounts()
+{
+    for (Entry &entry : m_entries) {
+        entry.count = 0;
+    }
+}
+
+qint64 DeviceTypeRegistry::structureBytes() const
+{
+    // 条目数组加上名称索引的桶和节点
+    return static_cast<qint64>(m_entries.capacity()) * sizeof(Entry)
+        + static_cast<qint64>(m_index.capacity()) * sizeof(void *)
+        + static_cast<qint64>(m_index.size()) * (sizeof(QString) + sizeof(int) + 2 * sizeof(void *));
+}
@@ -1,6 +1,11 @@
 #include "DeviceWidget.h"
 #include "DeviceManager.h"
+#include "SparklineBuffer.h"
+#include "SparklineDelegate.h"
+#include "DeviceTreeModel.h"
+#include "DeviceStatusFeed.h"
 #include <QTabWidget>
+#include <QTabBar>
 #include <QLineEdit>
 #include <QTreeView>
 #include <QStandardItemModel>
@@ -10,9 +15,25 @@
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QCheckBox>
+#include <QBitArray>
+#include <QSet>
 #include <QDebug>
+#include <algorithm>
+
+namespace {
+// 树项目中保存设备句柄的数据角色，用于命中查询缓存的位图过滤和状态更新
+const int DeviceHandleRole = DeviceTreeModel::DeviceHandleRole;
+// 迷你折线图列的序号和宽度
+const int SparklineColumn = 1;
+const int SparklineColumnWidth = 80;
+}
 
 DeviceWidget::DeviceWidget(QWidget *parent)
+    : DeviceWidget(&DeviceManager::instance(), parent)
+{
+}
+
+DeviceWidget::DeviceWidget(DeviceManager *manager, QWidget *parent)
     : QWidget(parent)
     , m_tabWidget(nullptr)
     , m_searchEdit(nullptr)
@@ -26,17 +47,32 @@ DeviceWidget::DeviceWidget(QWidget *parent)
     , m_mainLayout(nullptr)
     , m_searchLayout(nullptr)
     , m_statusLayout(nullptr)
+    , m_currentTypeId(DeviceTypeRegistry::AllTypes)
     , m_updatingSelection(false)
+    , m_sparklineBuffer(nullptr)
+    , m_sparklineDelegate(nullptr)
+    , m_sparklinesVisible(false)
+    , m_statusFeed(nullptr)
+    , m_manager(manager)
 {
     setupUI();
     setupDeviceTree();
     
     // 连接设备管理器信号
-    connect(&DeviceManager::instance(), &DeviceManager::dataLoaded,
+    connect(m_manager, &DeviceManager::dataLoaded,
             this, &DeviceWidget::onDeviceDataLoaded);
     
+    // 目录修改按范围增量更新树，不重建模型
+    connect(m_manager, &DeviceManager::devicesInserted, this, &DeviceWidget::onDevicesInserted);
+    connect(m_manager, &DeviceManager::devicesRemoved, this, &DeviceWidget::onDevicesRemoved);
+    connect(m_manager, &DeviceManager::devicesChanged, this, &DeviceWidget::onDevicesChanged);
+    connect(m_manager, &DeviceManager::devicesMoved, this, &DeviceWidget::onDevicesMoved);
+    connect(m_manager, &DeviceManager::deviceTypesChanged, this, &DeviceWidget::onDeviceTypesChanged);
+    connect(m_manager, &DeviceManager::handlesRenumbered, this, &DeviceWidget::onHandlesRenumbered);
+    connect(m_manager, &DeviceManager::catalogChanged, this, &DeviceWidget::onCatalogChanged);
+    
     // 如果数据已经加载，直接更新界面
-    if (!DeviceManager::instance().getAllDevices().isEmpty()) {
+    if (!m_manager->getAllDevices().isEmpty()) {
         onDeviceDataLoaded();
     }
 }
@@ -70,13 +106,82 @@ void DeviceWidget::setSearchText(const QString &text)
     }
 }
 
+void DeviceWidget::setSparklineBuffer(SparklineBuffer *buffer)
+{
+    if (buffer == m_sparklineBuffer) {
+        return;
+    }
+    
+    if (m_sparklineBuffer) {
+        disconnect(m_sparklineBuffer, nullptr, this, nullptr);
+    }
+    if (m_sparklineDelegate) {
+        m_deviceTree->setItemDelegateForColumn(SparklineColumn, nullptr);
+        delete m_sparklineDelegate;
+        m_sparklineDelegate = nullptr;
+    }
+    
+    m_sparklineBuffer = buffer;
+    if (m_sparklineBuffer) {
+        m_sparklineDelegate = new SparklineDelegate(m_sparklineBuffer, this);
+        m_deviceTree->setItemDelegateForColumn(SparklineColumn, m_sparklineDelegate);
+        connect(m_sparklineBuffer, &SparklineBuffer::samplesAppended,
+                this, &DeviceWidget::onSparklineSamplesAppended);
+    }
+    m_deviceTree->viewport()->update();
+}
+
+void DeviceWidget::setSparklinesVisible(bool visible)
+{
+    if (visible == m_sparklinesVisible) {
+        return;
+    }
+    
+    // 折线图单元格只在显示时创建，切换后重建当前列表并恢复过滤
+    m_sparklinesVisible = visible;
+    loadDeviceData(m_currentTypeId);
+    if (!getSearchText().isEmpty()) {
+        filterDevices(getSearchText());
+    }
+}
+
+void DeviceWidget::setStatusFeed(DeviceStatusFeed *feed)
+{
+    if (feed == m_statusFeed) {
+        return;
+    }
+    
+    if (m_statusFeed) {
+        disconnect(m_statusFeed, nullptr, m_deviceModel, nullptr);
+    }
+    
+    // 状态变化直接转为模型的最小范围dataChanged，不修改项目
+    m_statusFeed = feed;
+    m_deviceModel->setStatusFeed(feed);
+    if (m_statusFeed) {
+        // 状态中的设备ID和句柄必须按本控件显示的目录解析
+        m_statusFeed->setDeviceManager(m_manager);
+        connect(m_statusFeed, &DeviceStatusFeed::statusesChanged,
+                m_deviceModel, &DeviceTreeModel::notifyStatusChanged);
+    }
+    m_deviceTree->viewport()->update();
+}
+
 void DeviceWidget::setupUI()
 {
     m_mainLayout = new QVBoxLayout(this);
     m_mainLayout->setContentsMargins(8, 8, 8, 8);
     m_mainLayout->setSpacing(8);
     
-    // 创建标签页
+    // 创建标签页 - 设置标签页的响应式属性
+    m_tabWidget = new QTabWidget(this);
+    m_tabWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_tabWidget->setMinimumHeight(40);
+    m_tabWidget->setMaximumHeight(50);
+    
+    // 设置标签页可滚动（当标签页过多时）
+    m_tabWidget->setUsesScrollButtons(true);
+    m_tabWidget->setElideMode(Qt::ElideRight);
     createTabs();
     
     // 创建搜索布局 - 响应式水平布局
@@ -103,6 +208,8 @@ void DeviceWidget::setupUI()
     m_deviceTree->setRootIsDecorated(true);
     m_deviceTree->setExpandsOnDoubleClick(true);
     m_deviceTree->setAlternatingRowColors(true);
+    // 统一行高使滚动时不必逐行计算高度，十万行级别也能保持流畅
+    m_deviceTree->setUniformRowHeights(true);
     m_deviceTree->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     m_deviceTree->setMinimumHeight(200);
     
@@ -151,42 +258,88 @@ void DeviceWidget::setupUI()
 
 void DeviceWidget::createTabs()
 {
-    m_tabWidget = new QTabWidget(this);
-    
-    // 设置标签页的响应式属性
-    m_tabWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    m_tabWidget->setMinimumHeight(40);
-    m_tabWidget->setMaximumHeight(50);
-    
-    // 设置标签页可滚动（当标签页过多时）
-    m_tabWidget->setUsesScrollButtons(true);
-    m_tabWidget->setElideMode(Qt::ElideRight);
+    // 重建期间不触发标签页切换
+    const bool blocked = m_tabWidget->blockSignals(true);
+    while (m_tabWidget->count() > 0) {
+        QWidget *page = m_tabWidget->widget(0);
+        m_tabWidget->removeTab(0);
+        delete page;
+    }
     
-    // 添加设备类型标签页
-    QStringList deviceTypes = DeviceManager::instance().getDeviceTypes();
+    m_tabWidget->blockSignals(blocked);
     
-    // 添加"全部模型"标签页
-    QWidget *allTab = new QWidget();
-    allTab->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-    m_tabWidget->addTab(allTab, "全部模型");
+    updateTabs();
+}
+
+void DeviceWidget::insertTypeTab(int index, int typeId)
+{
+    QWidget *typeTab = new QWidget();
+    typeTab->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    index = m_tabWidget->insertTab(index, typeTab, m_manager->deviceTypeRegistry().displayName(typeId));
+    m_tabWidget->tabBar()->setTabData(index, typeId);
+}
+
+bool DeviceWidget::updateTabs()
+{
+    const DeviceTypeRegistry types = m_manager->deviceTypeRegistry();
+    
+    // "全部模型"标签页在最前，其余为有设备的类型（注册顺序）；没有设备的
+    // 类型不显示标签页，但保留类型ID，再出现设备时标签页回到原来的位置
+    QVector<int> visible;
+    visible.append(DeviceTypeRegistry::AllTypes);
+    for (int typeId : types.typeIds()) {
+        if (types.deviceCount(typeId) > 0) {
+            visible.append(typeId);
+        }
+    }
     
-    // 添加其他设备类型标签页
-    for (const QString &type : deviceTypes) {
-        if (type != "全部模型") {
-            QWidget *typeTab = new QWidget();
-            typeTab->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            m_tabWidget->addTab(typeTab, type);
+    // 已有的标签页也按注册顺序排列，逐个对齐：删除不再显示的，插入缺少的
+    const bool blocked = m_tabWidget->blockSignals(true);
+    for (int i = 0; i < visible.size(); ++i) {
+        while (i < m_tabWidget->count() && !visible.contains(typeIdForTab(i))) {
+            QWidget *page = m_tabWidget->widget(i);
+            m_tabWidget->removeTab(i);
+            delete page;
+        }
+        if (i >= m_tabWidget->count() || typeIdForTab(i) != visible.at(i)) {
+            insertTypeTab(i, visible.at(i));
         }
     }
+    while (m_tabWidget->count() > visible.size()) {
+        QWidget *page = m_tabWidget->widget(visible.size());
+        m_tabWidget->removeTab(visible.size());
+        delete page;
+    }
+    
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        const int typeId = typeIdForTab(i);
+        m_tabWidget->setTabText(i, types.displayName(typeId));
+        m_tabWidget->setTabToolTip(i, QString("%1 个设备").arg(types.deviceCount(typeId)));
+    }
+    
+    // 当前类型已不在目录中时回到"全部模型"
+    const int currentIndex = qMax(0, visible.indexOf(m_currentTypeId));
+    m_tabWidget->setCurrentIndex(currentIndex);
+    m_tabWidget->blockSignals(blocked);
+    
+    const bool fellBack = typeIdForTab(currentIndex) != m_currentTypeId;
+    m_currentTypeId = typeIdForTab(currentIndex);
+    return fellBack;
+}
+
+int DeviceWidget::typeIdForTab(int index) const
+{
+    const QVariant typeId = m_tabWidget->tabBar()->tabData(index);
+    return typeId.isValid() ? typeId.toInt() : int(DeviceTypeRegistry::UnknownType);
 }
 
 void DeviceWidget::setupDeviceTree()
 {
-    m_deviceModel = new QStandardItemModel(this);
-    m_deviceModel->setHorizontalHeaderLabels(QStringList() << "设备名称");
+    m_deviceModel = new DeviceTreeModel(this);
     
     if (m_deviceTree) {
         m_deviceTree->setModel(m_deviceModel);
+        updateTreeColumns();
         
         // 连接模型信号
         connect(m_deviceModel, &QStandardItemModel::itemChanged,
@@ -237,20 +390,294 @@ void DeviceWidget::onTabChanged(int index)
         return;
     }
     
-    QString tabText = m_tabWidget->tabText(index);
-    m_currentDeviceType = (tabText == "全部模型") ? QString() : tabText;
-    
-    loadDeviceData(m_currentDeviceType);
+    m_currentTypeId = typeIdForTab(index);
+    loadDeviceData(m_currentTypeId);
 }
 
 void DeviceWidget::onDeviceDataLoaded()
 {
     // 重新创建标签页
-    m_tabWidget->clear();
     createTabs();
     
     // 加载当前类型的设备数据
-    loadDeviceData(m_currentDeviceType);
+    loadDeviceData(m_currentTypeId);
+}
+
+void DeviceWidget::onSparklineSamplesAppended(const QStringList &deviceIds)
+{
+    Q_UNUSED(deviceIds)
+    
+    // 只重绘视口：视图只为可见行调用代理，未变化设备的位图直接复用
+    if (m_sparklinesVisible && m_deviceTree->isVisible()) {
+        m_deviceTree->viewport()->update();
+    }
+}
+
+void DeviceWidget::onDevicesInserted(const QString &parentId, int first, int last, const QStringList &deviceIds)
+{
+    Q_UNUSED(parentId)
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    
+    if (!m_deviceModel) {
+        return;
+    }
+    
+    // 信号在整个事务提交后发出，按设备的最终状态处理：之后又被删除的
+    // 设备跳过，目录中相邻且放入同一父项目的设备合并为一次insertRows
+    const DeviceManager &manager = *m_manager;
+    const bool wasUpdating = m_updatingSelection;
+    m_updatingSelection = true;
+    
+    QStandardItem *batchParent = nullptr;
+    int batchRow = 0;
+    QList<QStandardItem*> batch;
+    QString previousId;
+    
+    auto flushBatch = [&]() {
+        if (batch.isEmpty()) {
+            return;
+        }
+        if (m_sparklinesVisible) {
+            // 多列的行只能逐行插入
+            for (int i = 0; i < batch.size(); ++i) {
+                batchParent->insertRow(batchRow + i, createDeviceRow(batch.at(i)));
+            }
+        } else {
+            batchParent->insertRows(batchRow, batch);
+        }
+        for (QStandardItem *item : batch) {
+            updateParentCheckState(item);
+        }
+        if (batchParent != m_deviceModel->invisibleRootItem()) {
+            m_deviceTree->expand(batchParent->index());
+        }
+        batch.clear();
+    };
+    
+    for (const QString &id : deviceIds) {
+        const DeviceInfo device = manager.getDevice(id);
+        if (!device.isValid() || m_itemsById.contains(id) || !isDeviceShown(device)) {
+            flushBatch();
+            continue;
+        }
+        
+        QStandardItem *parentItem = parentItemFor(device);
+        const int managerRow = manager.deviceRow(id);
+        const bool adjacent = !batch.isEmpty() && parentItem == batchParent && managerRow > 0 &&
+                              manager.childIds(device.parentId).at(managerRow - 1) == previousId;
+        if (!adjacent) {
+            flushBatch();
+            batchParent = parentItem;
+            batchRow = itemRowFor(device, parentItem);
+        }
+        
+        QStandardItem *item = createDeviceItem(id);
+        if (m_selectedDeviceIds.contains(id)) {
+            item->setCheckState(Qt::Checked);
+        }
+        m_itemsById.insert(id, item);
+        batch.append(item);
+        previousId = id;
+    }
+    flushBatch();
+    
+    m_updatingSelection = wasUpdating;
+}
+
+void DeviceWidget::onDevicesRemoved(const QString &parentId, int first, int last, const QStringList &deviceIds)
+{
+    Q_UNUSED(parentId)
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    
+    if (!m_deviceModel) {
+        return;
+    }
+    
+    QSet<QString> removedIds;
+    for (const QString &id : deviceIds) {
+        removedIds.insert(id);
+    }
+    
+    // 按父项目收集要删除的行；祖先也被删除的项目随祖先一起删除
+    QHash<QStandardItem*, QVector<int>> rowsByParent;
+    for (const QString &id : deviceIds) {
+        QStandardItem *item = m_itemsById.value(id);
+        if (!item) {
+            continue;
+        }
+        bool ancestorRemoved = false;
+        for (QStandardItem *ancestor = item->parent(); ancestor; ancestor = ancestor->parent()) {
+            if (removedIds.contains(ancestor->data(Qt::UserRole).toString())) {
+                ancestorRemoved = true;
+                break;
+            }
+        }
+        if (!ancestorRemoved) {
+            QStandardItem *parentItem = item->parent() ? item->parent() : m_deviceModel->invisibleRootItem();
+            rowsByParent[parentItem].append(item->row());
+        }
+    }
+    
+    const bool wasUpdating = m_updatingSelection;
+    m_updatingSelection = true;
+    
+    // 连续的行合并为一次removeRows，从后往前删除以保持行号有效
+    for (auto it = rowsByParent.begin(); it != rowsByParent.end(); ++it) {
+        QStandardItem *parentItem = it.key();
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+        
+        int rangeLast = rows.last();
+        int rangeFirst = rangeLast;
+        for (int i = rows.size() - 2; i >= -1; --i) {
+            if (i >= 0 && rows.at(i) == rangeFirst - 1) {
+                rangeFirst = rows.at(i);
+                continue;
+            }
+            for (int row = rangeFirst; row <= rangeLast; ++row) {
+                unregisterItems(parentItem->child(row));
+            }
+            parentItem->removeRows(rangeFirst, rangeLast - rangeFirst + 1);
+            if (i >= 0) {
+                rangeFirst = rangeLast = rows.at(i);
+            }
+        }
+        
+        if (parentItem->rowCount() > 0) {
+            updateParentCheckState(parentItem->child(0));
+        }
+    }
+    
+    m_updatingSelection = wasUpdating;
+    
+    // 已删除的设备不再保持选中
+    const int selectedCount = m_selectedDeviceIds.size();
+    for (int i = m_selectedDeviceIds.size() - 1; i >= 0; --i) {
+        if (removedIds.contains(m_selectedDeviceIds.at(i))) {
+            m_selectedDeviceIds.removeAt(i);
+        }
+    }
+    if (m_selectedDeviceIds.size() != selectedCount) {
+        emit selectionChanged(m_selectedDeviceIds);
+    }
+}
+
+void DeviceWidget::onDevicesChanged(const QString &parentId, int first, int last, const QStringList &deviceIds)
+{
+    Q_UNUSED(parentId)
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    
+    if (!m_deviceModel) {
+        return;
+    }
+    
+    const DeviceManager &manager = *m_manager;
+    const bool wasUpdating = m_updatingSelection;
+    m_updatingSelection = true;
+    
+    for (const QString &id : deviceIds) {
+        const DeviceInfo device = manager.getDevice(id);
+        QStandardItem *item = m_itemsById.value(id);
+        const bool shown = device.isValid() && isDeviceShown(device);
+        
+        if (item && shown) {
+            item->setText(device.name);
+        } else if (item) {
+            // 类型改变后不再属于当前标签页
+            takeDeviceItem(item);
+        } else if (shown) {
+            insertDeviceItem(device);
+        }
+    }
+    
+    m_updatingSelection = wasUpdating;
+}
+
+void DeviceWidget::onDevicesMoved(const QString &sourceParentId, int sourceFirst, int sourceLast,
+                                  const QString &destinationParentId, int destinationRow, const QStringList &deviceIds)
+{
+    Q_UNUSED(sourceParentId)
+    Q_UNUSED(sourceFirst)
+    Q_UNUSED(sourceLast)
+    Q_UNUSED(destinationParentId)
+    Q_UNUSED(destinationRow)
+    
+    if (!m_deviceModel) {
+        return;
+    }
+    
+    const DeviceManager &manager = *m_manager;
+    const bool wasUpdating = m_updatingSelection;
+    m_updatingSelection = true;
+    
+    for (const QString &id : deviceIds) {
+        const DeviceInfo device = manager.getDevice(id);
+        QStandardItem *item = m_itemsById.value(id);
+        if (!item || !device.isValid()) {
+            // 未显示的设备的子行已在顶层，不受移动影响
+            continue;
+        }
+        
+        // 整行（连同子行）取出后插入新位置
+        QStandardItem *oldParent = item->parent() ? item->parent() : m_deviceModel->invisibleRootItem();
+        QList<QStandardItem*> row = oldParent->takeRow(item->row());
+        QStandardItem *newParent = parentItemFor(device);
+        newParent->insertRow(itemRowFor(device, newParent), row);
+        
+        if (item->hasChildren()) {
+            m_deviceTree->expand(item->index());
+        }
+        if (newParent != m_deviceModel->invisibleRootItem()) {
+            m_deviceTree->expand(newParent->index());
+        }
+        if (oldParent->rowCount() > 0) {
+            updateParentCheckState(oldParent->child(0));
+        }
+        updateParentCheckState(item);
+    }
+    
+    m_updatingSelection = wasUpdating;
+}
+
+void DeviceWidget::onDeviceTypesChanged(const QStringList &types)
+{
+    Q_UNUSED(types)
+    
+    // 为有设备的新类型插入标签页，不影响当前标签页
+    if (updateTabs()) {
+        loadDeviceData(m_currentTypeId);
+    }
+}
+
+void DeviceWidget::onHandlesRenumbered(const QVector<int> &handles)
+{
+    if (!m_deviceModel) {
+        return;
+    }
+    
+    // 改写句柄不是勾选变化，不触发选择处理
+    const bool wasUpdating = m_updatingSelection;
+    m_updatingSelection = true;
+    m_deviceModel->remapHandles(handles);
+    m_updatingSelection = wasUpdating;
+}
+
+void DeviceWidget::onCatalogChanged()
+{
+    // 新行默认可见，有搜索关键字时重新过滤
+    if (!getSearchText().isEmpty()) {
+        filterDevices(getSearchText());
+    }
+    updateSelectedCount();
+    updateSelectAllCheckBox();
+    
+    // 设备数量变化可能使类型的标签页出现或消失
+    if (updateTabs()) {
+        loadDeviceData(m_currentTypeId);
+    }
 }
 
 void DeviceWidget::onSelectAllChanged(bool checked)
@@ -283,56 +710,27 @@ void DeviceWidget::onSelectAllChanged(bool checked)
     emit selectionChanged(m_selectedDeviceIds);
 }
 
-void DeviceWidget::loadDeviceData(const QString &deviceType)
+void DeviceWidget::loadDeviceData(int typeId)
 {
     if (!m_deviceModel) {
         return;
     }
     
     m_deviceModel->clear();
-    m_deviceModel->setHorizontalHeaderLabels(QStringList() << "设备名称");
+    m_itemsById.clear();
+    updateTreeColumns();
     
-    QList<DeviceInfo> devices;
-    if (deviceType.isEmpty()) {
-        // 显示所有设备
-        devices = DeviceManager::instance().getAllDevices();
-    } else {
-        // 显示指定类型的设备
-        devices = DeviceManager::instance().getDevicesByType(deviceType);
-    }
-    
-    // 创建设备组映射
-    QHash<QString, QStandardItem*> itemMap;
-    
-    // 首先创建所有组节点
-    for (const DeviceInfo &device : devices) {
-        if (device.isGroup) {
-            QStandardItem *item = createDeviceItem(device.id);
-            itemMap.insert(device.id, item);
-            m_deviceModel->appendRow(item);
-        }
-    }
-    
-    // 然后添加非组设备
-    for (const DeviceInfo &device : devices) {
-        if (!device.isGroup) {
-            QStandardItem *item = createDeviceItem(device.id);
-            
-            if (!device.parentId.isEmpty() && itemMap.contains(device.parentId)) {
-                // 添加到父组
-                itemMap[device.parentId]->appendRow(item);
-            } else {
-                // 添加到根级别
-                m_deviceModel->appendRow(item);
-            }
-            
-            itemMap.insert(device.id, item);
-        }
+    // 按目录顺序添加设备，被类型过滤掉的设备的子设备放到顶层
+    for (const QString &id : m_manager->childIds(QString())) {
+        appendDeviceTree(id, typeId);
     }
     
     // 展开所有组节点
     m_deviceTree->expandAll();
     
+    // 状态更新按句柄定位项目
+    m_deviceModel->rebuildHandleIndex();
+    
     // 更新选择状态
     updateSelection();
     updateSelectedCount();
@@ -358,14 +756,18 @@ void DeviceWidget::filterDevices(const QString &filter)
         m_noResultLabel->hide();
         m_deviceTree->show();
     } else {
-        // 过滤显示
+        // 过滤显示：匹配结果来自设备管理器的查询缓存，以位图形式按句柄检查
         bool hasVisibleItems = false;
-        QString lowerFilter = filter.toLower();
+        const DeviceManager &manager = *m_manager;
+        QBitArray matches(manager.deviceHandleCount());
+        for (int handle : manager.queryDeviceHandles(m_currentTypeId, filter)) {
+            matches.setBit(handle);
+        }
         
         for (int i = 0; i < m_deviceModel->rowCount(); ++i) {
             QStandardItem *item = m_deviceModel->item(i);
             if (item) {
-                bool visible = filterItemRecursive(item, lowerFilter);
+                bool visible = filterItemRecursive(item, matches);
                 m_deviceTree->setRowHidden(i, QModelIndex(), !visible);
                 if (visible) {
                     hasVisibleItems = true;
@@ -440,7 +842,7 @@ void DeviceWidget::updateSelectAllCheckBox()
 
 QStandardItem* DeviceWidget::createDeviceItem(const QString &deviceId)
 {
-    DeviceInfo device = DeviceManager::instance().getDevice(deviceId);
+    DeviceInfo device = m_manager->getDevice(deviceId);
     if (!device.isValid()) {
         return nullptr;
     }
@@ -449,6 +851,7 @@ QStandardItem* DeviceWidget::createDeviceItem(const QString &deviceId)
     item->setCheckable(true);
     item->setCheckState(Qt::Unchecked);
     item->setData(device.id, Qt::UserRole);
+    item->setData(m_manager->deviceHandle(device.id), DeviceHandleRole);
     
     // 设置图标或样式（可选）
     if (device.isGroup) {
@@ -458,6 +861,148 @@ QStandardItem* DeviceWidget::createDeviceItem(const QString &deviceId)
     return item;
 }
 
+QList<QStandardItem*> DeviceWidget::createDeviceRow(QStandardItem *item) const
+{
+    QList<QStandardItem*> row;
+    row.append(item);
+    
+    if (m_sparklinesVisible && item) {
+        // 折线图单元格只保存设备ID，由绘制代理从环形缓冲区取值
+        QStandardItem *sparklineItem = new QStandardItem();
+        sparklineItem->setEditable(false);
+        sparklineItem->setData(item->data(Qt::UserRole), Qt::UserRole);
+        row.append(sparklineItem);
+    }
+    
+    return row;
+}
+
+bool DeviceWidget::isDeviceShown(const DeviceInfo &device) const
+{
+    return m_currentTypeId == DeviceTypeRegistry::AllTypes ||
+           m_manager->deviceTypeIdForHandle(m_manager->deviceHandle(device.id)) == m_currentTypeId;
+}
+
+void DeviceWidget::appendDeviceTree(const QString &deviceId, int typeId)
+{
+    const DeviceManager &manager = *m_manager;
+    const DeviceInfo device = manager.getDevice(deviceId);
+    if (!device.isValid()) {
+        return;
+    }
+    
+    if (typeId == DeviceTypeRegistry::AllTypes ||
+        manager.deviceTypeIdForHandle(manager.deviceHandle(deviceId)) == typeId) {
+        QStandardItem *item = createDeviceItem(device.id);
+        parentItemFor(device)->appendRow(createDeviceRow(item));
+        m_itemsById.insert(device.id, item);
+    }
+    
+    for (const QString &childId : device.children) {
+        appendDeviceTree(childId, typeId);
+    }
+}
+
+QStandardItem *DeviceWidget::parentItemFor(const DeviceInfo &device) const
+{
+    QStandardItem *parentItem = m_itemsById.value(device.parentId);
+    return parentItem ? parentItem : m_deviceModel->invisibleRootItem();
+}
+
+int DeviceWidget::itemRowFor(const DeviceInfo &device, QStandardItem *parentItem) const
+{
+    const QStringList siblings = m_manager->childIds(device.parentId);
+    for (int i = siblings.indexOf(device.id) + 1; i < siblings.size(); ++i) {
+        QStandardItem *sibling = m_itemsById.value(siblings.at(i));
+        if (sibling && (sibling->parent() ? sibling->parent() : m_deviceModel->invisibleRootItem()) == parentItem) {
+            return sibling->row();
+        }
+    }
+    return parentItem->rowCount();
+}
+
+QStandardItem *DeviceWidget::insertDeviceItem(const DeviceInfo &device)
+{
+    QStandardItem *parentItem = parentItemFor(device);
+    QStandardItem *item = createDeviceItem(device.id);
+    if (m_selectedDeviceIds.contains(device.id)) {
+        item->setCheckState(Qt::Checked);
+    }
+    parentItem->insertRow(itemRowFor(device, parentItem), createDeviceRow(item));
+    m_itemsById.insert(device.id, item);
+    
+    // 之前放在顶层的子设备移回该设备下
+    QStandardItem *rootItem = m_deviceModel->invisibleRootItem();
+    for (const QString &childId : device.children) {
+        QStandardItem *child = m_itemsById.value(childId);
+        if (child && !child->parent()) {
+            const DeviceInfo childDevice = m_manager->getDevice(childId);
+            QList<QStandardItem*> row = rootItem->takeRow(child->row());
+            item->insertRow(itemRowFor(childDevice, item), row);
+        }
+    }
+    
+    if (item->hasChildren()) {
+        m_deviceTree->expand(item->index());
+        updateParentCheckState(item->child(0));
+    }
+    if (parentItem != rootItem) {
+        m_deviceTree->expand(parentItem->index());
+    }
+    updateParentCheckState(item);
+    return item;
+}
+
+void DeviceWidget::takeDeviceItem(QStandardItem *item)
+{
+    QStandardItem *rootItem = m_deviceModel->invisibleRootItem();
+    
+    // 子行移到顶层，与重新加载时的结果一致
+    while (item->rowCount() > 0) {
+        rootItem->appendRow(item->takeRow(0));
+    }
+    
+    QStandardItem *parentItem = item->parent() ? item->parent() : rootItem;
+    m_itemsById.remove(item->data(Qt::UserRole).toString());
+    parentItem->removeRow(item->row());
+    if (parentItem->rowCount() > 0) {
+        updateParentCheckState(parentItem->child(0));
+    }
+}
+
+void DeviceWidget::unregisterItems(QStandardItem *item)
+{
+    if (!item) {
+        return;
+    }
+    
+    m_itemsById.remove(item->data(Qt::UserRole).toString());
+    for (int i = 0; i < item->rowCount(); ++i) {
+        unregisterItems(item->child(i));
+    }
+}
+
+void DeviceWidget::updateTreeColumns()
+{
+    QStringList labels;
+    labels << "设备名称";
+    if (m_sparklinesVisible) {
+        labels << "最近数值";
+    }
+    m_deviceModel->setHorizontalHeaderLabels(labels);
+    
+    // 名称列占满剩余宽度，折线图列固定宽度
+    QHeaderView *header = m_deviceTree->header();
+    header->setStretchLastSection(!m_sparklinesVisible);
+    if (m_sparklinesVisible) {
+        header->setSectionResizeMode(0, QHeaderView::Stretch);
+        header->setSectionResizeMode(SparklineColumn, QHeaderView::Fixed);
+        header->resizeSection(SparklineColumn, SparklineColumnWidth);
+    } else {
+        header->setSectionResizeMode(0, QHeaderView::Interactive);
+    }
+}
+
 void DeviceWidget::setItemCheckedRecursive(QStandardItem *item, bool checked)
 {
     if (!item) {
@@ -521,7 +1066,7 @@ void DeviceWidget::collectSelectedDevices(QStandardItem *item, QStringList &sele
     if (item->checkState() == Qt::Checked) {
         QString deviceId = item->data(Qt::UserRole).toString();
         if (!deviceId.isEmpty() && !selectedIds.contains(deviceId)) {
-            DeviceInfo device = DeviceManager::instance().getDevice(deviceId);
+            DeviceInfo device = m_manager->getDevice(deviceId);
             // 只收集非组设备
             if (!device.isGroup) {
                 selectedIds.append(deviceId);
@@ -558,24 +1103,23 @@ void DeviceWidget::setItemVisibleRecursive(QStandardItem *item, bool visible)
     }
 }
 
-bool DeviceWidget::filterItemRecursive(QStandardItem *item, const QString &filter)
+bool DeviceWidget::filterItemRecursive(QStandardItem *item, const QBitArray &matches)
 {
     if (!item) {
         return false;
     }
     
-    QString deviceId = item->data(Qt::UserRole).toString();
-    DeviceInfo device = DeviceManager::instance().getDevice(deviceId);
-    
     // 检查当前项目是否匹配
-    bool currentMatches = device.name.toLower().contains(filter) || 
-                         device.id.toLower().contains(filter);
+    bool hasHandle = false;
+    const int handle = item->data(DeviceHandleRole).toInt(&hasHandle);
+    bool currentMatches = hasHandle && handle >= 0 && handle < matches.size() &&
+                          matches.testBit(handle);
     
     // 检查子项目是否有匹配
     bool childMatches = false;
     for (int i = 0; i < item->rowCount(); ++i) {
         QStandardItem *child = item->child(i);
-        if (child && filterItemRecursive(child, filter)) {
+        if (child && filterItemRecursive(child, matches)) {
             childMatches = true;
         }
     }
@@ -646,7 +1190,7 @@ void DeviceWidget::countVisibleDevices(QStandardItem *item, int &totalVisible, i
     if (isVisible) {
         QString deviceId = item->data(Qt::UserRole).toString();
         if (!deviceId.isEmpty()) {
-            DeviceInfo device = DeviceManager::instance().getDevice(deviceId);
+            DeviceInfo device = m_manager->getDevice(deviceId);
             // 只统计非组设备
             if (!device.isGroup) {
                 totalVisible++;
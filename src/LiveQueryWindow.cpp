@@ -0,0 +1,140 @@
+#include "LiveQueryWindow.h"
+#include "TimeSeriesStore.h"
+#include <QElapsedTimer>
+
+void LiveTailRunner::run(const LiveWindowDelta &request, quint64 generation)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    LiveWindowDelta delta = request;
+    const int tailCount = delta.bucketer.bucketCount() - delta.firstUpdatedBucket;
+    for (DeviceSeries &series : delta.tail) {
+        qint64 scanned = 0;
+        if (tailCount > 0) {
+            series.buckets = m_store->aggregateDevice(series.deviceId, delta.bucketer, delta.firstUpdatedBucket,
+                                                      tailCount, &scanned);
+        }
+        delta.samplesScanned += scanned;
+    }
+    delta.elapsedUs = timer.nsecsElapsed() / 1000;
+
+    emit finished(delta, generation);
+}
+
+LiveQueryWindow::LiveQueryWindow(TimeSeriesStore *store, QObject *parent)
+    : QObject(parent)
+    , m_runner(new LiveTailRunner(store))
+    , m_spanMs(0)
+    , m_active(false)
+    , m_inFlight(false)
+    , m_hasPending(false)
+    , m_pendingNowMs(0)
+    , m_generation(0)
+{
+    qRegisterMetaType<LiveWindowDelta>("LiveWindowDelta");
+
+    m_runner->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_runner, &QObject::deleteLater);
+    connect(this, &LiveQueryWindow::runRequested, m_runner, &LiveTailRunner::run, Qt::QueuedConnection);
+    connect(m_runner, &LiveTailRunner::finished, this, &LiveQueryWindow::onRunFinished, Qt::QueuedConnection);
+
+    m_workerThread.setObjectName("LiveQueryWindow");
+    m_workerThread.start();
+}
+
+LiveQueryWindow::~LiveQueryWindow()
+{
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+void LiveQueryWindow::reset(const TimeSeriesQueryResult &result, qint64 spanMs)
+{
+    ++m_generation;
+    m_hasPending = false;
+    m_result = result;
+    m_spanMs = spanMs;
+    m_active = result.bucketer.isValid() && spanMs > 0 && !result.cancelled;
+}
+
+void LiveQueryWindow::stop()
+{
+    ++m_generation;
+    m_hasPending = false;
+    m_active = false;
+}
+
+bool LiveQueryWindow::advanceTo(qint64 nowMs)
+{
+    if (!m_active) {
+        return false;
+    }
+
+    // 增量以上一次应用后的结果为基准，执行中的聚合完成后再派发
+    if (m_inFlight) {
+        m_hasPending = true;
+        m_pendingNowMs = nowMs;
+        return true;
+    }
+
+    dispatch(nowMs);
+    return true;
+}
+
+void LiveQueryWindow::dispatch(qint64 nowMs)
+{
+    const TimeBucketer &oldBucketer = m_result.bucketer;
+    const TimeBucketer bucketer(nowMs - m_spanMs, nowMs, oldBucketer.granularity());
+    const int oldCount = oldBucketer.bucketCount();
+    const qint64 oldFirst = oldBucketer.firstOrdinal();
+    const qint64 newFirst = bucketer.firstOrdinal();
+
+    // 旧窗口的最后一个桶可能仍在累积样本，与新出现的桶一起重新聚合
+    qint64 firstUpdated = oldFirst + oldCount - 1 - newFirst;
+    qint64 dropped = newFirst - oldFirst;
+    if (dropped < 0 || firstUpdated < 0) {
+        // 时钟回拨或窗口越过了整个旧窗口（如系统休眠后），整体重新聚合
+        dropped = oldCount;
+        firstUpdated = 0;
+    }
+    firstUpdated = qMin<qint64>(firstUpdated, bucketer.bucketCount());
+
+    LiveWindowDelta request;
+    request.bucketer = bucketer;
+    request.droppedHeadBuckets = static_cast<int>(dropped);
+    request.firstUpdatedBucket = static_cast<int>(firstUpdated);
+    request.tail.reserve(m_result.series.size());
+    for (const DeviceSeries &series : m_result.series) {
+        request.tail.append(DeviceSeries(series.deviceId, QVector<BucketAggregate>()));
+    }
+
+    m_inFlight = true;
+    emit runRequested(request, m_generation);
+}
+
+void LiveQueryWindow::onRunFinished(const LiveWindowDelta &delta, quint64 generation)
+{
+    m_inFlight = false;
+
+    // reset()或stop()之前派发的聚合基于旧的结果，直接丢弃
+    if (generation == m_generation && m_active) {
+        for (int i = 0; i < m_result.series.size() && i < delta.tail.size(); ++i) {
+            QVector<BucketAggregate> &buckets = m_result.series[i].buckets;
+            buckets.remove(0, qMin(delta.droppedHeadBuckets, buckets.size()));
+            buckets.resize(delta.firstUpdatedBucket);
+            buckets += delta.tail.at(i).buckets;
+        }
+
+        m_result.bucketer = delta.bucketer;
+        m_result.samplesScanned = delta.samplesScanned;
+        m_result.elapsedUs = delta.elapsedUs;
+
+        emit windowAdvanced(delta);
+    }
+
+    if (m_hasPending && m_active) {
+        m_hasPending = false;
+        dispatch(m_pendingNowMs);
+    }
+}
@@ -1,9 +1,24 @@
 #include "MainWindow.h"
 #include "TimeWidget.h"
 #include "DeviceWidget.h"
+#include "ChartPreviewWidget.h"
+#include "TimeSeriesStore.h"
+#include "QueryResultCache.h"
+#include "QueryExecutor.h"
+#include "QueryScheduler.h"
+#include "QueryPrefetcher.h"
+#include "SparklineBuffer.h"
+#include "DeviceStatusFeed.h"
+#include "DeviceStatusSources.h"
+#include "CatalogWatcher.h"
+#include "DeviceManager.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QApplication>
+#include <QPushButton>
+#include <QStatusBar>
+#include <QFileDialog>
+#include <QProgressDialog>
 #include <QDebug>
 #include <QFile>
 #include <QTextStream>
@@ -11,20 +26,93 @@
 #include <QFrame>
 #include <QSizePolicy>
 #include <QResizeEvent>
+#include <QtMath>
+#include <QtNumeric>
 
-MainWindow::MainWindow(QWidget *parent)
+namespace {
+/**
+ * @brief 取桶平均值作为折线图数值，空桶为NaN
+ * @param buckets 聚合序列
+ * @param from 起始桶序号
+ */
+QVector<double> bucketAverages(const QVector<BucketAggregate> &buckets, int from)
+{
+    QVector<double> values;
+    values.reserve(qMax(0, buckets.size() - from));
+    for (int i = qMax(0, from); i < buckets.size(); ++i) {
+        values.append(buckets.at(i).isEmpty() ? qQNaN() : buckets.at(i).average());
+    }
+    return values;
+}
+
+QString granularityName(TimeWidget::TimeGranularity granularity)
+{
+    switch (granularity) {
+    case TimeWidget::Minutes15:
+        return "15分钟";
+    case TimeWidget::Hour1:
+        return "1小时";
+    case TimeWidget::Day1:
+        return "1天";
+    }
+    return QString();
+}
+}
+
+MainWindowPaths MainWindowPaths::defaults()
+{
+    MainWindowPaths paths;
+    paths.storeRootPath = TimeSeriesStore::defaultRootPath();
+    paths.catalogFilePath = CatalogWatcher::defaultFilePath();
+    paths.statusFilePath = DeviceStatusFileTail::defaultFilePath();
+    return paths;
+}
+
+MainWindow::MainWindow(const MainWindowPaths &paths, QWidget *parent)
     : QMainWindow(parent)
     , m_timeWidget(nullptr)
     , m_deviceWidget(nullptr)
+    , m_chartPreview(nullptr)
     , m_centralWidget(nullptr)
+    , m_coarsenButton(nullptr)
+    , m_exportButton(nullptr)
+    , m_exportProgress(nullptr)
     , m_mainLayout(nullptr)
+    , m_currentGranularity(TimeWidget::Hour1)
+    , m_resultCache(new QueryResultCache())
+    , m_dataStore(new TimeSeriesStore(paths.storeRootPath))
+    , m_queryExecutor(new QueryExecutor(m_dataStore.data()))
+    , m_queryScheduler(new QueryScheduler(m_queryExecutor.data()))
+    , m_queryPrefetcher(new QueryPrefetcher(m_dataStore.data(), m_queryScheduler.data()))
+    , m_liveWindow(new LiveQueryWindow(m_dataStore.data()))
+    , m_dataExporter(new DataExporter(m_dataStore.data()))
+    , m_sparklineBuffer(new SparklineBuffer())
+    , m_statusFeed(new DeviceStatusFeed())
+    , m_catalogWatcher(paths.catalogFilePath.isEmpty()
+                       ? nullptr : new CatalogWatcher(&DeviceManager::instance(), paths.catalogFilePath))
+    , m_dataCompleteness(1.0)
+    , m_overBudget(false)
+    , m_suggestedGranularity(TimeWidget::Hour1)
+    , m_autoCoarsen(false)
     , m_isInitialized(false)
 {
+    qRegisterMetaType<QueryCostEstimate>("QueryCostEstimate");
+    m_dataStore->setResultCache(m_resultCache.data());
+    // 设备状态由采集程序追加写入状态文件
+    if (!paths.statusFilePath.isEmpty()) {
+        m_statusFeed->addSource(new DeviceStatusFileTail(paths.statusFilePath));
+    }
+    
     initializeWindow();
     setupUI();
     setupStyles();
     connectSignals();
     
+    // 目录文件由CMDB导出程序重新生成时热加载，设备树按差异增量更新
+    if (m_catalogWatcher) {
+        m_catalogWatcher->start();
+    }
+    
     // 标记初始化完成
     m_isInitialized = true;
     updateWindowTitle();
@@ -75,15 +163,33 @@ void MainWindow::setupUI()
     m_deviceWidget = new DeviceWidget(this);
     m_deviceWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     m_deviceWidget->setMinimumHeight(300);
+    m_deviceWidget->setSparklineBuffer(m_sparklineBuffer.data());
+    m_deviceWidget->setSparklinesVisible(true);
+    m_deviceWidget->setStatusFeed(m_statusFeed.data());
     m_mainLayout->addWidget(m_deviceWidget);
     
-    // 设置布局拉伸因子 - 时间控件固定高度，设备控件可扩展
+    // 创建数据预览图
+    m_chartPreview = new ChartPreviewWidget(this);
+    m_chartPreview->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    m_mainLayout->addWidget(m_chartPreview);
+    
+    // 设置布局拉伸因子 - 时间控件固定高度，设备控件与预览图可扩展
     m_mainLayout->setStretchFactor(m_timeWidget, 0);
     m_mainLayout->setStretchFactor(separator, 0);
-    m_mainLayout->setStretchFactor(m_deviceWidget, 1);
+    m_mainLayout->setStretchFactor(m_deviceWidget, 2);
+    m_mainLayout->setStretchFactor(m_chartPreview, 1);
     
     // 设置布局对齐方式
     m_mainLayout->setAlignment(Qt::AlignTop);
+    
+    // 查询超出开销预算时在状态栏提供切换到更粗颗粒度的按钮
+    m_coarsenButton = new QPushButton(this);
+    m_coarsenButton->hide();
+    statusBar()->addPermanentWidget(m_coarsenButton);
+    
+    m_exportButton = new QPushButton("导出...", this);
+    m_exportButton->setToolTip("把选中设备在当前时间范围内的数据导出为CSV或列式二进制文件");
+    statusBar()->addPermanentWidget(m_exportButton);
 }
 
 void MainWindow::setupStyles()
@@ -131,7 +237,37 @@ void MainWindow::connectSignals()
     if (m_timeWidget) {
         connect(m_timeWidget, &TimeWidget::timeRangeChanged,
                 this, &MainWindow::onTimeRangeChanged);
+        connect(m_timeWidget, &TimeWidget::granularityChanged,
+                this, &MainWindow::onGranularityChanged);
+        connect(m_timeWidget, &TimeWidget::liveModeChanged,
+                this, &MainWindow::onLiveModeChanged);
+        connect(m_timeWidget, &TimeWidget::liveWindowAdvanced,
+                this, &MainWindow::onLiveWindowAdvanced);
+        connect(m_liveWindow.data(), &LiveQueryWindow::windowAdvanced,
+                this, &MainWindow::onLiveDeltaReady);
+        m_currentGranularity = m_timeWidget->getGranularity();
+    }
+    
+    if (m_coarsenButton) {
+        connect(m_coarsenButton, &QPushButton::clicked,
+                this, &MainWindow::applySuggestedGranularity);
+    }
+    
+    if (m_exportButton) {
+        connect(m_exportButton, &QPushButton::clicked, this, &MainWindow::showExportDialog);
     }
+    connect(m_dataExporter.data(), &DataExporter::progressChanged,
+            this, &MainWindow::onExportProgress);
+    connect(m_dataExporter.data(), &DataExporter::finished,
+            this, &MainWindow::onExportFinished);
+    
+    // 连接查询调度器信号
+    connect(m_queryScheduler.data(), &QueryScheduler::queryStarted,
+            this, &MainWindow::onQueryStarted);
+    connect(m_queryScheduler.data(), &QueryScheduler::partialResultReady,
+            this, &MainWindow::onPartialResultReady);
+    connect(m_queryScheduler.data(), &QueryScheduler::resultReady,
+            this, &MainWindow::onQueryResultReady);
     
     // 连接设备控件信号
     if (m_deviceWidget) {
@@ -158,6 +294,7 @@ void MainWindow::onTimeRangeChanged(const QDateTime &start, const QDateTime &end
     
     // 发出时间范围变化的通知信号
     emit timeRangeUpdated(start, end);
+    refreshData();
     emit statusChanged(getStatusSummary());
 }
 
@@ -175,6 +312,7 @@ void MainWindow::onDeviceSelectionChanged(const QStringList &selectedDevices)
     
     // 发出设备选择变化的通知信号
     emit deviceSelectionUpdated(selectedDevices);
+    refreshData();
     emit statusChanged(getStatusSummary());
 }
 
@@ -193,6 +331,288 @@ void MainWindow::onSearchTextChanged(const QString &text)
     emit statusChanged(getStatusSummary());
 }
 
+void MainWindow::onGranularityChanged(TimeWidget::TimeGranularity granularity)
+{
+    m_currentGranularity = granularity;
+    
+    qDebug() << "Granularity changed:" << granularity;
+    
+    refreshData();
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::refreshData()
+{
+    // 完整查询完成后重新启动实时窗口
+    m_liveWindow->stop();
+    
+    if (!m_currentStartTime.isValid() || !m_currentEndTime.isValid() || m_selectedDevices.isEmpty()) {
+        m_queryScheduler->cancel();
+        m_currentData = TimeSeriesQueryResult();
+        if (m_chartPreview) {
+            m_chartPreview->clear();
+        }
+        m_dataCompleteness = 1.0;
+        m_currentEstimate = QueryCostEstimate();
+        m_overBudget = false;
+        if (m_coarsenButton) {
+            m_coarsenButton->hide();
+        }
+        return;
+    }
+    
+    const TimeSeriesQuery query(m_selectedDevices,
+                                m_currentStartTime.toMSecsSinceEpoch(),
+                                m_currentEndTime.toMSecsSinceEpoch(),
+                                m_currentGranularity);
+    
+    // 执行前估算查询开销，超出预算时提示或自动切换到更粗的颗粒度
+    m_currentEstimate = m_costEstimator.estimate(query);
+    m_overBudget = m_costEstimator.exceedsBudget(m_currentEstimate);
+    m_suggestedGranularity = m_overBudget ? m_costEstimator.suggestGranularity(query) : m_currentGranularity;
+    const bool canCoarsen = m_overBudget && m_suggestedGranularity != m_currentGranularity;
+    
+    if (canCoarsen && m_autoCoarsen) {
+        qDebug() << "Query over budget:" << QueryCostEstimator::formatEstimate(m_currentEstimate)
+                 << ", switching to granularity" << m_suggestedGranularity;
+        // 颗粒度变化会再次调用refreshData
+        applySuggestedGranularity();
+        return;
+    }
+    
+    if (m_coarsenButton) {
+        m_coarsenButton->setText(QString("切换到%1").arg(granularityName(m_suggestedGranularity)));
+        m_coarsenButton->setVisible(canCoarsen);
+    }
+    if (m_overBudget) {
+        emit queryBudgetExceeded(m_currentEstimate, m_suggestedGranularity);
+    }
+    
+    // 连续的选择变化由调度器合并，过时的查询会被取消
+    m_queryScheduler->submit(query);
+}
+
+void MainWindow::applySuggestedGranularity()
+{
+    if (!m_overBudget || m_suggestedGranularity == m_currentGranularity) {
+        return;
+    }
+    
+    if (m_timeWidget) {
+        // 由TimeWidget发出granularityChanged，保持按钮状态一致
+        m_timeWidget->setGranularity(m_suggestedGranularity);
+    } else {
+        onGranularityChanged(m_suggestedGranularity);
+    }
+}
+
+void MainWindow::onQueryStarted(const TimeSeriesQuery &query)
+{
+    Q_UNUSED(query);
+    
+    m_currentData = TimeSeriesQueryResult();
+    m_dataCompleteness = 0.0;
+    if (m_chartPreview) {
+        m_chartPreview->clear();
+    }
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::onPartialResultReady(const PartialQueryResult &partial)
+{
+    // 先到的设备立即显示，完整结果到达后整体替换
+    m_currentData.bucketer = partial.bucketer;
+    m_currentData.series += partial.series;
+    m_dataCompleteness = partial.completeness();
+    if (m_chartPreview) {
+        m_chartPreview->addSeries(partial);
+    }
+    
+    emit dataPartiallyUpdated(partial);
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::onQueryResultReady(const TimeSeriesQueryResult &result)
+{
+    m_currentData = result;
+    m_dataCompleteness = 1.0;
+    m_costEstimator.recordExecution(result);
+    
+    // 实时模式下以完整结果为起点，之后只增量更新
+    if (m_timeWidget && m_timeWidget->isLiveMode()) {
+        m_liveWindow->reset(result, m_currentStartTime.msecsTo(m_currentEndTime));
+    }
+    
+    qDebug() << "Data query finished:" << m_currentData.series.size() << "devices,"
+             << m_currentData.bucketer.bucketCount() << "buckets,"
+             << m_currentData.samplesScanned << "samples in"
+             << m_currentData.elapsedUs << "us on" << m_queryExecutor->threadCount()
+             << "threads, cache hit rate" << m_resultCache->hitRate()
+             << ", dropped" << m_queryScheduler->droppedCount()
+             << "cancelled" << m_queryScheduler->cancelledCount()
+             << ", prefetch hit rate" << m_queryPrefetcher->hitRate();
+    
+    if (m_chartPreview) {
+        m_chartPreview->setData(m_currentData);
+    }
+    
+    // 折线图显示每个设备最后若干个桶
+    QStringList sparklineDevices;
+    for (const DeviceSeries &series : m_currentData.series) {
+        const int from = series.buckets.size() - m_sparklineBuffer->capacity();
+        m_sparklineBuffer->assign(series.deviceId, bucketAverages(series.buckets, from));
+        sparklineDevices.append(series.deviceId);
+    }
+    m_sparklineBuffer->notifyAppended(sparklineDevices);
+    
+    emit dataUpdated(m_currentData);
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::onLiveModeChanged(bool enabled)
+{
+    qDebug() << "Live mode" << (enabled ? "enabled" : "disabled");
+    
+    // 开启时TimeWidget随即发出timeRangeChanged，完整结果到达后启动实时窗口
+    if (!enabled) {
+        m_liveWindow->stop();
+    }
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::onLiveWindowAdvanced(const QDateTime &start, const QDateTime &end)
+{
+    m_currentStartTime = start;
+    m_currentEndTime = end;
+    emit timeRangeUpdated(start, end);
+    
+    // 完整查询尚未返回时忽略，结果到达后的下一次滚动会补齐；
+    // 尾部在后台线程上聚合，增量到达后由onLiveDeltaReady应用
+    m_liveWindow->advanceTo(end.toMSecsSinceEpoch());
+}
+
+void MainWindow::onLiveDeltaReady(const LiveWindowDelta &delta)
+{
+    const int previousBuckets = m_currentData.bucketer.bucketCount();
+    m_currentData = m_liveWindow->result();
+    
+    // 折线图只追加新桶，并替换滚动前仍在累积的尾部桶
+    const int replaced = qMax(0, previousBuckets - delta.droppedHeadBuckets - delta.firstUpdatedBucket);
+    QStringList sparklineDevices;
+    for (const DeviceSeries &series : delta.tail) {
+        const QVector<double> values = bucketAverages(series.buckets, 0);
+        m_sparklineBuffer->appendValues(series.deviceId, values.constData(), values.size(), replaced);
+        sparklineDevices.append(series.deviceId);
+    }
+    m_sparklineBuffer->notifyAppended(sparklineDevices);
+    if (m_chartPreview) {
+        // 窗口每次滑动分桶都会变化，用advanceData保留用户缩放后的视图
+        m_chartPreview->advanceData(m_currentData);
+    }
+    
+    emit dataAdvanced(delta);
+    emit statusChanged(getStatusSummary());
+}
+
+void MainWindow::showExportDialog()
+{
+    if (m_dataExporter->isRunning()) {
+        return;
+    }
+    
+    const QString aggregatedCsv = "聚合数据 CSV (*.csv)";
+    const QString rawCsv = "原始样本 CSV (*.csv)";
+    const QString aggregatedColumnar = "聚合数据 列式二进制 (*.tscol)";
+    const QString rawColumnar = "原始样本 列式二进制 (*.tscol)";
+    QString selectedFilter = aggregatedCsv;
+    const QString filePath = QFileDialog::getSaveFileName(
+        this, "导出数据", QString(),
+        QStringList({aggregatedCsv, rawCsv, aggregatedColumnar, rawColumnar}).join(";;"),
+        &selectedFilter);
+    if (filePath.isEmpty()) {
+        return;
+    }
+    
+    const ExportRequest::Format format = (selectedFilter == aggregatedColumnar || selectedFilter == rawColumnar)
+        ? ExportRequest::Columnar : ExportRequest::Csv;
+    const ExportRequest::Content content = (selectedFilter == rawCsv || selectedFilter == rawColumnar)
+        ? ExportRequest::RawSamples : ExportRequest::Aggregated;
+    if (!exportCurrentSelection(filePath, format, content)) {
+        statusBar()->showMessage(QString("无法导出: %1").arg(m_dataExporter->getLastError()), 5000);
+        return;
+    }
+    
+    if (!m_exportProgress) {
+        m_exportProgress = new QProgressDialog("正在导出...", "取消", 0, 1000, this);
+        m_exportProgress->setWindowModality(Qt::WindowModal);
+        m_exportProgress->setAutoClose(false);
+        m_exportProgress->setAutoReset(false);
+        connect(m_exportProgress, &QProgressDialog::canceled,
+                m_dataExporter.data(), &DataExporter::cancel);
+    }
+    m_exportProgress->setValue(0);
+    m_exportProgress->show();
+}
+
+bool MainWindow::exportCurrentSelection(const QString &filePath, ExportRequest::Format format,
+                                        ExportRequest::Content content)
+{
+    QDateTime start;
+    QDateTime end;
+    ExportRequest request;
+    if (getCurrentTimeRange(start, end)) {
+        request.query = TimeSeriesQuery(getCurrentSelectedDevices(), start.toMSecsSinceEpoch(),
+                                        end.toMSecsSinceEpoch(), getCurrentGranularity());
+    }
+    request.filePath = filePath;
+    request.format = format;
+    request.content = content;
+    
+    if (!m_dataExporter->start(request)) {
+        qDebug() << "Export not started:" << m_dataExporter->getLastError();
+        return false;
+    }
+    if (m_exportButton) {
+        m_exportButton->setEnabled(false);
+    }
+    return true;
+}
+
+void MainWindow::onExportProgress(const ExportStats &stats)
+{
+    if (m_exportProgress) {
+        m_exportProgress->setValue(qFloor(stats.completeness * 1000.0));
+        m_exportProgress->setLabelText(QString("已导出 %1 行，%2 MB/s")
+                                       .arg(stats.rowsWritten)
+                                       .arg(stats.megabytesPerSecond(), 0, 'f', 1));
+    }
+}
+
+void MainWindow::onExportFinished(const ExportStats &stats)
+{
+    if (m_exportProgress) {
+        m_exportProgress->hide();
+    }
+    if (m_exportButton) {
+        m_exportButton->setEnabled(true);
+    }
+    
+    QString message;
+    if (stats.cancelled) {
+        message = "导出已取消";
+    } else if (!stats.error.isEmpty()) {
+        message = QString("导出失败: %1").arg(stats.error);
+    } else {
+        message = QString("导出完成: %1 行，%2 MB，%3 MB/s")
+                  .arg(stats.rowsWritten)
+                  .arg(stats.bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+                  .arg(stats.megabytesPerSecond(), 0, 'f', 1);
+    }
+    statusBar()->showMessage(message, 10000);
+    
+    emit exportFinished(stats);
+}
+
 void MainWindow::updateWindowTitle()
 {
     if (!m_isInitialized) {
@@ -225,6 +645,11 @@ QString MainWindow::getStatusSummary() const
                       .arg(m_currentEndTime.toString("yyyy-MM-dd hh:mm"));
     }
     
+    // 实时模式
+    if (m_timeWidget && m_timeWidget->isLiveMode()) {
+        statusParts << "Live";
+    }
+    
     // 设备选择信息
     statusParts << QString("Devices: %1 selected").arg(m_selectedDevices.size());
     
@@ -233,6 +658,22 @@ QString MainWindow::getStatusSummary() const
         statusParts << QString("Search: \"%1\"").arg(m_searchText);
     }
     
+    // 查询开销估算
+    if (m_currentEstimate.rows > 0) {
+        QString cost = QString("Cost: %1").arg(QueryCostEstimator::formatEstimate(m_currentEstimate));
+        if (m_overBudget) {
+            cost += m_suggestedGranularity != m_currentGranularity
+                ? QString(" (over budget, try %1)").arg(granularityName(m_suggestedGranularity))
+                : QString(" (over budget)");
+        }
+        statusParts << cost;
+    }
+    
+    // 数据加载进度
+    if (m_dataCompleteness < 1.0) {
+        statusParts << QString("Data: %1% loaded").arg(qFloor(m_dataCompleteness * 100.0));
+    }
+    
     return statusParts.join(" | ");
 }bool
  MainWindow::getCurrentTimeRange(QDateTime &start, QDateTime &end) const
@@ -255,6 +696,84 @@ QString MainWindow::getCurrentSearchText() const
     return m_searchText;
 }
 
+TimeWidget::TimeGranularity MainWindow::getCurrentGranularity() const
+{
+    return m_currentGranularity;
+}
+
+const TimeSeriesQueryResult &MainWindow::getCurrentData() const
+{
+    return m_currentData;
+}
+
+TimeSeriesStore *MainWindow::dataStore() const
+{
+    return m_dataStore.data();
+}
+
+double MainWindow::getDataCompleteness() const
+{
+    return m_dataCompleteness;
+}
+
+QueryScheduler *MainWindow::queryScheduler() const
+{
+    return m_queryScheduler.data();
+}
+
+QueryPrefetcher *MainWindow::queryPrefetcher() const
+{
+    return m_queryPrefetcher.data();
+}
+
+LiveQueryWindow *MainWindow::liveWindow() const
+{
+    return m_liveWindow.data();
+}
+
+DataExporter *MainWindow::dataExporter() const
+{
+    return m_dataExporter.data();
+}
+
+SparklineBuffer *MainWindow::sparklineBuffer() const
+{
+    return m_sparklineBuffer.data();
+}
+
+DeviceStatusFeed *MainWindow::statusFeed() const
+{
+    return m_statusFeed.data();
+}
+
+CatalogWatcher *MainWindow::catalogWatcher() const
+{
+    return m_catalogWatcher.data();
+}
+
+QueryCostEstimate MainWindow::getCurrentEstimate() const
+{
+    return m_currentEstimate;
+}
+
+QueryCostEstimator *MainWindow::costEstimator()
+{
+    return &m_costEstimator;
+}
+
+void MainWindow::setAutoCoarsenEnabled(bool enabled)
+{
+    m_autoCoarsen = enabled;
+    if (enabled) {
+        applySuggestedGranularity();
+    }
+}
+
+bool MainWindow::isAutoCoarsenEnabled() const
+{
+    return m_autoCoarsen;
+}
+
 void MainWindow::setTimeRange(const QDateTime &start, const QDateTime &end)
 {
     if (m_timeWidget && start.isValid() && end.isValid() && start <= end) {
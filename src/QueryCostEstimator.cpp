@@ -0,0 +1,89 @@
+#include "QueryCostEstimator.h"
+
+namespace {
+// 延迟模型参数：每次查询的固定开销和初始的每行耗时
+const double FixedOverheadMs = 1.0;
+const double DefaultUsPerRow = 0.25;
+// 校准时新观测值的权重
+const double CalibrationWeight = 0.2;
+// 行数过少时计时误差太大，不参与校准
+const qint64 MinCalibrationRows = 1000;
+// 从原始样本聚合的行不足此比例时不参与校准
+const double MinScannedRatio = 0.5;
+}
+
+QueryCostEstimator::QueryCostEstimator()
+    : m_usPerRow(DefaultUsPerRow)
+{
+}
+
+QueryCostEstimate QueryCostEstimator::estimate(const TimeSeriesQuery &query) const
+{
+    QueryCostEstimate estimate;
+    if (!query.isValid()) {
+        return estimate;
+    }
+
+    const TimeBucketer bucketer(query.startMs, query.endMs, query.granularity);
+    estimate.deviceCount = query.deviceIds.size();
+    estimate.bucketCount = bucketer.bucketCount();
+    estimate.rows = static_cast<qint64>(estimate.deviceCount) * estimate.bucketCount;
+    estimate.bytes = estimate.rows * static_cast<qint64>(sizeof(BucketAggregate)) +
+                     estimate.deviceCount * static_cast<qint64>(sizeof(DeviceSeries));
+    estimate.latencyMs = FixedOverheadMs + estimate.rows * m_usPerRow / 1000.0;
+    return estimate;
+}
+
+bool QueryCostEstimator::exceedsBudget(const QueryCostEstimate &estimate) const
+{
+    return estimate.rows > m_budget.maxRows || estimate.bytes > m_budget.maxBytes ||
+           estimate.latencyMs > m_budget.maxLatencyMs;
+}
+
+TimeWidget::TimeGranularity QueryCostEstimator::suggestGranularity(const TimeSeriesQuery &query) const
+{
+    // 颗粒度枚举由细到粗排列
+    TimeSeriesQuery coarser = query;
+    for (int g = query.granularity; g <= TimeWidget::Day1; ++g) {
+        coarser.granularity = static_cast<TimeWidget::TimeGranularity>(g);
+        if (!exceedsBudget(estimate(coarser))) {
+            return coarser.granularity;
+        }
+    }
+    return TimeWidget::Day1;
+}
+
+void QueryCostEstimator::recordExecution(const TimeSeriesQueryResult &result)
+{
+    // 命中结果缓存或预聚合层的行几乎不耗时，按它们校准会使每行耗时趋近于0、
+    // 延迟预算失效；只用从原始样本聚合的行校准，估计值即未命中时的耗时
+    const qint64 rows = static_cast<qint64>(result.series.size()) * result.bucketer.bucketCount();
+    const qint64 scannedRows = result.bucketsScanned;
+    if (result.cancelled || scannedRows < MinCalibrationRows || scannedRows < rows * MinScannedRatio) {
+        return;
+    }
+
+    const double observedUs = qMax(0.0, result.elapsedUs - FixedOverheadMs * 1000.0);
+    m_usPerRow += CalibrationWeight * (observedUs / scannedRows - m_usPerRow);
+}
+
+QString QueryCostEstimator::formatEstimate(const QueryCostEstimate &estimate)
+{
+    QString rows;
+    if (estimate.rows >= 1000000) {
+        rows = QString("%1M").arg(estimate.rows / 1000000.0, 0, 'f', 1);
+    } else if (estimate.rows >= 1000) {
+        rows = QString("%1k").arg(estimate.rows / 1000.0, 0, 'f', 1);
+    } else {
+        rows = QString::number(estimate.rows);
+    }
+
+    QString bytes;
+    if (estimate.bytes >= 1024 * 1024) {
+        bytes = QString("%1 MB").arg(estimate.bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    } else {
+        bytes = QString("%1 KB").arg(qMax<qint64>(1, estimate.bytes / 1024));
+    }
+
+    return QString("%1 rows, %2, ~%3 ms").arg(rows).arg(bytes).arg(qRound(estimate.latencyMs));
+}
@@ -0,0 +1,233 @@
+#include "QueryExecutor.h"
+#include "QueryResultCache.h"
+#include "TimeSeriesStore.h"
+#include "WorkStealingThreadPool.h"
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+// 设备数少于线程数时，每个线程平均分到的时间切片数
+const int SlicesPerThread = 4;
+// 时间切片的最小桶数，避免切片过碎
+const int MinSliceBuckets = 16;
+// 部分结果的默认发送间隔（约一帧）
+const int DefaultStreamIntervalMs = 16;
+
+/**
+ * @brief 需要并行读取的一段缺失时间桶
+ */
+struct BucketSlice {
+    int deviceIndex;
+    int firstBucket;
+    int bucketCount;
+};
+}
+
+void QueryCancelToken::cancel() const
+{
+    QMutexLocker locker(&m_state->mutex);
+    m_state->cancelled.store(true);
+    m_state->condition.wakeAll();
+}
+
+bool QueryCancelToken::waitForCancel(qint64 usecs) const
+{
+    QDeadlineTimer deadline(Qt::PreciseTimer);
+    deadline.setPreciseRemainingTime(0, qMax<qint64>(0, usecs) * 1000, Qt::PreciseTimer);
+
+    QMutexLocker locker(&m_state->mutex);
+    while (!m_state->cancelled.load() && !deadline.hasExpired()) {
+        m_state->condition.wait(&m_state->mutex, deadline);
+    }
+    return m_state->cancelled.load();
+}
+
+QueryExecutor::QueryExecutor(TimeSeriesStore *store, int threadCount, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+    , m_pool(new WorkStealingThreadPool(threadCount))
+    , m_streamIntervalMs(DefaultStreamIntervalMs)
+{
+}
+
+QueryExecutor::~QueryExecutor()
+{
+}
+
+void QueryExecutor::setThreadCount(int threadCount)
+{
+    m_pool.reset(new WorkStealingThreadPool(threadCount));
+}
+
+int QueryExecutor::threadCount() const
+{
+    return m_pool->threadCount();
+}
+
+TimeSeriesQueryResult QueryExecutor::execute(const TimeSeriesQuery &query, const QueryCancelToken &token)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    TimeSeriesQueryResult result;
+    result.bucketer = TimeBucketer(query.startMs, query.endMs, query.granularity);
+    if (!m_store || !query.isValid() || !result.bucketer.isValid()) {
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+        return result;
+    }
+
+    const TimeBucketer &bucketer = result.bucketer;
+    const int deviceCount = query.deviceIds.size();
+    result.series.resize(deviceCount);
+    // 任务只写入各自的元素，提前取得裸指针以免在工作线程中触发隐式共享检查
+    DeviceSeries *series = result.series.data();
+    for (int i = 0; i < deviceCount; ++i) {
+        series[i].deviceId = query.deviceIds.at(i);
+    }
+
+    std::atomic<qint64> scanned(0);
+    std::atomic<qint64> scannedBuckets(0);
+    std::atomic<int> completed(0);
+    int total = 0;
+
+    auto reportProgress = [this, &completed, &total]() {
+        const int done = completed.fetch_add(1) + 1;
+        // 按百分比节流，避免两万个设备产生两万次信号
+        if (done == total || done * 100LL / total != (done - 1) * 100LL / total) {
+            emit progressChanged(done, total);
+        }
+    };
+
+    // 已完成的设备先缓存在批次中，按流式间隔发出
+    QMutex streamMutex;
+    PartialQueryResult streamBatch;
+    streamBatch.bucketer = bucketer;
+    streamBatch.totalDevices = deviceCount;
+    QElapsedTimer sinceLastBatch;
+
+    auto deviceCompleted = [this, series, &streamMutex, &streamBatch, &sinceLastBatch](int index) {
+        QMutexLocker locker(&streamMutex);
+        streamBatch.series.append(series[index]);
+        ++streamBatch.completedDevices;
+        // 第一个设备立即发出，之后按间隔节流；最后一批由完整结果代替
+        if (!sinceLastBatch.isValid() || sinceLastBatch.elapsed() >= m_streamIntervalMs) {
+            sinceLastBatch.start();
+            emit partialResultReady(streamBatch);
+            streamBatch.series.clear();
+        }
+    };
+
+    if (deviceCount >= m_pool->threadCount()) {
+        // 设备足够多：每个设备一个任务，经由存储的结果缓存查询
+        total = deviceCount;
+        for (int i = 0; i < deviceCount; ++i) {
+            m_pool->submit([this, series, i, &bucketer, &token, &scanned, &scannedBuckets, &reportProgress,
+                            &deviceCompleted]() {
+                if (token.isCancelled()) {
+                    return;
+                }
+                qint64 deviceScanned = 0;
+                qint64 deviceBuckets = 0;
+                series[i].buckets = m_store->queryDevice(series[i].deviceId, bucketer, &deviceScanned, &deviceBuckets);
+                scanned.fetch_add(deviceScanned);
+                scannedBuckets.fetch_add(deviceBuckets);
+                reportProgress();
+                deviceCompleted(i);
+            });
+        }
+        m_pool->waitForDone();
+    } else {
+        // 设备较少：先在调用线程查缓存，再把缺失的时间桶切片并行读取
+        QueryResultCache *cache = m_store->resultCache();
+        QVector<BucketSlice> gaps;
+        QVector<quint64> generations(deviceCount, 0);
+        int missingBuckets = 0;
+        for (int i = 0; i < deviceCount; ++i) {
+            QVector<QueryResultCache::Segment> deviceGaps;
+            if (cache) {
+                deviceGaps = cache->lookup(series[i].deviceId, bucketer, series[i].buckets, &generations[i]);
+            } else {
+                series[i].buckets.resize(bucketer.bucketCount());
+                deviceGaps.append(QueryResultCache::Segment(0, bucketer.bucketCount()));
+            }
+            for (const QueryResultCache::Segment &gap : deviceGaps) {
+                gaps.append(BucketSlice{i, gap.firstBucket, gap.bucketCount});
+                missingBuckets += gap.bucketCount;
+            }
+        }
+
+        const int targetSlices = m_pool->threadCount() * SlicesPerThread;
+        const int sliceBuckets = qMax(MinSliceBuckets, (missingBuckets + targetSlices - 1) / targetSlices);
+
+        QVector<BucketSlice> slices;
+        for (const BucketSlice &gap : gaps) {
+            for (int first = gap.firstBucket; first < gap.firstBucket + gap.bucketCount; first += sliceBuckets) {
+                const int count = qMin(sliceBuckets, gap.firstBucket + gap.bucketCount - first);
+                slices.append(BucketSlice{gap.deviceIndex, first, count});
+            }
+        }
+
+        QVector<BucketAggregate *> outputs(deviceCount);
+        std::unique_ptr<std::atomic<int>[]> remainingSlices(new std::atomic<int>[deviceCount]);
+        for (int i = 0; i < deviceCount; ++i) {
+            outputs[i] = series[i].buckets.data();
+            remainingSlices[i].store(0);
+        }
+        for (const BucketSlice &slice : slices) {
+            remainingSlices[slice.deviceIndex].fetch_add(1);
+        }
+
+        // 完全命中缓存的设备立即发出
+        for (int i = 0; i < deviceCount; ++i) {
+            if (remainingSlices[i].load() == 0) {
+                deviceCompleted(i);
+            }
+        }
+        std::atomic<int> *remaining = remainingSlices.get();
+
+        total = slices.size();
+        for (const BucketSlice &slice : slices) {
+            BucketAggregate *out = outputs.at(slice.deviceIndex) + slice.firstBucket;
+            const QString deviceId = series[slice.deviceIndex].deviceId;
+            m_pool->submit([this, slice, out, deviceId, remaining, &bucketer, &token, &scanned, &scannedBuckets,
+                            &reportProgress, &deviceCompleted]() {
+                if (token.isCancelled()) {
+                    return;
+                }
+                qint64 sliceScanned = 0;
+                qint64 sliceBuckets = 0;
+                const QVector<BucketAggregate> buckets = m_store->aggregateDevice(
+                    deviceId, bucketer, slice.firstBucket, slice.bucketCount, &sliceScanned, &sliceBuckets);
+                std::copy(buckets.constBegin(), buckets.constEnd(), out);
+                scanned.fetch_add(sliceScanned);
+                scannedBuckets.fetch_add(sliceBuckets);
+                reportProgress();
+                // 设备的最后一个切片完成后才发出该设备
+                if (remaining[slice.deviceIndex].fetch_sub(1) == 1) {
+                    deviceCompleted(slice.deviceIndex);
+                }
+            });
+        }
+        m_pool->waitForDone();
+
+        // 以完整空档为单位写回缓存，被取消时空档可能不完整；
+        // 查找之后有新样本写入的设备不写回
+        if (cache && !token.isCancelled()) {
+            for (const BucketSlice &gap : gaps) {
+                cache->insertIfCurrent(series[gap.deviceIndex].deviceId, bucketer, gap.firstBucket,
+                                       series[gap.deviceIndex].buckets.mid(gap.firstBucket, gap.bucketCount),
+                                       generations.at(gap.deviceIndex));
+            }
+        }
+    }
+
+    result.samplesScanned = scanned.load();
+    result.bucketsScanned = scannedBuckets.load();
+    result.cancelled = token.isCancelled();
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
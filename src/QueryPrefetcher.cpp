@@ -0,0 +1,274 @@
+#include "QueryPrefetcher.h"
+#include "QueryResultCache.h"
+#include "QueryScheduler.h"
+#include "TimeSeriesStore.h"
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+const qint64 MsPerDay = 24 * 60 * 60 * 1000LL;
+// 默认参数：查询完成后空闲300毫秒再预取，最多占用四分之一个核心和一半缓存
+const int DefaultIdleDelayMs = 300;
+const int DefaultCpuBudget = 25;
+const double DefaultMemoryBudget = 0.5;
+// 记录的已预取窗口数上限
+const int MaxPrefetchedWindows = 16;
+}
+
+void PrefetchRunner::run(const QVector<TimeSeriesQuery> &windows, const QueryCancelToken &token,
+                         int cpuBudget, int byteCap)
+{
+    QVector<TimeSeriesQuery> completed;
+    QueryResultCache *cache = m_store->resultCache();
+    int insertedBytes = 0;
+
+    for (const TimeSeriesQuery &window : windows) {
+        if (!cache) {
+            break;
+        }
+
+        const TimeBucketer bucketer(window.startMs, window.endMs, window.granularity);
+        bool aborted = false;
+        for (const QString &deviceId : window.deviceIds) {
+            if (token.isCancelled() || insertedBytes >= byteCap) {
+                aborted = true;
+                break;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            // 只聚合缺失的空档，并按写入的字节数计入预取占用
+            QVector<BucketAggregate> buckets;
+            quint64 generation = 0;
+            const QVector<QueryResultCache::Segment> gaps = cache->lookup(deviceId, bucketer, buckets, &generation);
+            for (const QueryResultCache::Segment &gap : gaps) {
+                if (token.isCancelled()) {
+                    aborted = true;
+                    break;
+                }
+                const QVector<BucketAggregate> gapBuckets =
+                    m_store->aggregateDevice(deviceId, bucketer, gap.firstBucket, gap.bucketCount);
+                if (cache->insertIfCurrent(deviceId, bucketer, gap.firstBucket, gapBuckets, generation)) {
+                    insertedBytes += gapBuckets.size() * static_cast<int>(sizeof(BucketAggregate));
+                }
+            }
+            if (aborted) {
+                break;
+            }
+
+            // 按占空比让出CPU，使预取线程的平均CPU占用不超过上限；取消时立即醒来
+            if (cpuBudget < 100) {
+                const qint64 busyUs = timer.nsecsElapsed() / 1000;
+                token.waitForCancel(busyUs * (100 - cpuBudget) / cpuBudget);
+            }
+        }
+
+        if (aborted) {
+            break;
+        }
+        completed.append(window);
+    }
+
+    emit finished(completed, insertedBytes);
+}
+
+QueryPrefetcher::QueryPrefetcher(TimeSeriesStore *store, QueryScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+    , m_runner(new PrefetchRunner(store))
+    , m_enabled(true)
+    , m_cpuBudget(DefaultCpuBudget)
+    , m_memoryBudget(DefaultMemoryBudget)
+    , m_runningWindows(0)
+    , m_running(false)
+    , m_windowsPrefetched(0)
+    , m_windowsPreempted(0)
+    , m_userQueries(0)
+    , m_hits(0)
+    , m_prefetchedBytes(0)
+{
+    qRegisterMetaType<QVector<TimeSeriesQuery>>("QVector<TimeSeriesQuery>");
+    qRegisterMetaType<QueryCancelToken>("QueryCancelToken");
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(DefaultIdleDelayMs);
+    connect(&m_idleTimer, &QTimer::timeout, this, &QueryPrefetcher::onIdleTimeout);
+
+    m_runner->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_runner, &QObject::deleteLater);
+    connect(this, &QueryPrefetcher::runRequested, m_runner, &PrefetchRunner::run, Qt::QueuedConnection);
+    connect(m_runner, &PrefetchRunner::finished, this, &QueryPrefetcher::onRunFinished, Qt::QueuedConnection);
+
+    if (scheduler) {
+        connect(scheduler, &QueryScheduler::querySubmitted, this, &QueryPrefetcher::onUserQuerySubmitted);
+        connect(scheduler, &QueryScheduler::resultReady, this, &QueryPrefetcher::onUserResultReady);
+    }
+
+    m_workerThread.setObjectName("QueryPrefetcher");
+    m_workerThread.start(QThread::LowestPriority);
+}
+
+QueryPrefetcher::~QueryPrefetcher()
+{
+    cancelRunning();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+QVector<TimeSeriesQuery> QueryPrefetcher::predictNextQueries(const TimeSeriesQuery &query)
+{
+    QVector<TimeSeriesQuery> windows;
+    if (!query.isValid()) {
+        return windows;
+    }
+
+    const qint64 span = query.endMs - query.startMs;
+
+    // 向前翻一个周期
+    windows.append(TimeSeriesQuery(query.deviceIds, query.startMs - span, query.startMs, query.granularity));
+
+    // "前三天"快捷按钮
+    if (span < 3 * MsPerDay) {
+        windows.append(TimeSeriesQuery(query.deviceIds, query.endMs - 3 * MsPerDay, query.endMs, query.granularity));
+    }
+
+    // 切换到更粗的颗粒度
+    if (query.granularity == TimeWidget::Minutes15) {
+        windows.append(TimeSeriesQuery(query.deviceIds, query.startMs, query.endMs, TimeWidget::Hour1));
+    } else if (query.granularity == TimeWidget::Hour1) {
+        windows.append(TimeSeriesQuery(query.deviceIds, query.startMs, query.endMs, TimeWidget::Day1));
+    }
+
+    return windows;
+}
+
+void QueryPrefetcher::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!enabled) {
+        m_idleTimer.stop();
+        cancelRunning();
+    }
+}
+
+double QueryPrefetcher::hitRate() const
+{
+    return m_userQueries == 0 ? 0.0 : static_cast<double>(m_hits) / static_cast<double>(m_userQueries);
+}
+
+void QueryPrefetcher::onUserQuerySubmitted(const TimeSeriesQuery &query)
+{
+    // 用户查询优先：立即停止预取
+    m_idleTimer.stop();
+    cancelRunning();
+
+    if (!query.isValid()) {
+        return;
+    }
+
+    ++m_userQueries;
+    const TimeBucketer bucketer(query.startMs, query.endMs, query.granularity);
+    const qint64 firstOrdinal = bucketer.firstOrdinal();
+    const qint64 endOrdinal = firstOrdinal + bucketer.bucketCount();
+
+    // 只有完整覆盖查询范围的预取窗口才算命中
+    for (const PrefetchedWindow &window : m_prefetched) {
+        if (window.granularity != query.granularity ||
+            window.firstOrdinal > firstOrdinal || window.endOrdinal < endOrdinal) {
+            continue;
+        }
+
+        bool coversDevices = true;
+        for (const QString &deviceId : query.deviceIds) {
+            if (!window.deviceIds.contains(deviceId)) {
+                coversDevices = false;
+                break;
+            }
+        }
+        if (coversDevices) {
+            ++m_hits;
+            break;
+        }
+    }
+}
+
+void QueryPrefetcher::onUserResultReady(const TimeSeriesQueryResult &result)
+{
+    QueryScheduler *scheduler = qobject_cast<QueryScheduler *>(sender());
+    if (!m_enabled || !scheduler || scheduler->isBusy()) {
+        return;
+    }
+
+    // 结果中不含原始时间范围，使用对齐后的分桶范围作为预测基准
+    QStringList deviceIds;
+    deviceIds.reserve(result.series.size());
+    for (const DeviceSeries &series : result.series) {
+        deviceIds << series.deviceId;
+    }
+    m_lastQuery = TimeSeriesQuery(deviceIds, result.bucketer.startMs(), result.bucketer.endMs(),
+                                  result.bucketer.granularity());
+    m_idleTimer.start();
+}
+
+void QueryPrefetcher::onIdleTimeout()
+{
+    if (!m_enabled || m_running || !m_store->resultCache()) {
+        return;
+    }
+
+    const QVector<TimeSeriesQuery> windows = predictNextQueries(m_lastQuery);
+    if (windows.isEmpty()) {
+        return;
+    }
+
+    // 上限只约束预取写入的字节；被淘汰的部分无法逐条追踪，以缓存总占用为上界
+    const QueryResultCache *cache = m_store->resultCache();
+    m_prefetchedBytes = qMin<qint64>(m_prefetchedBytes, cache->usedBytes());
+    const qint64 byteCap = static_cast<qint64>(cache->maxBytes() * m_memoryBudget);
+    const int remainingBytes = static_cast<int>(qMax<qint64>(0, byteCap - m_prefetchedBytes));
+    m_runningToken = QueryCancelToken();
+    m_runningWindows = windows.size();
+    m_running = true;
+
+    emit prefetchStarted(windows.size());
+    emit runRequested(windows, m_runningToken, m_cpuBudget, remainingBytes);
+}
+
+void QueryPrefetcher::onRunFinished(const QVector<TimeSeriesQuery> &completedWindows, int insertedBytes)
+{
+    m_running = false;
+    m_prefetchedBytes += insertedBytes;
+    m_windowsPrefetched += completedWindows.size();
+    if (m_runningToken.isCancelled()) {
+        m_windowsPreempted += m_runningWindows - completedWindows.size();
+    }
+
+    for (const TimeSeriesQuery &query : completedWindows) {
+        const TimeBucketer bucketer(query.startMs, query.endMs, query.granularity);
+        PrefetchedWindow window;
+        window.granularity = query.granularity;
+        window.firstOrdinal = bucketer.firstOrdinal();
+        window.endOrdinal = bucketer.firstOrdinal() + bucketer.bucketCount();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        window.deviceIds = QSet<QString>(query.deviceIds.begin(), query.deviceIds.end());
+#else
+        window.deviceIds = query.deviceIds.toSet();
+#endif
+        m_prefetched.append(window);
+    }
+    while (m_prefetched.size() > MaxPrefetchedWindows) {
+        m_prefetched.removeFirst();
+    }
+
+    qDebug() << "Prefetch finished:" << completedWindows.size() << "of" << m_runningWindows
+             << "windows, hit rate" << hitRate();
+    emit prefetchFinished(completedWindows.size());
+}
+
+void QueryPrefetcher::cancelRunning()
+{
+    if (m_running) {
+        m_runningToken.cancel();
+    }
+}
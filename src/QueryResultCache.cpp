@@ -0,0 +1,236 @@
+#include "QueryResultCache.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <limits>
+
+QueryResultCache::QueryResultCache(int maxBytes)
+    : m_cache(maxBytes), m_hitBuckets(0), m_missBuckets(0)
+{
+}
+
+QVector<QueryResultCache::Segment> QueryResultCache::lookup(const QString &deviceId, const TimeBucketer &bucketer,
+                                                            QVector<BucketAggregate> &buckets,
+                                                            quint64 *generation)
+{
+    QVector<Segment> gaps;
+    if (!bucketer.isValid()) {
+        return gaps;
+    }
+
+    buckets.resize(bucketer.bucketCount());
+    const qint64 queryFirst = bucketer.firstOrdinal();
+    const qint64 queryEnd = queryFirst + bucketer.bucketCount();
+    qint64 cursor = queryFirst;
+
+    QMutexLocker locker(&m_mutex);
+    if (generation) {
+        *generation = m_generations.value(deviceId);
+    }
+    const BucketRunList *runs = m_cache.object(QueryCacheKey(deviceId, bucketer.granularity()));
+
+    if (runs) {
+        for (const BucketRun &run : *runs) {
+            if (run.endOrdinal() <= cursor) {
+                continue;
+            }
+            if (run.firstOrdinal >= queryEnd) {
+                break;
+            }
+
+            if (run.firstOrdinal > cursor) {
+                gaps.append(Segment(static_cast<int>(cursor - queryFirst),
+                                    static_cast<int>(run.firstOrdinal - cursor)));
+                cursor = run.firstOrdinal;
+            }
+
+            // 复制与查询范围重叠的部分
+            const qint64 overlapEnd = qMin(queryEnd, run.endOrdinal());
+            std::copy(run.buckets.constBegin() + (cursor - run.firstOrdinal),
+                      run.buckets.constBegin() + (overlapEnd - run.firstOrdinal),
+                      buckets.begin() + (cursor - queryFirst));
+            m_hitBuckets += overlapEnd - cursor;
+            cursor = overlapEnd;
+        }
+    }
+
+    if (cursor < queryEnd) {
+        gaps.append(Segment(static_cast<int>(cursor - queryFirst), static_cast<int>(queryEnd - cursor)));
+    }
+
+    for (const Segment &gap : gaps) {
+        m_missBuckets += gap.bucketCount;
+    }
+    return gaps;
+}
+
+void QueryResultCache::insert(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                              const QVector<BucketAggregate> &buckets)
+{
+    QMutexLocker locker(&m_mutex);
+    insertLocked(deviceId, bucketer, firstBucket, buckets);
+}
+
+bool QueryResultCache::insertIfCurrent(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                                       const QVector<BucketAggregate> &buckets, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_generations.value(deviceId) != generation) {
+        return false;
+    }
+    insertLocked(deviceId, bucketer, firstBucket, buckets);
+    return true;
+}
+
+void QueryResultCache::insertLocked(const QString &deviceId, const TimeBucketer &bucketer, int firstBucket,
+                                    const QVector<BucketAggregate> &buckets)
+{
+    if (!bucketer.isValid() || buckets.isEmpty()) {
+        return;
+    }
+
+    const qint64 newFirst = bucketer.firstOrdinal() + firstBucket;
+    const qint64 newEnd = newFirst + buckets.size();
+    const QueryCacheKey key(deviceId, bucketer.granularity());
+
+    BucketRunList *runs = m_cache.take(key);
+    if (!runs) {
+        runs = new BucketRunList();
+    }
+
+    // 找出与新段重叠或相邻的已有段 [first, last)
+    int first = 0;
+    while (first < runs->size() && runs->at(first).endOrdinal() < newFirst) {
+        ++first;
+    }
+    int last = first;
+    while (last < runs->size() && runs->at(last).firstOrdinal <= newEnd) {
+        ++last;
+    }
+
+    BucketRun merged;
+    merged.firstOrdinal = newFirst;
+    qint64 mergedEnd = newEnd;
+    if (last > first) {
+        merged.firstOrdinal = qMin(newFirst, runs->at(first).firstOrdinal);
+        mergedEnd = qMax(newEnd, runs->at(last - 1).endOrdinal());
+    }
+    merged.buckets.resize(static_cast<int>(mergedEnd - merged.firstOrdinal));
+
+    // 先复制旧段，再用新数据覆盖
+    for (int i = first; i < last; ++i) {
+        const BucketRun &run = runs->at(i);
+        std::copy(run.buckets.constBegin(), run.buckets.constEnd(),
+                  merged.buckets.begin() + (run.firstOrdinal - merged.firstOrdinal));
+    }
+    std::copy(buckets.constBegin(), buckets.constEnd(),
+              merged.buckets.begin() + (newFirst - merged.firstOrdinal));
+
+    runs->erase(runs->begin() + first, runs->begin() + last);
+    runs->insert(first, merged);
+
+    // 超出内存上限的条目会被QCache直接丢弃
+    m_cache.insert(key, runs, costOf(*runs));
+}
+
+void QueryResultCache::invalidateFrom(const QString &deviceId, qint64 fromMs)
+{
+    const TimeWidget::TimeGranularity granularities[] = {
+        TimeWidget::Minutes15, TimeWidget::Hour1, TimeWidget::Day1
+    };
+
+    // 即使没有缓存条目也要推进代数，正在读取空档的查询据此放弃写回
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_generations[deviceId];
+    }
+
+    for (TimeWidget::TimeGranularity granularity : granularities) {
+        const QueryCacheKey key(deviceId, granularity);
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_cache.contains(key)) {
+                continue;
+            }
+        }
+
+        // 包含fromMs的桶及其之后的桶全部失效
+        const qint64 ordinal = TimeBucketer(fromMs, fromMs + 1, granularity).firstOrdinal();
+
+        QMutexLocker locker(&m_mutex);
+        BucketRunList *runs = m_cache.take(key);
+        if (!runs) {
+            continue;
+        }
+
+        while (!runs->isEmpty() && runs->last().firstOrdinal >= ordinal) {
+            runs->removeLast();
+        }
+        if (!runs->isEmpty() && runs->last().endOrdinal() > ordinal) {
+            runs->last().buckets.resize(static_cast<int>(ordinal - runs->last().firstOrdinal));
+        }
+
+        if (runs->isEmpty()) {
+            delete runs;
+        } else {
+            m_cache.insert(key, runs, costOf(*runs));
+        }
+    }
+}
+
+void QueryResultCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+void QueryResultCache::setMaxBytes(int maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(maxBytes);
+}
+
+int QueryResultCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+int QueryResultCache::usedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}
+
+int QueryResultCache::entryCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}
+
+quint64 QueryResultCache::hitBuckets() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitBuckets;
+}
+
+quint64 QueryResultCache::missBuckets() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_missBuckets;
+}
+
+double QueryResultCache::hitRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 total = m_hitBuckets + m_missBuckets;
+    return total == 0 ? 0.0 : static_cast<double>(m_hitBuckets) / static_cast<double>(total);
+}
+
+int QueryResultCache::costOf(const BucketRunList &runs)
+{
+    qint64 bytes = sizeof(BucketRunList);
+    for (const BucketRun &run : runs) {
+        bytes += sizeof(BucketRun) + run.buckets.size() * static_cast<qint64>(sizeof(BucketAggregate));
+    }
+    return static_cast<int>(qMin<qint64>(bytes, std::numeric_limits<int>::max()));
+}
@@ -0,0 +1,160 @@
+#include "QueryScheduler.h"
+#include <QDebug>
+
+namespace {
+// 默认稳定周期：拖动时间编辑框或连续勾选时的事件间隔通常小于该值
+const int DefaultSettleIntervalMs = 50;
+}
+
+void QueryRunner::run(const TimeSeriesQuery &query, const QueryCancelToken &token, quint64 generation)
+{
+    // 排队期间已被取消的查询不再执行
+    if (token.isCancelled()) {
+        TimeSeriesQueryResult result;
+        result.cancelled = true;
+        emit finished(result, generation);
+        return;
+    }
+
+    emit finished(m_executor->execute(query, token), generation);
+}
+
+QueryScheduler::QueryScheduler(QueryExecutor *executor, QObject *parent)
+    : QObject(parent)
+    , m_runner(new QueryRunner(executor))
+    , m_hasPending(false)
+    , m_inFlight(false)
+    , m_generation(0)
+    , m_submittedCount(0)
+    , m_executedCount(0)
+    , m_droppedCount(0)
+    , m_cancelledCount(0)
+{
+    qRegisterMetaType<TimeSeriesQuery>("TimeSeriesQuery");
+    qRegisterMetaType<TimeSeriesQueryResult>("TimeSeriesQueryResult");
+    qRegisterMetaType<QueryCancelToken>("QueryCancelToken");
+    qRegisterMetaType<PartialQueryResult>("PartialQueryResult");
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(DefaultSettleIntervalMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &QueryScheduler::onSettleTimeout);
+
+    m_runner->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_runner, &QObject::deleteLater);
+    connect(this, &QueryScheduler::runRequested, m_runner, &QueryRunner::run, Qt::QueuedConnection);
+    connect(m_runner, &QueryRunner::finished, this, &QueryScheduler::onRunFinished, Qt::QueuedConnection);
+    // 部分结果在执行器的工作线程中发出，先于对应的finished到达
+    connect(executor, &QueryExecutor::partialResultReady,
+            this, &QueryScheduler::onPartialResult, Qt::QueuedConnection);
+
+    m_workerThread.setObjectName("QueryScheduler");
+    m_workerThread.start();
+}
+
+QueryScheduler::~QueryScheduler()
+{
+    cancel();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+void QueryScheduler::setSettleInterval(int msec)
+{
+    m_settleTimer.setInterval(qMax(0, msec));
+}
+
+void QueryScheduler::submit(const TimeSeriesQuery &query)
+{
+    ++m_submittedCount;
+    emit querySubmitted(query);
+
+    // 尚未执行的旧查询直接被新查询替换
+    if (m_hasPending) {
+        ++m_droppedCount;
+        m_hasPending = false;
+    }
+
+    // 与执行中的查询相同，等待其结果即可
+    if (m_inFlight && !m_inFlightToken.isCancelled() && query == m_inFlightQuery) {
+        ++m_droppedCount;
+        m_settleTimer.stop();
+        return;
+    }
+
+    m_pendingQuery = query;
+    m_hasPending = true;
+
+    if (m_inFlight && !m_inFlightToken.isCancelled()) {
+        m_inFlightToken.cancel();
+        ++m_cancelledCount;
+    }
+
+    m_settleTimer.start();
+}
+
+void QueryScheduler::cancel()
+{
+    m_settleTimer.stop();
+
+    if (m_hasPending) {
+        ++m_droppedCount;
+        m_hasPending = false;
+    }
+
+    if (m_inFlight && !m_inFlightToken.isCancelled()) {
+        m_inFlightToken.cancel();
+        ++m_cancelledCount;
+    }
+}
+
+void QueryScheduler::onSettleTimeout()
+{
+    // 执行中的查询已被取消，其结束后立即派发
+    if (!m_inFlight) {
+        dispatchPending();
+    }
+}
+
+void QueryScheduler::onRunFinished(const TimeSeriesQueryResult &result, quint64 generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    m_inFlight = false;
+
+    if (!m_inFlightToken.isCancelled()) {
+        ++m_executedCount;
+        emit resultReady(result);
+    } else {
+        qDebug() << "Query cancelled after" << result.elapsedUs << "us";
+    }
+
+    if (m_hasPending && !m_settleTimer.isActive()) {
+        dispatchPending();
+    }
+}
+
+void QueryScheduler::onPartialResult(const PartialQueryResult &partial)
+{
+    // 执行器一次只执行一个查询，未取消的执行中查询即为其来源
+    if (m_inFlight && !m_inFlightToken.isCancelled()) {
+        emit partialResultReady(partial);
+    }
+}
+
+void QueryScheduler::dispatchPending()
+{
+    if (!m_hasPending) {
+        return;
+    }
+
+    m_hasPending = false;
+    m_inFlightQuery = m_pendingQuery;
+    m_inFlightToken = QueryCancelToken();
+    m_inFlight = true;
+    ++m_generation;
+
+    emit queryStarted(m_inFlightQuery);
+    emit runRequested(m_inFlightQuery, m_inFlightToken, m_generation);
+}
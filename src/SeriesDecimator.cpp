@@ -0,0 +1,148 @@
+#include "SeriesDecimator.h"
+#include <QtMath>
+
+namespace {
+/**
+ * @brief 追加点，与上一个点相同时跳过
+ */
+void appendPoint(QVector<QPointF> &points, const QPointF &point)
+{
+    if (points.isEmpty() || points.last() != point) {
+        points.append(point);
+    }
+}
+
+double bucketMiddle(const TimeBucketer &bucketer, int index)
+{
+    return (bucketer.bucketStart(index) + bucketer.bucketEnd(index)) / 2.0;
+}
+}
+
+QVector<QPointF> SeriesDecimator::decimate(Mode mode, const TimeBucketer &bucketer,
+                                           const QVector<BucketAggregate> &buckets,
+                                           qint64 startMs, qint64 endMs, int columns)
+{
+    QVector<QPointF> points;
+    if (!bucketer.isValid() || endMs <= startMs || columns <= 0 ||
+        startMs >= bucketer.endMs() || endMs <= bucketer.startMs()) {
+        return points;
+    }
+
+    // 与范围相交的桶
+    const int bucketCount = qMin(bucketer.bucketCount(), buckets.size());
+    const int first = startMs <= bucketer.startMs() ? 0 : bucketer.bucketIndex(startMs);
+    const int last = qMin(endMs >= bucketer.endMs() ? bucketCount : bucketer.bucketIndex(endMs - 1) + 1,
+                          bucketCount);
+
+    if (mode == Lttb) {
+        QVector<QPointF> averages;
+        averages.reserve(last - first);
+        for (int i = first; i < last; ++i) {
+            if (!buckets.at(i).isEmpty()) {
+                averages.append(QPointF(bucketMiddle(bucketer, i), buckets.at(i).average()));
+            }
+        }
+        return largestTriangleThreeBuckets(averages.constData(), averages.size(), columns);
+    }
+
+    const double msPerColumn = static_cast<double>(endMs - startMs) / columns;
+    points.reserve(qMin(last - first, 4 * columns));
+
+    int column = -1;
+    int bucketsInColumn = 0;
+    double singleX = 0.0;
+    BucketAggregate merged;
+    auto flush = [&]() {
+        if (bucketsInColumn == 1) {
+            // 桶比像素宽时按桶绘制平均值折线
+            appendPoint(points, QPointF(singleX, merged.average()));
+        } else if (bucketsInColumn > 1) {
+            const double x = startMs + (column + 0.5) * msPerColumn;
+            appendPoint(points, QPointF(x, merged.first));
+            appendPoint(points, QPointF(x, merged.min));
+            appendPoint(points, QPointF(x, merged.max));
+            appendPoint(points, QPointF(x, merged.last));
+        }
+    };
+
+    for (int i = first; i < last; ++i) {
+        const BucketAggregate &bucket = buckets.at(i);
+        if (bucket.isEmpty()) {
+            continue;
+        }
+
+        const double x = bucketMiddle(bucketer, i);
+        const int bucketColumn = qBound(0, static_cast<int>((x - startMs) / msPerColumn), columns - 1);
+        if (bucketColumn != column) {
+            flush();
+            column = bucketColumn;
+            bucketsInColumn = 0;
+            merged = BucketAggregate();
+        }
+        merged.merge(bucket);
+        singleX = x;
+        ++bucketsInColumn;
+    }
+    flush();
+
+    return points;
+}
+
+QVector<QPointF> SeriesDecimator::largestTriangleThreeBuckets(const QPointF *points, int count, int threshold)
+{
+    QVector<QPointF> result;
+    if (count <= 0) {
+        return result;
+    }
+    if (threshold < 3 || threshold >= count) {
+        result.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            result.append(points[i]);
+        }
+        return result;
+    }
+
+    result.reserve(threshold);
+    result.append(points[0]);
+
+    // 首尾两点之外的点平均分组
+    const double groupSize = static_cast<double>(count - 2) / (threshold - 2);
+    int selected = 0;
+    for (int group = 0; group < threshold - 2; ++group) {
+        // 下一组的平均点作为三角形的第三个顶点
+        const int nextStart = static_cast<int>(qFloor((group + 1) * groupSize)) + 1;
+        const int nextEnd = qMin(static_cast<int>(qFloor((group + 2) * groupSize)) + 1, count);
+        double nextX = 0.0;
+        double nextY = 0.0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            nextX += points[i].x();
+            nextY += points[i].y();
+        }
+        const int nextCount = nextEnd - nextStart;
+        if (nextCount > 0) {
+            nextX /= nextCount;
+            nextY /= nextCount;
+        }
+
+        // 当前组中与上一个选中点构成最大三角形的点
+        const int groupStart = static_cast<int>(qFloor(group * groupSize)) + 1;
+        const int groupEnd = static_cast<int>(qFloor((group + 1) * groupSize)) + 1;
+        const QPointF &anchor = points[selected];
+        double maxArea = -1.0;
+        int best = groupStart;
+        for (int i = groupStart; i < groupEnd; ++i) {
+            const double area = qAbs((anchor.x() - nextX) * (points[i].y() - anchor.y()) -
+                                     (anchor.x() - points[i].x()) * (nextY - anchor.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                best = i;
+            }
+        }
+
+        result.append(points[best]);
+        selected = best;
+    }
+
+    result.append(points[count - 1]);
+    return result;
+}
@@ -0,0 +1,95 @@
+#include "SparklineBuffer.h"
+
+SparklineBuffer::SparklineBuffer(int capacity, QObject *parent)
+    : QObject(parent)
+    , m_capacity(qMax(2, capacity))
+    , m_nextRevision(0)
+{
+}
+
+void SparklineBuffer::append(const QString &deviceId, double value)
+{
+    appendValues(deviceId, &value, 1);
+    notifyAppended(QStringList(deviceId));
+}
+
+void SparklineBuffer::appendValues(const QString &deviceId, const double *values, int count, int replaceLast)
+{
+    if (count <= 0 && replaceLast <= 0) {
+        return;
+    }
+
+    Ring &r = ring(deviceId);
+    r.size -= qBound(0, replaceLast, r.size);
+
+    // 超过容量的部分只保留最后capacity个
+    if (count > m_capacity) {
+        values += count - m_capacity;
+        count = m_capacity;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (r.size < m_capacity) {
+            r.values[(r.head + r.size) % m_capacity] = values[i];
+            ++r.size;
+        } else {
+            r.values[r.head] = values[i];
+            r.head = (r.head + 1) % m_capacity;
+        }
+    }
+    r.revision = ++m_nextRevision;
+}
+
+void SparklineBuffer::assign(const QString &deviceId, const QVector<double> &values)
+{
+    Ring &r = ring(deviceId);
+    r.head = 0;
+    r.size = 0;
+    appendValues(deviceId, values.constData(), values.size());
+    r.revision = ++m_nextRevision;
+}
+
+void SparklineBuffer::notifyAppended(const QStringList &deviceIds)
+{
+    if (!deviceIds.isEmpty()) {
+        emit samplesAppended(deviceIds);
+    }
+}
+
+QVector<double> SparklineBuffer::values(const QString &deviceId) const
+{
+    QVector<double> result;
+    auto it = m_rings.constFind(deviceId);
+    if (it == m_rings.constEnd()) {
+        return result;
+    }
+
+    const Ring &r = it.value();
+    result.reserve(r.size);
+    for (int i = 0; i < r.size; ++i) {
+        result.append(r.values.at((r.head + i) % m_capacity));
+    }
+    return result;
+}
+
+quint64 SparklineBuffer::revision(const QString &deviceId) const
+{
+    auto it = m_rings.constFind(deviceId);
+    return it == m_rings.constEnd() ? 0 : it.value().revision;
+}
+
+void SparklineBuffer::clear()
+{
+    const QStringList deviceIds = m_rings.keys();
+    m_rings.clear();
+    notifyAppended(deviceIds);
+}
+
+SparklineBuffer::Ring &SparklineBuffer::ring(const QString &deviceId)
+{
+    auto it = m_rings.find(deviceId);
+    if (it == m_rings.end()) {
+        it = m_rings.insert(deviceId, Ring());
+        it.value().values.resize(m_capacity);
+    }
+    return it.value();
+}
@@ -0,0 +1,143 @@
+#include "SparklineDelegate.h"
+#include "SparklineBuffer.h"
+#include <QApplication>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyle>
+#include <QtMath>
+#include <QtNumeric>
+
+namespace {
+// 折线图与单元格边缘的距离（像素）
+const int SparklineMargin = 2;
+// 折线图列的默认宽度（像素）
+const int SparklineWidth = 80;
+// 默认缓存的位图数，远大于一屏的行数
+const int DefaultCacheCapacity = 1024;
+}
+
+SparklineDelegate::SparklineDelegate(const SparklineBuffer *buffer, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_buffer(buffer)
+    , m_cache(DefaultCacheCapacity)
+    , m_renderCount(0)
+{
+}
+
+void SparklineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                              const QModelIndex &index) const
+{
+    // 背景（交替行颜色、选中高亮）交给样式绘制
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, widget);
+
+    if (!m_buffer) {
+        return;
+    }
+    const QString deviceId = index.data(Qt::UserRole).toString();
+    const quint64 revision = m_buffer->revision(deviceId);
+    const QRect rect = option.rect.adjusted(SparklineMargin, SparklineMargin, -SparklineMargin, -SparklineMargin);
+    if (deviceId.isEmpty() || revision == 0 || rect.isEmpty()) {
+        return;
+    }
+
+    const bool selected = option.state & QStyle::State_Selected;
+    const qreal ratio = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    const QSize pixelSize(qCeil(rect.width() * ratio), qCeil(rect.height() * ratio));
+
+    CachedSparkline *cached = m_cache.object(deviceId);
+    if (!cached || cached->revision != revision || cached->selected != selected ||
+        cached->pixmap.size() != pixelSize) {
+        const QColor color = selected ? opt.palette.color(QPalette::HighlightedText) : QColor("#4a9eff");
+        cached = new CachedSparkline;
+        cached->pixmap = render(m_buffer->values(deviceId), rect.size(), ratio, color);
+        cached->revision = revision;
+        cached->selected = selected;
+        m_cache.insert(deviceId, cached);
+    }
+
+    painter->drawPixmap(rect.topLeft(), cached->pixmap);
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    return QSize(SparklineWidth, QStyledItemDelegate::sizeHint(option, index).height());
+}
+
+void SparklineDelegate::setCacheCapacity(int count)
+{
+    m_cache.setMaxCost(qMax(1, count));
+}
+
+void SparklineDelegate::invalidate()
+{
+    m_cache.clear();
+}
+
+QPixmap SparklineDelegate::render(const QVector<double> &values, const QSize &size,
+                                  qreal ratio, const QColor &color) const
+{
+    ++m_renderCount;
+
+    QPixmap pixmap(qCeil(size.width() * ratio), qCeil(size.height() * ratio));
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    // 纵轴范围取有效数值的最小/最大值
+    double minValue = 0.0;
+    double maxValue = 0.0;
+    bool hasValue = false;
+    for (double value : values) {
+        if (qIsNaN(value)) {
+            continue;
+        }
+        minValue = hasValue ? qMin(minValue, value) : value;
+        maxValue = hasValue ? qMax(maxValue, value) : value;
+        hasValue = true;
+    }
+    if (!hasValue) {
+        return pixmap;
+    }
+
+    const double width = size.width() - 1;
+    const double height = size.height() - 1;
+    const double step = values.size() > 1 ? width / (values.size() - 1) : 0.0;
+    const double range = maxValue - minValue;
+    auto pointAt = [&](int i) {
+        // 数值不变时画在中间
+        const double y = range > 0.0 ? height - (values.at(i) - minValue) / range * height : height / 2.0;
+        return QPointF(i * step, y);
+    };
+
+    // 空桶（NaN）处断开折线
+    QPainterPath path;
+    bool penDown = false;
+    for (int i = 0; i < values.size(); ++i) {
+        if (qIsNaN(values.at(i))) {
+            penDown = false;
+            continue;
+        }
+        if (penDown) {
+            path.lineTo(pointAt(i));
+        } else {
+            path.moveTo(pointAt(i));
+            penDown = true;
+        }
+    }
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(color, 1.0));
+    painter.drawPath(path);
+
+    // 标出最新的值
+    if (!qIsNaN(values.last())) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(color);
+        painter.drawEllipse(pointAt(values.size() - 1), 1.5, 1.5);
+    }
+    return pixmap;
+}
@@ -0,0 +1,64 @@
+#include "StringPool.h"
+
+namespace {
+// QSet节点的额外开销：next指针和哈希值
+const int NodeOverhead = sizeof(void *) + sizeof(uint);
+}
+
+StringPool::StringPool()
+    : m_bytes(0)
+{
+}
+
+StringPool &StringPool::global()
+{
+    static StringPool pool;
+    return pool;
+}
+
+QString StringPool::intern(const QString &text)
+{
+    if (text.isEmpty()) {
+        return text;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_strings.constFind(text);
+    if (it != m_strings.constEnd()) {
+        return *it;
+    }
+    m_bytes += stringBytes(text) + static_cast<qint64>(sizeof(QString)) + NodeOverhead;
+    return *m_strings.insert(text);
+}
+
+bool StringPool::owns(const QString &text) const
+{
+    if (text.isEmpty()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_strings.constFind(text);
+    return it != m_strings.constEnd() && it->constData() == text.constData();
+}
+
+int StringPool::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_strings.size();
+}
+
+qint64 StringPool::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bytes;
+}
+
+qint64 StringPool::stringBytes(const QString &text)
+{
+    if (text.isEmpty()) {
+        return 0;
+    }
+    // 数据块头部加上含结尾0的UTF-16字符
+    return static_cast<qint64>(sizeof(QArrayData)) + (text.capacity() + 1) * static_cast<qint64>(sizeof(QChar));
+}
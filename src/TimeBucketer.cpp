@@ -0,0 +1,186 @@
+#include "TimeBucketer.h"
+#include <QDateTime>
+#include <algorithm>
+
+namespace {
+const qint64 MsPer15Minutes = 15 * 60 * 1000LL;
+const qint64 MsPerHour = 60 * 60 * 1000LL;
+const qint64 MsPerDay = 24 * MsPerHour;
+}
+
+TimeBucketer::TimeBucketer()
+    : m_granularity(TimeWidget::Hour1)
+    , m_widthMs(MsPerHour)
+    , m_originMs(0)
+    , m_bucketCount(0)
+    , m_firstOrdinal(0)
+{
+}
+
+TimeBucketer::TimeBucketer(qint64 startMs, qint64 endMs,
+                           TimeWidget::TimeGranularity granularity,
+                           const QTimeZone &zone)
+    : m_granularity(granularity)
+    , m_widthMs(granularityMs(granularity))
+    , m_originMs(startMs)
+    , m_bucketCount(0)
+    , m_firstOrdinal(0)
+{
+    if (endMs <= startMs) {
+        return;
+    }
+
+    // 跳变表多覆盖两天，保证对齐后的边界也能查到正确偏移
+    buildTransitionTable(zone, startMs - 2 * MsPerDay, endMs + 2 * MsPerDay);
+
+    if (granularity == TimeWidget::Day1) {
+        // 按本地日期划分，每天的起点由本地零点换算回UTC
+        const qint64 firstDay = floorDiv(startMs + offsetAt(startMs), MsPerDay);
+        const qint64 lastDay = floorDiv(endMs - 1 + offsetAt(endMs - 1), MsPerDay);
+
+        m_firstOrdinal = firstDay;
+        m_bucketCount = static_cast<int>(lastDay - firstDay + 1);
+        m_dayStarts.reserve(m_bucketCount + 1);
+        for (qint64 day = firstDay; day <= lastDay + 1; ++day) {
+            m_dayStarts.append(localToUtc(day * MsPerDay));
+        }
+        m_originMs = m_dayStarts.first();
+    } else {
+        // 固定宽度的桶按本地时钟对齐（兼容非整点时区）
+        const qint64 offset = offsetAt(startMs);
+        m_originMs = floorDiv(startMs + offset, m_widthMs) * m_widthMs - offset;
+        // 全局序号按UTC起点计算，跨越夏令时切换的查询之间保持一致
+        m_firstOrdinal = floorDiv(m_originMs, m_widthMs);
+        m_bucketCount = static_cast<int>((endMs - m_originMs + m_widthMs - 1) / m_widthMs);
+    }
+}
+
+qint64 TimeBucketer::granularityMs(TimeWidget::TimeGranularity granularity)
+{
+    switch (granularity) {
+    case TimeWidget::Minutes15:
+        return MsPer15Minutes;
+    case TimeWidget::Hour1:
+        return MsPerHour;
+    case TimeWidget::Day1:
+        return MsPerDay;
+    }
+    return MsPerHour;
+}
+
+qint64 TimeBucketer::bucketStart(int index) const
+{
+    if (m_granularity == TimeWidget::Day1) {
+        if (m_dayStarts.isEmpty()) {
+            return m_originMs;
+        }
+        return m_dayStarts.at(index);
+    }
+    return m_originMs + index * m_widthMs;
+}
+
+int TimeBucketer::bucketIndex(qint64 timestampMs) const
+{
+    if (!isValid() || timestampMs < startMs() || timestampMs >= endMs()) {
+        return -1;
+    }
+
+    if (m_granularity != TimeWidget::Day1) {
+        return static_cast<int>((timestampMs - m_originMs) / m_widthMs);
+    }
+
+    int index = static_cast<int>(floorDiv(timestampMs + offsetAt(timestampMs), MsPerDay) - m_firstOrdinal);
+    index = qBound(0, index, m_bucketCount - 1);
+
+    // 零点落在跳变空档内时，本地日期与桶可能错开一位
+    while (index > 0 && timestampMs < m_dayStarts.at(index)) {
+        --index;
+    }
+    while (index < m_bucketCount - 1 && timestampMs >= m_dayStarts.at(index + 1)) {
+        ++index;
+    }
+    return index;
+}
+
+QVector<qint64> TimeBucketer::boundaries() const
+{
+    if (!isValid()) {
+        return QVector<qint64>();
+    }
+
+    if (m_granularity == TimeWidget::Day1) {
+        return m_dayStarts;
+    }
+
+    QVector<qint64> result(m_bucketCount + 1);
+    qint64 *out = result.data();
+    for (int i = 0; i <= m_bucketCount; ++i) {
+        out[i] = m_originMs + i * m_widthMs;
+    }
+    return result;
+}
+
+bool TimeBucketer::operator==(const TimeBucketer &other) const
+{
+    return m_granularity == other.m_granularity &&
+           m_bucketCount == other.m_bucketCount &&
+           m_originMs == other.m_originMs &&
+           endMs() == other.endMs();
+}
+
+void TimeBucketer::buildTransitionTable(const QTimeZone &zone, qint64 fromMs, qint64 toMs)
+{
+    m_transitionsMs.clear();
+    m_offsetsMs.clear();
+
+    if (!zone.isValid()) {
+        m_offsetsMs.append(0);
+        return;
+    }
+
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(fromMs, Qt::UTC);
+    const QDateTime to = QDateTime::fromMSecsSinceEpoch(toMs, Qt::UTC);
+    m_offsetsMs.append(zone.offsetFromUtc(from) * 1000LL);
+
+    if (zone.hasTransitions()) {
+        const QTimeZone::OffsetDataList transitions = zone.transitions(from, to);
+        for (const QTimeZone::OffsetData &transition : transitions) {
+            m_transitionsMs.append(transition.atUtc.toMSecsSinceEpoch());
+            m_offsetsMs.append(transition.offsetFromUtc * 1000LL);
+        }
+    }
+}
+
+qint64 TimeBucketer::offsetAt(qint64 utcMs) const
+{
+    if (m_offsetsMs.isEmpty()) {
+        return 0;
+    }
+
+    // 跳变表通常每年只有两项，二分查找的代价可以忽略
+    const auto it = std::upper_bound(m_transitionsMs.constBegin(), m_transitionsMs.constEnd(), utcMs);
+    return m_offsetsMs.at(static_cast<int>(it - m_transitionsMs.constBegin()));
+}
+
+qint64 TimeBucketer::localToUtc(qint64 localMs) const
+{
+    const qint64 offset = offsetAt(localMs - offsetAt(localMs));
+    const qint64 utcMs = localMs - offset;
+    if (offsetAt(utcMs) == offset) {
+        return utcMs;
+    }
+
+    // 本地时间落在跳变空档内（例如零点被跳过），该日从跳变时刻开始
+    const qint64 lower = qMin(utcMs, localMs - offsetAt(utcMs));
+    const auto it = std::upper_bound(m_transitionsMs.constBegin(), m_transitionsMs.constEnd(), lower);
+    return it != m_transitionsMs.constEnd() ? *it : utcMs;
+}
+
+qint64 TimeBucketer::floorDiv(qint64 value, qint64 divisor)
+{
+    qint64 quotient = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+        --quotient;
+    }
+    return quotient;
+}
@@ -0,0 +1,783 @@
+#include "TimeSeriesStore.h"
+#include "AggregationKernels.h"
+#include "QueryResultCache.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// 预聚合层文件头：8字节标识 + 对齐所用时区的ID（补零），之后是定长记录
+const char RollupMagic[8] = {'T', 'S', 'R', 'O', 'L', 'L', 'U', 'P'};
+const int RollupHeaderSize = 64;
+
+// 预聚合层，由粗到细排列
+const TimeWidget::TimeGranularity RollupTiers[] = {
+    TimeWidget::Day1, TimeWidget::Hour1, TimeWidget::Minutes15
+};
+
+/**
+ * @brief 预聚合层中一个时间桶的记录
+ */
+struct RollupRecord {
+    qint64 ordinal;  // 全局桶序号
+    qint64 count;
+    double sum;
+    double min;
+    double max;
+    double first;
+    double last;
+};
+static_assert(sizeof(RollupRecord) == 56, "RollupRecord must be tightly packed");
+
+QByteArray rollupHeader(const QTimeZone &zone)
+{
+    QByteArray header(RollupHeaderSize, '\0');
+    std::memcpy(header.data(), RollupMagic, sizeof(RollupMagic));
+    const QByteArray zoneId = zone.id().left(RollupHeaderSize - static_cast<int>(sizeof(RollupMagic)));
+    std::memcpy(header.data() + sizeof(RollupMagic), zoneId.constData(), zoneId.size());
+    return header;
+}
+
+BucketAggregate toAggregate(const RollupRecord &record)
+{
+    BucketAggregate aggregate;
+    aggregate.count = record.count;
+    aggregate.sum = record.sum;
+    aggregate.min = record.min;
+    aggregate.max = record.max;
+    aggregate.first = record.first;
+    aggregate.last = record.last;
+    return aggregate;
+}
+
+RollupRecord toRecord(qint64 ordinal, const BucketAggregate &aggregate)
+{
+    RollupRecord record;
+    record.ordinal = ordinal;
+    record.count = aggregate.count;
+    record.sum = aggregate.sum;
+    record.min = aggregate.min;
+    record.max = aggregate.max;
+    record.first = aggregate.first;
+    record.last = aggregate.last;
+    return record;
+}
+
+/**
+ * @brief 追加记录，与最后一条记录同序号时合并（跨数据块的同一个桶）
+ */
+void appendRecord(QVector<RollupRecord> &records, const RollupRecord &record)
+{
+    if (!records.isEmpty() && records.last().ordinal == record.ordinal) {
+        BucketAggregate merged = toAggregate(records.last());
+        merged.merge(toAggregate(record));
+        records.last() = toRecord(record.ordinal, merged);
+    } else {
+        records.append(record);
+    }
+}
+
+/**
+ * @brief 把一段聚合结果中的非空桶转换为记录
+ */
+void appendRecords(QVector<RollupRecord> &records, const TimeBucketer &bucketer,
+                   const QVector<BucketAggregate> &buckets)
+{
+    for (int i = 0; i < buckets.size(); ++i) {
+        if (!buckets.at(i).isEmpty()) {
+            appendRecord(records, toRecord(bucketer.firstOrdinal() + i, buckets.at(i)));
+        }
+    }
+}
+
+bool hasValidHeader(QFile &file, const QByteArray &header)
+{
+    return file.size() >= RollupHeaderSize && file.seek(0) && file.read(RollupHeaderSize) == header;
+}
+
+/**
+ * @brief 一个数据块的两列样本，优先内存映射，文件系统不支持时退回整块读取
+ */
+struct ChunkColumns {
+    const qint64 *timestamps = nullptr;
+    const double *values = nullptr;
+    qint64 count = 0;
+    QByteArray tsBuffer;
+    QByteArray valBuffer;
+
+    /**
+     * @brief 映射已打开的两个列文件
+     * @return 读取成功时返回true，空块也返回true（count为0）
+     */
+    bool load(QFile &tsFile, QFile &valFile)
+    {
+        // 写入可能正在进行，以两列中较短的一列为准
+        count = qMin(tsFile.size() / static_cast<qint64>(sizeof(qint64)),
+                     valFile.size() / static_cast<qint64>(sizeof(double)));
+        if (count <= 0) {
+            count = 0;
+            return true;
+        }
+
+        timestamps = reinterpret_cast<const qint64 *>(tsFile.map(0, count * sizeof(qint64)));
+        values = reinterpret_cast<const double *>(valFile.map(0, count * sizeof(double)));
+        if (timestamps && values) {
+            return true;
+        }
+
+        tsBuffer = tsFile.read(count * sizeof(qint64));
+        valBuffer = valFile.read(count * sizeof(double));
+        if (tsBuffer.size() != count * static_cast<qint64>(sizeof(qint64)) ||
+            valBuffer.size() != count * static_cast<qint64>(sizeof(double))) {
+            return false;
+        }
+        timestamps = reinterpret_cast<const qint64 *>(tsBuffer.constData());
+        values = reinterpret_cast<const double *>(valBuffer.constData());
+        return true;
+    }
+};
+}
+
+TimeSeriesStore::TimeSeriesStore(const QString &rootPath, qint64 chunkSpanMs)
+    : m_rootPath(rootPath)
+    , m_chunkSpanMs(chunkSpanMs > 0 ? chunkSpanMs : 24 * 60 * 60 * 1000LL)
+    , m_resultCache(nullptr)
+    , m_zone(QTimeZone::systemTimeZone())
+    , m_rollupsEnabled(true)
+{
+    if (!QDir().mkpath(m_rootPath)) {
+        m_lastError = QString("无法创建数据目录: %1").arg(m_rootPath);
+        qWarning() << "TimeSeriesStore:" << m_lastError;
+    }
+}
+
+QString TimeSeriesStore::defaultRootPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/timeseries";
+}
+
+bool TimeSeriesStore::append(const QString &deviceId, const qint64 *timestamps, const double *values, int count)
+{
+    if (deviceId.isEmpty() || !timestamps || !values) {
+        m_lastError = "无效的写入参数";
+        return false;
+    }
+
+    if (count <= 0) {
+        return true;
+    }
+
+    for (int i = 1; i < count; ++i) {
+        if (timestamps[i] < timestamps[i - 1]) {
+            m_lastError = QString("设备 %1 的样本时间戳必须递增").arg(deviceId);
+            return false;
+        }
+    }
+
+    if (!QDir().mkpath(deviceDirectory(deviceId))) {
+        m_lastError = QString("无法创建设备数据目录: %1").arg(deviceDirectory(deviceId));
+        return false;
+    }
+
+    // 样本不早于设备已有的全部样本时才能增量更新预聚合层
+    const QVector<qint64> starts = loadChunkIndex(deviceId);
+    const bool hadSamples = !starts.isEmpty();
+    qint64 lastTimestamp = 0;
+    const bool inOrder = !hadSamples || !readLastTimestamp(deviceId, starts.last(), lastTimestamp) ||
+                         timestamps[0] >= lastTimestamp;
+
+    // 按数据块拆分后逐块追加
+    int begin = 0;
+    while (begin < count) {
+        const qint64 chunkStart = chunkStartFor(timestamps[begin]);
+        int end = begin + 1;
+        while (end < count && timestamps[end] < chunkStart + m_chunkSpanMs) {
+            ++end;
+        }
+
+        if (!appendToChunk(deviceId, chunkStart, timestamps + begin, values + begin, end - begin)) {
+            // 前面的数据块已经落盘，预聚合层和缓存仍需与之保持一致
+            if (begin > 0) {
+                const QString error = m_lastError;
+                if (!rebuildRollups(deviceId)) {
+                    qWarning() << "TimeSeriesStore:" << m_lastError;
+                }
+                if (m_resultCache) {
+                    m_resultCache->invalidateFrom(deviceId, timestamps[0]);
+                }
+                m_lastError = error;
+            }
+            return false;
+        }
+        begin = end;
+    }
+
+    // 原始样本已落盘；预聚合层无法增量更新时从原始样本重建，
+    // 重建失败则删除预聚合层，查询回退到原始样本，不影响本次写入
+    if (!(inOrder && updateRollups(deviceId, timestamps, values, count, hadSamples)) &&
+        !rebuildRollups(deviceId)) {
+        qWarning() << "TimeSeriesStore:" << m_lastError;
+    }
+
+    // 新样本可能落入已缓存的桶，使其及之后的缓存失效
+    if (m_resultCache) {
+        m_resultCache->invalidateFrom(deviceId, timestamps[0]);
+    }
+
+    return true;
+}
+
+bool TimeSeriesStore::append(const QString &deviceId, qint64 timestampMs, double value)
+{
+    return append(deviceId, &timestampMs, &value, 1);
+}
+
+TimeSeriesQueryResult TimeSeriesStore::query(const TimeSeriesQuery &query) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    TimeSeriesQueryResult result;
+    result.bucketer = TimeBucketer(query.startMs, query.endMs, query.granularity);
+
+    if (query.isValid() && result.bucketer.isValid()) {
+        result.series.reserve(query.deviceIds.size());
+        for (const QString &deviceId : query.deviceIds) {
+            qint64 scanned = 0;
+            qint64 buckets = 0;
+            result.series.append(DeviceSeries(deviceId, queryDevice(deviceId, result.bucketer, &scanned, &buckets)));
+            result.samplesScanned += scanned;
+            result.bucketsScanned += buckets;
+        }
+    }
+
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
+
+QVector<BucketAggregate> TimeSeriesStore::queryDevice(const QString &deviceId, const TimeBucketer &bucketer,
+                                                      qint64 *samplesScanned, qint64 *bucketsScanned) const
+{
+    if (!m_resultCache) {
+        return aggregateDevice(deviceId, bucketer, 0, bucketer.bucketCount(), samplesScanned, bucketsScanned);
+    }
+
+    QVector<BucketAggregate> result;
+    qint64 scanned = 0;
+    qint64 scannedBuckets = 0;
+
+    // 只聚合缓存中缺失的空档，并写回缓存；期间有新样本写入则不写回
+    quint64 generation = 0;
+    const QVector<QueryResultCache::Segment> gaps = m_resultCache->lookup(deviceId, bucketer, result, &generation);
+    for (const QueryResultCache::Segment &gap : gaps) {
+        qint64 gapScanned = 0;
+        qint64 gapBuckets = 0;
+        const QVector<BucketAggregate> buckets =
+            aggregateDevice(deviceId, bucketer, gap.firstBucket, gap.bucketCount, &gapScanned, &gapBuckets);
+        std::copy(buckets.constBegin(), buckets.constEnd(), result.begin() + gap.firstBucket);
+        m_resultCache->insertIfCurrent(deviceId, bucketer, gap.firstBucket, buckets, generation);
+        scanned += gapScanned;
+        scannedBuckets += gapBuckets;
+    }
+
+    if (samplesScanned) {
+        *samplesScanned = scanned;
+    }
+    if (bucketsScanned) {
+        *bucketsScanned = scannedBuckets;
+    }
+    return result;
+}
+
+QVector<BucketAggregate> TimeSeriesStore::aggregateDevice(const QString &deviceId, const TimeBucketer &bucketer,
+                                                          int firstBucket, int bucketCount,
+                                                          qint64 *samplesScanned, qint64 *bucketsScanned) const
+{
+    QVector<BucketAggregate> result(qMax(0, bucketCount));
+    qint64 scanned = 0;
+    qint64 scannedBuckets = 0;
+
+    if (bucketer.isValid() && bucketCount > 0 && firstBucket >= 0 &&
+        firstBucket + bucketCount <= bucketer.bucketCount()) {
+        QVector<qint64> boundaries(bucketCount + 1);
+        for (int i = 0; i <= bucketCount; ++i) {
+            boundaries[i] = bucketer.bucketStart(firstBucket + i);
+        }
+        const qint64 rangeStart = boundaries.first();
+        const qint64 rangeEnd = boundaries.last();
+
+        // 优先读取可用的最粗预聚合层
+        bool fromRollup = false;
+        if (m_rollupsEnabled) {
+            QReadLocker locker(&m_rollupLock);
+            TimeBucketer tierBucketer;
+            QVector<int> tierToBucket;
+            const StorageTier tier = planTier(deviceId, boundaries.constData(), bucketCount,
+                                              bucketer.granularity(), tierBucketer, tierToBucket);
+            if (tier != RawSamples) {
+                const qint64 samples = aggregateRollup(deviceId, tierBucketer.granularity(), tierBucketer,
+                                                       tierToBucket, result.data());
+                if (samples >= 0) {
+                    scanned = samples;
+                    fromRollup = true;
+                }
+            }
+        }
+
+        // 块起点已排序，按时间顺序聚合与范围相交的块
+        const QVector<qint64> starts = fromRollup ? QVector<qint64>() : loadChunkIndex(deviceId);
+        for (qint64 chunkStart : starts) {
+            if (chunkStart + m_chunkSpanMs <= rangeStart) {
+                continue;
+            }
+            if (chunkStart >= rangeEnd) {
+                break;
+            }
+            scanned += aggregateChunk(deviceId, chunkStart, boundaries.constData(), bucketCount, result.data());
+        }
+        if (!fromRollup) {
+            scannedBuckets = bucketCount;
+        }
+    }
+
+    if (samplesScanned) {
+        *samplesScanned = scanned;
+    }
+    if (bucketsScanned) {
+        *bucketsScanned = scannedBuckets;
+    }
+    return result;
+}
+
+TimeSeriesStore::StorageTier TimeSeriesStore::selectTier(const QString &deviceId, const TimeBucketer &bucketer,
+                                                         int firstBucket, int bucketCount) const
+{
+    if (!m_rollupsEnabled || !bucketer.isValid() || bucketCount <= 0 || firstBucket < 0 ||
+        firstBucket + bucketCount > bucketer.bucketCount()) {
+        return RawSamples;
+    }
+
+    QVector<qint64> boundaries(bucketCount + 1);
+    for (int i = 0; i <= bucketCount; ++i) {
+        boundaries[i] = bucketer.bucketStart(firstBucket + i);
+    }
+
+    QReadLocker locker(&m_rollupLock);
+    TimeBucketer tierBucketer;
+    QVector<int> tierToBucket;
+    return planTier(deviceId, boundaries.constData(), bucketCount, bucketer.granularity(),
+                    tierBucketer, tierToBucket);
+}
+
+bool TimeSeriesStore::rebuildRollups(const QString &deviceId)
+{
+    QWriteLocker locker(&m_rollupLock);
+    const QByteArray header = rollupHeader(m_zone);
+    const QVector<qint64> starts = loadChunkIndex(deviceId);
+
+    for (TimeWidget::TimeGranularity tier : RollupTiers) {
+        // 逐块聚合，相邻块中属于同一个桶的记录在追加时合并
+        QVector<RollupRecord> records;
+        for (qint64 chunkStart : starts) {
+            const TimeBucketer bucketer(chunkStart, chunkStart + m_chunkSpanMs, tier, m_zone);
+            const QVector<qint64> boundaries = bucketer.boundaries();
+            QVector<BucketAggregate> buckets(bucketer.bucketCount());
+            aggregateChunk(deviceId, chunkStart, boundaries.constData(), bucketer.bucketCount(), buckets.data());
+            appendRecords(records, bucketer, buckets);
+        }
+
+        const qint64 recordBytes = static_cast<qint64>(records.size()) * sizeof(RollupRecord);
+        QSaveFile file(rollupPath(deviceId, tier));
+        if (!file.open(QIODevice::WriteOnly) || file.write(header) != header.size() ||
+            file.write(reinterpret_cast<const char *>(records.constData()), recordBytes) != recordBytes ||
+            !file.commit()) {
+            m_lastError = QString("无法重建预聚合层: %1").arg(file.fileName());
+            locker.unlock();
+            removeRollups(deviceId);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+qint64 TimeSeriesStore::scanSamples(const QString &deviceId, qint64 startMs, qint64 endMs,
+                                    const SampleVisitor &visitor, QString *error) const
+{
+    qint64 visited = 0;
+    if (endMs <= startMs) {
+        return visited;
+    }
+
+    const QVector<qint64> starts = loadChunkIndex(deviceId);
+    auto it = std::lower_bound(starts.constBegin(), starts.constEnd(), chunkStartFor(startMs));
+    for (; it != starts.constEnd() && *it < endMs; ++it) {
+        QFile tsFile(chunkPath(deviceId, *it, "ts"));
+        QFile valFile(chunkPath(deviceId, *it, "val"));
+        ChunkColumns columns;
+        // 索引中的数据块读不出来时停止，不能跳过而让调用方得到缺失样本的结果
+        if (!tsFile.open(QIODevice::ReadOnly) || !valFile.open(QIODevice::ReadOnly) ||
+            !columns.load(tsFile, valFile)) {
+            if (error) {
+                *error = QString("无法读取数据块: %1 (%2)")
+                             .arg(tsFile.fileName(), tsFile.error() != QFile::NoError ? tsFile.errorString()
+                                                                                      : valFile.errorString());
+            }
+            break;
+        }
+
+        const qint64 *tsEnd = columns.timestamps + columns.count;
+        const qint64 *first = std::lower_bound(columns.timestamps, tsEnd, startMs);
+        const qint64 *last = std::lower_bound(first, tsEnd, endMs);
+        const qint64 count = last - first;
+        if (count <= 0) {
+            continue;
+        }
+
+        visited += count;
+        if (!visitor(first, columns.values + (first - columns.timestamps), count)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+QVector<qint64> TimeSeriesStore::chunkStarts(const QString &deviceId) const
+{
+    return loadChunkIndex(deviceId);
+}
+
+QString TimeSeriesStore::deviceDirectory(const QString &deviceId) const
+{
+    // 设备ID经过百分号编码，避免路径分隔符等特殊字符
+    return m_rootPath + "/" + QString::fromLatin1(QUrl::toPercentEncoding(deviceId, QByteArray(), "."));
+}
+
+QString TimeSeriesStore::chunkPath(const QString &deviceId, qint64 chunkStart, const QString &suffix) const
+{
+    return deviceDirectory(deviceId) + "/" + QString::number(chunkStart) + "." + suffix;
+}
+
+QString TimeSeriesStore::rollupPath(const QString &deviceId, TimeWidget::TimeGranularity tier) const
+{
+    QString name;
+    switch (tier) {
+    case TimeWidget::Minutes15:
+        name = "15m";
+        break;
+    case TimeWidget::Hour1:
+        name = "1h";
+        break;
+    case TimeWidget::Day1:
+        name = "1d";
+        break;
+    }
+    return deviceDirectory(deviceId) + "/rollup-" + name + ".bin";
+}
+
+qint64 TimeSeriesStore::chunkStartFor(qint64 timestampMs) const
+{
+    qint64 index = timestampMs / m_chunkSpanMs;
+    if (timestampMs % m_chunkSpanMs != 0 && timestampMs < 0) {
+        --index;
+    }
+    return index * m_chunkSpanMs;
+}
+
+QVector<qint64> TimeSeriesStore::loadChunkIndex(const QString &deviceId) const
+{
+    {
+        QReadLocker locker(&m_indexLock);
+        auto it = m_chunkIndex.constFind(deviceId);
+        if (it != m_chunkIndex.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QVector<qint64> starts;
+    const QStringList files = QDir(deviceDirectory(deviceId)).entryList(QStringList() << "*.ts", QDir::Files);
+    for (const QString &fileName : files) {
+        bool ok = false;
+        const qint64 chunkStart = fileName.left(fileName.size() - 3).toLongLong(&ok);
+        if (ok) {
+            starts.append(chunkStart);
+        }
+    }
+    std::sort(starts.begin(), starts.end());
+
+    QWriteLocker locker(&m_indexLock);
+    m_chunkIndex.insert(deviceId, starts);
+    return starts;
+}
+
+bool TimeSeriesStore::appendToChunk(const QString &deviceId, qint64 chunkStart,
+                                    const qint64 *timestamps, const double *values, int count)
+{
+    qint64 lastTimestamp = 0;
+    if (readLastTimestamp(deviceId, chunkStart, lastTimestamp) && timestamps[0] < lastTimestamp) {
+        m_lastError = QString("设备 %1 的样本不能早于已写入的样本").arg(deviceId);
+        return false;
+    }
+
+    QFile tsFile(chunkPath(deviceId, chunkStart, "ts"));
+    QFile valFile(chunkPath(deviceId, chunkStart, "val"));
+    if (!tsFile.open(QIODevice::WriteOnly | QIODevice::Append) ||
+        !valFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        m_lastError = QString("无法打开数据块文件: %1").arg(tsFile.fileName());
+        return false;
+    }
+
+    const qint64 tsBytes = static_cast<qint64>(count) * sizeof(qint64);
+    const qint64 valBytes = static_cast<qint64>(count) * sizeof(double);
+    const qint64 oldTsSize = tsFile.size();
+    const qint64 oldValSize = valFile.size();
+
+    if (tsFile.write(reinterpret_cast<const char *>(timestamps), tsBytes) != tsBytes ||
+        valFile.write(reinterpret_cast<const char *>(values), valBytes) != valBytes) {
+        // 回滚到写入前的长度，保持两列长度一致
+        tsFile.resize(oldTsSize);
+        valFile.resize(oldValSize);
+        m_lastError = QString("写入数据块失败: %1").arg(tsFile.errorString());
+        return false;
+    }
+
+    // 更新已缓存的块索引
+    QWriteLocker locker(&m_indexLock);
+    auto it = m_chunkIndex.find(deviceId);
+    if (it != m_chunkIndex.end()) {
+        QVector<qint64> &starts = it.value();
+        auto pos = std::lower_bound(starts.begin(), starts.end(), chunkStart);
+        if (pos == starts.end() || *pos != chunkStart) {
+            starts.insert(pos, chunkStart);
+        }
+    }
+
+    return true;
+}
+
+bool TimeSeriesStore::readLastTimestamp(const QString &deviceId, qint64 chunkStart, qint64 &timestampMs) const
+{
+    QFile tsFile(chunkPath(deviceId, chunkStart, "ts"));
+    if (!tsFile.open(QIODevice::ReadOnly) || tsFile.size() < static_cast<qint64>(sizeof(qint64))) {
+        return false;
+    }
+
+    const qint64 lastOffset = (tsFile.size() / sizeof(qint64) - 1) * sizeof(qint64);
+    if (!tsFile.seek(lastOffset)) {
+        return false;
+    }
+    return tsFile.read(reinterpret_cast<char *>(&timestampMs), sizeof(qint64)) == sizeof(qint64);
+}
+
+qint64 TimeSeriesStore::aggregateChunk(const QString &deviceId, qint64 chunkStart,
+                                       const qint64 *boundaries, int bucketCount,
+                                       BucketAggregate *out) const
+{
+    QFile tsFile(chunkPath(deviceId, chunkStart, "ts"));
+    QFile valFile(chunkPath(deviceId, chunkStart, "val"));
+    if (!tsFile.open(QIODevice::ReadOnly) || !valFile.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    ChunkColumns columns;
+    if (!columns.load(tsFile, valFile) || columns.count == 0) {
+        return 0;
+    }
+
+    return AggregationKernels::aggregate(columns.timestamps, columns.values, columns.count,
+                                         boundaries, bucketCount, out);
+}
+
+bool TimeSeriesStore::updateRollups(const QString &deviceId, const qint64 *timestamps, const double *values,
+                                    int count, bool hadSamples)
+{
+    QWriteLocker locker(&m_rollupLock);
+    const QByteArray header = rollupHeader(m_zone);
+
+    for (TimeWidget::TimeGranularity tier : RollupTiers) {
+        // 先把本批样本聚合为记录
+        const TimeBucketer bucketer(timestamps[0], timestamps[count - 1] + 1, tier, m_zone);
+        const QVector<qint64> boundaries = bucketer.boundaries();
+        QVector<BucketAggregate> buckets(bucketer.bucketCount());
+        AggregationKernels::aggregate(timestamps, values, count, boundaries.constData(),
+                                      bucketer.bucketCount(), buckets.data());
+        QVector<RollupRecord> records;
+        appendRecords(records, bucketer, buckets);
+
+        QFile file(rollupPath(deviceId, tier));
+        if (!file.open(QIODevice::ReadWrite)) {
+            m_lastError = QString("无法打开预聚合层文件: %1").arg(file.fileName());
+            return false;
+        }
+
+        if (file.size() == 0) {
+            // 已有样本却没有预聚合层（升级前写入的数据），需要重建
+            if (hadSamples || file.write(header) != header.size()) {
+                return false;
+            }
+        } else if (!hasValidHeader(file, header)) {
+            return false;
+        }
+
+        // 丢弃上次写入中断留下的不完整记录
+        const qint64 recordCount = (file.size() - RollupHeaderSize) / static_cast<qint64>(sizeof(RollupRecord));
+        const qint64 endOffset = RollupHeaderSize + recordCount * static_cast<qint64>(sizeof(RollupRecord));
+        if (file.size() != endOffset && !file.resize(endOffset)) {
+            return false;
+        }
+
+        int firstNew = 0;
+        if (recordCount > 0 && !records.isEmpty()) {
+            const qint64 lastOffset = endOffset - static_cast<qint64>(sizeof(RollupRecord));
+            RollupRecord last;
+            if (!file.seek(lastOffset) ||
+                file.read(reinterpret_cast<char *>(&last), sizeof(RollupRecord)) != sizeof(RollupRecord)) {
+                return false;
+            }
+
+            // 样本写入了更早的数据块，记录无法保持有序
+            if (records.first().ordinal < last.ordinal) {
+                return false;
+            }
+
+            // 与最后一个桶合并后原位改写
+            if (records.first().ordinal == last.ordinal) {
+                BucketAggregate merged = toAggregate(last);
+                merged.merge(toAggregate(records.first()));
+                last = toRecord(last.ordinal, merged);
+                if (!file.seek(lastOffset) ||
+                    file.write(reinterpret_cast<const char *>(&last), sizeof(RollupRecord)) != sizeof(RollupRecord)) {
+                    m_lastError = QString("写入预聚合层失败: %1").arg(file.errorString());
+                    return false;
+                }
+                firstNew = 1;
+            }
+        }
+
+        const qint64 newBytes = static_cast<qint64>(records.size() - firstNew) * sizeof(RollupRecord);
+        if (newBytes > 0 && (!file.seek(endOffset) ||
+                             file.write(reinterpret_cast<const char *>(records.constData() + firstNew), newBytes) != newBytes)) {
+            file.resize(endOffset);
+            m_lastError = QString("写入预聚合层失败: %1").arg(file.errorString());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TimeSeriesStore::removeRollups(const QString &deviceId)
+{
+    QWriteLocker locker(&m_rollupLock);
+    for (TimeWidget::TimeGranularity tier : RollupTiers) {
+        QFile::remove(rollupPath(deviceId, tier));
+    }
+}
+
+TimeSeriesStore::StorageTier TimeSeriesStore::planTier(const QString &deviceId, const qint64 *boundaries,
+                                                       int bucketCount, TimeWidget::TimeGranularity granularity,
+                                                       TimeBucketer &tierBucketer, QVector<int> &tierToBucket) const
+{
+    const QByteArray header = rollupHeader(m_zone);
+
+    for (TimeWidget::TimeGranularity tier : RollupTiers) {
+        // 只能用不细于查询颗粒度的层
+        if (TimeBucketer::granularityMs(tier) > TimeBucketer::granularityMs(granularity)) {
+            continue;
+        }
+
+        // 层的桶必须完整落在某个查询桶内，查询边界才都是层的边界
+        const TimeBucketer candidate(boundaries[0], boundaries[bucketCount], tier, m_zone);
+        if (!candidate.isValid() || candidate.startMs() != boundaries[0] ||
+            candidate.endMs() != boundaries[bucketCount]) {
+            continue;
+        }
+
+        QVector<int> mapping(candidate.bucketCount());
+        bool aligned = true;
+        int bucket = 0;
+        for (int i = 0; i < candidate.bucketCount() && aligned; ++i) {
+            const qint64 start = candidate.bucketStart(i);
+            while (boundaries[bucket + 1] <= start) {
+                ++bucket;
+            }
+            aligned = start >= boundaries[bucket] && candidate.bucketEnd(i) <= boundaries[bucket + 1];
+            mapping[i] = bucket;
+        }
+        if (!aligned) {
+            continue;
+        }
+
+        QFile file(rollupPath(deviceId, tier));
+        if (!file.open(QIODevice::ReadOnly) || !hasValidHeader(file, header)) {
+            continue;
+        }
+
+        tierBucketer = candidate;
+        tierToBucket = mapping;
+        switch (tier) {
+        case TimeWidget::Minutes15:
+            return Minutes15Rollup;
+        case TimeWidget::Hour1:
+            return Hour1Rollup;
+        case TimeWidget::Day1:
+            return Day1Rollup;
+        }
+    }
+
+    return RawSamples;
+}
+
+qint64 TimeSeriesStore::aggregateRollup(const QString &deviceId, TimeWidget::TimeGranularity tier,
+                                        const TimeBucketer &tierBucketer, const QVector<int> &tierToBucket,
+                                        BucketAggregate *out) const
+{
+    QFile file(rollupPath(deviceId, tier));
+    if (!file.open(QIODevice::ReadOnly) || !hasValidHeader(file, rollupHeader(m_zone))) {
+        return -1;
+    }
+
+    const qint64 recordCount = (file.size() - RollupHeaderSize) / static_cast<qint64>(sizeof(RollupRecord));
+    if (recordCount <= 0) {
+        return 0;
+    }
+
+    const qint64 mappedBytes = RollupHeaderSize + recordCount * static_cast<qint64>(sizeof(RollupRecord));
+    QByteArray buffer;
+    const uchar *mapped = file.map(0, mappedBytes);
+    const RollupRecord *records = nullptr;
+    if (mapped) {
+        records = reinterpret_cast<const RollupRecord *>(mapped + RollupHeaderSize);
+    } else {
+        // 文件系统不支持内存映射时退回到整体读取
+        if (!file.seek(RollupHeaderSize)) {
+            return -1;
+        }
+        buffer = file.read(mappedBytes - RollupHeaderSize);
+        if (buffer.size() != mappedBytes - RollupHeaderSize) {
+            return -1;
+        }
+        records = reinterpret_cast<const RollupRecord *>(buffer.constData());
+    }
+
+    // 记录按序号排序，二分定位到范围起点
+    const qint64 firstOrdinal = tierBucketer.firstOrdinal();
+    const qint64 endOrdinal = firstOrdinal + tierBucketer.bucketCount();
+    const RollupRecord *it = std::lower_bound(records, records + recordCount, firstOrdinal,
+                                              [](const RollupRecord &record, qint64 ordinal) {
+                                                  return record.ordinal < ordinal;
+                                              });
+
+    qint64 samples = 0;
+    for (; it != records + recordCount && it->ordinal < endOrdinal; ++it) {
+        out[tierToBucket.at(static_cast<int>(it->ordinal - firstOrdinal))].merge(toAggregate(*it));
+        samples += it->count;
+    }
+    return samples;
+}
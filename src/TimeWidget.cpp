@@ -8,6 +8,13 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QPushButton>
+#include <QSignalBlocker>
+#include <QTimer>
+
+namespace {
+// 实时模式默认每10秒滚动一次
+const int DefaultLiveIntervalMs = 10000;
+}
 
 TimeWidget::TimeWidget(QWidget *parent)
     : QWidget(parent)
@@ -17,13 +24,19 @@ TimeWidget::TimeWidget(QWidget *parent)
     , m_endTimeEdit(nullptr)
     , m_titleLabel(nullptr)
     , m_errorLabel(nullptr)
+    , m_liveButton(nullptr)
+    , m_liveTimer(new QTimer(this))
     , m_mainLayout(nullptr)
     , m_granularityLayout(nullptr)
     , m_quickTimeLayout(nullptr)
     , m_timeRangeLayout(nullptr)
     , m_currentGranularity(Hour1)
     , m_updatingTime(false)
+    , m_liveSpanMs(0)
 {
+    m_liveTimer->setInterval(DefaultLiveIntervalMs);
+    connect(m_liveTimer, &QTimer::timeout, this, &TimeWidget::onLiveTimerTimeout);
+    
     setupUI();
     
     // 设置默认时间范围（前一天）
@@ -152,6 +165,15 @@ void TimeWidget::createQuickTimeButtons()
     m_quickTimeLayout->addWidget(btnYesterday);
     m_quickTimeLayout->addWidget(btn3Days);
     
+    // 实时模式按钮（不属于快捷按钮组，可与快捷选择同时生效）
+    m_liveButton = new QPushButton("实时", this);
+    m_liveButton->setCheckable(true);
+    m_liveButton->setToolTip("时间窗口随当前时间滚动");
+    m_liveButton->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+    m_liveButton->setMinimumWidth(70);
+    m_quickTimeLayout->addWidget(m_liveButton);
+    connect(m_liveButton, &QPushButton::toggled, this, &TimeWidget::setLiveMode);
+    
     // 添加弹性空间
     m_quickTimeLayout->addStretch(1);
     
@@ -238,9 +260,81 @@ void TimeWidget::setTimeRange(const QDateTime &start, const QDateTime &end)
     m_endTimeEdit->setDateTime(end);
     m_updatingTime = false;
     
+    // 实时模式下快捷选择改变窗口长度，继续滚动
+    if (isLiveMode() && start < end) {
+        m_liveSpanMs = start.msecsTo(end);
+    }
+    
     emitTimeRangeChanged();
 }
 
+void TimeWidget::setLiveMode(bool enabled)
+{
+    if (enabled == isLiveMode()) {
+        return;
+    }
+    
+    if (m_liveButton) {
+        const QSignalBlocker blocker(m_liveButton);
+        m_liveButton->setChecked(enabled);
+    }
+    
+    if (!enabled) {
+        m_liveTimer->stop();
+        emit liveModeChanged(false);
+        qDebug() << "Live mode disabled";
+        return;
+    }
+    
+    m_liveSpanMs = qMax<qint64>(1, getStartTime().msecsTo(getEndTime()));
+    m_liveTimer->start();
+    emit liveModeChanged(true);
+    qDebug() << "Live mode enabled, window" << m_liveSpanMs << "ms";
+    
+    // 窗口终点对齐到当前时间
+    const QDateTime now = QDateTime::currentDateTime();
+    setTimeRange(now.addMSecs(-m_liveSpanMs), now);
+}
+
+bool TimeWidget::isLiveMode() const
+{
+    return m_liveTimer->isActive();
+}
+
+void TimeWidget::setLiveInterval(int msec)
+{
+    m_liveTimer->setInterval(qMax(1, msec));
+}
+
+int TimeWidget::liveInterval() const
+{
+    return m_liveTimer->interval();
+}
+
+void TimeWidget::onLiveTimerTimeout()
+{
+    const QDateTime end = QDateTime::currentDateTime();
+    const QDateTime start = end.addMSecs(-m_liveSpanMs);
+    
+    m_updatingTime = true;
+    m_startTimeEdit->setDateTime(start);
+    m_endTimeEdit->setDateTime(end);
+    m_updatingTime = false;
+    
+    emit liveWindowAdvanced(start, end);
+}
+
+void TimeWidget::setGranularity(TimeGranularity granularity)
+{
+    QAbstractButton *button = m_granularityGroup ? m_granularityGroup->button(granularity) : nullptr;
+    if (!button || granularity == m_currentGranularity) {
+        return;
+    }
+    
+    button->setChecked(true);
+    onGranularityButtonClicked();
+}
+
 void TimeWidget::onGranularityButtonClicked()
 {
     int id = m_granularityGroup->checkedId();
@@ -283,6 +377,9 @@ void TimeWidget::onDateTimeChanged()
         return;
     }
     
+    // 手动编辑时间范围时退出实时模式
+    setLiveMode(false);
+    
     // 验证时间格式
     if (!validateTimeFormat(m_startTimeEdit->dateTime())) {
         showError("开始时间格式无效");
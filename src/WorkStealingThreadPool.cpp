@@ -0,0 +1,168 @@
+#include "WorkStealingThreadPool.h"
+#include <QMutexLocker>
+#include <QThread>
+
+namespace {
+// 当前线程所属的线程池及队列序号，用于把工作线程内提交的任务放进自己的队列
+thread_local const WorkStealingThreadPool *t_currentPool = nullptr;
+thread_local int t_workerIndex = -1;
+}
+
+/**
+ * @brief 运行WorkStealingThreadPool::workerLoop的线程
+ */
+class WorkStealingThreadPool::Worker : public QThread
+{
+public:
+    Worker(WorkStealingThreadPool *pool, int index)
+        : m_pool(pool), m_index(index) {}
+
+protected:
+    void run() override
+    {
+        t_currentPool = m_pool;
+        t_workerIndex = m_index;
+        m_pool->workerLoop(m_index);
+    }
+
+private:
+    WorkStealingThreadPool *m_pool;
+    int m_index;
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(int threadCount)
+    : m_stopping(false)
+    , m_queuedTasks(0)
+    , m_pendingTasks(0)
+    , m_nextQueue(0)
+    , m_stolenTasks(0)
+{
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        m_queues.emplace_back(new TaskQueue());
+    }
+
+    m_threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        Worker *worker = new Worker(this, i);
+        worker->setObjectName(QString("QueryWorker-%1").arg(i));
+        m_threads.append(worker);
+        worker->start();
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    waitForDone();
+
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_stopping = true;
+        m_workAvailable.wakeAll();
+    }
+
+    for (QThread *thread : m_threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+void WorkStealingThreadPool::submit(Task task)
+{
+    if (!task) {
+        return;
+    }
+
+    int index = 0;
+    if (t_currentPool == this) {
+        index = t_workerIndex;
+    } else {
+        index = static_cast<int>(m_nextQueue.fetch_add(1) % m_queues.size());
+    }
+
+    m_pendingTasks.fetch_add(1);
+    {
+        TaskQueue &queue = *m_queues[index];
+        QMutexLocker locker(&queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    m_queuedTasks.fetch_add(1);
+
+    QMutexLocker locker(&m_stateMutex);
+    m_workAvailable.wakeOne();
+}
+
+void WorkStealingThreadPool::waitForDone()
+{
+    Q_ASSERT(t_currentPool != this);
+
+    QMutexLocker locker(&m_stateMutex);
+    while (m_pendingTasks.load() > 0) {
+        m_allDone.wait(&m_stateMutex);
+    }
+}
+
+void WorkStealingThreadPool::workerLoop(int index)
+{
+    for (;;) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            task();
+            finishTask();
+            continue;
+        }
+
+        // 所有队列都为空时休眠，直到有新任务或线程池停止
+        QMutexLocker locker(&m_stateMutex);
+        while (!m_stopping && m_queuedTasks.load() == 0) {
+            m_workAvailable.wait(&m_stateMutex);
+        }
+        if (m_stopping && m_queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingThreadPool::popLocal(int index, Task &task)
+{
+    TaskQueue &queue = *m_queues[index];
+    QMutexLocker locker(&queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queuedTasks.fetch_sub(1);
+    return true;
+}
+
+bool WorkStealingThreadPool::steal(int thief, Task &task)
+{
+    const int queueCount = static_cast<int>(m_queues.size());
+    for (int offset = 1; offset < queueCount; ++offset) {
+        TaskQueue &queue = *m_queues[(thief + offset) % queueCount];
+        QMutexLocker locker(&queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_queuedTasks.fetch_sub(1);
+        m_stolenTasks.fetch_add(1);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::finishTask()
+{
+    if (m_pendingTasks.fetch_sub(1) == 1) {
+        QMutexLocker locker(&m_stateMutex);
+        m_allDone.wakeAll();
+    }
+}
@@ -55,7 +55,7 @@ int main(int argc, char *argv[])
     }
     
     // 创建并显示主窗口
-    MainWindow window;
+    MainWindow window(MainWindowPaths::defaults());
     window.show();
     
     return app.exec();
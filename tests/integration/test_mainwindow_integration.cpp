@@ -2,6 +2,8 @@
 #include <QTest>
 #include <QSignalSpy>
 #include <QDateTime>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QDebug>
 #include "MainWindow.h"
 #include "TimeWidget.h"
@@ -66,6 +68,7 @@ private slots:
     void testMemoryLeakPrevention();
 
 private:
+    QTemporaryDir m_dataDir;  // 时间序列存储的临时目录
     MainWindow *m_mainWindow;
     TimeWidget *m_timeWidget;
     DeviceWidget *m_deviceWidget;
@@ -82,6 +85,10 @@ void TestMainWindowIntegration::initTestCase()
 {
     qDebug() << "Starting MainWindow integration tests...";
     
+    // 不读写用户数据目录中的实际数据
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dataDir.isValid());
+    
     // 初始化设备管理器
     DeviceManager::instance().loadDeviceData();
     
@@ -95,7 +102,10 @@ void TestMainWindowIntegration::cleanupTestCase()
 
 void TestMainWindowIntegration::init()
 {
-    m_mainWindow = new MainWindow();
+    // 只指定临时存储，不监视目录文件、不读取状态文件
+    MainWindowPaths paths;
+    paths.storeRootPath = m_dataDir.path() + "/store";
+    m_mainWindow = new MainWindow(paths);
     
     // 获取子组件的引用（通过findChild或其他方式）
     m_timeWidget = m_mainWindow->findChild<TimeWidget*>();
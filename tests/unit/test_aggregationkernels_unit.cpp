@@ -0,0 +1,198 @@
+#include <QApplication>
+#include <QTest>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cmath>
+#include "AggregationKernels.h"
+
+/**
+ * @brief AggregationKernels单元测试类
+ *
+ * 验证标量与AVX2聚合内核的结果一致，并测量每核每秒处理的样本数
+ */
+class TestAggregationKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 正确性测试
+    void testMatchesReference_data();
+    void testMatchesReference();
+    void testMergesAcrossCalls();
+    void testSamplesOutsideRange();
+
+    // 性能测试
+    void benchmarkThroughput_data();
+    void benchmarkThroughput();
+
+private:
+    void generateSamples(int count, QVector<qint64> &timestamps, QVector<double> &values) const;
+    static QVector<qint64> makeBoundaries(qint64 start, qint64 width, int bucketCount);
+};
+
+Q_DECLARE_METATYPE(AggregationKernels::Implementation)
+
+void TestAggregationKernels::initTestCase()
+{
+    qDebug() << "Starting AggregationKernels unit tests, active implementation:"
+             << AggregationKernels::implementationName(AggregationKernels::activeImplementation());
+}
+
+void TestAggregationKernels::cleanupTestCase()
+{
+    qDebug() << "AggregationKernels unit tests completed.";
+}
+
+void TestAggregationKernels::generateSamples(int count, QVector<qint64> &timestamps, QVector<double> &values) const
+{
+    timestamps.resize(count);
+    values.resize(count);
+    for (int i = 0; i < count; ++i) {
+        timestamps[i] = 1000 + i * 7LL;
+        values[i] = std::sin(i * 0.01) * 100.0 + (i % 13);
+    }
+}
+
+QVector<qint64> TestAggregationKernels::makeBoundaries(qint64 start, qint64 width, int bucketCount)
+{
+    QVector<qint64> boundaries(bucketCount + 1);
+    for (int i = 0; i <= bucketCount; ++i) {
+        boundaries[i] = start + i * width;
+    }
+    return boundaries;
+}
+
+void TestAggregationKernels::testMatchesReference_data()
+{
+    QTest::addColumn<AggregationKernels::Implementation>("implementation");
+    QTest::newRow("scalar") << AggregationKernels::Scalar;
+    QTest::newRow("avx2") << AggregationKernels::Avx2;
+}
+
+void TestAggregationKernels::testMatchesReference()
+{
+    QFETCH(AggregationKernels::Implementation, implementation);
+    if (!AggregationKernels::isSupported(implementation)) {
+        QSKIP("Implementation not supported on this CPU");
+    }
+
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    generateSamples(10007, timestamps, values);
+    const QVector<qint64> boundaries = makeBoundaries(0, 333, 250);
+
+    // 参考结果：逐个样本累加
+    QVector<BucketAggregate> expected(250);
+    for (int i = 0; i < timestamps.size(); ++i) {
+        const int bucket = static_cast<int>(timestamps[i] / 333);
+        if (bucket < 250) {
+            expected[bucket].add(values[i]);
+        }
+    }
+
+    QVector<BucketAggregate> actual(250);
+    AggregationKernels::aggregate(implementation, timestamps.constData(), values.constData(),
+                                  timestamps.size(), boundaries.constData(), 250, actual.data());
+
+    for (int bucket = 0; bucket < 250; ++bucket) {
+        QCOMPARE(actual[bucket].count, expected[bucket].count);
+        QCOMPARE(actual[bucket].min, expected[bucket].min);
+        QCOMPARE(actual[bucket].max, expected[bucket].max);
+        QCOMPARE(actual[bucket].first, expected[bucket].first);
+        QCOMPARE(actual[bucket].last, expected[bucket].last);
+        QVERIFY(std::fabs(actual[bucket].sum - expected[bucket].sum) < 1e-6);
+    }
+}
+
+void TestAggregationKernels::testMergesAcrossCalls()
+{
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    generateSamples(1000, timestamps, values);
+    const QVector<qint64> boundaries = makeBoundaries(0, 100000, 1);
+
+    // 分两次调用的结果应与一次调用相同
+    QVector<BucketAggregate> whole(1);
+    AggregationKernels::aggregate(timestamps.constData(), values.constData(), 1000,
+                                  boundaries.constData(), 1, whole.data());
+
+    QVector<BucketAggregate> split(1);
+    AggregationKernels::aggregate(timestamps.constData(), values.constData(), 400,
+                                  boundaries.constData(), 1, split.data());
+    AggregationKernels::aggregate(timestamps.constData() + 400, values.constData() + 400, 600,
+                                  boundaries.constData(), 1, split.data());
+
+    QCOMPARE(split[0].count, whole[0].count);
+    QCOMPARE(split[0].first, whole[0].first);
+    QCOMPARE(split[0].last, whole[0].last);
+    QCOMPARE(split[0].min, whole[0].min);
+    QCOMPARE(split[0].max, whole[0].max);
+}
+
+void TestAggregationKernels::testSamplesOutsideRange()
+{
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    generateSamples(100, timestamps, values);
+
+    // 只有 [1100, 1200) 内的样本被计入
+    const QVector<qint64> boundaries = makeBoundaries(1100, 50, 2);
+    QVector<BucketAggregate> out(2);
+    const qint64 consumed = AggregationKernels::aggregate(timestamps.constData(), values.constData(), 100,
+                                                          boundaries.constData(), 2, out.data());
+
+    QCOMPARE(consumed, out[0].count + out[1].count);
+    QCOMPARE(consumed, qint64(14));
+}
+
+void TestAggregationKernels::benchmarkThroughput_data()
+{
+    testMatchesReference_data();
+}
+
+void TestAggregationKernels::benchmarkThroughput()
+{
+    QFETCH(AggregationKernels::Implementation, implementation);
+    if (!AggregationKernels::isSupported(implementation)) {
+        QSKIP("Implementation not supported on this CPU");
+    }
+
+    // 约一年15分钟颗粒度的桶，每桶数百个样本
+    const int sampleCount = 8 * 1000 * 1000;
+    const int bucketCount = 35040;
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    generateSamples(sampleCount, timestamps, values);
+    const QVector<qint64> boundaries = makeBoundaries(0, 7LL * sampleCount / bucketCount + 1, bucketCount);
+    QVector<BucketAggregate> out(bucketCount);
+
+    int runs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ++runs;
+        out.fill(BucketAggregate());
+        AggregationKernels::aggregate(implementation, timestamps.constData(), values.constData(),
+                                      sampleCount, boundaries.constData(), bucketCount, out.data());
+    }
+
+    // 单线程运行，即每核吞吐量
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    if (seconds > 0.0) {
+        qDebug() << AggregationKernels::implementationName(implementation) << "throughput:"
+                 << qRound64(static_cast<double>(runs) * sampleCount / seconds) << "samples/sec/core";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestAggregationKernels test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_aggregationkernels_unit.moc"
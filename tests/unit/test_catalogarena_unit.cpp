@@ -0,0 +1,165 @@
+#include <QApplication>
+#include <QTest>
+#include <QDebug>
+#include <cstdint>
+#include "CatalogArena.h"
+
+/**
+ * @brief CatalogArena单元测试类
+ *
+ * 测试内存区的对齐和分块、UTF-8解码（包括无效序列），以及整体释放
+ */
+class TestCatalogArena : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 分配测试
+    void testAlignment();
+    void testLargeAllocation();
+    void testRelease();
+
+    // 字符串测试
+    void testCopyUtf8();
+    void testInvalidUtf8();
+    void testCopy();
+};
+
+void TestCatalogArena::initTestCase()
+{
+    qDebug() << "Starting CatalogArena unit tests...";
+}
+
+void TestCatalogArena::cleanupTestCase()
+{
+    qDebug() << "CatalogArena unit tests completed.";
+}
+
+void TestCatalogArena::testAlignment()
+{
+    CatalogArena arena(1024);
+    QCOMPARE(arena.blockCount(), 0);
+
+    // 交替分配不同对齐的内存，每次都满足对齐要求
+    for (int i = 0; i < 50; ++i) {
+        char *bytes = static_cast<char *>(arena.allocate(1, 1));
+        QVERIFY(bytes != nullptr);
+        qint64 *value = arena.allocateArray<qint64>(1);
+        QCOMPARE(reinterpret_cast<uintptr_t>(value) % alignof(qint64), uintptr_t(0));
+        *value = i;
+        QChar *text = arena.allocateArray<QChar>(3);
+        QCOMPARE(reinterpret_cast<uintptr_t>(text) % alignof(QChar), uintptr_t(0));
+    }
+
+    // 块用完后自动开新块
+    QVERIFY(arena.blockCount() > 1);
+    QVERIFY(arena.usedBytes() <= arena.reservedBytes());
+}
+
+void TestCatalogArena::testLargeAllocation()
+{
+    CatalogArena arena(1024);
+    int *small = arena.allocateArray<int>(4);
+    const qint64 usedBefore = arena.usedBytes();
+
+    // 大的分配单独占一块，当前块继续使用
+    int *large = arena.allocateArray<int>(10000);
+    for (int i = 0; i < 10000; ++i) {
+        large[i] = i;
+    }
+    QCOMPARE(arena.blockCount(), 2);
+    QVERIFY(arena.usedBytes() >= usedBefore + 40000);
+
+    int *next = arena.allocateArray<int>(4);
+    QCOMPARE(next, small + 4);
+    QCOMPARE(arena.blockCount(), 2);
+    QCOMPARE(large[9999], 9999);
+}
+
+void TestCatalogArena::testRelease()
+{
+    CatalogArena arena(1024);
+    for (int i = 0; i < 100; ++i) {
+        arena.allocateArray<qint64>(32);
+    }
+    QVERIFY(arena.blockCount() > 1);
+
+    arena.release();
+    QCOMPARE(arena.blockCount(), 0);
+    QCOMPARE(arena.reservedBytes(), qint64(0));
+    QCOMPARE(arena.usedBytes(), qint64(0));
+
+    // 释放后可以继续使用
+    const ArenaString text = arena.copyUtf8("abc", 3);
+    QCOMPARE(text.toString(), QString("abc"));
+    QCOMPARE(arena.blockCount(), 1);
+}
+
+void TestCatalogArena::testCopyUtf8()
+{
+    CatalogArena arena;
+    const QByteArray samples[] = {
+        QByteArray("pump_1"),
+        QString("1号泵（检修）").toUtf8(),
+        QString("温度传感器 ü é").toUtf8(),
+        QByteArray("仪表\xF0\x9F\x98\x80")
+    };
+    for (const QByteArray &utf8 : samples) {
+        const ArenaString text = arena.copyUtf8(utf8.constData(), utf8.size());
+        QCOMPARE(text.toString(), QString::fromUtf8(utf8));
+    }
+
+    // 基本平面以外的字符解码为代理对
+    const QByteArray emoji("\xF0\x9F\x98\x80");
+    const ArenaString pair = arena.copyUtf8(emoji.constData(), emoji.size());
+    QCOMPARE(pair.size, 2);
+    QVERIFY(pair.data[0].isHighSurrogate());
+    QVERIFY(pair.data[1].isLowSurrogate());
+
+    // 解码后多余的空间还给当前块，下一个字符串紧接在后面
+    const QByteArray chinese = QString("设备").toUtf8();
+    const ArenaString first = arena.copyUtf8(chinese.constData(), chinese.size());
+    const ArenaString second = arena.copyUtf8("x", 1);
+    QCOMPARE(first.size, 2);
+    QCOMPARE(second.data, first.data + 2);
+
+    QVERIFY(arena.copyUtf8("", 0).isEmpty());
+    QVERIFY(arena.copyUtf8("", 0).toString().isNull());
+    QVERIFY(first == arena.copy(first.view()));
+    QVERIFY(first != second);
+}
+
+void TestCatalogArena::testInvalidUtf8()
+{
+    CatalogArena arena;
+    const QChar replacement(QChar::ReplacementCharacter);
+
+    // 孤立的后续字节、截断的序列、过长编码和代理区码点都替换为U+FFFD
+    QCOMPARE(arena.copyUtf8("a\x80" "b", 3).toString(), QString("a") + replacement + "b");
+    QCOMPARE(arena.copyUtf8("\xE8\xAE", 2).toString(), QString(replacement));
+    QCOMPARE(arena.copyUtf8("\xC0\xAF", 2).toString(), QString(replacement));
+    QCOMPARE(arena.copyUtf8("\xED\xA0\x80", 3).toString(), QString(replacement));
+    QCOMPARE(arena.copyUtf8("\xF8z", 2).toString(), QString(replacement) + "z");
+}
+
+void TestCatalogArena::testCopy()
+{
+    CatalogArena arena;
+    const QString source("产线A");
+    const ArenaString text = arena.copy(QStringView(source));
+    QVERIFY(text.data != source.constData());
+    QCOMPARE(text.toString(), source);
+    QVERIFY(arena.copy(QStringView()).isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    TestCatalogArena test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_catalogarena_unit.moc"
@@ -0,0 +1,589 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTreeView>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include "CatalogLoader.h"
+#include "CatalogWatcher.h"
+#include "DeviceManager.h"
+#include "DeviceWidget.h"
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+/**
+ * @brief 生成大目录：每个分组若干设备，类型循环使用
+ */
+QByteArray largeCatalog(int groupCount, int devicesPerGroup)
+{
+    QByteArray text;
+    for (int g = 0; g < groupCount; ++g) {
+        const QByteArray groupId = "group_" + QByteArray::number(g);
+        text += groupId + ",,分组,1,分组" + QByteArray::number(g) + "\n";
+        for (int d = 0; d < devicesPerGroup; ++d) {
+            text += groupId + "_" + QByteArray::number(d) + "," + groupId + ",类型"
+                    + QByteArray::number((g + d) % 12) + ",0,设备" + QByteArray::number(d) + "\n";
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief 原来的加载方式：逐行复制为QByteArray，解析为QHash<QString, DeviceInfo>
+ *
+ * 只用于与内存区解析比较，不做校验。
+ */
+void parseIntoHash(const QByteArray &data, QHash<QString, DeviceInfo> &devices, QStringList &types)
+{
+    int lineStart = 0;
+    while (lineStart < data.size()) {
+        int lineEnd = data.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            lineEnd = data.size();
+        }
+        const QByteArray line = data.mid(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        const QList<QByteArray> fields = line.split(',');
+        if (fields.size() < 5) {
+            continue;
+        }
+        DeviceInfo device(QString::fromUtf8(fields.at(0)), QString::fromUtf8(fields.at(4)),
+                          QString::fromUtf8(fields.at(2)), QString::fromUtf8(fields.at(1)), fields.at(3) == "1");
+        if (!types.contains(device.type)) {
+            types.append(device.type);
+        }
+        devices.insert(device.id, device);
+    }
+}
+
+/**
+ * @brief 读取进程的常驻内存（只支持Linux，其他平台返回0）
+ */
+qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+}
+
+/**
+ * @brief CatalogLoader和CatalogWatcher单元测试类
+ *
+ * 测试目录文件的解析和校验、与设备管理器当前内容的差异应用（只产生
+ * 实际变化的修改），以及文件变化后的后台重新加载
+ */
+class TestCatalogLoader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 解析测试
+    void testParse();
+    void testParseErrors();
+
+    // 差异测试
+    void testApplyDiff();
+    void testApplyUnchangedIsNoop();
+    void testReorderAndReparent();
+    void testWidgetStateKept();
+
+    // 整体加载测试
+    void testLoadCatalog();
+    void benchmarkReload_data();
+    void benchmarkReload();
+
+    // 并行解析测试
+    void testParallelParse();
+    void testParallelParseErrors();
+    void benchmarkParallelParse_data();
+    void benchmarkParallelParse();
+
+    // 热加载测试
+    void testWatcherReload();
+
+private:
+    /**
+     * @brief 解析目录文本，失败时测试失败
+     */
+    CatalogData parseCatalog(const QByteArray &text);
+
+    /**
+     * @brief 基础测试目录：两个分组，各两个设备
+     */
+    QByteArray baseCatalog() const;
+};
+
+void TestCatalogLoader::initTestCase()
+{
+    qDebug() << "Starting CatalogLoader unit tests...";
+    DeviceManager::instance().loadDeviceData();
+}
+
+void TestCatalogLoader::cleanupTestCase()
+{
+    qDebug() << "CatalogLoader unit tests completed.";
+}
+
+CatalogData TestCatalogLoader::parseCatalog(const QByteArray &text)
+{
+    CatalogData catalog;
+    QString error;
+    const bool ok = CatalogLoader::parse(text, catalog, &error);
+    if (!ok) {
+        qWarning() << error;
+    }
+    return catalog;
+}
+
+QByteArray TestCatalogLoader::baseCatalog() const
+{
+    return "# id,parent,type,group,name\n"
+           "line_a,,产线,1,产线A\n"
+           "pump_1,line_a,泵,0,1号泵\n"
+           "pump_2,line_a,泵,0,2号泵\n"
+           "line_b,,产线,1,产线B\n"
+           "fan_1,line_b,风机,0,1号风机\n"
+           "fan_2,line_b,风机,0,2号风机\n";
+}
+
+void TestCatalogLoader::testParse()
+{
+    CatalogData catalog;
+    QString error;
+
+    // 子设备可以出现在父设备之前，名称可以包含逗号
+    QVERIFY(CatalogLoader::parse("pump_1,line_a,泵,0,1号泵, 备用\r\n"
+                                 "\n"
+                                 "line_a,,产线,true,产线A\n"
+                                 "pump_2,line_a,泵,false,2号泵", catalog, &error));
+    QCOMPARE(catalog.deviceCount(), 3);
+    QCOMPARE(catalog.rootIds(), QStringList({"line_a"}));
+    QCOMPARE(catalog.indexOf("pump_2"), 2);
+    QCOMPARE(catalog.indexOf("missing"), -1);
+    const DeviceInfo line = catalog.device(catalog.indexOf("line_a"));
+    QVERIFY(line.isGroup);
+    QCOMPARE(line.children, QStringList({"pump_1", "pump_2"}));
+    QCOMPARE(catalog.record(0).name.toString(), QString("1号泵, 备用"));
+    QCOMPARE(catalog.record(0).parent, 1);
+    QCOMPARE(catalog.record(1).parent, -1);
+    QCOMPARE(catalog.types(), QStringList({"泵", "产线"}));
+    QCOMPARE(catalog.record(0).contentHash, CatalogLoader::contentHash(catalog.device(0)));
+
+    // 内容哈希只取决于名称、类型和分组标志
+    DeviceInfo moved = catalog.device(0);
+    moved.parentId = "elsewhere";
+    QCOMPARE(CatalogLoader::contentHash(moved), catalog.record(0).contentHash);
+    moved.name = "改名";
+    QVERIFY(CatalogLoader::contentHash(moved) != catalog.record(0).contentHash);
+
+    // 副本共用内存区，原目录释放后仍然有效
+    CatalogData copy = catalog;
+    catalog = CatalogData();
+    QCOMPARE(copy.device(2).name, QString("2号泵"));
+    QCOMPARE(copy.arenaCount(), 1);
+    QVERIFY(copy.reservedBytes() > 0);
+}
+
+void TestCatalogLoader::testParseErrors()
+{
+    CatalogData catalog;
+    QString error;
+
+    QVERIFY(!CatalogLoader::parse("a,,t,0\n", catalog, &error));
+    QVERIFY(error.contains("1"));
+    QVERIFY(!CatalogLoader::parse("a,,t,0,A\na,,t,0,B\n", catalog, &error));
+    QVERIFY(error.contains("a"));
+    QVERIFY(!CatalogLoader::parse("a,missing,t,0,A\n", catalog, &error));
+    QVERIFY(!CatalogLoader::parse("a,,t,maybe,A\n", catalog, &error));
+    QVERIFY(!CatalogLoader::parse("a,,t,0,\n", catalog, &error));
+    QVERIFY(!CatalogLoader::parse("a,b,t,1,A\nb,a,t,1,B\n", catalog, &error));
+    QVERIFY(!CatalogLoader::loadFile("/nonexistent/catalog.csv", catalog, &error));
+
+    // 空文件是合法的空目录
+    QVERIFY(CatalogLoader::parse("# empty\n", catalog, &error));
+    QVERIFY(catalog.isEmpty());
+    QVERIFY(!catalog.contains("a"));
+
+    // 解析失败时输出空目录
+    QVERIFY(CatalogLoader::parse("a,,t,0,A\n", catalog, &error));
+    QVERIFY(!CatalogLoader::parse("a,,t,0,A\nb,,t,0\n", catalog, &error));
+    QVERIFY(catalog.isEmpty());
+}
+
+void TestCatalogLoader::testApplyDiff()
+{
+    DeviceManager &manager = DeviceManager::instance();
+
+    // 第一次应用替换示例数据
+    CatalogDiffStats stats = CatalogLoader::applyDiff(manager, parseCatalog(baseCatalog()));
+    QCOMPARE(stats.added, 6);
+    QVERIFY(stats.removed > 0);
+    QCOMPARE(manager.getAllDevices().size(), 6);
+    QCOMPARE(manager.childIds(QString()), QStringList({"line_a", "line_b"}));
+    QCOMPARE(manager.childIds("line_b"), QStringList({"fan_1", "fan_2"}));
+
+    QSignalSpy insertedSpy(&manager, &DeviceManager::devicesInserted);
+    QSignalSpy removedSpy(&manager, &DeviceManager::devicesRemoved);
+    QSignalSpy changedSpy(&manager, &DeviceManager::devicesChanged);
+    QSignalSpy catalogSpy(&manager, &DeviceManager::catalogChanged);
+
+    // 改名一个、删除一个、新增一个
+    stats = CatalogLoader::applyDiff(manager, parseCatalog(
+        "line_a,,产线,1,产线A\n"
+        "pump_1,line_a,泵,0,1号泵（检修）\n"
+        "pump_3,line_a,泵,0,3号泵\n"
+        "line_b,,产线,1,产线B\n"
+        "fan_1,line_b,风机,0,1号风机\n"
+        "fan_2,line_b,风机,0,2号风机\n"));
+    QCOMPARE(stats.added, 1);
+    QCOMPARE(stats.removed, 1);
+    QCOMPARE(stats.changed, 1);
+    QCOMPARE(stats.moved, 0);
+    QCOMPARE(catalogSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(3).toStringList(), QStringList({"pump_3"}));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(3).toStringList(), QStringList({"pump_2"}));
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(manager.getDevice("pump_1").name, QString("1号泵（检修）"));
+    QCOMPARE(manager.childIds("line_a"), QStringList({"pump_1", "pump_3"}));
+
+    // 删除整个分组只发出一次删除
+    removedSpy.clear();
+    stats = CatalogLoader::applyDiff(manager, parseCatalog(
+        "line_a,,产线,1,产线A\n"
+        "pump_1,line_a,泵,0,1号泵（检修）\n"
+        "pump_3,line_a,泵,0,3号泵\n"));
+    QCOMPARE(stats.removed, 3);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(3).toStringList(), QStringList({"line_b", "fan_1", "fan_2"}));
+}
+
+void TestCatalogLoader::testApplyUnchangedIsNoop()
+{
+    DeviceManager &manager = DeviceManager::instance();
+    const CatalogData catalog = parseCatalog(baseCatalog());
+    CatalogLoader::applyDiff(manager, catalog);
+
+    QSignalSpy catalogSpy(&manager, &DeviceManager::catalogChanged);
+    const quint64 version = manager.catalogVersion();
+    const CatalogDiffStats stats = CatalogLoader::applyDiff(manager, catalog);
+    QCOMPARE(stats.total(), 0);
+    QCOMPARE(catalogSpy.count(), 0);
+    QCOMPARE(manager.catalogVersion(), version);
+}
+
+void TestCatalogLoader::testReorderAndReparent()
+{
+    DeviceManager &manager = DeviceManager::instance();
+    CatalogLoader::applyDiff(manager, parseCatalog(baseCatalog()));
+
+    // 调整产线A内的顺序、把1号风机移到产线A、把产线B嵌套到产线A下
+    const CatalogDiffStats stats = CatalogLoader::applyDiff(manager, parseCatalog(
+        "line_a,,产线,1,产线A\n"
+        "fan_1,line_a,风机,0,1号风机\n"
+        "pump_2,line_a,泵,0,2号泵\n"
+        "pump_1,line_a,泵,0,1号泵\n"
+        "line_b,line_a,产线,1,产线B\n"
+        "fan_2,line_b,风机,0,2号风机\n"));
+    QCOMPARE(stats.added, 0);
+    QCOMPARE(stats.removed, 0);
+    QCOMPARE(stats.changed, 0);
+    QVERIFY(stats.moved > 0);
+    QCOMPARE(manager.childIds(QString()), QStringList({"line_a"}));
+    QCOMPARE(manager.childIds("line_a"), QStringList({"fan_1", "pump_2", "pump_1", "line_b"}));
+    QCOMPARE(manager.childIds("line_b"), QStringList({"fan_2"}));
+
+    // 反向嵌套：原来的父分组移到子分组下
+    CatalogLoader::applyDiff(manager, parseCatalog(
+        "line_b,,产线,1,产线B\n"
+        "line_a,line_b,产线,1,产线A\n"
+        "fan_2,line_b,风机,0,2号风机\n"));
+    QCOMPARE(manager.childIds(QString()), QStringList({"line_b"}));
+    QCOMPARE(manager.childIds("line_b"), QStringList({"line_a", "fan_2"}));
+    QVERIFY(manager.childIds("line_a").isEmpty());
+    QCOMPARE(manager.getAllDevices().size(), 3);
+}
+
+void TestCatalogLoader::testWidgetStateKept()
+{
+    DeviceManager &manager = DeviceManager::instance();
+    CatalogLoader::applyDiff(manager, parseCatalog(baseCatalog()));
+
+    DeviceWidget widget;
+    QTreeView *tree = widget.findChild<QTreeView*>();
+    QVERIFY(tree != nullptr);
+    QAbstractItemModel *model = tree->model();
+    widget.setSelectedDevices(QStringList() << "pump_1" << "fan_2");
+    widget.setSearchText("号");
+    tree->collapse(model->index(1, 0));
+
+    QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+    QSignalSpy selectionSpy(&widget, &DeviceWidget::selectionChanged);
+
+    // 新增和改名不影响选择、展开状态和搜索文本
+    CatalogLoader::applyDiff(manager, parseCatalog(QByteArray(baseCatalog()).replace("2号泵", "2号泵（新）")
+                                                   + "pump_4,line_a,泵,0,4号泵\n"));
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(selectionSpy.count(), 0);
+    QCOMPARE(widget.getSelectedDevices(), QStringList() << "pump_1" << "fan_2");
+    QCOMPARE(widget.getSearchText(), QString("号"));
+    QVERIFY(tree->isExpanded(model->index(0, 0)));
+    QVERIFY(!tree->isExpanded(model->index(1, 0)));
+    QCOMPARE(model->rowCount(model->index(0, 0)), 3);
+    QCOMPARE(model->index(1, 0, model->index(0, 0)).data().toString(), QString("2号泵（新）"));
+
+    // 选中的设备被删除后从选择中移除
+    CatalogLoader::applyDiff(manager, parseCatalog(QByteArray(baseCatalog()).replace("pump_1,line_a,泵,0,1号泵\n", "")));
+    QCOMPARE(selectionSpy.count(), 1);
+    QCOMPARE(widget.getSelectedDevices(), QStringList() << "fan_2");
+}
+
+void TestCatalogLoader::testLoadCatalog()
+{
+    DeviceManager plant;
+    QSignalSpy loadedSpy(&plant, &DeviceManager::dataLoaded);
+    const CatalogData catalog = parseCatalog(baseCatalog());
+    QVERIFY(plant.loadCatalog(catalog));
+    QCOMPARE(loadedSpy.count(), 1);
+    QCOMPARE(plant.getAllDevices().size(), catalog.deviceCount());
+    QCOMPARE(plant.childIds(QString()), QStringList({"line_a", "line_b"}));
+    QCOMPARE(plant.childIds("line_a"), QStringList({"pump_1", "pump_2"}));
+    QCOMPARE(plant.getDevice("fan_2").parentId, QString("line_b"));
+    QCOMPARE(plant.getDevicesByType("泵").size(), 2);
+
+    // 整体替换后句柄按文件顺序分配，再应用相同目录没有差异
+    QCOMPARE(plant.snapshot()->deviceIdForHandle(0), QString("line_a"));
+    QCOMPARE(CatalogLoader::applyDiff(plant, catalog).total(), 0);
+
+    // 已登记的类型保留ID
+    const int pump = plant.deviceTypeId("泵");
+    QVERIFY(plant.loadCatalog(parseCatalog("pump_9,,泵,0,9号泵\n")));
+    QCOMPARE(plant.deviceTypeId("泵"), pump);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(pump), 1);
+    QCOMPARE(plant.getAllDevices().size(), 1);
+
+    // 事务中不能整体替换
+    plant.beginTransaction();
+    QVERIFY(!plant.loadCatalog(catalog));
+    QVERIFY(!plant.getLastError().isEmpty());
+    plant.commitTransaction();
+}
+
+void TestCatalogLoader::benchmarkReload_data()
+{
+    QTest::addColumn<bool>("useArena");
+    QTest::newRow("QHash<QString, DeviceInfo> intermediate") << false;
+    QTest::newRow("parse-side arena") << true;
+}
+
+void TestCatalogLoader::benchmarkReload()
+{
+    QFETCH(bool, useArena);
+    const int groupCount = 200;
+    const int devicesPerGroup = 100;
+    const QByteArray text = largeCatalog(groupCount, devicesPerGroup);
+    const qint64 residentBefore = residentBytes();
+
+    // 每次都从文本完整加载并构建快照，快照随即释放；两种方式只有解析
+    // 阶段不同，构建出的快照都使用Qt容器
+    int runs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ++runs;
+        CatalogBuilder builder;
+        if (useArena) {
+            CatalogData catalog;
+            QVERIFY(CatalogLoader::parse(text, catalog));
+            QVERIFY(builder.assign(catalog));
+        } else {
+            QHash<QString, DeviceInfo> devices;
+            QStringList types;
+            parseIntoHash(text, devices, types);
+            QVERIFY(builder.assign(devices, types));
+        }
+        QCOMPARE(builder.build(1)->deviceCount(), groupCount * (devicesPerGroup + 1));
+    }
+
+    const double ms = timer.nsecsElapsed() / 1e6 / runs;
+    qDebug() << (useArena ? "Parse-side arena" : "QHash intermediate") << "reload:" << ms << "ms per load," << runs << "reloads,"
+             << "resident memory grew" << (residentBytes() - residentBefore) / 1024 << "KB";
+}
+
+void TestCatalogLoader::testParallelParse()
+{
+    // 子设备在文件开头、父设备在文件末尾，层级跨越所有分块
+    const QByteArray text = "early_child,late_group,类型0,0,提前的设备\n" + largeCatalog(3000, 40)
+                            + "late_group,,分组,1,最后的分组";
+    QVERIFY(text.size() > 4 * CatalogLoader::ParallelChunkBytes);
+
+    CatalogData sequential;
+    CatalogData parallel;
+    QVERIFY(CatalogLoader::parse(text, sequential));
+    QVERIFY(CatalogLoader::parse(text.constData(), text.size(), parallel, 4));
+    QCOMPARE(sequential.arenaCount(), 1);
+    QCOMPARE(parallel.arenaCount(), 4);
+
+    // 记录顺序、行号、层级和哈希都与单线程解析相同
+    QCOMPARE(parallel.deviceCount(), sequential.deviceCount());
+    QCOMPARE(parallel.rootIds(), sequential.rootIds());
+    QCOMPARE(parallel.types(), sequential.types());
+    for (int i = 0; i < sequential.deviceCount(); ++i) {
+        const CatalogRecord &expected = sequential.record(i);
+        const CatalogRecord &actual = parallel.record(i);
+        QVERIFY(actual.id == expected.id);
+        QCOMPARE(actual.line, expected.line);
+        QCOMPARE(actual.parent, expected.parent);
+        QCOMPARE(actual.contentHash, expected.contentHash);
+        QCOMPARE(actual.childCount, expected.childCount);
+        QVERIFY(std::equal(actual.children, actual.children + actual.childCount, expected.children));
+    }
+    QCOMPARE(parallel.device(parallel.indexOf("late_group")).children, QStringList({"early_child"}));
+
+    // 映射文件后并行解析
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath("large_catalog.csv"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(text);
+    file.close();
+    CatalogData loaded;
+    QString error;
+    QVERIFY(CatalogLoader::loadFile(file.fileName(), loaded, &error, 0));
+    QCOMPARE(loaded.deviceCount(), sequential.deviceCount());
+
+    // 读入内存后并行解析，结果相同
+    CatalogData read;
+    QVERIFY(CatalogLoader::loadFile(file.fileName(), read, &error, 0, CatalogLoader::ReadIntoMemory));
+    QCOMPARE(read.deviceCount(), sequential.deviceCount());
+    QVERIFY(read.record(read.deviceCount() - 1).id == sequential.record(sequential.deviceCount() - 1).id);
+
+    // 小输入不切分
+    CatalogData small;
+    QVERIFY(CatalogLoader::parse(baseCatalog().constData(), baseCatalog().size(), small, 8));
+    QCOMPARE(small.arenaCount(), 1);
+    QCOMPARE(small.deviceCount(), 6);
+}
+
+void TestCatalogLoader::testParallelParseErrors()
+{
+    const QByteArray text = largeCatalog(3000, 40);
+
+    // 错误出现在不同分块中时，报告的仍是文件中最早的错误
+    const QByteArray broken[] = {
+        text + "group_10_3,group_10,类型1,0,重复\n",
+        text + "bad line\n",
+        QByteArray(text).replace("group_2000_5,group_2000,", "group_2000_5,missing_group,"),
+        "dup,,t,0,A\n" + text + "dup,,t,0,B\n",
+        "dup,,t,0,A\n" + text + "dup,,t,0,B\nbad line\n",
+        "a,,t,maybe,A\n" + text + "a,,t,0,A\n"
+    };
+    for (const QByteArray &data : broken) {
+        CatalogData sequential;
+        CatalogData parallel;
+        QString expectedError;
+        QString actualError;
+        QVERIFY(!CatalogLoader::parse(data, sequential, &expectedError));
+        QVERIFY(!CatalogLoader::parse(data.constData(), data.size(), parallel, 4, &actualError));
+        QCOMPARE(actualError, expectedError);
+        QVERIFY(parallel.isEmpty());
+    }
+}
+
+void TestCatalogLoader::benchmarkParallelParse_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+void TestCatalogLoader::benchmarkParallelParse()
+{
+    QFETCH(int, threadCount);
+    const QByteArray text = largeCatalog(5000, 50);
+
+    int runs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ++runs;
+        CatalogData catalog;
+        QVERIFY(CatalogLoader::parse(text.constData(), text.size(), catalog, threadCount));
+    }
+
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    if (seconds > 0.0) {
+        qDebug() << threadCount << "threads:" << runs * (text.size() / (1024.0 * 1024.0)) / seconds << "MB/s";
+    }
+}
+
+void TestCatalogLoader::testWatcherReload()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("device_catalog.csv");
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(baseCatalog());
+    file.close();
+
+    DeviceManager &manager = DeviceManager::instance();
+    CatalogWatcher watcher(&manager, path);
+    watcher.setSettleInterval(20);
+    QSignalSpy reloadedSpy(&watcher, &CatalogWatcher::catalogReloaded);
+    QSignalSpy failedSpy(&watcher, &CatalogWatcher::reloadFailed);
+
+    watcher.start();
+    QTRY_COMPARE_WITH_TIMEOUT(reloadedSpy.count(), 1, 5000);
+    QCOMPARE(manager.getAllDevices().size(), 6);
+
+    // 文件被整体替换（导出程序的原子写入）后仍能发现变化
+    const QString tempPath = dir.filePath("device_catalog.tmp");
+    QFile replacement(tempPath);
+    QVERIFY(replacement.open(QIODevice::WriteOnly));
+    replacement.write(baseCatalog() + "fan_3,line_b,风机,0,3号风机\n");
+    replacement.close();
+    QVERIFY(QFile::remove(path));
+    QVERIFY(QFile::rename(tempPath, path));
+    QTRY_VERIFY_WITH_TIMEOUT(manager.getDevice("fan_3").isValid(), 5000);
+    QCOMPARE(reloadedSpy.last().at(0).value<CatalogDiffStats>().added, 1);
+
+    // 解析失败时保持当前目录
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("broken line\n");
+    file.close();
+    QTRY_COMPARE_WITH_TIMEOUT(failedSpy.count(), 1, 5000);
+    QVERIFY(!watcher.getLastError().isEmpty());
+    QVERIFY(manager.getDevice("fan_3").isValid());
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestCatalogLoader test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_catalogloader_unit.moc"
@@ -0,0 +1,420 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include "CatalogLoader.h"
+#include "CatalogSnapshot.h"
+#include "DeviceManager.h"
+#include "StringPool.h"
+
+/**
+ * @brief CatalogSnapshot和CatalogBuilder单元测试类
+ *
+ * 测试快照在修改后保持不变、事务中的修改在提交前不发布、基于旧快照
+ * 的修改不能发布、类型和父设备的原子，以及后台线程在目录被反复修改
+ * 时读取快照的一致性
+ */
+class TestCatalogSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 快照测试
+    void testSnapshotUnchangedByMutation();
+    void testTransactionNotPublished();
+
+    // 发布测试
+    void testPublishBuilder();
+    void testStaleBuilderRejected();
+    void testHandleCompaction();
+
+    // 原子测试
+    void testAtoms();
+    void testAtomsReleased();
+    void testAtomMemory();
+
+    // 并发测试
+    void testConcurrentReaders();
+
+private:
+    DeviceManager &manager() { return DeviceManager::instance(); }
+
+    /**
+     * @brief 检查快照内部的层级和句柄是否一致
+     */
+    static bool isConsistent(const CatalogSnapshot &snapshot);
+};
+
+void TestCatalogSnapshot::initTestCase()
+{
+    qDebug() << "Starting CatalogSnapshot unit tests...";
+    manager().loadDeviceData();
+    QVERIFY(manager().isDataLoaded());
+}
+
+void TestCatalogSnapshot::cleanupTestCase()
+{
+    qDebug() << "CatalogSnapshot unit tests completed.";
+}
+
+bool TestCatalogSnapshot::isConsistent(const CatalogSnapshot &snapshot)
+{
+    const QList<DeviceInfo> devices = snapshot.allDevices();
+    if (devices.size() != snapshot.deviceCount()) {
+        return false;
+    }
+    for (const DeviceInfo &device : devices) {
+        if (!device.parentId.isEmpty() && !snapshot.contains(device.parentId)) {
+            return false;
+        }
+        if (snapshot.childIdAt(device.parentId, snapshot.deviceRow(device.id)) != device.id) {
+            return false;
+        }
+        if (snapshot.deviceIdForHandle(snapshot.deviceHandle(device.id)) != device.id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestCatalogSnapshot::testSnapshotUnchangedByMutation()
+{
+    const CatalogSnapshotPtr before = manager().snapshot();
+    const int count = before->deviceCount();
+
+    QVERIFY(manager().addDevice(DeviceInfo("sensor_200", "气体传感器", "传感器", "sensor_group")));
+    const CatalogSnapshotPtr after = manager().snapshot();
+
+    // 旧快照保持原样，新快照的版本号加一
+    QCOMPARE(before->deviceCount(), count);
+    QVERIFY(!before->contains("sensor_200"));
+    QVERIFY(after->contains("sensor_200"));
+    QCOMPARE(after->version(), before->version() + 1);
+    QCOMPARE(manager().catalogVersion(), after->version());
+
+    QVERIFY(manager().removeDevice("sensor_200"));
+    QVERIFY(after->contains("sensor_200"));
+    QVERIFY(!manager().snapshot()->contains("sensor_200"));
+}
+
+void TestCatalogSnapshot::testTransactionNotPublished()
+{
+    const quint64 version = manager().catalogVersion();
+
+    manager().beginTransaction();
+    QVERIFY(manager().addDevice(DeviceInfo("sensor_201", "烟雾传感器", "传感器", "sensor_group")));
+
+    // 管理器的查询看到未提交的修改，发布的快照看不到
+    QVERIFY(manager().getDevice("sensor_201").isValid());
+    QVERIFY(!manager().snapshot()->contains("sensor_201"));
+    QCOMPARE(manager().catalogVersion(), version);
+
+    // 事务进行中不能发布其他修改
+    CatalogBuilder builder(manager().snapshot());
+    QVERIFY(builder.removeDevice("sensor_001"));
+    QVERIFY(!manager().publish(builder));
+
+    manager().commitTransaction();
+    QVERIFY(manager().snapshot()->contains("sensor_201"));
+    QCOMPARE(manager().catalogVersion(), version + 1);
+
+    QVERIFY(manager().removeDevice("sensor_201"));
+}
+
+void TestCatalogSnapshot::testPublishBuilder()
+{
+    QSignalSpy insertedSpy(&manager(), &DeviceManager::devicesInserted);
+    QSignalSpy catalogSpy(&manager(), &DeviceManager::catalogChanged);
+    const CatalogSnapshotPtr base = manager().snapshot();
+
+    CatalogBuilder builder(base);
+    QVERIFY(builder.addDevice(DeviceInfo("sensor_202", "光照传感器", "传感器", "sensor_group")));
+    QVERIFY(builder.addDevice(DeviceInfo("sensor_203", "噪声传感器", "传感器", "sensor_group")));
+    QVERIFY(builder.current().contains("sensor_203"));
+    QVERIFY(!base->contains("sensor_202"));
+    QVERIFY(!manager().getDevice("sensor_202").isValid());
+
+    // 发布后按合并后的范围发出信号
+    QVERIFY(manager().publish(builder));
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(3).toStringList(), QStringList() << "sensor_202" << "sensor_203");
+    QCOMPARE(catalogSpy.count(), 1);
+    QCOMPARE(catalogSpy.at(0).at(0).toULongLong(), base->version() + 1);
+    QVERIFY(manager().getDevice("sensor_203").isValid());
+
+    // 没有修改的发布不产生新版本
+    const quint64 version = manager().catalogVersion();
+    QVERIFY(manager().publish(CatalogBuilder(manager().snapshot())));
+    QCOMPARE(manager().catalogVersion(), version);
+
+    QVERIFY(manager().removeDevice("sensor_202"));
+    QVERIFY(manager().removeDevice("sensor_203"));
+}
+
+void TestCatalogSnapshot::testStaleBuilderRejected()
+{
+    CatalogBuilder stale(manager().snapshot());
+    QVERIFY(stale.removeDevice("sensor_001"));
+
+    // 构造之后目录被修改，基于旧快照的差异不能发布
+    QVERIFY(manager().addDevice(DeviceInfo("sensor_204", "风速传感器", "传感器", "sensor_group")));
+    QSignalSpy removedSpy(&manager(), &DeviceManager::devicesRemoved);
+    QVERIFY(!manager().publish(stale));
+    QVERIFY(!manager().getLastError().isEmpty());
+    QCOMPARE(removedSpy.count(), 0);
+    QVERIFY(manager().getDevice("sensor_001").isValid());
+
+    QVERIFY(manager().removeDevice("sensor_204"));
+}
+
+void TestCatalogSnapshot::testHandleCompaction()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    const int baseHandles = plant.deviceHandleCount();
+
+    // 空位不超过一半时句柄保持不变
+    QSignalSpy spy(&plant, &DeviceManager::handlesRenumbered);
+    plant.beginTransaction();
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(plant.addDevice(DeviceInfo(QString("churn_%1").arg(i), "临时设备", "传感器")));
+    }
+    plant.commitTransaction();
+    const int lastHandle = plant.deviceHandle("churn_99");
+    QVERIFY(plant.removeDevice("churn_0"));
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(plant.deviceHandle("churn_99"), lastHandle);
+
+    // 超过一半后压缩，存活设备按原顺序重新编号
+    QStringList before;
+    for (const DeviceInfo &device : plant.snapshot()->allDevices()) {
+        before.append(device.id);
+    }
+    plant.beginTransaction();
+    for (int i = 1; i < 90; ++i) {
+        QVERIFY(plant.removeDevice(QString("churn_%1").arg(i)));
+    }
+    plant.commitTransaction();
+    QCOMPARE(spy.count(), 1);
+
+    const CatalogSnapshotPtr snapshot = plant.snapshot();
+    QCOMPARE(snapshot->handleCount(), snapshot->deviceCount());
+    QCOMPARE(snapshot->handleCount(), baseHandles + 10);
+    QVERIFY(isConsistent(*snapshot));
+    const QVector<int> renumbered = spy.at(0).at(0).value<QVector<int>>();
+    QCOMPARE(renumbered.size(), baseHandles + 100);
+    QCOMPARE(renumbered.value(lastHandle), snapshot->deviceHandle("churn_99"));
+    QCOMPARE(renumbered.value(lastHandle - 1), snapshot->deviceHandle("churn_98"));
+    QCOMPARE(renumbered.value(lastHandle - 10), -1);
+
+    // 句柄顺序与原来的目录顺序一致，按句柄保存的类型和父设备随之移动
+    QStringList after;
+    for (const DeviceInfo &device : snapshot->allDevices()) {
+        after.append(device.id);
+    }
+    QStringList expected = before;
+    for (int i = 1; i < 90; ++i) {
+        expected.removeOne(QString("churn_%1").arg(i));
+    }
+    QCOMPARE(after, expected);
+    const int sensor = snapshot->deviceHandle("sensor_001");
+    QCOMPARE(snapshot->typeId(sensor), snapshot->types().typeId("传感器"));
+    QCOMPARE(snapshot->parentAtom(sensor), snapshot->atom("sensor_group"));
+    QCOMPARE(snapshot->queryHandles("传感器", "临时设备").size(), 10);
+}
+
+void TestCatalogSnapshot::testAtoms()
+{
+    const CatalogSnapshotPtr snapshot = manager().snapshot();
+    const int sensor1 = snapshot->deviceHandle("sensor_001");
+    const int sensor2 = snapshot->deviceHandle("sensor_002");
+    const int group = snapshot->deviceHandle("sensor_group");
+
+    // 相同的类型映射为同一个类型ID，相同的父设备映射为同一个原子，顶层设备的父设备原子为0
+    QVERIFY(snapshot->typeId(sensor1) > 0);
+    QCOMPARE(snapshot->typeId(sensor1), snapshot->typeId(sensor2));
+    QCOMPARE(snapshot->typeId(sensor1), snapshot->types().typeId("传感器"));
+    QCOMPARE(snapshot->atomString(snapshot->atom("传感器")), QString("传感器"));
+    QCOMPARE(snapshot->parentAtom(sensor1), snapshot->parentAtom(sensor2));
+    QCOMPARE(snapshot->parentAtom(sensor1), snapshot->atom("sensor_group"));
+    QCOMPARE(snapshot->parentAtom(group), 0);
+    QCOMPARE(snapshot->atom("不存在的类型"), -1);
+    QVERIFY(snapshot->queryHandles("不存在的类型", QString()).isEmpty());
+
+    // 同一目录中相同的字符串共享数据
+    QCOMPARE(snapshot->device("sensor_001").type.constData(), snapshot->device("sensor_002").type.constData());
+
+    // 移动和删除更新按句柄保存的原子
+    QVERIFY(manager().addDevice(DeviceInfo("atom_001", "原子设备", "新类型", "sensor_group")));
+    QVERIFY(manager().moveDevice("atom_001", "child_group"));
+    const CatalogSnapshotPtr moved = manager().snapshot();
+    const int handle = moved->deviceHandle("atom_001");
+    QCOMPARE(moved->parentAtom(handle), moved->atom("child_group"));
+    QCOMPARE(moved->typeId(handle), moved->types().typeId("新类型"));
+    QCOMPARE(moved->atom("传感器"), snapshot->atom("传感器"));
+
+    QVERIFY(manager().removeDevice("atom_001"));
+    QCOMPARE(manager().snapshot()->typeId(handle), -1);
+    QCOMPARE(manager().snapshot()->parentAtom(handle), -1);
+    QVERIFY(manager().snapshot()->queryHandles("新类型", QString()).isEmpty());
+}
+
+void TestCatalogSnapshot::testAtomsReleased()
+{
+    StringPool pool;
+    DeviceManager plant(&pool);
+    plant.loadDeviceData();
+    const int atomCount = plant.snapshot()->atomCount();
+
+    // 父设备原子在最后一个子设备移走或删除后释放，空位留给新字符串
+    QVERIFY(plant.addDevice(DeviceInfo("churn_group", "临时分组", "分组")));
+    QVERIFY(plant.addDevice(DeviceInfo("churn_001", "临时设备1", "传感器", "churn_group")));
+    QVERIFY(plant.addDevice(DeviceInfo("churn_002", "临时设备2", "传感器", "churn_group")));
+    QVERIFY(plant.snapshot()->atom("churn_group") > 0);
+    QVERIFY(plant.moveDevice("churn_001", QString()));
+    QVERIFY(plant.snapshot()->atom("churn_group") > 0);
+    QVERIFY(plant.removeDevice("churn_group"));
+    QCOMPARE(plant.snapshot()->atom("churn_group"), -1);
+    QVERIFY(plant.removeDevice("churn_001"));
+
+    // 反复增删设备组时原子表不增长
+    for (int round = 0; round < 100; ++round) {
+        const QString groupId = QString("churn_group_%1").arg(round);
+        QVERIFY(plant.addDevice(DeviceInfo(groupId, "临时分组", "分组")));
+        QVERIFY(plant.addDevice(DeviceInfo(groupId + "_child", "临时设备", "传感器", groupId)));
+        QVERIFY(plant.removeDevice(groupId));
+    }
+    const CatalogSnapshotPtr snapshot = plant.snapshot();
+    QVERIFY(snapshot->atomCount() <= atomCount + 1);
+    QVERIFY(isConsistent(*snapshot));
+
+    // 仍被引用的原子不受影响，设备类型的原子一直保留
+    const int sensor = snapshot->deviceHandle("sensor_001");
+    QCOMPARE(snapshot->parentAtom(sensor), snapshot->atom("sensor_group"));
+    QVERIFY(snapshot->atom("分组") > 0);
+
+    // 整体替换时原子表从现有设备重建
+    QHash<QString, DeviceInfo> devices;
+    devices.insert("solo_group", DeviceInfo("solo_group", "分组", "分组"));
+    devices.insert("solo_001", DeviceInfo("solo_001", "设备", "传感器", "solo_group"));
+    CatalogBuilder builder(snapshot);
+    QVERIFY(builder.assign(devices, QStringList()));
+    const CatalogSnapshotPtr assigned = builder.build(snapshot->version() + 1);
+    QCOMPARE(assigned->atom("sensor_group"), -1);
+    QCOMPARE(assigned->parentAtom(assigned->deviceHandle("solo_001")), assigned->atom("solo_group"));
+    QCOMPARE(assigned->atomCount(), 1 + assigned->types().typeIds().size() + 1);
+}
+
+void TestCatalogSnapshot::testAtomMemory()
+{
+    // 一万个设备分布在两百个分组下，共十二种类型
+    const int groupCount = 200;
+    const int devicesPerGroup = 50;
+    QByteArray text;
+    for (int g = 0; g < groupCount; ++g) {
+        const QByteArray groupId = "group_" + QByteArray::number(g);
+        text += groupId + ",,分组,1,分组" + QByteArray::number(g) + "\n";
+        for (int d = 0; d < devicesPerGroup; ++d) {
+            text += groupId + "_" + QByteArray::number(d) + "," + groupId + ",类型"
+                    + QByteArray::number((g + d) % 12) + ",0,设备" + QByteArray::number(d) + "\n";
+        }
+    }
+    CatalogData catalog;
+    QVERIFY(CatalogLoader::parse(text, catalog));
+
+    // 驻留前每个设备各自保存类型和父设备ID
+    qint64 before = 0;
+    for (int i = 0; i < catalog.deviceCount(); ++i) {
+        const DeviceInfo device = catalog.device(i);
+        before += StringPool::stringBytes(device.type) + StringPool::stringBytes(device.parentId);
+    }
+
+    StringPool pool;
+    DeviceManager plant(&pool);
+    CatalogLoader::applyDiff(plant, catalog);
+    const CatalogSnapshotPtr snapshot = plant.snapshot();
+    QCOMPARE(snapshot->deviceCount(), catalog.deviceCount());
+
+    // 驻留后每个字符串保存一份，每个设备只多两个整数原子
+    qint64 after = static_cast<qint64>(snapshot->handleCount()) * 2 * sizeof(int);
+    for (int atom = 0; atom < snapshot->atomCount(); ++atom) {
+        after += StringPool::stringBytes(snapshot->atomString(atom));
+    }
+    qDebug() << "Type and parent strings for" << catalog.deviceCount() << "devices:"
+             << before << "bytes before interning," << after << "bytes after,"
+             << snapshot->atomCount() << "atoms; catalog total"
+             << snapshot->memoryUsage().total() << "bytes";
+
+    QCOMPARE(snapshot->atomCount(), 1 + 13 + groupCount);
+    QVERIFY(after * 2 < before);
+
+    // 按类型原子过滤的结果与逐个比较字符串一致
+    int typeCount = 0;
+    for (int i = 0; i < catalog.deviceCount(); ++i) {
+        typeCount += catalog.record(i).type.toString() == "类型3" ? 1 : 0;
+    }
+    QCOMPARE(snapshot->queryHandles("类型3", QString()).size(), typeCount);
+}
+
+void TestCatalogSnapshot::testConcurrentReaders()
+{
+    const int readerCount = 4;
+    std::atomic<bool> stop(false);
+    std::atomic<int> inconsistent(0);
+    std::atomic<int> reads(0);
+
+    DeviceManager *deviceManager = &manager();
+    QList<QThread *> readers;
+    for (int i = 0; i < readerCount; ++i) {
+        readers.append(QThread::create([deviceManager, &stop, &inconsistent, &reads]() {
+            while (!stop.load()) {
+                const CatalogSnapshotPtr snapshot = deviceManager->snapshot();
+                const QVector<int> handles = deviceManager->queryDeviceHandles(*snapshot, "传感器", QString());
+                bool ok = isConsistent(*snapshot);
+                for (const DeviceInfo &device : snapshot->devicesForHandles(handles)) {
+                    ok = ok && device.type == "传感器";
+                }
+                if (!ok) {
+                    ++inconsistent;
+                }
+                ++reads;
+            }
+        }));
+        readers.last()->start();
+    }
+
+    // 读者运行期间反复修改目录
+    const quint64 version = manager().catalogVersion();
+    const int rounds = 200;
+    for (int i = 0; i < rounds; ++i) {
+        const QString id = QString("sensor_3%1").arg(i, 2, 10, QChar('0'));
+        QVERIFY(manager().addDevice(DeviceInfo(id, "临时传感器", "传感器", "sensor_group"), 0));
+        QVERIFY(manager().moveDevice("sensor_001", i % 2 ? "sensor_group" : QString()));
+        QVERIFY(manager().removeDevice(id));
+    }
+
+    stop = true;
+    for (QThread *reader : readers) {
+        QVERIFY(reader->wait(10000));
+        delete reader;
+    }
+
+    QCOMPARE(manager().catalogVersion(), version + rounds * 3);
+    QVERIFY(reads.load() > 0);
+    QCOMPARE(inconsistent.load(), 0);
+    QVERIFY(isConsistent(*manager().snapshot()));
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    TestCatalogSnapshot test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_catalogsnapshot_unit.moc"
@@ -0,0 +1,266 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QDebug>
+#include "ChartPreviewWidget.h"
+
+/**
+ * @brief ChartPreviewWidget单元测试类
+ *
+ * 测试折线点数与控件宽度成正比、平移复用缓存、缩放范围限制以及
+ * 部分结果只为新设备生成折线
+ */
+class TestChartPreviewWidget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    // 数据测试
+    void testEmptyWidget();
+    void testSetDataResetsView();
+    void testPolylineBoundedByWidth();
+
+    // 视图测试
+    void testPanReusesCache();
+    void testZoomLimits();
+
+    // 增量测试
+    void testPartialResultsAppend();
+    void testDecimationModeInvalidates();
+    void testLiveAdvanceKeepsZoom();
+
+private:
+    static constexpr qint64 MsPerHour = 60 * 60 * 1000LL;
+    static constexpr qint64 MsPerDay = 24 * MsPerHour;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    TimeSeriesQueryResult makeResult(int devices, int days, TimeWidget::TimeGranularity granularity) const;
+
+    ChartPreviewWidget *m_widget;
+};
+
+void TestChartPreviewWidget::initTestCase()
+{
+    qDebug() << "Starting ChartPreviewWidget unit tests...";
+}
+
+void TestChartPreviewWidget::cleanupTestCase()
+{
+    qDebug() << "ChartPreviewWidget unit tests completed.";
+}
+
+void TestChartPreviewWidget::init()
+{
+    m_widget = new ChartPreviewWidget();
+    m_widget->resize(872, 300);  // 绘图区域宽800像素
+}
+
+void TestChartPreviewWidget::cleanup()
+{
+    delete m_widget;
+    m_widget = nullptr;
+}
+
+TimeSeriesQueryResult TestChartPreviewWidget::makeResult(int devices, int days,
+                                                         TimeWidget::TimeGranularity granularity) const
+{
+    TimeSeriesQueryResult result;
+    result.bucketer = TimeBucketer(BaseTime, BaseTime + days * MsPerDay, granularity);
+    for (int d = 0; d < devices; ++d) {
+        QVector<BucketAggregate> buckets(result.bucketer.bucketCount());
+        for (int i = 0; i < buckets.size(); ++i) {
+            buckets[i].add((i * 7 + d) % 100);
+        }
+        result.series.append(DeviceSeries(QString("sensor_%1").arg(d), buckets));
+    }
+    return result;
+}
+
+void TestChartPreviewWidget::testEmptyWidget()
+{
+    QCOMPARE(m_widget->seriesCount(), 0);
+    QVERIFY(m_widget->cachedPolyline(0).isEmpty());
+    QCOMPARE(m_widget->cacheRebuildCount(), 0);
+
+    // 没有数据时绘制提示文字
+    m_widget->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_widget));
+}
+
+void TestChartPreviewWidget::testSetDataResetsView()
+{
+    QSignalSpy spy(m_widget, &ChartPreviewWidget::viewRangeChanged);
+    const TimeSeriesQueryResult result = makeResult(3, 7, TimeWidget::Hour1);
+
+    m_widget->setData(result);
+    QCOMPARE(m_widget->seriesCount(), 3);
+    QCOMPARE(m_widget->viewStartMs(), result.bucketer.startMs());
+    QCOMPARE(m_widget->viewEndMs(), result.bucketer.endMs());
+    QCOMPARE(spy.count(), 1);
+
+    // 相同分桶的新结果保留视图
+    m_widget->zoom(2.0, result.bucketer.startMs());
+    const qint64 zoomedEnd = m_widget->viewEndMs();
+    m_widget->setData(makeResult(2, 7, TimeWidget::Hour1));
+    QCOMPARE(m_widget->viewEndMs(), zoomedEnd);
+
+    m_widget->clear();
+    QCOMPARE(m_widget->seriesCount(), 0);
+    QCOMPARE(m_widget->viewStartMs(), m_widget->viewEndMs());
+}
+
+void TestChartPreviewWidget::testPolylineBoundedByWidth()
+{
+    // 一年的15分钟数据（约3.5万个桶）降到与宽度成正比的点数
+    m_widget->setData(makeResult(1, 365, TimeWidget::Minutes15));
+    const QPolygonF polyline = m_widget->cachedPolyline(0);
+    QVERIFY(!polyline.isEmpty());
+    QVERIFY(polyline.size() <= 4 * 800);
+
+    // 控件变窄后点数随之减少
+    m_widget->resize(472, 300);
+    QVERIFY(m_widget->cachedPolyline(0).size() <= 4 * 400);
+    QCOMPARE(m_widget->cacheRebuildCount(), 2);
+
+    // 绘制一次
+    m_widget->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_widget));
+}
+
+void TestChartPreviewWidget::testPanReusesCache()
+{
+    const TimeSeriesQueryResult result = makeResult(2, 30, TimeWidget::Minutes15);
+    m_widget->setData(result);
+
+    // 放大到中间的1/8
+    const qint64 middle = (result.bucketer.startMs() + result.bucketer.endMs()) / 2;
+    m_widget->zoom(8.0, middle);
+    m_widget->cachedPolyline(0);
+    const int rebuilds = m_widget->cacheRebuildCount();
+    const qint64 span = m_widget->viewEndMs() - m_widget->viewStartMs();
+
+    // 一屏以内的平移只改变绘制变换
+    m_widget->pan(span / 2);
+    m_widget->pan(-span);
+    m_widget->cachedPolyline(0);
+    QCOMPARE(m_widget->cacheRebuildCount(), rebuilds);
+    QCOMPARE(m_widget->viewEndMs() - m_widget->viewStartMs(), span);
+
+    // 超出缓存范围后重新降采样
+    m_widget->pan(3 * span);
+    m_widget->cachedPolyline(0);
+    QCOMPARE(m_widget->cacheRebuildCount(), rebuilds + 1);
+}
+
+void TestChartPreviewWidget::testZoomLimits()
+{
+    const TimeSeriesQueryResult result = makeResult(1, 7, TimeWidget::Hour1);
+    m_widget->setData(result);
+
+    // 缩小不超过完整范围
+    m_widget->zoom(0.1, result.bucketer.startMs());
+    QCOMPARE(m_widget->viewStartMs(), result.bucketer.startMs());
+    QCOMPARE(m_widget->viewEndMs(), result.bucketer.endMs());
+
+    // 放大不小于一个时间桶
+    m_widget->zoom(1000000.0, result.bucketer.startMs());
+    QCOMPARE(m_widget->viewEndMs() - m_widget->viewStartMs(), TimeBucketer::granularityMs(TimeWidget::Hour1));
+
+    // 平移不超出数据范围
+    m_widget->pan(-MsPerDay);
+    QCOMPARE(m_widget->viewStartMs(), result.bucketer.startMs());
+
+    m_widget->resetView();
+    QCOMPARE(m_widget->viewEndMs(), result.bucketer.endMs());
+}
+
+void TestChartPreviewWidget::testPartialResultsAppend()
+{
+    const TimeSeriesQueryResult result = makeResult(3, 7, TimeWidget::Hour1);
+    m_widget->clear();
+
+    PartialQueryResult partial;
+    partial.bucketer = result.bucketer;
+    partial.totalDevices = 3;
+    partial.series = result.series.mid(0, 1);
+    partial.completedDevices = 1;
+    m_widget->addSeries(partial);
+    QCOMPARE(m_widget->seriesCount(), 1);
+    QVERIFY(!m_widget->cachedPolyline(0).isEmpty());
+    const int rebuilds = m_widget->cacheRebuildCount();
+
+    // 后续批次只为新设备生成折线
+    partial.series = result.series.mid(1);
+    partial.completedDevices = 3;
+    m_widget->addSeries(partial);
+    QCOMPARE(m_widget->seriesCount(), 3);
+    QVERIFY(!m_widget->cachedPolyline(2).isEmpty());
+    QCOMPARE(m_widget->cacheRebuildCount(), rebuilds);
+}
+
+void TestChartPreviewWidget::testDecimationModeInvalidates()
+{
+    m_widget->setData(makeResult(1, 30, TimeWidget::Minutes15));
+    const QPolygonF minMax = m_widget->cachedPolyline(0);
+
+    m_widget->setDecimationMode(SeriesDecimator::Lttb);
+    QCOMPARE(m_widget->decimationMode(), SeriesDecimator::Lttb);
+    const QPolygonF lttb = m_widget->cachedPolyline(0);
+    QVERIFY(lttb.size() <= 800);
+    QVERIFY(lttb != minMax);
+}
+
+void TestChartPreviewWidget::testLiveAdvanceKeepsZoom()
+{
+    // 模拟实时窗口：7天窗口每次向后滑动一小时
+    auto windowAt = [this](qint64 shiftMs) {
+        TimeSeriesQueryResult result = makeResult(2, 7, TimeWidget::Hour1);
+        result.bucketer = TimeBucketer(BaseTime + shiftMs, BaseTime + 7 * MsPerDay + shiftMs, TimeWidget::Hour1);
+        return result;
+    };
+    m_widget->setData(windowAt(0));
+
+    // 完整视图跟随新窗口
+    m_widget->advanceData(windowAt(MsPerHour));
+    QCOMPARE(m_widget->viewStartMs(), BaseTime + MsPerHour);
+    QCOMPARE(m_widget->viewEndMs(), BaseTime + 7 * MsPerDay + MsPerHour);
+
+    // 贴着右端放大后，视图随新数据平移且跨度不变
+    m_widget->setViewRange(BaseTime + 6 * MsPerDay + MsPerHour, BaseTime + 7 * MsPerDay + MsPerHour);
+    m_widget->advanceData(windowAt(2 * MsPerHour));
+    QCOMPARE(m_widget->viewStartMs(), BaseTime + 6 * MsPerDay + 2 * MsPerHour);
+    QCOMPARE(m_widget->viewEndMs(), BaseTime + 7 * MsPerDay + 2 * MsPerHour);
+
+    // 查看历史时保持原时间范围
+    m_widget->setViewRange(BaseTime + 3 * MsPerDay, BaseTime + 4 * MsPerDay);
+    m_widget->advanceData(windowAt(3 * MsPerHour));
+    QCOMPARE(m_widget->viewStartMs(), BaseTime + 3 * MsPerDay);
+    QCOMPARE(m_widget->viewEndMs(), BaseTime + 4 * MsPerDay);
+
+    // 视图滑出窗口左端时限制在新数据范围内
+    m_widget->setViewRange(BaseTime + 3 * MsPerHour, BaseTime + 5 * MsPerHour);
+    m_widget->advanceData(windowAt(4 * MsPerHour));
+    QCOMPARE(m_widget->viewStartMs(), BaseTime + 4 * MsPerHour);
+    QCOMPARE(m_widget->viewEndMs(), BaseTime + 6 * MsPerHour);
+    QCOMPARE(m_widget->seriesCount(), 2);
+
+    // 粒度改变时恢复完整范围
+    m_widget->advanceData(makeResult(1, 7, TimeWidget::Minutes15));
+    QCOMPARE(m_widget->viewStartMs(), BaseTime);
+    QCOMPARE(m_widget->viewEndMs(), BaseTime + 7 * MsPerDay);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestChartPreviewWidget test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_chartpreviewwidget_unit.moc"
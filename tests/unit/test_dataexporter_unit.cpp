@@ -0,0 +1,344 @@
+#include <QApplication>
+#include <QDir>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDebug>
+#include <cstring>
+#include "DataExporter.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+
+/**
+ * @brief DataExporter单元测试类
+ *
+ * 测试CSV与列式二进制导出的内容、按块流式写出、取消时目标文件不变
+ * 以及后台导出的进度与吞吐统计
+ */
+class TestDataExporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 内容测试
+    void testAggregatedCsv();
+    void testRawCsvRange();
+    void testRawColumnarBlocks();
+    void testAggregatedColumnar();
+
+    // 控制测试
+    void testCancelKeepsTarget();
+    void testReadErrorStopsExport();
+    void testBackgroundExport();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 MsPerDay = 24 * 60 * MsPerMinute;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    ExportRequest makeRequest(const QString &filePath, ExportRequest::Format format,
+                              ExportRequest::Content content) const;
+    QList<QByteArray> readLines(const QString &filePath) const;
+
+    template <typename T>
+    static T readValue(const QByteArray &data, int &offset)
+    {
+        T value;
+        std::memcpy(&value, data.constData() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+};
+
+void TestDataExporter::initTestCase()
+{
+    qDebug() << "Starting DataExporter unit tests...";
+}
+
+void TestDataExporter::cleanupTestCase()
+{
+    qDebug() << "DataExporter unit tests completed.";
+}
+
+ExportRequest TestDataExporter::makeRequest(const QString &filePath, ExportRequest::Format format,
+                                            ExportRequest::Content content) const
+{
+    ExportRequest request;
+    request.query = TimeSeriesQuery(QStringList() << "sensor_001" << "sensor,002",
+                                    BaseTime, BaseTime + 2 * MsPerDay, TimeWidget::Hour1);
+    request.filePath = filePath;
+    request.format = format;
+    request.content = content;
+    return request;
+}
+
+QList<QByteArray> TestDataExporter::readLines(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QList<QByteArray>();
+    }
+    QList<QByteArray> lines = file.readAll().split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    return lines;
+}
+
+void TestDataExporter::testAggregatedCsv()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+    QVERIFY(TestSeries::appendMinutes(store, "sensor,002", 60, 0.5));
+
+    ExportRunner runner(&store);
+    const QString path = dir.path() + "/aggregated.csv";
+    const ExportStats stats = runner.exportData(
+        makeRequest(path, ExportRequest::Csv, ExportRequest::Aggregated), QueryCancelToken());
+    QVERIFY2(stats.succeeded(), qPrintable(stats.error));
+
+    const QList<QByteArray> lines = readLines(path);
+    QCOMPARE(lines.first(), QByteArray("device_id,bucket_start_ms,count,min,max,avg,first,last"));
+
+    // 每个非空桶一行，设备ID中的逗号被转义
+    const TimeSeriesQueryResult expected = store.query(makeRequest(path, ExportRequest::Csv,
+                                                                   ExportRequest::Aggregated).query);
+    int nonEmpty = 0;
+    for (const DeviceSeries &series : expected.series) {
+        for (const BucketAggregate &bucket : series.buckets) {
+            nonEmpty += bucket.isEmpty() ? 0 : 1;
+        }
+    }
+    QCOMPARE(lines.size() - 1, nonEmpty);
+    QCOMPARE(stats.rowsWritten, qint64(nonEmpty));
+    qint64 secondDeviceSamples = 0;
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("\"sensor,002\",")) {
+            secondDeviceSamples += line.split(',').at(3).toLongLong();
+        }
+    }
+    QCOMPARE(secondDeviceSamples, qint64(60));
+    QVERIFY(lines.last().endsWith(",29.5"));
+    QCOMPARE(stats.bytesWritten, QFile(path).size());
+}
+
+void TestDataExporter::testRawCsvRange()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+
+    // 原始样本严格按查询范围导出，不按桶对齐
+    ExportRequest request = makeRequest(dir.path() + "/raw.csv", ExportRequest::Csv, ExportRequest::RawSamples);
+    request.query.deviceIds = QStringList() << "sensor_001";
+    request.query.startMs = BaseTime + 10 * MsPerMinute + 1;
+    request.query.endMs = BaseTime + 20 * MsPerMinute;
+
+    ExportRunner runner(&store);
+    const ExportStats stats = runner.exportData(request, QueryCancelToken());
+    QVERIFY(stats.succeeded());
+
+    const QList<QByteArray> lines = readLines(request.filePath);
+    QCOMPARE(lines.size(), 1 + 9);
+    QCOMPARE(lines.at(1), QByteArray("sensor_001,") + QByteArray::number(BaseTime + 11 * MsPerMinute) + ",5.5");
+    QCOMPARE(stats.completedDevices, 1);
+    QCOMPARE(stats.completeness, 1.0);
+}
+
+void TestDataExporter::testRawColumnarBlocks()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+    QVERIFY(TestSeries::appendMinutes(store, "sensor,002", 100, 0.5));
+
+    ExportRequest request = makeRequest(dir.path() + "/raw.tscol", ExportRequest::Columnar,
+                                        ExportRequest::RawSamples);
+    request.blockRows = 1000;
+
+    ExportRunner runner(&store);
+    const ExportStats stats = runner.exportData(request, QueryCancelToken());
+    QVERIFY(stats.succeeded());
+    QCOMPARE(stats.rowsWritten, qint64(2 * 24 * 60 + 100));
+
+    QFile file(request.filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+
+    // 文件头
+    QCOMPARE(data.left(8), QByteArray("TSCOLEXP"));
+    int offset = 8;
+    QCOMPARE(readValue<quint32>(data, offset), quint32(1));
+    QCOMPARE(readValue<quint32>(data, offset), quint32(ExportRequest::RawSamples));
+    QCOMPARE(readValue<qint32>(data, offset), qint32(TimeWidget::Hour1));
+    QCOMPARE(readValue<quint32>(data, offset), quint32(2));
+    for (const QString &deviceId : request.query.deviceIds) {
+        const quint16 length = readValue<quint16>(data, offset);
+        QCOMPARE(QString::fromUtf8(data.mid(offset, length)), deviceId);
+        offset += length;
+    }
+
+    // 数据块：每块不超过blockRows行，且不跨数据块（每天1440个样本切成两块）
+    QVector<qint64> rowsPerDevice(2, 0);
+    quint64 blocks = 0;
+    qint64 expectedTimestamp = BaseTime;
+    while (offset < data.size() && data.mid(offset, 8) != QByteArray("TSCOLEND")) {
+        const quint32 deviceIndex = readValue<quint32>(data, offset);
+        const quint32 rows = readValue<quint32>(data, offset);
+        QVERIFY(deviceIndex < 2);
+        QVERIFY(rows > 0 && rows <= 1000);
+        const int valuesOffset = offset + rows * sizeof(qint64);
+        for (quint32 i = 0; i < rows; ++i) {
+            int tsOffset = offset + i * sizeof(qint64);
+            int valOffset = valuesOffset + i * sizeof(double);
+            const qint64 timestamp = readValue<qint64>(data, tsOffset);
+            if (deviceIndex == 0) {
+                QCOMPARE(timestamp, expectedTimestamp);
+                expectedTimestamp += MsPerMinute;
+            }
+            QCOMPARE(readValue<double>(data, valOffset), (timestamp - BaseTime) / MsPerMinute * 0.5);
+        }
+        offset = valuesOffset + rows * sizeof(double);
+        rowsPerDevice[deviceIndex] += rows;
+        ++blocks;
+    }
+    QCOMPARE(blocks, quint64(2 + 2 + 1));
+    QCOMPARE(rowsPerDevice.at(0), qint64(2 * 24 * 60));
+    QCOMPARE(rowsPerDevice.at(1), qint64(100));
+
+    // 文件尾
+    offset += 8;
+    QCOMPARE(readValue<quint64>(data, offset), quint64(stats.rowsWritten));
+    QCOMPARE(readValue<quint64>(data, offset), blocks);
+    QCOMPARE(offset, data.size());
+}
+
+void TestDataExporter::testAggregatedColumnar()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+
+    ExportRequest request = makeRequest(dir.path() + "/aggregated.tscol", ExportRequest::Columnar,
+                                        ExportRequest::Aggregated);
+    request.query.deviceIds = QStringList() << "sensor_001";
+    request.blockRows = 10;
+
+    ExportRunner runner(&store);
+    const ExportStats stats = runner.exportData(request, QueryCancelToken());
+    QVERIFY(stats.succeeded());
+
+    const TimeSeriesQueryResult expected = store.query(request.query);
+    QCOMPARE(stats.rowsWritten, qint64(expected.bucketer.bucketCount()));
+
+    QFile file(request.filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+
+    // 跳过文件头，读第一块的七列
+    int offset = 8 + 4 * sizeof(quint32);
+    const quint16 idLength = readValue<quint16>(data, offset);
+    offset += idLength;
+    QCOMPARE(readValue<quint32>(data, offset), quint32(0));
+    const quint32 rows = readValue<quint32>(data, offset);
+    QCOMPARE(rows, quint32(10));
+
+    const BucketAggregate &bucket = expected.series.first().buckets.at(3);
+    int column = offset + 3 * sizeof(qint64);
+    QCOMPARE(readValue<qint64>(data, column), expected.bucketer.bucketStart(3));
+    column = offset + rows * sizeof(qint64) + 3 * sizeof(qint64);
+    QCOMPARE(readValue<qint64>(data, column), bucket.count);
+    column = offset + 2 * rows * sizeof(qint64) + 3 * sizeof(double);
+    QCOMPARE(readValue<double>(data, column), bucket.sum);
+    column = offset + 2 * rows * sizeof(qint64) + (4 * rows + 3) * sizeof(double);
+    QCOMPARE(readValue<double>(data, column), bucket.last);
+}
+
+void TestDataExporter::testCancelKeepsTarget()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 24 * 60, 0.5));
+
+    const QString path = dir.path() + "/existing.csv";
+    QFile existing(path);
+    QVERIFY(existing.open(QIODevice::WriteOnly));
+    existing.write("previous export\n");
+    existing.close();
+
+    QueryCancelToken token;
+    token.cancel();
+    ExportRunner runner(&store);
+    const ExportStats stats = runner.exportData(makeRequest(path, ExportRequest::Csv, ExportRequest::RawSamples), token);
+
+    QVERIFY(stats.cancelled);
+    QVERIFY(!stats.succeeded());
+    QCOMPARE(readLines(path), QList<QByteArray>() << "previous export");
+}
+
+void TestDataExporter::testReadErrorStopsExport()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+
+    // 第二天的数据块读不出来，导出失败且不留下缺少样本的文件
+    const qint64 secondChunk = store.chunkStarts("sensor_001").at(1);
+    const QString valPath = dir.path() + "/store/sensor_001/" + QString::number(secondChunk) + ".val";
+    QVERIFY(QFile::remove(valPath));
+    QVERIFY(QDir().mkpath(valPath));
+
+    const QString path = dir.path() + "/raw.csv";
+    QueryCancelToken token;
+    ExportRunner runner(&store);
+    const ExportStats stats = runner.exportData(makeRequest(path, ExportRequest::Csv, ExportRequest::RawSamples), token);
+
+    QVERIFY(!stats.succeeded());
+    QVERIFY(!stats.cancelled);
+    QVERIFY(stats.error.contains(QString::number(secondChunk)));
+    QVERIFY(!QFile::exists(path));
+}
+
+void TestDataExporter::testBackgroundExport()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path() + "/store");
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60, 0.5));
+
+    DataExporter exporter(&store);
+    QSignalSpy finishedSpy(&exporter, &DataExporter::finished);
+
+    // 无效请求不会开始
+    QVERIFY(!exporter.start(ExportRequest()));
+    QVERIFY(!exporter.getLastError().isEmpty());
+
+    const ExportRequest request = makeRequest(dir.path() + "/raw.csv", ExportRequest::Csv, ExportRequest::RawSamples);
+    QVERIFY(exporter.start(request));
+    QVERIFY(exporter.isRunning());
+    // 同一时刻只允许一个导出
+    QVERIFY(!exporter.start(request));
+
+    QVERIFY(finishedSpy.wait(10000));
+    QVERIFY(!exporter.isRunning());
+    const ExportStats stats = finishedSpy.first().first().value<ExportStats>();
+    QVERIFY(stats.succeeded());
+    QCOMPARE(stats.rowsWritten, qint64(2 * 24 * 60));
+    QVERIFY(stats.megabytesPerSecond() > 0.0);
+    QCOMPARE(exporter.lastStats().rowsWritten, stats.rowsWritten);
+    qDebug() << "Raw CSV export:" << stats.bytesWritten << "bytes," << stats.megabytesPerSecond() << "MB/s";
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestDataExporter test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_dataexporter_unit.moc"
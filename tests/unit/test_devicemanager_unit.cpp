@@ -0,0 +1,363 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include "DeviceManager.h"
+
+/**
+ * @brief DeviceManager单元测试类
+ *
+ * 测试设备目录的增删改移操作、事务内变更信号的合并、删除后句柄
+ * 失效、查询缓存随修改失效，以及异步查询的结果、取消和并发吞吐量。
+ * 每个测试结束时恢复示例数据的目录。
+ */
+class TestDeviceManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 单个操作测试
+    void testAddAndRemoveDevice();
+    void testInvalidOperations();
+    void testUpdateDevice();
+    void testMoveDevice();
+
+    // 事务测试
+    void testTransactionMergesRanges();
+    void testNestedTransaction();
+    void testRemoveSubtree();
+
+    // 异步查询测试
+    void testAsyncQueries();
+    void testAsyncUsesPinnedSnapshot();
+    void testAsyncCancel();
+    void benchmarkConcurrentCallers_data();
+    void benchmarkConcurrentCallers();
+
+private:
+    DeviceManager &manager() { return DeviceManager::instance(); }
+};
+
+void TestDeviceManager::initTestCase()
+{
+    qDebug() << "Starting DeviceManager unit tests...";
+    manager().loadDeviceData();
+    QVERIFY(manager().isDataLoaded());
+}
+
+void TestDeviceManager::cleanupTestCase()
+{
+    qDebug() << "DeviceManager unit tests completed.";
+}
+
+void TestDeviceManager::testAddAndRemoveDevice()
+{
+    QSignalSpy insertedSpy(&manager(), &DeviceManager::devicesInserted);
+    QSignalSpy removedSpy(&manager(), &DeviceManager::devicesRemoved);
+    QSignalSpy catalogSpy(&manager(), &DeviceManager::catalogChanged);
+    const quint64 version = manager().catalogVersion();
+    const int sensorCount = manager().getDevicesByType("传感器").size();
+
+    // 不在事务中的单个修改立即提交
+    QVERIFY(manager().addDevice(DeviceInfo("sensor_100", "振动传感器", "传感器", "sensor_group"), 1));
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(0).toString(), QString("sensor_group"));
+    QCOMPARE(insertedSpy.at(0).at(1).toInt(), 1);
+    QCOMPARE(insertedSpy.at(0).at(2).toInt(), 1);
+    QCOMPARE(insertedSpy.at(0).at(3).toStringList(), QStringList({"sensor_100"}));
+    QCOMPARE(catalogSpy.count(), 1);
+    QCOMPARE(manager().catalogVersion(), version + 1);
+    QCOMPARE(manager().deviceRow("sensor_100"), 1);
+    QCOMPARE(manager().childIds("sensor_group").at(1), QString("sensor_100"));
+
+    // 查询缓存随目录版本失效
+    QCOMPARE(manager().getDevicesByType("传感器").size(), sensorCount + 1);
+    QVERIFY(manager().deviceHandle("sensor_100") >= 0);
+
+    QVERIFY(manager().removeDevice("sensor_100"));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), 1);
+    QCOMPARE(manager().getDevicesByType("传感器").size(), sensorCount);
+    QCOMPARE(manager().deviceHandle("sensor_100"), -1);
+    QVERIFY(!manager().getDevice("sensor_100").isValid());
+    QCOMPARE(catalogSpy.count(), 2);
+}
+
+void TestDeviceManager::testInvalidOperations()
+{
+    QSignalSpy catalogSpy(&manager(), &DeviceManager::catalogChanged);
+
+    QVERIFY(!manager().addDevice(DeviceInfo("sensor_001", "重复", "传感器", "sensor_group")));
+    QVERIFY(!manager().getLastError().isEmpty());
+    QVERIFY(!manager().addDevice(DeviceInfo("orphan", "孤立设备", "传感器", "missing_group")));
+    QVERIFY(!manager().addDevice(DeviceInfo("", "无ID", "传感器")));
+    QVERIFY(!manager().updateDevice(DeviceInfo("missing", "不存在", "传感器")));
+    QVERIFY(!manager().removeDevice("missing"));
+    QVERIFY(!manager().moveDevice("sensor_001", "missing_group"));
+
+    // 不能移动到自身的子设备下
+    QVERIFY(!manager().moveDevice("sensor_group", "sensor_001"));
+    QVERIFY(!manager().moveDevice("sensor_group", "sensor_group"));
+
+    QCOMPARE(catalogSpy.count(), 0);
+}
+
+void TestDeviceManager::testUpdateDevice()
+{
+    QSignalSpy changedSpy(&manager(), &DeviceManager::devicesChanged);
+    QSignalSpy typesSpy(&manager(), &DeviceManager::deviceTypesChanged);
+    const DeviceInfo original = manager().getDevice("sensor_002");
+
+    DeviceInfo device = original;
+    device.name = "温度传感器B2";
+    device.type = "测试类型";
+    QVERIFY(manager().updateDevice(device));
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.at(0).at(3).toStringList(), QStringList({"sensor_002"}));
+    QCOMPARE(typesSpy.count(), 1);
+    QVERIFY(manager().getDeviceTypes().contains("测试类型"));
+    QCOMPARE(manager().getDevice("sensor_002").name, QString("温度传感器B2"));
+    QCOMPARE(manager().getDevice("sensor_002").children, original.children);
+
+    // 没有变化时不发信号
+    QVERIFY(manager().updateDevice(device));
+    QCOMPARE(changedSpy.count(), 1);
+
+    QVERIFY(manager().updateDevice(original));
+    QCOMPARE(manager().getDevice("sensor_002").type, original.type);
+}
+
+void TestDeviceManager::testMoveDevice()
+{
+    QSignalSpy movedSpy(&manager(), &DeviceManager::devicesMoved);
+    const int sourceRow = manager().deviceRow("sensor_001");
+
+    QVERIFY(manager().moveDevice("sensor_001", "child_group", 0));
+    QCOMPARE(movedSpy.count(), 1);
+    const QList<QVariant> args = movedSpy.at(0);
+    QCOMPARE(args.at(0).toString(), QString("sensor_group"));
+    QCOMPARE(args.at(1).toInt(), sourceRow);
+    QCOMPARE(args.at(3).toString(), QString("child_group"));
+    QCOMPARE(args.at(4).toInt(), 0);
+    QCOMPARE(manager().getDevice("sensor_001").parentId, QString("child_group"));
+    QCOMPARE(manager().childIds("child_group").first(), QString("sensor_001"));
+    QVERIFY(!manager().childIds("sensor_group").contains("sensor_001"));
+
+    // 移回原位置；同一父设备内移动到当前位置不发信号
+    QVERIFY(manager().moveDevice("sensor_001", "sensor_group", sourceRow));
+    QCOMPARE(manager().deviceRow("sensor_001"), sourceRow);
+    QVERIFY(manager().moveDevice("sensor_001", "sensor_group", sourceRow));
+    QCOMPARE(movedSpy.count(), 2);
+}
+
+void TestDeviceManager::testTransactionMergesRanges()
+{
+    QSignalSpy insertedSpy(&manager(), &DeviceManager::devicesInserted);
+    QSignalSpy removedSpy(&manager(), &DeviceManager::devicesRemoved);
+    QSignalSpy changedSpy(&manager(), &DeviceManager::devicesChanged);
+    QSignalSpy catalogSpy(&manager(), &DeviceManager::catalogChanged);
+    const quint64 version = manager().catalogVersion();
+
+    // 一个分组和其下的三个设备：分组插入一次，连续的子设备合并为一个范围
+    manager().beginTransaction();
+    QVERIFY(manager().inTransaction());
+    QVERIFY(manager().addDevice(DeviceInfo("batch_group", "批量分组", "传感器", "", true)));
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(manager().addDevice(DeviceInfo(QString("batch_%1").arg(i), QString("批量设备%1").arg(i),
+                                               "传感器", "batch_group")));
+    }
+    QCOMPARE(insertedSpy.count(), 0);
+    QVERIFY(manager().getDevice("batch_1").isValid());
+    manager().commitTransaction();
+    QVERIFY(!manager().inTransaction());
+
+    QCOMPARE(insertedSpy.count(), 2);
+    QCOMPARE(insertedSpy.at(0).at(0).toString(), QString());
+    QCOMPARE(insertedSpy.at(1).at(0).toString(), QString("batch_group"));
+    QCOMPARE(insertedSpy.at(1).at(1).toInt(), 0);
+    QCOMPARE(insertedSpy.at(1).at(2).toInt(), 2);
+    QCOMPARE(insertedSpy.at(1).at(3).toStringList(), QStringList({"batch_0", "batch_1", "batch_2"}));
+    QCOMPARE(catalogSpy.count(), 1);
+    QCOMPARE(manager().catalogVersion(), version + 1);
+
+    // 相邻设备的修改合并为一个范围
+    manager().beginTransaction();
+    for (int i = 2; i >= 0; --i) {
+        DeviceInfo device = manager().getDevice(QString("batch_%1").arg(i));
+        device.name += "*";
+        QVERIFY(manager().updateDevice(device));
+    }
+    manager().commitTransaction();
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.at(0).at(1).toInt(), 0);
+    QCOMPARE(changedSpy.at(0).at(2).toInt(), 2);
+
+    // 连续删除同一位置的设备合并为一个范围
+    manager().beginTransaction();
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(manager().removeDevice(QString("batch_%1").arg(i)));
+    }
+    manager().commitTransaction();
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), 0);
+    QCOMPARE(removedSpy.at(0).at(2).toInt(), 2);
+    QCOMPARE(removedSpy.at(0).at(3).toStringList().size(), 3);
+
+    QVERIFY(manager().removeDevice("batch_group"));
+    QCOMPARE(catalogSpy.count(), 4);
+}
+
+void TestDeviceManager::testNestedTransaction()
+{
+    QSignalSpy catalogSpy(&manager(), &DeviceManager::catalogChanged);
+
+    manager().beginTransaction();
+    manager().beginTransaction();
+    QVERIFY(manager().addDevice(DeviceInfo("nested_001", "嵌套设备", "传感器", "sensor_group")));
+    manager().commitTransaction();
+    QCOMPARE(catalogSpy.count(), 0);
+    QVERIFY(manager().removeDevice("nested_001"));
+    manager().commitTransaction();
+
+    // 插入和删除都在最外层提交时按顺序发出
+    QCOMPARE(catalogSpy.count(), 1);
+
+    // 空事务不改变版本
+    const quint64 version = manager().catalogVersion();
+    manager().beginTransaction();
+    manager().commitTransaction();
+    QCOMPARE(manager().catalogVersion(), version);
+}
+
+void TestDeviceManager::testRemoveSubtree()
+{
+    manager().beginTransaction();
+    QVERIFY(manager().addDevice(DeviceInfo("tree_group", "子树分组", "子模型", "", true)));
+    QVERIFY(manager().addDevice(DeviceInfo("tree_sub", "子树子分组", "子模型", "tree_group", true)));
+    QVERIFY(manager().addDevice(DeviceInfo("tree_leaf", "子树设备", "子模型", "tree_sub")));
+    manager().commitTransaction();
+    const int handleCount = manager().deviceHandleCount();
+    const int leafHandle = manager().deviceHandle("tree_leaf");
+
+    QSignalSpy removedSpy(&manager(), &DeviceManager::devicesRemoved);
+    QVERIFY(manager().removeDevice("tree_group"));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(3).toStringList(), QStringList({"tree_group", "tree_sub", "tree_leaf"}));
+
+    // 句柄保留为空位，其他设备的句柄不变，查询不再返回已删除的设备
+    QCOMPARE(manager().deviceHandleCount(), handleCount);
+    QVERIFY(!manager().queryDeviceHandles(QString(), "子树").contains(leafHandle));
+    QVERIFY(!manager().getDevice("tree_leaf").isValid());
+    for (const DeviceInfo &device : manager().getAllDevices()) {
+        QVERIFY(!device.id.startsWith("tree_"));
+    }
+}
+
+void TestDeviceManager::testAsyncQueries()
+{
+    QFuture<QList<DeviceInfo>> search = manager().searchDevicesAsync("温度");
+    QFuture<QList<DeviceInfo>> byType = manager().getDevicesByTypeAsync("传感器");
+    QFuture<QList<DeviceInfo>> children = manager().getChildDevicesAsync("child_group");
+    QFuture<QList<DeviceInfo>> all = manager().searchDevicesAsync(QString());
+
+    // 结果与同步查询一致
+    QCOMPARE(search.result().size(), manager().searchDevices("温度").size());
+    QCOMPARE(byType.result().size(), manager().getDevicesByType("传感器").size());
+    QCOMPARE(children.result().size(), manager().getChildDevices("child_group").size());
+    QCOMPARE(all.result().size(), manager().getAllDevices().size());
+    QVERIFY(search.isFinished());
+    QVERIFY(!search.isCanceled());
+}
+
+void TestDeviceManager::testAsyncUsesPinnedSnapshot()
+{
+    const int sensorCount = manager().getDevicesByType("传感器").size();
+
+    // 调用之后的修改不影响已提交的查询
+    QFuture<QList<DeviceInfo>> future = manager().getDevicesByTypeAsync("传感器");
+    QVERIFY(manager().addDevice(DeviceInfo("async_001", "异步传感器", "传感器", "sensor_group")));
+    QCOMPARE(future.result().size(), sensorCount);
+
+    QCOMPARE(manager().getDevicesByTypeAsync("传感器").result().size(), sensorCount + 1);
+    QVERIFY(manager().removeDevice("async_001"));
+}
+
+void TestDeviceManager::testAsyncCancel()
+{
+    QueryCancelToken token;
+    token.cancel();
+    QFuture<QList<DeviceInfo>> cancelled = manager().searchDevicesAsync("传感器", token);
+    cancelled.waitForFinished();
+    QVERIFY(cancelled.isCanceled());
+    QCOMPARE(cancelled.resultCount(), 0);
+
+    // 未取消的令牌不影响查询
+    QFuture<QList<DeviceInfo>> future = manager().getChildDevicesAsync("sensor_group", QueryCancelToken());
+    QVERIFY(!future.result().isEmpty());
+}
+
+void TestDeviceManager::benchmarkConcurrentCallers_data()
+{
+    QTest::addColumn<int>("callerCount");
+    QTest::newRow("1 caller") << 1;
+    QTest::newRow("4 callers") << 4;
+    QTest::newRow("16 callers") << 16;
+    QTest::newRow("64 callers") << 64;
+}
+
+void TestDeviceManager::benchmarkConcurrentCallers()
+{
+    QFETCH(int, callerCount);
+
+    // 每个调用线程连续提交查询并等待结果，关键字轮换以同时覆盖缓存命中和未命中
+    const int queriesPerCaller = 200;
+    const QStringList keywords = {"温度", "传感器", "模块", "sensor", "控制器", "root", "湿度", "压力"};
+    DeviceManager *deviceManager = &manager();
+    std::atomic<int> failures(0);
+
+    int runs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ++runs;
+        QList<QThread *> callers;
+        for (int i = 0; i < callerCount; ++i) {
+            callers.append(QThread::create([deviceManager, &keywords, &failures, i]() {
+                for (int q = 0; q < queriesPerCaller; ++q) {
+                    const QString &keyword = keywords.at((i + q) % keywords.size());
+                    if (deviceManager->searchDevicesAsync(keyword).result().isEmpty()) {
+                        ++failures;
+                    }
+                }
+            }));
+            callers.last()->start();
+        }
+        for (QThread *caller : callers) {
+            caller->wait();
+            delete caller;
+        }
+    }
+
+    QCOMPARE(failures.load(), 0);
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    if (seconds > 0.0) {
+        qDebug() << callerCount << "callers:"
+                 << qRound64(runs * callerCount * queriesPerCaller / seconds) << "queries/sec";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestDeviceManager test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_devicemanager_unit.moc"
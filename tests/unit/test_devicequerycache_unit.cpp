@@ -0,0 +1,122 @@
+#include <QApplication>
+#include <QTest>
+#include <QDebug>
+#include "DeviceQueryCache.h"
+#include "DeviceManager.h"
+
+/**
+ * @brief DeviceQueryCache单元测试类
+ *
+ * 测试查询结果缓存的命中统计、版本失效和容量限制
+ */
+class TestDeviceQueryCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 缓存行为测试
+    void testHitAndMiss();
+    void testVersionInvalidation();
+    void testCapacityBound();
+
+    // 设备管理器集成测试
+    void testManagerQueriesUseCache();
+};
+
+void TestDeviceQueryCache::initTestCase()
+{
+    qDebug() << "Starting DeviceQueryCache unit tests...";
+    DeviceManager::instance().loadDeviceData();
+}
+
+void TestDeviceQueryCache::cleanupTestCase()
+{
+    qDebug() << "DeviceQueryCache unit tests completed.";
+}
+
+void TestDeviceQueryCache::testHitAndMiss()
+{
+    DeviceQueryCache cache;
+    cache.setCatalogVersion(1);
+
+    QVector<int> handles;
+    const DeviceQueryKey key(1, 3, "温度");
+    QVERIFY(!cache.lookup(key, handles));
+    QCOMPARE(cache.missCount(), quint64(1));
+
+    cache.insert(key, QVector<int>() << 3 << 5 << 8);
+    QVERIFY(cache.lookup(key, handles));
+    QCOMPARE(handles, QVector<int>() << 3 << 5 << 8);
+    QCOMPARE(cache.hitCount(), quint64(1));
+    QCOMPARE(cache.hitRate(), 0.5);
+}
+
+void TestDeviceQueryCache::testVersionInvalidation()
+{
+    DeviceQueryCache cache;
+    cache.setCatalogVersion(1);
+    cache.insert(DeviceQueryKey(1, 0, "a"), QVector<int>() << 1);
+    QCOMPARE(cache.entryCount(), 1);
+
+    // 目录版本变化后旧条目全部失效
+    cache.setCatalogVersion(2);
+    QCOMPARE(cache.entryCount(), 0);
+
+    QVector<int> handles;
+    QVERIFY(!cache.lookup(DeviceQueryKey(1, 0, "a"), handles));
+
+    // 过期版本的结果不会被写入
+    cache.insert(DeviceQueryKey(1, 0, "a"), QVector<int>() << 1);
+    QCOMPARE(cache.entryCount(), 0);
+}
+
+void TestDeviceQueryCache::testCapacityBound()
+{
+    DeviceQueryCache cache(4096);
+    cache.setCatalogVersion(1);
+
+    for (int i = 0; i < 100; ++i) {
+        cache.insert(DeviceQueryKey(1, 0, QString::number(i)), QVector<int>(64, i));
+    }
+
+    QVERIFY(cache.usedBytes() <= cache.maxBytes());
+    QVERIFY(cache.entryCount() < 100);
+
+    // 最近插入的条目应当仍在缓存中
+    QVector<int> handles;
+    QVERIFY(cache.lookup(DeviceQueryKey(1, 0, "99"), handles));
+}
+
+void TestDeviceQueryCache::testManagerQueriesUseCache()
+{
+    DeviceManager &manager = DeviceManager::instance();
+    QVERIFY(manager.isDataLoaded());
+
+    const quint64 hitsBefore = manager.queryCache().hitCount();
+    QList<DeviceInfo> first = manager.searchDevices("Sensor");
+    QList<DeviceInfo> second = manager.searchDevices("SENSOR");
+
+    // 规范化后的关键字相同，第二次查询应命中缓存
+    QCOMPARE(manager.queryCache().hitCount(), hitsBefore + 1);
+    QCOMPARE(first.size(), second.size());
+    QCOMPARE(first.size(), 5);
+
+    QList<DeviceInfo> sensors = manager.getDevicesByType("传感器");
+    QCOMPARE(sensors.size(), 5);
+    for (const DeviceInfo &device : sensors) {
+        QCOMPARE(device.type, QString("传感器"));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestDeviceQueryCache test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_devicequerycache_unit.moc"
@@ -0,0 +1,338 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QThread>
+#include <QDebug>
+#include "CatalogLoader.h"
+#include "DeviceManager.h"
+#include "DeviceStatusFeed.h"
+#include "DeviceStatusSources.h"
+
+/**
+ * @brief 手动驱动的状态来源（测试用）
+ */
+class ManualStatusSource : public DeviceStatusSource
+{
+    Q_OBJECT
+
+public:
+    ManualStatusSource() : DeviceStatusSource() {}
+
+    void send(int handle, DeviceStatusFeed::Status status) { publish(DeviceStatusUpdate(handle, status)); }
+    bool flush() { return flushPending(); }
+
+public slots:
+    void start() override {}
+    void stop() override {}
+};
+
+/**
+ * @brief DeviceStatusFeed单元测试类
+ *
+ * 测试无锁队列的跨线程传递、按帧合并、队列满时的暂存合并以及
+ * 模拟来源和状态文件来源
+ */
+class TestDeviceStatusFeed : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 队列测试
+    void testQueueOrderAndCapacity();
+    void testQueueAcrossThreads();
+
+    // 合并测试
+    void testCoalescePerFrame();
+    void testOverflowKeepsLatest();
+    void testReloadClearsStatuses();
+
+    // 来源测试
+    void testStatusFromString();
+    void testSimulatorStorm();
+    void testFileTail();
+    void testFileTailBoundedRead();
+};
+
+void TestDeviceStatusFeed::initTestCase()
+{
+    qDebug() << "Starting DeviceStatusFeed unit tests...";
+}
+
+void TestDeviceStatusFeed::cleanupTestCase()
+{
+    qDebug() << "DeviceStatusFeed unit tests completed.";
+}
+
+void TestDeviceStatusFeed::testQueueOrderAndCapacity()
+{
+    DeviceStatusQueue queue(5);
+    QCOMPARE(queue.capacity(), 8);
+
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(queue.tryPush(DeviceStatusUpdate(i, DeviceStatusFeed::Online)));
+    }
+    QVERIFY(!queue.tryPush(DeviceStatusUpdate(8, DeviceStatusFeed::Online)));
+    QCOMPARE(queue.sizeApprox(), 8);
+
+    DeviceStatusUpdate update;
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(queue.tryPop(update));
+        QCOMPARE(update.handle, i);
+    }
+    QVERIFY(!queue.tryPop(update));
+
+    // 按设备ID的更新
+    QVERIFY(queue.tryPush(DeviceStatusUpdate(QString("sensor_001"), DeviceStatusFeed::Alarm)));
+    QVERIFY(queue.tryPop(update));
+    QCOMPARE(update.handle, -1);
+    QCOMPARE(update.deviceId, QString("sensor_001"));
+    QCOMPARE(int(update.status), int(DeviceStatusFeed::Alarm));
+}
+
+void TestDeviceStatusFeed::testQueueAcrossThreads()
+{
+    // 生产者线程写入一百万条，消费者按顺序全部取出
+    const int total = 1000000;
+    DeviceStatusQueue queue(1024);
+    QThread *producer = QThread::create([&queue, total]() {
+        for (int i = 0; i < total; ) {
+            if (queue.tryPush(DeviceStatusUpdate(i, DeviceStatusFeed::Online))) {
+                ++i;
+            }
+        }
+    });
+    producer->start();
+
+    int expected = 0;
+    DeviceStatusUpdate update;
+    while (expected < total) {
+        if (queue.tryPop(update)) {
+            QCOMPARE(update.handle, expected);
+            ++expected;
+        }
+    }
+    producer->wait();
+    delete producer;
+    QCOMPARE(queue.sizeApprox(), 0);
+}
+
+void TestDeviceStatusFeed::testCoalescePerFrame()
+{
+    DeviceStatusFeed feed;
+    ManualStatusSource source;
+    feed.attachSource(&source);
+    QSignalSpy spy(&feed, &DeviceStatusFeed::statusesChanged);
+
+    // 一帧内同一设备的多次更新只保留最后一次
+    for (int i = 0; i < 1000; ++i) {
+        source.send(3, i % 2 ? DeviceStatusFeed::Alarm : DeviceStatusFeed::Online);
+    }
+    source.send(5, DeviceStatusFeed::Offline);
+    const QVector<int> changed = feed.drain();
+    QCOMPARE(changed, QVector<int>({3, 5}));
+    QCOMPARE(feed.status(3), DeviceStatusFeed::Alarm);
+    QCOMPARE(feed.status(5), DeviceStatusFeed::Offline);
+    QCOMPARE(feed.status(4), DeviceStatusFeed::Unknown);
+    QCOMPARE(feed.receivedCount(), quint64(1001));
+    QCOMPARE(spy.count(), 1);
+
+    // 最终状态未变化的设备不通知
+    source.send(3, DeviceStatusFeed::Online);
+    source.send(3, DeviceStatusFeed::Alarm);
+    QVERIFY(feed.drain().isEmpty());
+    QCOMPARE(spy.count(), 1);
+
+    // 空帧不发信号
+    QVERIFY(feed.drain().isEmpty());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(feed.status(-1), DeviceStatusFeed::Unknown);
+}
+
+void TestDeviceStatusFeed::testOverflowKeepsLatest()
+{
+    DeviceStatusFeed feed;
+    ManualStatusSource source;
+    feed.attachSource(&source);
+    const int capacity = source.queue()->capacity();
+
+    // 填满队列后继续写入的更新按设备合并暂存
+    for (int i = 0; i < capacity; ++i) {
+        source.send(i % 10, DeviceStatusFeed::Online);
+    }
+    source.send(1, DeviceStatusFeed::Offline);
+    source.send(2, DeviceStatusFeed::Alarm);
+    source.send(1, DeviceStatusFeed::Alarm);
+    QCOMPARE(source.publishedCount(), quint64(capacity + 3));
+    QVERIFY(!source.flush());
+
+    feed.drain();
+    QCOMPARE(feed.status(1), DeviceStatusFeed::Online);
+
+    // 暂存写入后最终状态与写入顺序一致
+    QVERIFY(source.flush());
+    feed.drain();
+    QCOMPARE(feed.status(1), DeviceStatusFeed::Alarm);
+    QCOMPARE(feed.status(2), DeviceStatusFeed::Alarm);
+}
+
+void TestDeviceStatusFeed::testReloadClearsStatuses()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    DeviceStatusFeed feed;
+    feed.setDeviceManager(&plant);
+    ManualStatusSource source;
+    feed.attachSource(&source);
+
+    const int handle = plant.deviceHandle("sensor_001");
+    source.send(handle, DeviceStatusFeed::Alarm);
+    feed.drain();
+    QCOMPARE(feed.status(handle), DeviceStatusFeed::Alarm);
+
+    // 整体加载重新分配句柄，旧状态不能留在同一句柄的其他设备上
+    CatalogData catalog;
+    QVERIFY(CatalogLoader::parse("pump_001,,泵,0,1号泵\nsensor_001,,传感器,0,温度传感器A\n", catalog));
+    QVERIFY(plant.loadCatalog(catalog));
+    QCOMPARE(feed.status(handle), DeviceStatusFeed::Unknown);
+    QCOMPARE(feed.status(plant.deviceHandle("sensor_001")), DeviceStatusFeed::Unknown);
+
+    // 之后的更新正常应用
+    source.send(plant.deviceHandle("pump_001"), DeviceStatusFeed::Online);
+    QCOMPARE(feed.drain(), QVector<int>({plant.deviceHandle("pump_001")}));
+
+    // 换用其他目录时同样清空
+    DeviceManager other;
+    feed.setDeviceManager(&other);
+    QCOMPARE(feed.status(plant.deviceHandle("pump_001")), DeviceStatusFeed::Unknown);
+}
+
+void TestDeviceStatusFeed::testStatusFromString()
+{
+    bool ok = false;
+    QCOMPARE(DeviceStatusFeed::statusFromString("online", &ok), DeviceStatusFeed::Online);
+    QVERIFY(ok);
+    QCOMPARE(DeviceStatusFeed::statusFromString(" ALARM ", &ok), DeviceStatusFeed::Alarm);
+    QVERIFY(ok);
+    QCOMPARE(DeviceStatusFeed::statusFromString("2", &ok), DeviceStatusFeed::Offline);
+    QVERIFY(ok);
+    QCOMPARE(DeviceStatusFeed::statusFromString("broken", &ok), DeviceStatusFeed::Unknown);
+    QVERIFY(!ok);
+}
+
+void TestDeviceStatusFeed::testSimulatorStorm()
+{
+    DeviceStatusFeed feed;
+    feed.setFrameInterval(16);
+    QSignalSpy spy(&feed, &DeviceStatusFeed::statusesChanged);
+
+    // 工作线程中每秒十万次更新，GUI线程每帧只收到一次合并后的通知
+    feed.addSource(new DeviceStatusSimulator(1000, 100000));
+    QTRY_VERIFY_WITH_TIMEOUT(feed.receivedCount() > 10000, 5000);
+    QVERIFY(spy.count() > 0);
+    QVERIFY(quint64(spy.count()) <= feed.frameCount());
+    for (const QList<QVariant> &args : spy) {
+        QVERIFY(args.at(0).value<QVector<int>>().size() <= 1000);
+    }
+    QVERIFY(feed.changedCount() < feed.receivedCount());
+}
+
+void TestDeviceStatusFeed::testFileTail()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("status.log");
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("# device,status\nsensor_001,online\nsensor_002,alarm\nbad line\nsensor_003,off");
+    file.flush();
+
+    DeviceStatusFileTail tail(path);
+    QCOMPARE(tail.poll(), 2);
+    QCOMPARE(tail.invalidLineCount(), 1);
+
+    // 半行在写完换行符后才解析
+    file.write("line\nsensor_004,3\n");
+    file.flush();
+    QCOMPARE(tail.poll(), 2);
+    QCOMPARE(tail.poll(), 0);
+
+    DeviceStatusUpdate update;
+    QStringList ids;
+    while (tail.queue()->tryPop(update)) {
+        ids.append(update.deviceId);
+        QCOMPARE(update.handle, -1);
+    }
+    QCOMPARE(ids, QStringList({"sensor_001", "sensor_002", "sensor_003", "sensor_004"}));
+
+    // 文件被截断后从头读取
+    file.close();
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("sensor_005,online\n");
+    file.close();
+    QCOMPARE(tail.poll(), 1);
+}
+
+void TestDeviceStatusFeed::testFileTailBoundedRead()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("status.log");
+
+    // 历史很长的状态文件：第一次只读取末尾一段，不重放全部历史
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QByteArray history;
+    int total = 0;
+    while (history.size() < DeviceStatusFileTail::initialTailBytes() * 3) {
+        history += "history_" + QByteArray::number(total++) + ",offline\n";
+    }
+    file.write(history);
+    file.flush();
+
+    DeviceStatusFileTail tail(path);
+    const int first = tail.poll();
+    QVERIFY(first > 0);
+    QVERIFY(first < total / 2);
+    QCOMPARE(tail.invalidLineCount(), 0);
+
+    // 读到的是末尾连续的完整行，开头不完整的行被丢弃
+    DeviceStatusUpdate update;
+    QStringList ids;
+    while (tail.queue()->tryPop(update)) {
+        ids.append(update.deviceId);
+    }
+    QCOMPARE(ids.size(), first);
+    QCOMPARE(ids.first(), QString("history_%1").arg(total - first));
+    QCOMPARE(ids.last(), QString("history_%1").arg(total - 1));
+
+    // 之后追加的内容跨越多个读取块也完整解析
+    QByteArray burst;
+    for (int i = 0; i < 20000; ++i) {
+        burst += "burst_" + QByteArray::number(i) + ",online\n";
+    }
+    file.write(burst);
+    file.flush();
+    QCOMPARE(tail.poll(), 20000);
+
+    // 过长的行丢弃，不影响后面的行
+    file.write(QByteArray(10000, 'x') + "\nsensor_001,alarm\n");
+    file.flush();
+    QCOMPARE(tail.poll(), 1);
+    QCOMPARE(tail.invalidLineCount(), 1);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestDeviceStatusFeed test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_devicestatusfeed_unit.moc"
@@ -0,0 +1,217 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QPixmap>
+#include <QDebug>
+#include <algorithm>
+#include "DeviceTreeModel.h"
+#include "DeviceStatusFeed.h"
+
+/**
+ * @brief 手动驱动的状态来源（测试用）
+ */
+class ManualStatusSource : public DeviceStatusSource
+{
+    Q_OBJECT
+
+public:
+    void send(int handle, DeviceStatusFeed::Status status) { publish(DeviceStatusUpdate(handle, status)); }
+
+public slots:
+    void start() override {}
+    void stop() override {}
+};
+
+/**
+ * @brief DeviceTreeModel单元测试类
+ *
+ * 测试设备状态以图标显示、状态变化合并为最小范围的dataChanged，
+ * 以及状态风暴不产生逐项信号或模型重置
+ */
+class TestDeviceTreeModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    // 状态显示测试
+    void testStatusRoles();
+
+    // 通知测试
+    void testContiguousRanges();
+    void testStormWithoutItemSignals();
+    void testRemovedItemsIgnored();
+    void testInsertedItemsIndexed();
+
+private:
+    /**
+     * @brief 创建两个分组、每组100个设备的树，句柄为0-199
+     */
+    void populate();
+
+    DeviceTreeModel *m_model;
+    DeviceStatusFeed *m_feed;
+    ManualStatusSource *m_source;
+};
+
+void TestDeviceTreeModel::initTestCase()
+{
+    qDebug() << "Starting DeviceTreeModel unit tests...";
+}
+
+void TestDeviceTreeModel::cleanupTestCase()
+{
+    qDebug() << "DeviceTreeModel unit tests completed.";
+}
+
+void TestDeviceTreeModel::init()
+{
+    m_model = new DeviceTreeModel();
+    m_feed = new DeviceStatusFeed();
+    m_source = new ManualStatusSource();
+    m_feed->attachSource(m_source);
+    populate();
+    m_model->setStatusFeed(m_feed);
+    connect(m_feed, &DeviceStatusFeed::statusesChanged, m_model, &DeviceTreeModel::notifyStatusChanged);
+}
+
+void TestDeviceTreeModel::cleanup()
+{
+    delete m_source;
+    delete m_feed;
+    delete m_model;
+}
+
+void TestDeviceTreeModel::populate()
+{
+    for (int group = 0; group < 2; ++group) {
+        QStandardItem *groupItem = new QStandardItem(QString("group_%1").arg(group));
+        for (int i = 0; i < 100; ++i) {
+            const int handle = group * 100 + i;
+            QStandardItem *item = new QStandardItem(QString("device_%1").arg(handle));
+            item->setData(QString("device_%1").arg(handle), DeviceTreeModel::DeviceIdRole);
+            item->setData(handle, DeviceTreeModel::DeviceHandleRole);
+            groupItem->appendRow(item);
+        }
+        m_model->appendRow(groupItem);
+    }
+}
+
+void TestDeviceTreeModel::testStatusRoles()
+{
+    const QModelIndex device = m_model->index(5, 0, m_model->index(0, 0));
+    QCOMPARE(device.data(DeviceTreeModel::DeviceStatusRole).toInt(), int(DeviceStatusFeed::Unknown));
+    QVERIFY(device.data(Qt::DecorationRole).isNull());
+
+    m_source->send(5, DeviceStatusFeed::Alarm);
+    m_feed->drain();
+    QCOMPARE(device.data(DeviceTreeModel::DeviceStatusRole).toInt(), int(DeviceStatusFeed::Alarm));
+    QVERIFY(!device.data(Qt::DecorationRole).value<QPixmap>().isNull());
+
+    // 没有句柄的分组节点不显示状态
+    QCOMPARE(m_model->index(0, 0).data(DeviceTreeModel::DeviceStatusRole).toInt(), int(DeviceStatusFeed::Unknown));
+
+    // 移除状态来源后回到普通数据
+    m_model->setStatusFeed(nullptr);
+    QVERIFY(device.data(Qt::DecorationRole).isNull());
+}
+
+void TestDeviceTreeModel::testContiguousRanges()
+{
+    QSignalSpy spy(m_model, &QAbstractItemModel::dataChanged);
+
+    // 第一组的行3-5、9和第二组的行0合并为三个范围
+    for (int handle : {5, 3, 4, 9, 100}) {
+        m_source->send(handle, DeviceStatusFeed::Online);
+    }
+    m_feed->drain();
+    QCOMPARE(spy.count(), 3);
+
+    QVector<QPair<int, int>> ranges;
+    for (const QList<QVariant> &args : spy) {
+        const QModelIndex topLeft = args.at(0).toModelIndex();
+        const QModelIndex bottomRight = args.at(1).toModelIndex();
+        QCOMPARE(topLeft.parent(), bottomRight.parent());
+        ranges.append(qMakePair(topLeft.parent().row() * 1000 + topLeft.row(),
+                                bottomRight.parent().row() * 1000 + bottomRight.row()));
+        QVERIFY(args.at(2).value<QVector<int>>().contains(DeviceTreeModel::DeviceStatusRole));
+    }
+    std::sort(ranges.begin(), ranges.end());
+    QCOMPARE(ranges.at(0), qMakePair(3, 5));
+    QCOMPARE(ranges.at(1), qMakePair(9, 9));
+    QCOMPARE(ranges.at(2), qMakePair(1000, 1000));
+}
+
+void TestDeviceTreeModel::testStormWithoutItemSignals()
+{
+    QSignalSpy dataSpy(m_model, &QAbstractItemModel::dataChanged);
+    QSignalSpy itemSpy(m_model, &QStandardItemModel::itemChanged);
+    QSignalSpy resetSpy(m_model, &QAbstractItemModel::modelReset);
+
+    // 十万次更新覆盖全部设备，每个分组只发出一次dataChanged
+    for (int i = 0; i < 100000; ++i) {
+        m_source->send(i % 200, i % 3 ? DeviceStatusFeed::Online : DeviceStatusFeed::Offline);
+        if (i % 60000 == 59999) {
+            m_feed->drain();
+        }
+    }
+    m_feed->drain();
+
+    QCOMPARE(itemSpy.count(), 0);
+    QCOMPARE(resetSpy.count(), 0);
+    QVERIFY(dataSpy.count() <= 4);
+}
+
+void TestDeviceTreeModel::testRemovedItemsIgnored()
+{
+    QSignalSpy spy(m_model, &QAbstractItemModel::dataChanged);
+
+    // 删除的行移出索引，其他行的通知不受影响
+    m_model->removeRow(1);
+    m_source->send(150, DeviceStatusFeed::Alarm);
+    m_feed->drain();
+    QCOMPARE(spy.count(), 0);
+
+    m_source->send(50, DeviceStatusFeed::Alarm);
+    m_feed->drain();
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestDeviceTreeModel::testInsertedItemsIndexed()
+{
+    QSignalSpy spy(m_model, &QAbstractItemModel::dataChanged);
+
+    // 插入的行（连同子项目）无需重建索引即可收到通知
+    QStandardItem *groupItem = new QStandardItem("group_2");
+    QStandardItem *item = new QStandardItem("device_200");
+    item->setData(200, DeviceTreeModel::DeviceHandleRole);
+    groupItem->appendRow(item);
+    m_model->insertRow(0, groupItem);
+
+    m_source->send(200, DeviceStatusFeed::Offline);
+    m_feed->drain();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toModelIndex(), m_model->index(0, 0, m_model->index(0, 0)));
+
+    // 移动的行仍指向同一项目
+    QList<QStandardItem*> row = m_model->item(1)->takeRow(7);
+    m_model->item(2)->appendRow(row);
+    m_source->send(7, DeviceStatusFeed::Alarm);
+    m_feed->drain();
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toModelIndex(), m_model->index(100, 0, m_model->index(2, 0)));
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestDeviceTreeModel test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_devicetreemodel_unit.moc"
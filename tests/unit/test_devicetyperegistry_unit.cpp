@@ -0,0 +1,181 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QDebug>
+#include "DeviceTypeRegistry.h"
+#include "DeviceManager.h"
+#include "CatalogLoader.h"
+
+/**
+ * @brief DeviceTypeRegistry单元测试类
+ *
+ * 测试类型ID的分配和稳定性、显示名称，以及目录修改时各类型设备数量
+ * 的维护和按类型ID查询
+ */
+class TestDeviceTypeRegistry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 注册表测试
+    void testRegisterTypes();
+    void testDisplayName();
+
+    // 目录测试
+    void testDeviceCounts();
+    void testStableIdsAcrossReload();
+    void testQueryByTypeId();
+};
+
+void TestDeviceTypeRegistry::initTestCase()
+{
+    qDebug() << "Starting DeviceTypeRegistry unit tests...";
+}
+
+void TestDeviceTypeRegistry::cleanupTestCase()
+{
+    qDebug() << "DeviceTypeRegistry unit tests completed.";
+}
+
+void TestDeviceTypeRegistry::testRegisterTypes()
+{
+    DeviceTypeRegistry registry;
+    QCOMPARE(registry.count(), 0);
+    QCOMPARE(registry.displayName(DeviceTypeRegistry::AllTypes), QString("全部模型"));
+    QCOMPARE(registry.typeId(QString()), int(DeviceTypeRegistry::AllTypes));
+
+    // ID按注册顺序从1开始，重复注册返回原来的ID
+    const int sensor = registry.registerType("传感器");
+    const int root = registry.registerType("根模型");
+    QCOMPARE(sensor, 1);
+    QCOMPARE(root, 2);
+    QCOMPARE(registry.registerType("传感器"), sensor);
+    QCOMPARE(registry.typeId("根模型"), root);
+    QCOMPARE(registry.typeName(sensor), QString("传感器"));
+    QCOMPARE(registry.typeIds(), QVector<int>() << sensor << root);
+    QCOMPARE(registry.typeNames(), QStringList() << "传感器" << "根模型");
+
+    // 与"全部模型"同名的类型是普通类型，不会与AllTypes混淆
+    const int named = registry.registerType("全部模型");
+    QVERIFY(named != DeviceTypeRegistry::AllTypes);
+    QCOMPARE(registry.typeId("全部模型"), named);
+
+    QCOMPARE(registry.typeId("不存在的类型"), int(DeviceTypeRegistry::UnknownType));
+    QVERIFY(!registry.isValid(DeviceTypeRegistry::UnknownType));
+    QVERIFY(registry.typeName(99).isEmpty());
+}
+
+void TestDeviceTypeRegistry::testDisplayName()
+{
+    DeviceTypeRegistry registry;
+    const int sensor = registry.registerType("传感器");
+    QCOMPARE(registry.displayName(sensor), QString("传感器"));
+
+    QVERIFY(registry.setDisplayName(sensor, "传感器设备"));
+    QCOMPARE(registry.displayName(sensor), QString("传感器设备"));
+    QCOMPARE(registry.typeName(sensor), QString("传感器"));
+    QCOMPARE(registry.typeId("传感器"), sensor);
+
+    // 空显示名称恢复为类型名称
+    QVERIFY(registry.setDisplayName(sensor, QString()));
+    QCOMPARE(registry.displayName(sensor), QString("传感器"));
+    QVERIFY(!registry.setDisplayName(99, "无效"));
+}
+
+void TestDeviceTypeRegistry::testDeviceCounts()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    const DeviceTypeRegistry types = plant.deviceTypeRegistry();
+    const int sensor = types.typeId("传感器");
+    const int sensorCount = types.deviceCount(sensor);
+    QCOMPARE(sensorCount, plant.getDevicesByType("传感器").size());
+    QCOMPARE(types.deviceCount(DeviceTypeRegistry::AllTypes), plant.getAllDevices().size());
+
+    // 添加、修改类型和删除设备时数量随之变化
+    QSignalSpy typesSpy(&plant, &DeviceManager::deviceTypesChanged);
+    QVERIFY(plant.addDevice(DeviceInfo("count_001", "计数设备", "计数类型", "sensor_group")));
+    QCOMPARE(typesSpy.count(), 1);
+    const int counted = plant.deviceTypeId("计数类型");
+    QCOMPARE(counted, types.count() + 1);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(counted), 1);
+
+    QVERIFY(plant.updateDevice(DeviceInfo("count_001", "计数设备", "传感器", "sensor_group")));
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(counted), 0);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(sensor), sensorCount + 1);
+
+    // 删除设备组时子设备一起计入
+    const int groupSize = plant.childIds("sensor_group").size() + 1;
+    QVERIFY(plant.removeDevice("sensor_group"));
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(sensor), sensorCount + 1 - groupSize);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(DeviceTypeRegistry::AllTypes), plant.getAllDevices().size());
+
+    // 没有设备的类型仍然保留ID
+    QCOMPARE(plant.deviceTypeId("计数类型"), counted);
+    QCOMPARE(typesSpy.count(), 1);
+}
+
+void TestDeviceTypeRegistry::testStableIdsAcrossReload()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    QVERIFY(plant.addDevice(DeviceInfo("reload_001", "临时设备", "临时类型", "")));
+    const int sensor = plant.deviceTypeId("传感器");
+    const int temporary = plant.deviceTypeId("临时类型");
+
+    // 重新加载后已登记的类型保留原来的ID，数量重新统计
+    CatalogData catalog;
+    QVERIFY(CatalogLoader::parse("sensor_group,,传感器,1,传感器\n"
+                                 "sensor_001,sensor_group,传感器,0,温度传感器A\n"
+                                 "other_001,,新类型,0,新类型设备\n", catalog));
+    QVERIFY(plant.loadCatalog(catalog));
+    QVERIFY(!plant.getDevice("reload_001").isValid());
+    QCOMPARE(plant.deviceTypeId("传感器"), sensor);
+    QCOMPARE(plant.deviceTypeId("临时类型"), temporary);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(temporary), 0);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(sensor), 2);
+    QCOMPARE(plant.deviceTypeRegistry().deviceCount(sensor), plant.getDevicesByType(sensor).size());
+
+    // 新出现的类型追加在已有类型之后
+    QCOMPARE(plant.deviceTypeId("新类型"), temporary + 1);
+}
+
+void TestDeviceTypeRegistry::testQueryByTypeId()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    const int sensor = plant.deviceTypeId("传感器");
+
+    QCOMPARE(plant.getDevicesByType(sensor).size(), plant.getDevicesByType("传感器").size());
+    QCOMPARE(plant.getDevicesByType(DeviceTypeRegistry::AllTypes).size(), plant.getAllDevices().size());
+    QVERIFY(plant.getDevicesByType(DeviceTypeRegistry::UnknownType).isEmpty());
+    QCOMPARE(plant.queryDeviceHandles(sensor, "温度"), plant.queryDeviceHandles("传感器", "温度"));
+    for (int handle : plant.queryDeviceHandles(sensor, QString())) {
+        QCOMPARE(plant.deviceTypeIdForHandle(handle), sensor);
+    }
+
+    QFuture<QList<DeviceInfo>> future = plant.getDevicesByTypeAsync(sensor);
+    future.waitForFinished();
+    QCOMPARE(future.result().size(), plant.getDevicesByType(sensor).size());
+
+    // 显示名称不影响按ID查询
+    QSignalSpy typesSpy(&plant, &DeviceManager::deviceTypesChanged);
+    QVERIFY(plant.setDeviceTypeDisplayName(sensor, "传感器设备"));
+    QCOMPARE(typesSpy.count(), 1);
+    QCOMPARE(plant.deviceTypeRegistry().displayName(sensor), QString("传感器设备"));
+    QCOMPARE(plant.deviceTypeId("传感器"), sensor);
+    QVERIFY(!plant.setDeviceTypeDisplayName(99, "无效"));
+    QVERIFY(!plant.getLastError().isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    TestDeviceTypeRegistry test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_devicetyperegistry_unit.moc"
@@ -5,6 +5,32 @@
 #include <QDebug>
 #include "DeviceWidget.h"
 #include "DeviceManager.h"
+#include "CatalogLoader.h"
+#include "DeviceStatusFeed.h"
+#include "DeviceTreeModel.h"
+#include "SparklineBuffer.h"
+#include "SparklineDelegate.h"
+#include <QTreeView>
+#include <QTabWidget>
+#include <QTabBar>
+
+/**
+ * @brief 按设备ID发布状态的来源（测试用）
+ */
+class IdStatusSource : public DeviceStatusSource
+{
+    Q_OBJECT
+
+public:
+    void send(const QString &deviceId, DeviceStatusFeed::Status status)
+    {
+        publish(DeviceStatusUpdate(deviceId, status));
+    }
+
+public slots:
+    void start() override {}
+    void stop() override {}
+};
 
 /**
  * @brief DeviceWidget单元测试类
@@ -64,6 +90,19 @@ private slots:
     // 信号槽测试
     void testAllSignalConnections();
     void testSignalParameters();
+    
+    // 迷你折线图测试
+    void testSparklineColumn();
+    
+    // 目录增量更新测试
+    void testIncrementalCatalogUpdates();
+    void testHandleCompaction();
+    
+    // 多目录测试
+    void testInjectedCatalog();
+    
+    // 类型标签页测试
+    void testTypeTabs();
 
 private:
     DeviceWidget *m_deviceWidget;
@@ -474,6 +513,257 @@ void TestDeviceWidget::testSignalParameters()
     }
 }
 
+void TestDeviceWidget::testSparklineColumn()
+{
+    QTreeView *tree = m_deviceWidget->findChild<QTreeView*>();
+    QVERIFY(tree != nullptr);
+    QAbstractItemModel *model = tree->model();
+    QVERIFY(model != nullptr);
+    
+    // 默认不显示折线图列
+    QVERIFY(!m_deviceWidget->sparklinesVisible());
+    QCOMPARE(model->columnCount(), 1);
+    QVERIFY(m_deviceWidget->sparklineDelegate() == nullptr);
+    
+    SparklineBuffer buffer(8);
+    m_deviceWidget->setSparklineBuffer(&buffer);
+    QVERIFY(m_deviceWidget->sparklineDelegate() != nullptr);
+    QCOMPARE(tree->itemDelegateForColumn(1), m_deviceWidget->sparklineDelegate());
+    
+    // 显示后每行附加保存设备ID的折线图单元格
+    const QStringList selected = m_deviceWidget->getSelectedDevices();
+    m_deviceWidget->setSparklinesVisible(true);
+    QVERIFY(m_deviceWidget->sparklinesVisible());
+    QCOMPARE(m_deviceWidget->getSelectedDevices(), selected);
+    if (model->rowCount() > 0) {
+        QCOMPARE(model->columnCount(), 2);
+        QCOMPARE(model->index(0, 1).data(Qt::UserRole), model->index(0, 0).data(Qt::UserRole));
+    }
+    
+    m_deviceWidget->setSparklinesVisible(false);
+    QCOMPARE(model->columnCount(), 1);
+    
+    m_deviceWidget->setSparklineBuffer(nullptr);
+    QVERIFY(m_deviceWidget->sparklineDelegate() == nullptr);
+}
+
+void TestDeviceWidget::testIncrementalCatalogUpdates()
+{
+    QTreeView *tree = m_deviceWidget->findChild<QTreeView*>();
+    QVERIFY(tree != nullptr);
+    QAbstractItemModel *model = tree->model();
+    DeviceManager &manager = DeviceManager::instance();
+    
+    QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+    QSignalSpy insertedSpy(model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removedSpy(model, &QAbstractItemModel::rowsAboutToBeRemoved);
+    const int rootRows = model->rowCount();
+    
+    // 一个事务中添加分组和三个设备：分组一次插入，设备合并为一次插入
+    manager.beginTransaction();
+    manager.addDevice(DeviceInfo("widget_group", "增量分组", "传感器", "", true));
+    for (int i = 0; i < 3; ++i) {
+        manager.addDevice(DeviceInfo(QString("widget_%1").arg(i), QString("增量设备%1").arg(i),
+                                     "传感器", "widget_group"));
+    }
+    manager.commitTransaction();
+    
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(insertedSpy.count(), 2);
+    QCOMPARE(model->rowCount(), rootRows + 1);
+    const QModelIndex group = model->index(rootRows, 0);
+    QCOMPARE(group.data(Qt::UserRole).toString(), QString("widget_group"));
+    QCOMPARE(model->rowCount(group), 3);
+    QCOMPARE(model->index(1, 0, group).data().toString(), QString("增量设备1"));
+    
+    // 选中的设备被删除后从选择中移除
+    m_deviceWidget->setSelectedDevices(QStringList() << "widget_1" << "sensor_001");
+    QSignalSpy selectionSpy(m_deviceWidget, &DeviceWidget::selectionChanged);
+    
+    // 改名只更新对应行，移动到新位置
+    DeviceInfo device = manager.getDevice("widget_2");
+    device.name = "改名设备";
+    manager.updateDevice(device);
+    QCOMPARE(model->index(2, 0, group).data().toString(), QString("改名设备"));
+    manager.moveDevice("widget_2", "widget_group", 0);
+    QCOMPARE(model->index(0, 0, group).data(Qt::UserRole).toString(), QString("widget_2"));
+    
+    manager.removeDevice("widget_1");
+    QCOMPARE(model->rowCount(group), 2);
+    QCOMPARE(selectionSpy.count(), 1);
+    QCOMPARE(m_deviceWidget->getSelectedDevices(), QStringList() << "sensor_001");
+    
+    // 删除分组时子行随分组一次删除
+    removedSpy.clear();
+    manager.removeDevice("widget_group");
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(model->rowCount(), rootRows);
+    QCOMPARE(resetSpy.count(), 0);
+    
+    m_deviceWidget->clearSelection();
+}
+
+void TestDeviceWidget::testHandleCompaction()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    DeviceWidget plantWidget(&plant);
+    DeviceStatusFeed feed;
+    IdStatusSource source;
+    feed.attachSource(&source);
+    plantWidget.setStatusFeed(&feed);
+    
+    // 大量设备加入后又删除，空位超过一半时发布的快照重新编号句柄
+    plant.beginTransaction();
+    for (int i = 0; i < 200; ++i) {
+        QVERIFY(plant.addDevice(DeviceInfo(QString("churn_%1").arg(i), "临时设备", "传感器")));
+    }
+    plant.commitTransaction();
+    QVERIFY(plant.addDevice(DeviceInfo("kept_001", "保留设备", "传感器")));
+    source.send("kept_001", DeviceStatusFeed::Alarm);
+    feed.drain();
+    const int oldHandle = plant.deviceHandle("kept_001");
+    
+    QSignalSpy spy(&plant, &DeviceManager::handlesRenumbered);
+    plant.beginTransaction();
+    for (int i = 0; i < 200; ++i) {
+        QVERIFY(plant.removeDevice(QString("churn_%1").arg(i)));
+    }
+    plant.commitTransaction();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(plant.deviceHandleCount(), plant.getAllDevices().size());
+    const int newHandle = plant.deviceHandle("kept_001");
+    QVERIFY(newHandle < oldHandle);
+    QCOMPARE(spy.at(0).at(0).value<QVector<int>>().value(oldHandle), newHandle);
+    
+    // 状态随设备移到新句柄
+    QCOMPARE(feed.status(newHandle), DeviceStatusFeed::Alarm);
+    
+    // 项目保存的句柄已改写，搜索过滤和状态显示仍对应同一设备
+    plantWidget.setSearchText("保留设备");
+    QTreeView *tree = plantWidget.findChild<QTreeView*>();
+    QAbstractItemModel *model = tree->model();
+    int keptRow = -1;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        if (model->index(row, 0).data(Qt::UserRole).toString() == "kept_001") {
+            keptRow = row;
+        }
+    }
+    QVERIFY(keptRow >= 0);
+    const QModelIndex kept = model->index(keptRow, 0);
+    QCOMPARE(kept.data(DeviceTreeModel::DeviceHandleRole).toInt(), newHandle);
+    QCOMPARE(kept.data(DeviceTreeModel::DeviceStatusRole).toInt(), int(DeviceStatusFeed::Alarm));
+    QVERIFY(!tree->isRowHidden(keptRow, QModelIndex()));
+    QCOMPARE(plantWidget.getSelectedDevices(), QStringList());
+    plantWidget.setStatusFeed(nullptr);
+}
+
+void TestDeviceWidget::testInjectedCatalog()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    QVERIFY(plant.addDevice(DeviceInfo("plant_group", "二厂分组", "传感器", "", true)));
+    
+    DeviceWidget plantWidget(&plant);
+    QCOMPARE(plantWidget.deviceManager(), &plant);
+    QCOMPARE(m_deviceWidget->deviceManager(), &DeviceManager::instance());
+    
+    QAbstractItemModel *plantModel = plantWidget.findChild<QTreeView*>()->model();
+    QAbstractItemModel *defaultModel = m_deviceWidget->findChild<QTreeView*>()->model();
+    const int defaultRows = defaultModel->rowCount();
+    QCOMPARE(plantModel->rowCount(), plant.childIds(QString()).size());
+    QVERIFY(!DeviceManager::instance().getDevice("plant_group").isValid());
+    
+    // 一个目录的修改只更新显示该目录的控件
+    QVERIFY(plant.addDevice(DeviceInfo("plant_002", "二厂设备", "传感器", "plant_group")));
+    QCOMPARE(defaultModel->rowCount(), defaultRows);
+    plantWidget.setSearchText("二厂设备");
+    QCOMPARE(plantWidget.getSearchText(), QString("二厂设备"));
+    m_deviceWidget->setSelectedDevices(QStringList() << "sensor_001");
+    plantWidget.setSelectedDevices(QStringList() << "plant_002");
+    QCOMPARE(m_deviceWidget->getSelectedDevices(), QStringList() << "sensor_001");
+    QCOMPARE(plantWidget.getSelectedDevices(), QStringList() << "plant_002");
+    
+    // 状态汇集器按控件显示的目录解析设备ID
+    DeviceStatusFeed feed;
+    IdStatusSource source;
+    feed.attachSource(&source);
+    plantWidget.setStatusFeed(&feed);
+    QCOMPARE(feed.deviceManager(), static_cast<const DeviceManager *>(&plant));
+    source.send("plant_002", DeviceStatusFeed::Alarm);
+    QCOMPARE(feed.drain(), QVector<int>({plant.deviceHandle("plant_002")}));
+    QCOMPARE(feed.status(plant.deviceHandle("plant_002")), DeviceStatusFeed::Alarm);
+    plantWidget.setStatusFeed(nullptr);
+}
+
+void TestDeviceWidget::testTypeTabs()
+{
+    DeviceManager plant;
+    plant.loadDeviceData();
+    DeviceWidget plantWidget(&plant);
+    QTabWidget *tabs = plantWidget.findChild<QTabWidget*>();
+    QAbstractItemModel *model = plantWidget.findChild<QTreeView*>()->model();
+    
+    // 每个标签页的数据是类型ID，第一个是"全部模型"
+    const DeviceTypeRegistry types = plant.deviceTypeRegistry();
+    QCOMPARE(tabs->count(), types.count() + 1);
+    QCOMPARE(tabs->tabBar()->tabData(0).toInt(), int(DeviceTypeRegistry::AllTypes));
+    QCOMPARE(tabs->tabText(0), QString("全部模型"));
+    const int sensor = types.typeId("传感器");
+    const int sensorTab = types.typeIds().indexOf(sensor) + 1;
+    QCOMPARE(tabs->tabBar()->tabData(sensorTab).toInt(), sensor);
+    QCOMPARE(tabs->tabToolTip(sensorTab), QString("%1 个设备").arg(types.deviceCount(sensor)));
+    
+    tabs->setCurrentIndex(sensorTab);
+    QCOMPARE(plantWidget.currentTypeId(), sensor);
+    
+    // 名为"全部模型"的设备类型有自己的标签页，只显示该类型的设备
+    QVERIFY(plant.addDevice(DeviceInfo("named_001", "同名类型设备", "全部模型", "")));
+    QCOMPARE(tabs->count(), types.count() + 2);
+    QCOMPARE(plantWidget.currentTypeId(), sensor);
+    tabs->setCurrentIndex(tabs->count() - 1);
+    QCOMPARE(plantWidget.currentTypeId(), plant.deviceTypeId("全部模型"));
+    QVERIFY(plantWidget.currentTypeId() != DeviceTypeRegistry::AllTypes);
+    QCOMPARE(model->rowCount(), 1);
+    
+    // 修改显示名称只改标签页文字，当前类型不变
+    QVERIFY(plant.setDeviceTypeDisplayName(sensor, "传感器设备"));
+    QCOMPARE(tabs->tabText(sensorTab), QString("传感器设备"));
+    QCOMPARE(plantWidget.currentTypeId(), plant.deviceTypeId("全部模型"));
+    
+    // 设备数量变化后更新提示
+    QVERIFY(plant.addDevice(DeviceInfo("sensor_300", "新传感器", "传感器", "sensor_group")));
+    QCOMPARE(tabs->tabToolTip(sensorTab), QString("%1 个设备").arg(types.deviceCount(sensor) + 1));
+    
+    // 类型的设备全部删除后标签页消失，类型ID保留
+    const int named = plant.deviceTypeId("全部模型");
+    QVERIFY(plant.removeDevice("named_001"));
+    QCOMPARE(tabs->count(), types.count() + 1);
+    QCOMPARE(plantWidget.currentTypeId(), int(DeviceTypeRegistry::AllTypes));
+    QCOMPARE(tabs->currentIndex(), 0);
+    QCOMPARE(plant.deviceTypeId("全部模型"), named);
+    
+    // 重新加载后保持当前类型，没有设备的类型不显示标签页
+    tabs->setCurrentIndex(sensorTab);
+    CatalogData catalog;
+    QVERIFY(CatalogLoader::parse("root_group,,根模型,1,根模型\n"
+                                 "sensor_group,,传感器,1,传感器\n"
+                                 "sensor_001,sensor_group,传感器,0,温度传感器A\n", catalog));
+    QVERIFY(plant.loadCatalog(catalog));
+    QCOMPARE(plant.deviceTypeId("传感器"), sensor);
+    QCOMPARE(tabs->count(), 3);
+    QCOMPARE(plantWidget.currentTypeId(), sensor);
+    QCOMPARE(tabs->tabBar()->tabData(tabs->currentIndex()).toInt(), sensor);
+    QCOMPARE(model->rowCount(), 1);
+    
+    // 当前类型不在新目录中时回到"全部模型"
+    QVERIFY(CatalogLoader::parse("root_group,,根模型,1,根模型\n", catalog));
+    QVERIFY(plant.loadCatalog(catalog));
+    QCOMPARE(plantWidget.currentTypeId(), int(DeviceTypeRegistry::AllTypes));
+    QCOMPARE(tabs->count(), 2);
+    QCOMPARE(tabs->currentIndex(), 0);
+}
+
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
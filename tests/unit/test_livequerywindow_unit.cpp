@@ -0,0 +1,240 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDebug>
+#include "LiveQueryWindow.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+
+/**
+ * @brief LiveQueryWindow单元测试类
+ *
+ * 测试实时窗口滚动时只聚合新增的时间桶、丢弃过期的头部桶，
+ * 应用增量后的结果与完整查询一致，以及后台聚合期间的请求合并
+ */
+class TestLiveQueryWindow : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 滚动测试
+    void testInactiveWindow();
+    void testAdvanceAppendsTail();
+    void testAdvanceWithinBucket();
+    void testAdvancePastWholeWindow();
+
+    // 后台聚合测试
+    void testCoalescePendingAdvance();
+    void testResetDiscardsInFlight();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 MsPerHour = 60 * MsPerMinute;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+    static constexpr qint64 SpanMs = 24 * MsPerHour;
+
+    bool writeMinutes(TimeSeriesStore &store, qint64 fromMs, qint64 toMs);
+    void compareWithFullQuery(TimeSeriesStore &store, const LiveQueryWindow &window, qint64 nowMs);
+    TimeSeriesQuery windowQuery(qint64 nowMs) const;
+    static LiveWindowDelta advanceAndWait(LiveQueryWindow &window, qint64 nowMs);
+};
+
+void TestLiveQueryWindow::initTestCase()
+{
+    qDebug() << "Starting LiveQueryWindow unit tests...";
+}
+
+void TestLiveQueryWindow::cleanupTestCase()
+{
+    qDebug() << "LiveQueryWindow unit tests completed.";
+}
+
+bool TestLiveQueryWindow::writeMinutes(TimeSeriesStore &store, qint64 fromMs, qint64 toMs)
+{
+    // 样本值为距BaseTime的分钟数
+    const int count = static_cast<int>(qMax<qint64>(0, (toMs - fromMs + MsPerMinute - 1) / MsPerMinute));
+    return TestSeries::appendSamples(store, "sensor_001", fromMs, MsPerMinute, count, [fromMs](int i) {
+        return static_cast<double>((fromMs + i * MsPerMinute - BaseTime) / MsPerMinute);
+    });
+}
+
+TimeSeriesQuery TestLiveQueryWindow::windowQuery(qint64 nowMs) const
+{
+    return TimeSeriesQuery(QStringList() << "sensor_001", nowMs - SpanMs, nowMs, TimeWidget::Hour1);
+}
+
+LiveWindowDelta TestLiveQueryWindow::advanceAndWait(LiveQueryWindow &window, qint64 nowMs)
+{
+    QSignalSpy spy(&window, &LiveQueryWindow::windowAdvanced);
+    if (!window.advanceTo(nowMs) || !spy.wait(5000)) {
+        return LiveWindowDelta();
+    }
+    return spy.first().first().value<LiveWindowDelta>();
+}
+
+void TestLiveQueryWindow::compareWithFullQuery(TimeSeriesStore &store, const LiveQueryWindow &window, qint64 nowMs)
+{
+    const TimeSeriesQueryResult expected = store.query(windowQuery(nowMs));
+    const TimeSeriesQueryResult &actual = window.result();
+
+    QCOMPARE(actual.bucketer, expected.bucketer);
+    QCOMPARE(actual.series.size(), expected.series.size());
+    const QVector<BucketAggregate> &expectedBuckets = expected.series.first().buckets;
+    const QVector<BucketAggregate> &actualBuckets = actual.series.first().buckets;
+    QCOMPARE(actualBuckets.size(), expectedBuckets.size());
+    for (int i = 0; i < expectedBuckets.size(); ++i) {
+        QCOMPARE(actualBuckets.at(i).count, expectedBuckets.at(i).count);
+        QCOMPARE(actualBuckets.at(i).sum, expectedBuckets.at(i).sum);
+        QCOMPARE(actualBuckets.at(i).last, expectedBuckets.at(i).last);
+    }
+}
+
+void TestLiveQueryWindow::testInactiveWindow()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    LiveQueryWindow window(&store);
+    QSignalSpy spy(&window, &LiveQueryWindow::windowAdvanced);
+
+    QVERIFY(!window.isActive());
+    QVERIFY(!window.advanceTo(BaseTime));
+    QVERIFY(!spy.wait(100));
+}
+
+void TestLiveQueryWindow::testAdvanceAppendsTail()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    const qint64 start = BaseTime + 30 * MsPerHour + 10 * MsPerMinute;
+    QVERIFY(writeMinutes(store, BaseTime, start));
+
+    LiveQueryWindow window(&store);
+    window.reset(store.query(windowQuery(start)), SpanMs);
+    QVERIFY(window.isActive());
+
+    // 两个半小时后：新到的样本落入原来的最后一个桶和新出现的桶
+    const qint64 now = start + 2 * MsPerHour + 30 * MsPerMinute;
+    QVERIFY(writeMinutes(store, start, now));
+    const LiveWindowDelta delta = advanceAndWait(window, now);
+
+    QVERIFY(delta.isValid());
+    // 窗口起点后移两个半小时，丢弃最前面的两个桶
+    QCOMPARE(delta.droppedHeadBuckets, 2);
+    QCOMPARE(delta.firstUpdatedBucket, delta.bucketer.bucketCount() - 3);
+    QCOMPARE(delta.tail.size(), 1);
+    QCOMPARE(delta.tail.first().buckets.size(), 3);
+
+    // 只扫描了尾部的样本：原来最后一个桶、下一个整点桶以及当前桶的前40分钟
+    QCOMPARE(delta.samplesScanned, qint64(60 + 60 + 40));
+    compareWithFullQuery(store, window, now);
+}
+
+void TestLiveQueryWindow::testAdvanceWithinBucket()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    const qint64 start = BaseTime + 30 * MsPerHour + 10 * MsPerMinute;
+    QVERIFY(writeMinutes(store, BaseTime, start));
+
+    LiveQueryWindow window(&store);
+    window.reset(store.query(windowQuery(start)), SpanMs);
+
+    // 仍在同一个桶内：不丢弃头部，只重新聚合最后一个桶
+    const qint64 now = start + 20 * MsPerMinute;
+    QVERIFY(writeMinutes(store, start, now));
+    const LiveWindowDelta delta = advanceAndWait(window, now);
+
+    QCOMPARE(delta.droppedHeadBuckets, 0);
+    QCOMPARE(delta.firstUpdatedBucket, delta.bucketer.bucketCount() - 1);
+    QCOMPARE(delta.samplesScanned, qint64(30));
+    compareWithFullQuery(store, window, now);
+}
+
+void TestLiveQueryWindow::testAdvancePastWholeWindow()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    const qint64 start = BaseTime + 30 * MsPerHour;
+    QVERIFY(writeMinutes(store, BaseTime, start));
+
+    LiveQueryWindow window(&store);
+    window.reset(store.query(windowQuery(start)), SpanMs);
+    const int oldCount = window.result().bucketer.bucketCount();
+
+    // 系统休眠两天后唤醒：整个窗口重新聚合
+    const qint64 now = start + 48 * MsPerHour;
+    QVERIFY(writeMinutes(store, start, now));
+    const LiveWindowDelta delta = advanceAndWait(window, now);
+
+    QCOMPARE(delta.droppedHeadBuckets, oldCount);
+    QCOMPARE(delta.firstUpdatedBucket, 0);
+    compareWithFullQuery(store, window, now);
+
+    // 停止后不再滚动
+    window.stop();
+    QVERIFY(!window.advanceTo(now + MsPerHour));
+}
+
+void TestLiveQueryWindow::testCoalescePendingAdvance()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    const qint64 start = BaseTime + 30 * MsPerHour;
+    const qint64 now = start + 3 * MsPerHour;
+    QVERIFY(writeMinutes(store, BaseTime, now));
+
+    LiveQueryWindow window(&store);
+    window.reset(store.query(windowQuery(start)), SpanMs);
+    QSignalSpy spy(&window, &LiveQueryWindow::windowAdvanced);
+
+    // 第一次聚合执行期间的请求只保留最后一个，在其完成后派发
+    QVERIFY(window.advanceTo(start + MsPerHour));
+    QVERIFY(window.advanceTo(start + 2 * MsPerHour));
+    QVERIFY(window.advanceTo(now));
+    QVERIFY(window.isBusy());
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 2, 5000);
+    QVERIFY(!window.isBusy());
+
+    QCOMPARE(spy.last().first().value<LiveWindowDelta>().bucketer.endMs(), now);
+    compareWithFullQuery(store, window, now);
+}
+
+void TestLiveQueryWindow::testResetDiscardsInFlight()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    const qint64 start = BaseTime + 30 * MsPerHour;
+    const qint64 now = start + 2 * MsPerHour;
+    QVERIFY(writeMinutes(store, BaseTime, now));
+
+    LiveQueryWindow window(&store);
+    window.reset(store.query(windowQuery(start)), SpanMs);
+    QSignalSpy spy(&window, &LiveQueryWindow::windowAdvanced);
+
+    // 聚合结果回到窗口之前重新启动：旧窗口的增量被丢弃
+    QVERIFY(window.advanceTo(now));
+    window.reset(store.query(windowQuery(now)), SpanMs);
+    QTRY_VERIFY_WITH_TIMEOUT(!window.isBusy(), 5000);
+    QCOMPARE(spy.count(), 0);
+    compareWithFullQuery(store, window, now);
+
+    // 停止后到达的结果同样被丢弃
+    QVERIFY(window.advanceTo(now + MsPerHour));
+    window.stop();
+    QTRY_VERIFY_WITH_TIMEOUT(!window.isBusy(), 5000);
+    QCOMPARE(spy.count(), 0);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestLiveQueryWindow test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_livequerywindow_unit.moc"
@@ -0,0 +1,175 @@
+#include <QApplication>
+#include <QTest>
+#include <QDebug>
+#include "QueryCostEstimator.h"
+
+/**
+ * @brief QueryCostEstimator单元测试类
+ *
+ * 测试查询规模的精确估算、预算判断、颗粒度建议以及延迟模型校准
+ */
+class TestQueryCostEstimator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 估算测试
+    void testEstimateMatchesBucketer();
+    void testInvalidQuery();
+
+    // 预算测试
+    void testBudget();
+    void testSuggestGranularity();
+
+    // 校准测试
+    void testCalibration();
+    void testFormatEstimate();
+
+private:
+    static constexpr qint64 MsPerDay = 24 * 60 * 60 * 1000LL;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    TimeSeriesQuery makeQuery(int devices, int days, TimeWidget::TimeGranularity granularity) const;
+};
+
+void TestQueryCostEstimator::initTestCase()
+{
+    qDebug() << "Starting QueryCostEstimator unit tests...";
+}
+
+void TestQueryCostEstimator::cleanupTestCase()
+{
+    qDebug() << "QueryCostEstimator unit tests completed.";
+}
+
+TimeSeriesQuery TestQueryCostEstimator::makeQuery(int devices, int days, TimeWidget::TimeGranularity granularity) const
+{
+    QStringList deviceIds;
+    for (int i = 0; i < devices; ++i) {
+        deviceIds << QString("sensor_%1").arg(i);
+    }
+    return TimeSeriesQuery(deviceIds, BaseTime, BaseTime + days * MsPerDay, granularity);
+}
+
+void TestQueryCostEstimator::testEstimateMatchesBucketer()
+{
+    QueryCostEstimator estimator;
+    const TimeSeriesQuery query = makeQuery(50, 3, TimeWidget::Minutes15);
+    const TimeBucketer bucketer(query.startMs, query.endMs, query.granularity);
+
+    const QueryCostEstimate estimate = estimator.estimate(query);
+    QCOMPARE(estimate.deviceCount, 50);
+    QCOMPARE(estimate.bucketCount, bucketer.bucketCount());
+    QCOMPARE(estimate.rows, qint64(50) * bucketer.bucketCount());
+    QVERIFY(estimate.bytes >= estimate.rows * qint64(sizeof(BucketAggregate)));
+    QVERIFY(estimate.latencyMs > 0.0);
+
+    // 更粗的颗粒度行数更少
+    QVERIFY(estimator.estimate(makeQuery(50, 3, TimeWidget::Hour1)).rows < estimate.rows);
+}
+
+void TestQueryCostEstimator::testInvalidQuery()
+{
+    QueryCostEstimator estimator;
+    const QueryCostEstimate estimate = estimator.estimate(TimeSeriesQuery());
+    QCOMPARE(estimate.rows, qint64(0));
+    QVERIFY(!estimator.exceedsBudget(estimate));
+}
+
+void TestQueryCostEstimator::testBudget()
+{
+    QueryCostEstimator estimator;
+    QueryBudget budget;
+    budget.maxRows = 10000;
+    estimator.setBudget(budget);
+
+    // 10个设备 × 1天 × 96个15分钟桶 = 960行
+    QVERIFY(!estimator.exceedsBudget(estimator.estimate(makeQuery(10, 1, TimeWidget::Minutes15))));
+    // 100个设备 × 1年 × 15分钟 远超预算
+    QVERIFY(estimator.exceedsBudget(estimator.estimate(makeQuery(100, 365, TimeWidget::Minutes15))));
+
+    // 延迟预算同样生效
+    budget = QueryBudget();
+    budget.maxLatencyMs = 0.5;
+    estimator.setBudget(budget);
+    QVERIFY(estimator.exceedsBudget(estimator.estimate(makeQuery(1, 1, TimeWidget::Day1))));
+}
+
+void TestQueryCostEstimator::testSuggestGranularity()
+{
+    QueryCostEstimator estimator;
+    QueryBudget budget;
+    budget.maxRows = 100 * 31 * 24;
+    estimator.setBudget(budget);
+
+    // 100个设备 × 30天：15分钟超出预算，1小时刚好满足
+    QCOMPARE(estimator.suggestGranularity(makeQuery(100, 30, TimeWidget::Minutes15)), TimeWidget::Hour1);
+    // 不会建议比当前更细的颗粒度
+    QCOMPARE(estimator.suggestGranularity(makeQuery(100, 30, TimeWidget::Day1)), TimeWidget::Day1);
+    // 任何颗粒度都不满足时建议1天
+    QCOMPARE(estimator.suggestGranularity(makeQuery(100, 3000, TimeWidget::Minutes15)), TimeWidget::Day1);
+}
+
+void TestQueryCostEstimator::testCalibration()
+{
+    QueryCostEstimator estimator;
+    const double initial = estimator.microsecondsPerRow();
+
+    TimeSeriesQueryResult result;
+    result.bucketer = TimeBucketer(BaseTime, BaseTime + 30 * MsPerDay, TimeWidget::Minutes15);
+    result.series.resize(10);
+    const qint64 rows = 10LL * result.bucketer.bucketCount();
+    result.elapsedUs = 1000 + rows * 10;  // 每行10微秒
+    result.bucketsScanned = rows;
+
+    // 被取消的结果不参与校准
+    result.cancelled = true;
+    estimator.recordExecution(result);
+    QCOMPARE(estimator.microsecondsPerRow(), initial);
+
+    // 大部分行命中缓存或预聚合层的结果不参与校准
+    TimeSeriesQueryResult cached = result;
+    cached.cancelled = false;
+    cached.bucketsScanned = rows / 10;
+    cached.elapsedUs = 1000 + cached.bucketsScanned * 10;
+    for (int i = 0; i < 50; ++i) {
+        estimator.recordExecution(cached);
+    }
+    QCOMPARE(estimator.microsecondsPerRow(), initial);
+
+    // 多次观测后收敛到实际耗时
+    result.cancelled = false;
+    for (int i = 0; i < 50; ++i) {
+        estimator.recordExecution(result);
+    }
+    QVERIFY(qAbs(estimator.microsecondsPerRow() - 10.0) < 0.1);
+
+    // 部分命中缓存时按实际聚合的行计算每行耗时
+    TimeSeriesQueryResult partial = result;
+    partial.bucketsScanned = rows * 3 / 4;
+    partial.elapsedUs = 1000 + partial.bucketsScanned * 10;
+    estimator.recordExecution(partial);
+    QVERIFY(qAbs(estimator.microsecondsPerRow() - 10.0) < 0.1);
+}
+
+void TestQueryCostEstimator::testFormatEstimate()
+{
+    QueryCostEstimate estimate;
+    estimate.rows = 35040;
+    estimate.bytes = 3 * 1024 * 1024;
+    estimate.latencyMs = 8.6;
+    QCOMPARE(QueryCostEstimator::formatEstimate(estimate), QString("35.0k rows, 3.0 MB, ~9 ms"));
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestQueryCostEstimator test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_querycostestimator_unit.moc"
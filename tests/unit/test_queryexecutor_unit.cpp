@@ -0,0 +1,325 @@
+#include <QApplication>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QDebug>
+#include <atomic>
+#include "QueryExecutor.h"
+#include "QueryResultCache.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+#include "WorkStealingThreadPool.h"
+
+/**
+ * @brief QueryExecutor单元测试类
+ *
+ * 测试工作窃取线程池、并行查询与串行查询结果一致、进度上报，
+ * 并在合成数据集上按线程数对比查询耗时
+ */
+class TestQueryExecutor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 线程池测试
+    void testPoolRunsAllTasks();
+    void testPoolNestedSubmit();
+
+    // 执行器测试
+    void testMatchesSerialQuery_data();
+    void testMatchesSerialQuery();
+    void testFewDevicesAreSliced();
+    void testProgressReported();
+    void testStreamsPartialResults();
+    void testFirstPartialIsFast();
+
+    // 取消令牌测试
+    void testCancelWakesWaiter();
+
+    // 性能测试
+    void benchmarkThreadScaling_data();
+    void benchmarkThreadScaling();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+    static constexpr int DeviceCount = 64;
+    static constexpr int MinutesPerDevice = 3 * 24 * 60;
+
+    static void compareResults(const TimeSeriesQueryResult &actual, const TimeSeriesQueryResult &expected);
+    TimeSeriesQuery fullQuery(int deviceCount, TimeWidget::TimeGranularity granularity) const;
+
+    QTemporaryDir m_dataDir;
+    QScopedPointer<TimeSeriesStore> m_store;
+    QStringList m_deviceIds;
+};
+
+void TestQueryExecutor::initTestCase()
+{
+    qDebug() << "Starting QueryExecutor unit tests, ideal thread count:" << QThread::idealThreadCount();
+
+    // 合成数据集：64个设备，每个设备3天的分钟数据
+    QVERIFY(m_dataDir.isValid());
+    m_store.reset(new TimeSeriesStore(m_dataDir.path()));
+
+    for (int device = 0; device < DeviceCount; ++device) {
+        const QString deviceId = QString("sensor_%1").arg(device, 3, 10, QChar('0'));
+        QVERIFY(TestSeries::appendSamples(*m_store, deviceId, BaseTime, MsPerMinute, MinutesPerDevice,
+                                          [device](int i) { return device * 1000.0 + (i % 97); }));
+        m_deviceIds << deviceId;
+    }
+}
+
+void TestQueryExecutor::cleanupTestCase()
+{
+    qDebug() << "QueryExecutor unit tests completed.";
+}
+
+void TestQueryExecutor::compareResults(const TimeSeriesQueryResult &actual, const TimeSeriesQueryResult &expected)
+{
+    QCOMPARE(actual.bucketer, expected.bucketer);
+    QCOMPARE(actual.samplesScanned, expected.samplesScanned);
+    QCOMPARE(actual.series.size(), expected.series.size());
+    for (int i = 0; i < actual.series.size(); ++i) {
+        QCOMPARE(actual.series.at(i).deviceId, expected.series.at(i).deviceId);
+        QCOMPARE(actual.series.at(i).buckets.size(), expected.series.at(i).buckets.size());
+        for (int bucket = 0; bucket < actual.series.at(i).buckets.size(); ++bucket) {
+            const BucketAggregate &a = actual.series.at(i).buckets.at(bucket);
+            const BucketAggregate &e = expected.series.at(i).buckets.at(bucket);
+            QCOMPARE(a.count, e.count);
+            QCOMPARE(a.sum, e.sum);
+            QCOMPARE(a.min, e.min);
+            QCOMPARE(a.max, e.max);
+        }
+    }
+}
+
+TimeSeriesQuery TestQueryExecutor::fullQuery(int deviceCount, TimeWidget::TimeGranularity granularity) const
+{
+    return TimeSeriesQuery(m_deviceIds.mid(0, deviceCount), BaseTime,
+                           BaseTime + MinutesPerDevice * MsPerMinute, granularity);
+}
+
+void TestQueryExecutor::testPoolRunsAllTasks()
+{
+    WorkStealingThreadPool pool(4);
+    QCOMPARE(pool.threadCount(), 4);
+
+    std::atomic<int> sum(0);
+    for (int i = 1; i <= 1000; ++i) {
+        pool.submit([&sum, i]() { sum.fetch_add(i); });
+    }
+    pool.waitForDone();
+    QCOMPARE(sum.load(), 500500);
+
+    // 线程池可重复使用
+    pool.submit([&sum]() { sum.fetch_add(1); });
+    pool.waitForDone();
+    QCOMPARE(sum.load(), 500501);
+}
+
+void TestQueryExecutor::testPoolNestedSubmit()
+{
+    WorkStealingThreadPool pool(4);
+    std::atomic<int> leaves(0);
+
+    // 工作线程内提交的子任务同样被waitForDone等待
+    for (int i = 0; i < 8; ++i) {
+        pool.submit([&pool, &leaves]() {
+            for (int j = 0; j < 100; ++j) {
+                pool.submit([&leaves]() { leaves.fetch_add(1); });
+            }
+        });
+    }
+    pool.waitForDone();
+    QCOMPARE(leaves.load(), 800);
+}
+
+void TestQueryExecutor::testMatchesSerialQuery_data()
+{
+    QTest::addColumn<int>("deviceCount");
+    QTest::addColumn<int>("granularity");
+    QTest::newRow("all devices, 15 minutes") << int(DeviceCount) << int(TimeWidget::Minutes15);
+    QTest::newRow("all devices, 1 day") << int(DeviceCount) << int(TimeWidget::Day1);
+    QTest::newRow("one device, 1 hour") << 1 << int(TimeWidget::Hour1);
+}
+
+void TestQueryExecutor::testMatchesSerialQuery()
+{
+    QFETCH(int, deviceCount);
+    QFETCH(int, granularity);
+
+    const TimeSeriesQuery query = fullQuery(deviceCount, static_cast<TimeWidget::TimeGranularity>(granularity));
+    QueryExecutor executor(m_store.data(), 4);
+    compareResults(executor.execute(query), m_store->query(query));
+}
+
+void TestQueryExecutor::testFewDevicesAreSliced()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TimeSeriesStore store(dir.path());
+    QueryResultCache cache;
+    store.setResultCache(&cache);
+
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", MinutesPerDevice));
+
+    const TimeSeriesQuery query(QStringList() << "sensor_001", BaseTime,
+                                BaseTime + MinutesPerDevice * MsPerMinute, TimeWidget::Minutes15);
+    QueryExecutor executor(&store, 8);
+
+    // 信号在工作线程中直接调用，计数须是原子的
+    std::atomic<int> progressSignals(0);
+    connect(&executor, &QueryExecutor::progressChanged, this,
+            [&progressSignals](int, int) { progressSignals.fetch_add(1); }, Qt::DirectConnection);
+
+    // 单个设备被切成多个时间片，结果写回缓存
+    const TimeSeriesQueryResult first = executor.execute(query);
+    QCOMPARE(first.samplesScanned, qint64(MinutesPerDevice));
+    QCOMPARE(first.bucketsScanned, qint64(first.bucketer.bucketCount()));
+    QVERIFY(progressSignals.load() > 1);
+    QCOMPARE(cache.entryCount(), 1);
+
+    // 再次查询完全命中缓存
+    const TimeSeriesQueryResult second = executor.execute(query);
+    QCOMPARE(second.samplesScanned, qint64(0));
+    QCOMPARE(second.bucketsScanned, qint64(0));
+    compareResults(second, store.query(query));
+}
+
+void TestQueryExecutor::testProgressReported()
+{
+    QueryExecutor executor(m_store.data(), 4);
+
+    QMutex mutex;
+    int lastCompleted = 0;
+    int lastTotal = 0;
+    connect(&executor, &QueryExecutor::progressChanged, this,
+            [&mutex, &lastCompleted, &lastTotal](int completed, int total) {
+                QMutexLocker locker(&mutex);
+                lastCompleted = qMax(lastCompleted, completed);
+                lastTotal = total;
+            }, Qt::DirectConnection);
+
+    executor.execute(fullQuery(DeviceCount, TimeWidget::Hour1));
+    QCOMPARE(lastTotal, int(DeviceCount));
+    QCOMPARE(lastCompleted, int(DeviceCount));
+}
+
+void TestQueryExecutor::testStreamsPartialResults()
+{
+    QueryExecutor executor(m_store.data(), 4);
+    executor.setStreamInterval(0);
+
+    QMutex mutex;
+    QStringList streamedIds;
+    int lastCompleted = 0;
+    connect(&executor, &QueryExecutor::partialResultReady, this,
+            [&mutex, &streamedIds, &lastCompleted](const PartialQueryResult &partial) {
+                QMutexLocker locker(&mutex);
+                for (const DeviceSeries &series : partial.series) {
+                    streamedIds << series.deviceId;
+                }
+                lastCompleted = qMax(lastCompleted, partial.completedDevices);
+            }, Qt::DirectConnection);
+
+    // 间隔为0时每个设备完成即发出，所有设备恰好流式返回一次
+    const TimeSeriesQueryResult result = executor.execute(fullQuery(DeviceCount, TimeWidget::Hour1));
+    QCOMPARE(streamedIds.size(), int(DeviceCount));
+    QCOMPARE(lastCompleted, int(DeviceCount));
+    streamedIds.sort();
+    QCOMPARE(streamedIds, m_deviceIds);
+    QVERIFY(!result.cancelled);
+}
+
+void TestQueryExecutor::testFirstPartialIsFast()
+{
+    QueryExecutor executor(m_store.data());
+
+    QElapsedTimer timer;
+    std::atomic<qint64> firstPartialMs(-1);
+    connect(&executor, &QueryExecutor::partialResultReady, this,
+            [&timer, &firstPartialMs](const PartialQueryResult &) {
+                qint64 expected = -1;
+                firstPartialMs.compare_exchange_strong(expected, timer.elapsed());
+            }, Qt::DirectConnection);
+
+    timer.start();
+    const TimeSeriesQueryResult result = executor.execute(fullQuery(DeviceCount, TimeWidget::Minutes15));
+    qDebug() << "First partial after" << firstPartialMs.load() << "ms, full result after"
+             << result.elapsedUs / 1000 << "ms";
+
+    QVERIFY(firstPartialMs.load() >= 0);
+    QVERIFY(firstPartialMs.load() < 100);
+}
+
+void TestQueryExecutor::testCancelWakesWaiter()
+{
+    // 未取消时等待到超时
+    const QueryCancelToken token;
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!token.waitForCancel(20 * 1000));
+    QVERIFY(timer.elapsed() >= 20);
+
+    // 另一个线程取消副本时立即唤醒，无需等满10秒
+    QScopedPointer<QThread> canceller(QThread::create([token]() {
+        QThread::msleep(50);
+        token.cancel();
+    }));
+    timer.start();
+    canceller->start();
+    QVERIFY(token.waitForCancel(10 * 1000 * 1000));
+    QVERIFY(timer.elapsed() < 5000);
+    QVERIFY(canceller->wait(5000));
+
+    // 已取消时不再等待
+    QVERIFY(token.waitForCancel(10 * 1000 * 1000));
+}
+
+void TestQueryExecutor::benchmarkThreadScaling_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+void TestQueryExecutor::benchmarkThreadScaling()
+{
+    QFETCH(int, threadCount);
+
+    // 不挂结果缓存，每次都完整读取并聚合
+    QueryExecutor executor(m_store.data(), threadCount);
+    const TimeSeriesQuery query = fullQuery(DeviceCount, TimeWidget::Minutes15);
+
+    int runs = 0;
+    qint64 scanned = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ++runs;
+        scanned = executor.execute(query).samplesScanned;
+    }
+
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    if (seconds > 0.0) {
+        qDebug() << threadCount << "threads:" << qRound64(runs * scanned / seconds) << "samples/sec";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestQueryExecutor test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_queryexecutor_unit.moc"
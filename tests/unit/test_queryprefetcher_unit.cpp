@@ -0,0 +1,225 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDebug>
+#include "QueryPrefetcher.h"
+#include "QueryResultCache.h"
+#include "QueryScheduler.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+
+/**
+ * @brief QueryPrefetcher单元测试类
+ *
+ * 测试预测窗口、空闲预取预热缓存、用户查询打断预取、预取字节上限以及命中统计
+ */
+class TestQueryPrefetcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void cleanupTestCase();
+
+    // 预测测试
+    void testPredictNextQueries();
+
+    // 预取测试
+    void testPrefetchWarmsCache();
+    void testUserQueryPreemptsPrefetch();
+    void testMemoryBudget();
+    void testMemoryBudgetCountsOwnBytes();
+    void testHitStatistics();
+
+private:
+    static constexpr qint64 MsPerHour = 60 * 60 * 1000LL;
+    static constexpr qint64 MsPerDay = 24 * MsPerHour;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+    static constexpr int DeviceCount = 16;
+
+    TimeSeriesQuery dayQuery(int day, TimeWidget::TimeGranularity granularity) const;
+
+    QTemporaryDir m_dataDir;
+    QStringList m_deviceIds;
+    QScopedPointer<TimeSeriesStore> m_store;
+    QScopedPointer<QueryResultCache> m_cache;
+    QScopedPointer<QueryExecutor> m_executor;
+    QScopedPointer<QueryScheduler> m_scheduler;
+};
+
+void TestQueryPrefetcher::initTestCase()
+{
+    qDebug() << "Starting QueryPrefetcher unit tests...";
+
+    // 16个设备，每个设备10天的整点数据
+    QVERIFY(m_dataDir.isValid());
+    TimeSeriesStore store(m_dataDir.path());
+    for (int device = 0; device < DeviceCount; ++device) {
+        m_deviceIds << QString("sensor_%1").arg(device);
+        QVERIFY(TestSeries::appendSamples(store, m_deviceIds.last(), BaseTime, MsPerHour, 10 * 24,
+                                          [](int i) { return static_cast<double>(i); }));
+    }
+}
+
+void TestQueryPrefetcher::init()
+{
+    // 每个测试使用新的缓存与调度器
+    m_store.reset(new TimeSeriesStore(m_dataDir.path()));
+    m_cache.reset(new QueryResultCache());
+    m_store->setResultCache(m_cache.data());
+    m_executor.reset(new QueryExecutor(m_store.data(), 2));
+    m_scheduler.reset(new QueryScheduler(m_executor.data()));
+    m_scheduler->setSettleInterval(0);
+}
+
+void TestQueryPrefetcher::cleanup()
+{
+    m_scheduler.reset();
+    m_executor.reset();
+    m_store.reset();
+    m_cache.reset();
+}
+
+void TestQueryPrefetcher::cleanupTestCase()
+{
+    qDebug() << "QueryPrefetcher unit tests completed.";
+}
+
+TimeSeriesQuery TestQueryPrefetcher::dayQuery(int day, TimeWidget::TimeGranularity granularity) const
+{
+    return TimeSeriesQuery(m_deviceIds, BaseTime + day * MsPerDay, BaseTime + (day + 1) * MsPerDay, granularity);
+}
+
+void TestQueryPrefetcher::testPredictNextQueries()
+{
+    const TimeSeriesQuery query = dayQuery(5, TimeWidget::Minutes15);
+    const QVector<TimeSeriesQuery> windows = QueryPrefetcher::predictNextQueries(query);
+
+    // 前一天、三天超集、更粗颗粒度
+    QCOMPARE(windows.size(), 3);
+    QCOMPARE(windows.at(0), dayQuery(4, TimeWidget::Minutes15));
+    QCOMPARE(windows.at(1).startMs, BaseTime + 3 * MsPerDay);
+    QCOMPARE(windows.at(1).endMs, query.endMs);
+    QCOMPARE(windows.at(2), dayQuery(5, TimeWidget::Hour1));
+
+    // 1天颗粒度且范围超过三天时只预测前一个周期
+    const TimeSeriesQuery week(m_deviceIds, BaseTime, BaseTime + 7 * MsPerDay, TimeWidget::Day1);
+    QCOMPARE(QueryPrefetcher::predictNextQueries(week).size(), 1);
+
+    QVERIFY(QueryPrefetcher::predictNextQueries(TimeSeriesQuery()).isEmpty());
+}
+
+void TestQueryPrefetcher::testPrefetchWarmsCache()
+{
+    QueryPrefetcher prefetcher(m_store.data(), m_scheduler.data());
+    prefetcher.setIdleDelay(0);
+    prefetcher.setCpuBudget(100);
+    QSignalSpy finishedSpy(&prefetcher, &QueryPrefetcher::prefetchFinished);
+
+    m_scheduler->submit(dayQuery(5, TimeWidget::Hour1));
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(finishedSpy.first().first().toInt(), 3);
+    QCOMPARE(prefetcher.windowsPrefetched(), quint64(3));
+
+    // 前一天的查询完全命中缓存
+    QVector<BucketAggregate> buckets;
+    const TimeBucketer previousDay(BaseTime + 4 * MsPerDay, BaseTime + 5 * MsPerDay, TimeWidget::Hour1);
+    for (const QString &deviceId : m_deviceIds) {
+        QVERIFY(m_cache->lookup(deviceId, previousDay, buckets).isEmpty());
+    }
+}
+
+void TestQueryPrefetcher::testUserQueryPreemptsPrefetch()
+{
+    QueryPrefetcher prefetcher(m_store.data(), m_scheduler.data());
+    prefetcher.setIdleDelay(0);
+    prefetcher.setCpuBudget(1);  // 每个设备之后长时间休眠，保证预取仍在进行
+    QSignalSpy startedSpy(&prefetcher, &QueryPrefetcher::prefetchStarted);
+    QSignalSpy finishedSpy(&prefetcher, &QueryPrefetcher::prefetchFinished);
+
+    m_scheduler->submit(dayQuery(5, TimeWidget::Hour1));
+    QVERIFY(startedSpy.wait(5000));
+    QVERIFY(prefetcher.isRunning());
+
+    // 用户查询立即取消预取
+    m_scheduler->submit(dayQuery(8, TimeWidget::Hour1));
+    QVERIFY(finishedSpy.wait(5000));
+    QVERIFY(finishedSpy.first().first().toInt() < 3);
+    QVERIFY(prefetcher.windowsPreempted() > 0);
+}
+
+void TestQueryPrefetcher::testMemoryBudget()
+{
+    QueryPrefetcher prefetcher(m_store.data(), m_scheduler.data());
+    prefetcher.setIdleDelay(0);
+    prefetcher.setMemoryBudget(0.0);
+    QSignalSpy finishedSpy(&prefetcher, &QueryPrefetcher::prefetchFinished);
+
+    // 缓存已达上限时不预取任何窗口
+    m_scheduler->submit(dayQuery(5, TimeWidget::Hour1));
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(finishedSpy.first().first().toInt(), 0);
+    QCOMPARE(prefetcher.windowsPrefetched(), quint64(0));
+}
+
+void TestQueryPrefetcher::testMemoryBudgetCountsOwnBytes()
+{
+    // 其他设备的用户数据占用约200KB，超过预取上限本身
+    const TimeBucketer longRange(BaseTime, BaseTime + 4300 * MsPerHour, TimeWidget::Hour1);
+    m_cache->insert("other", longRange, 0, QVector<BucketAggregate>(longRange.bucketCount()));
+    const int byteCap = 100 * 1024;
+    QVERIFY(m_cache->usedBytes() > byteCap);
+
+    QueryPrefetcher prefetcher(m_store.data(), m_scheduler.data());
+    prefetcher.setIdleDelay(0);
+    prefetcher.setCpuBudget(100);
+    prefetcher.setMemoryBudget(static_cast<double>(byteCap) / m_cache->maxBytes());
+    QSignalSpy finishedSpy(&prefetcher, &QueryPrefetcher::prefetchFinished);
+
+    // 上限只计入预取写入的字节，三个窗口都能完成
+    m_scheduler->submit(dayQuery(5, TimeWidget::Hour1));
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(finishedSpy.first().first().toInt(), 3);
+    QVERIFY(prefetcher.prefetchedBytes() > 0);
+    QVERIFY(prefetcher.prefetchedBytes() <= byteCap);
+}
+
+void TestQueryPrefetcher::testHitStatistics()
+{
+    QueryPrefetcher prefetcher(m_store.data(), m_scheduler.data());
+    prefetcher.setIdleDelay(0);
+    prefetcher.setCpuBudget(100);
+    QSignalSpy finishedSpy(&prefetcher, &QueryPrefetcher::prefetchFinished);
+    QSignalSpy resultSpy(m_scheduler.data(), &QueryScheduler::resultReady);
+
+    m_scheduler->submit(dayQuery(5, TimeWidget::Hour1));
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(prefetcher.hitCount(), quint64(0));
+
+    // 与三天窗口部分重叠但未被完整覆盖：不算命中
+    m_scheduler->submit(TimeSeriesQuery(m_deviceIds, BaseTime + 2 * MsPerDay, BaseTime + 5 * MsPerDay,
+                                        TimeWidget::Hour1));
+    QVERIFY(resultSpy.wait(5000));
+    QCOMPARE(prefetcher.hitCount(), quint64(0));
+
+    // 向前翻一天：命中预取窗口，且无需扫描原始样本
+    m_scheduler->submit(dayQuery(4, TimeWidget::Hour1));
+    QVERIFY(resultSpy.wait(5000));
+    QCOMPARE(resultSpy.last().first().value<TimeSeriesQueryResult>().samplesScanned, qint64(0));
+    QCOMPARE(prefetcher.userQueryCount(), quint64(3));
+    QCOMPARE(prefetcher.hitCount(), quint64(1));
+    QCOMPARE(prefetcher.hitRate(), 1.0 / 3.0);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestQueryPrefetcher test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_queryprefetcher_unit.moc"
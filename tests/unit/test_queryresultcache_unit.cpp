@@ -0,0 +1,248 @@
+#include <QApplication>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <QDebug>
+#include "QueryResultCache.h"
+#include "TimeSeriesStore.h"
+
+/**
+ * @brief QueryResultCache单元测试类
+ *
+ * 测试部分重叠的查询范围复用已缓存的桶、段合并、写入后失效以及内存上限
+ */
+class TestQueryResultCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 缓存行为测试
+    void testFullMissThenHit();
+    void testPartialOverlap();
+    void testRunsMerge();
+    void testInvalidateFrom();
+    void testInsertAfterInvalidate();
+    void testMemoryLimit();
+
+    // 与存储集成测试
+    void testStoreReusesCachedBuckets();
+    void testStoreInvalidatesOnAppend();
+
+private:
+    static constexpr qint64 MsPerHour = 60 * 60 * 1000LL;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    static TimeBucketer hours(int firstHour, int hourCount);
+    static QVector<BucketAggregate> filledBuckets(int count, double value);
+};
+
+void TestQueryResultCache::initTestCase()
+{
+    qDebug() << "Starting QueryResultCache unit tests...";
+}
+
+void TestQueryResultCache::cleanupTestCase()
+{
+    qDebug() << "QueryResultCache unit tests completed.";
+}
+
+TimeBucketer TestQueryResultCache::hours(int firstHour, int hourCount)
+{
+    return TimeBucketer(BaseTime + firstHour * MsPerHour, BaseTime + (firstHour + hourCount) * MsPerHour,
+                        TimeWidget::Hour1, QTimeZone::utc());
+}
+
+QVector<BucketAggregate> TestQueryResultCache::filledBuckets(int count, double value)
+{
+    QVector<BucketAggregate> buckets(count);
+    for (BucketAggregate &bucket : buckets) {
+        bucket.add(value);
+    }
+    return buckets;
+}
+
+void TestQueryResultCache::testFullMissThenHit()
+{
+    QueryResultCache cache;
+    const TimeBucketer bucketer = hours(0, 24);
+
+    QVector<BucketAggregate> buckets;
+    QVector<QueryResultCache::Segment> gaps = cache.lookup("sensor_001", bucketer, buckets);
+    QCOMPARE(gaps.size(), 1);
+    QCOMPARE(gaps.first().firstBucket, 0);
+    QCOMPARE(gaps.first().bucketCount, 24);
+
+    cache.insert("sensor_001", bucketer, 0, filledBuckets(24, 1.0));
+
+    gaps = cache.lookup("sensor_001", bucketer, buckets);
+    QVERIFY(gaps.isEmpty());
+    QCOMPARE(buckets.size(), 24);
+    QCOMPARE(buckets.last().sum, 1.0);
+    QCOMPARE(cache.hitBuckets(), quint64(24));
+    QCOMPARE(cache.missBuckets(), quint64(24));
+    QCOMPARE(cache.hitRate(), 0.5);
+
+    // 其他颗粒度不共享缓存
+    const TimeBucketer quarters(bucketer.startMs(), bucketer.endMs(), TimeWidget::Minutes15, QTimeZone::utc());
+    QCOMPARE(cache.lookup("sensor_001", quarters, buckets).size(), 1);
+}
+
+void TestQueryResultCache::testPartialOverlap()
+{
+    QueryResultCache cache;
+    cache.insert("sensor_001", hours(0, 24), 0, filledBuckets(24, 1.0));
+
+    // 窗口向后平移12小时，只有后12小时缺失
+    QVector<BucketAggregate> buckets;
+    const QVector<QueryResultCache::Segment> gaps = cache.lookup("sensor_001", hours(12, 24), buckets);
+    QCOMPARE(gaps.size(), 1);
+    QCOMPARE(gaps.first().firstBucket, 12);
+    QCOMPARE(gaps.first().bucketCount, 12);
+    QCOMPARE(buckets.at(0).count, qint64(1));
+    QCOMPARE(buckets.at(11).count, qint64(1));
+    QVERIFY(buckets.at(12).isEmpty());
+
+    // 范围包含已缓存段时，两侧各有一个空档
+    const QVector<QueryResultCache::Segment> aroundGaps = cache.lookup("sensor_001", hours(-6, 36), buckets);
+    QCOMPARE(aroundGaps.size(), 2);
+    QCOMPARE(aroundGaps.at(0).firstBucket, 0);
+    QCOMPARE(aroundGaps.at(0).bucketCount, 6);
+    QCOMPARE(aroundGaps.at(1).firstBucket, 30);
+    QCOMPARE(aroundGaps.at(1).bucketCount, 6);
+}
+
+void TestQueryResultCache::testRunsMerge()
+{
+    QueryResultCache cache;
+    cache.insert("sensor_001", hours(0, 10), 0, filledBuckets(10, 1.0));
+    cache.insert("sensor_001", hours(20, 10), 0, filledBuckets(10, 2.0));
+
+    QVector<BucketAggregate> buckets;
+    QCOMPARE(cache.lookup("sensor_001", hours(0, 30), buckets).size(), 1);
+
+    // 填补中间空档后三段合并为一段，新数据覆盖重叠部分
+    cache.insert("sensor_001", hours(5, 20), 0, filledBuckets(20, 3.0));
+    QVERIFY(cache.lookup("sensor_001", hours(0, 30), buckets).isEmpty());
+    QCOMPARE(buckets.at(4).sum, 1.0);
+    QCOMPARE(buckets.at(5).sum, 3.0);
+    QCOMPARE(buckets.at(24).sum, 3.0);
+    QCOMPARE(buckets.at(25).sum, 2.0);
+}
+
+void TestQueryResultCache::testInvalidateFrom()
+{
+    QueryResultCache cache;
+    cache.insert("sensor_001", hours(0, 24), 0, filledBuckets(24, 1.0));
+    cache.insert("sensor_002", hours(0, 24), 0, filledBuckets(24, 1.0));
+
+    // 第10小时中间写入新样本，该小时及之后失效
+    cache.invalidateFrom("sensor_001", BaseTime + 10 * MsPerHour + 1000);
+
+    QVector<BucketAggregate> buckets;
+    const QVector<QueryResultCache::Segment> gaps = cache.lookup("sensor_001", hours(0, 24), buckets);
+    QCOMPARE(gaps.size(), 1);
+    QCOMPARE(gaps.first().firstBucket, 10);
+    QCOMPARE(gaps.first().bucketCount, 14);
+
+    // 其他设备不受影响
+    QVERIFY(cache.lookup("sensor_002", hours(0, 24), buckets).isEmpty());
+
+    // 失效点早于全部缓存时条目被移除
+    cache.invalidateFrom("sensor_002", BaseTime - MsPerHour);
+    QCOMPARE(cache.entryCount(), 1);
+}
+
+void TestQueryResultCache::testInsertAfterInvalidate()
+{
+    QueryResultCache cache;
+    QVector<BucketAggregate> buckets;
+    quint64 generation = 0;
+    QCOMPARE(cache.lookup("sensor_001", hours(0, 24), buckets, &generation).size(), 1);
+
+    // 读取空档期间写入了新样本：按查找时的代数写回被丢弃
+    cache.invalidateFrom("sensor_001", BaseTime + 10 * MsPerHour);
+    QVERIFY(!cache.insertIfCurrent("sensor_001", hours(0, 24), 0, filledBuckets(24, 1.0), generation));
+    QCOMPARE(cache.entryCount(), 0);
+
+    // 重新查找后可以写回，其他设备的失效不影响本设备
+    QCOMPARE(cache.lookup("sensor_001", hours(0, 24), buckets, &generation).size(), 1);
+    cache.invalidateFrom("sensor_002", BaseTime);
+    QVERIFY(cache.insertIfCurrent("sensor_001", hours(0, 24), 0, filledBuckets(24, 1.0), generation));
+    QVERIFY(cache.lookup("sensor_001", hours(0, 24), buckets).isEmpty());
+}
+
+void TestQueryResultCache::testMemoryLimit()
+{
+    QueryResultCache cache(64 * 1024);
+    for (int i = 0; i < 50; ++i) {
+        cache.insert(QString("sensor_%1").arg(i), hours(0, 24 * 7), 0, filledBuckets(24 * 7, 1.0));
+    }
+
+    QVERIFY(cache.usedBytes() <= cache.maxBytes());
+    QVERIFY(cache.entryCount() < 50);
+
+    // 最近写入的条目被保留
+    QVector<BucketAggregate> buckets;
+    QVERIFY(cache.lookup("sensor_49", hours(0, 24 * 7), buckets).isEmpty());
+}
+
+void TestQueryResultCache::testStoreReusesCachedBuckets()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TimeSeriesStore store(dir.path());
+    QueryResultCache cache;
+    store.setResultCache(&cache);
+
+    // 3天的整点数据
+    for (int hour = 0; hour < 72; ++hour) {
+        QVERIFY(store.append("sensor_001", BaseTime + hour * MsPerHour, hour));
+    }
+
+    qint64 scanned = 0;
+    const QVector<BucketAggregate> first = store.queryDevice("sensor_001", hours(0, 48), &scanned);
+    QCOMPARE(scanned, qint64(48));
+
+    // 平移后只扫描新增的24小时，结果与无缓存时一致
+    const QVector<BucketAggregate> shifted = store.queryDevice("sensor_001", hours(24, 48), &scanned);
+    QCOMPARE(scanned, qint64(24));
+
+    const QVector<BucketAggregate> uncached = store.aggregateDevice("sensor_001", hours(24, 48), 0, 48);
+    QCOMPARE(shifted.size(), uncached.size());
+    for (int i = 0; i < shifted.size(); ++i) {
+        QCOMPARE(shifted.at(i).count, uncached.at(i).count);
+        QCOMPARE(shifted.at(i).sum, uncached.at(i).sum);
+    }
+    QCOMPARE(first.at(24).sum, shifted.at(0).sum);
+}
+
+void TestQueryResultCache::testStoreInvalidatesOnAppend()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TimeSeriesStore store(dir.path());
+    QueryResultCache cache;
+    store.setResultCache(&cache);
+
+    QVERIFY(store.append("sensor_001", BaseTime, 1.0));
+    QCOMPARE(store.queryDevice("sensor_001", hours(0, 2)).at(0).count, qint64(1));
+
+    // 写入已缓存桶内的新样本后，查询结果必须包含它
+    QVERIFY(store.append("sensor_001", BaseTime + 1000, 2.0));
+    const QVector<BucketAggregate> buckets = store.queryDevice("sensor_001", hours(0, 2));
+    QCOMPARE(buckets.at(0).count, qint64(2));
+    QCOMPARE(buckets.at(0).sum, 3.0);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestQueryResultCache test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_queryresultcache_unit.moc"
@@ -0,0 +1,199 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDebug>
+#include "QueryScheduler.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+
+/**
+ * @brief QueryScheduler单元测试类
+ *
+ * 测试连续提交的查询被合并、过时的执行中查询被取消以及统计计数
+ */
+class TestQueryScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 取消令牌测试
+    void testExecutorHonoursCancelledToken();
+
+    // 调度测试
+    void testCoalescesBurst();
+    void testCancelsSupersededQuery();
+    void testIdenticalQueryNotRerun();
+    void testCancelDropsPending();
+    void testPartialResultsForwarded();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    TimeSeriesQuery queryForHours(int hours) const;
+
+    QTemporaryDir m_dataDir;
+    QScopedPointer<TimeSeriesStore> m_store;
+    QScopedPointer<QueryExecutor> m_executor;
+};
+
+void TestQueryScheduler::initTestCase()
+{
+    qDebug() << "Starting QueryScheduler unit tests...";
+
+    QVERIFY(m_dataDir.isValid());
+    m_store.reset(new TimeSeriesStore(m_dataDir.path()));
+    m_executor.reset(new QueryExecutor(m_store.data(), 2));
+
+    for (int device = 0; device < 8; ++device) {
+        QVERIFY(TestSeries::appendMinutes(*m_store, QString("sensor_%1").arg(device), 2 * 24 * 60));
+    }
+}
+
+void TestQueryScheduler::cleanupTestCase()
+{
+    qDebug() << "QueryScheduler unit tests completed.";
+}
+
+TimeSeriesQuery TestQueryScheduler::queryForHours(int hours) const
+{
+    QStringList deviceIds;
+    for (int device = 0; device < 8; ++device) {
+        deviceIds << QString("sensor_%1").arg(device);
+    }
+    return TimeSeriesQuery(deviceIds, BaseTime, BaseTime + hours * 60 * MsPerMinute, TimeWidget::Hour1);
+}
+
+void TestQueryScheduler::testExecutorHonoursCancelledToken()
+{
+    QueryCancelToken token;
+    const QueryCancelToken copy = token;
+    copy.cancel();
+    QVERIFY(token.isCancelled());
+
+    const TimeSeriesQueryResult result = m_executor->execute(queryForHours(24), token);
+    QVERIFY(result.cancelled);
+    QCOMPARE(result.samplesScanned, qint64(0));
+}
+
+void TestQueryScheduler::testCoalescesBurst()
+{
+    QueryScheduler scheduler(m_executor.data());
+    scheduler.setSettleInterval(30);
+    QSignalSpy startedSpy(&scheduler, &QueryScheduler::queryStarted);
+    QSignalSpy resultSpy(&scheduler, &QueryScheduler::resultReady);
+
+    // 模拟拖动时间编辑框：同一次事件处理中连续提交10次
+    for (int hours = 1; hours <= 10; ++hours) {
+        scheduler.submit(queryForHours(hours));
+    }
+
+    QVERIFY(resultSpy.wait(5000));
+    QCOMPARE(startedSpy.count(), 1);
+    QCOMPARE(startedSpy.first().first().value<TimeSeriesQuery>(), queryForHours(10));
+
+    const TimeSeriesQueryResult result = resultSpy.first().first().value<TimeSeriesQueryResult>();
+    QCOMPARE(result.bucketer.bucketCount(), 10);
+    QCOMPARE(scheduler.submittedCount(), quint64(10));
+    QCOMPARE(scheduler.droppedCount(), quint64(9));
+    QCOMPARE(scheduler.executedCount(), quint64(1));
+    QVERIFY(!scheduler.isBusy());
+}
+
+void TestQueryScheduler::testCancelsSupersededQuery()
+{
+    QueryScheduler scheduler(m_executor.data());
+    scheduler.setSettleInterval(0);
+    QSignalSpy startedSpy(&scheduler, &QueryScheduler::queryStarted);
+    QSignalSpy resultSpy(&scheduler, &QueryScheduler::resultReady);
+
+    scheduler.submit(queryForHours(48));
+    QVERIFY(startedSpy.wait(5000));
+
+    // 第一个查询已开始执行，新的查询使其过时
+    scheduler.submit(queryForHours(12));
+    QCOMPARE(scheduler.cancelledCount(), quint64(1));
+
+    QVERIFY(resultSpy.wait(5000));
+    QTest::qWait(50);
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(resultSpy.first().first().value<TimeSeriesQueryResult>().bucketer.bucketCount(), 12);
+    QCOMPARE(scheduler.executedCount(), quint64(1));
+}
+
+void TestQueryScheduler::testIdenticalQueryNotRerun()
+{
+    QueryScheduler scheduler(m_executor.data());
+    scheduler.setSettleInterval(0);
+    QSignalSpy startedSpy(&scheduler, &QueryScheduler::queryStarted);
+    QSignalSpy resultSpy(&scheduler, &QueryScheduler::resultReady);
+
+    scheduler.submit(queryForHours(24));
+    QVERIFY(startedSpy.wait(5000));
+    scheduler.submit(queryForHours(24));
+
+    QVERIFY(resultSpy.wait(5000));
+    QTest::qWait(50);
+    QCOMPARE(startedSpy.count(), 1);
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(scheduler.cancelledCount(), quint64(0));
+    QCOMPARE(scheduler.droppedCount(), quint64(1));
+}
+
+void TestQueryScheduler::testCancelDropsPending()
+{
+    QueryScheduler scheduler(m_executor.data());
+    scheduler.setSettleInterval(20);
+    QSignalSpy resultSpy(&scheduler, &QueryScheduler::resultReady);
+
+    scheduler.submit(queryForHours(24));
+    scheduler.cancel();
+
+    QTest::qWait(100);
+    QCOMPARE(resultSpy.count(), 0);
+    QCOMPARE(scheduler.droppedCount(), quint64(1));
+    QVERIFY(!scheduler.isBusy());
+}
+
+void TestQueryScheduler::testPartialResultsForwarded()
+{
+    QueryScheduler scheduler(m_executor.data());
+    scheduler.setSettleInterval(0);
+    m_executor->setStreamInterval(0);
+
+    // 记录信号到达顺序：部分结果必须先于完整结果
+    QStringList order;
+    int streamedDevices = 0;
+    connect(&scheduler, &QueryScheduler::partialResultReady, this,
+            [&order, &streamedDevices](const PartialQueryResult &partial) {
+                order << "partial";
+                streamedDevices += partial.series.size();
+            });
+    connect(&scheduler, &QueryScheduler::resultReady, this,
+            [&order](const TimeSeriesQueryResult &) { order << "result"; });
+    QSignalSpy resultSpy(&scheduler, &QueryScheduler::resultReady);
+
+    scheduler.submit(queryForHours(24));
+    QVERIFY(resultSpy.wait(5000));
+    m_executor->setStreamInterval(16);
+
+    QVERIFY(order.size() > 1);
+    QCOMPARE(order.first(), QString("partial"));
+    QCOMPARE(order.last(), QString("result"));
+    QCOMPARE(order.count("result"), 1);
+    QCOMPARE(streamedDevices, 8);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestQueryScheduler test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_queryscheduler_unit.moc"
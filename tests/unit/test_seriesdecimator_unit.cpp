@@ -0,0 +1,172 @@
+#include <QApplication>
+#include <QTest>
+#include <QDebug>
+#include <QtMath>
+#include "SeriesDecimator.h"
+
+/**
+ * @brief SeriesDecimator单元测试类
+ *
+ * 测试LTTB与每像素最小/最大值降采样的输出点数上限、首尾点与极值保留
+ */
+class TestSeriesDecimator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // LTTB测试
+    void testLttbThreshold();
+    void testLttbPassThrough();
+    void testLttbKeepsSpike();
+
+    // 序列降采样测试
+    void testMinMaxBoundedByColumns();
+    void testMinMaxWideBuckets();
+    void testRangeClipping();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 MsPerDay = 24 * 60 * MsPerMinute;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    QVector<BucketAggregate> makeBuckets(const TimeBucketer &bucketer) const;
+};
+
+void TestSeriesDecimator::initTestCase()
+{
+    qDebug() << "Starting SeriesDecimator unit tests...";
+}
+
+void TestSeriesDecimator::cleanupTestCase()
+{
+    qDebug() << "SeriesDecimator unit tests completed.";
+}
+
+QVector<BucketAggregate> TestSeriesDecimator::makeBuckets(const TimeBucketer &bucketer) const
+{
+    // 每个桶两个样本：正弦值及其加一
+    QVector<BucketAggregate> buckets(bucketer.bucketCount());
+    for (int i = 0; i < buckets.size(); ++i) {
+        const double value = qSin(i * 0.01);
+        buckets[i].add(value);
+        buckets[i].add(value + 1.0);
+    }
+    return buckets;
+}
+
+void TestSeriesDecimator::testLttbThreshold()
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.append(QPointF(i, qSin(i * 0.05)));
+    }
+
+    const QVector<QPointF> result = SeriesDecimator::largestTriangleThreeBuckets(points.constData(), points.size(), 100);
+    QCOMPARE(result.size(), 100);
+    QCOMPARE(result.first(), points.first());
+    QCOMPARE(result.last(), points.last());
+    for (int i = 1; i < result.size(); ++i) {
+        QVERIFY(result.at(i).x() > result.at(i - 1).x());
+    }
+}
+
+void TestSeriesDecimator::testLttbPassThrough()
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < 10; ++i) {
+        points.append(QPointF(i, i * i));
+    }
+
+    QCOMPARE(SeriesDecimator::largestTriangleThreeBuckets(points.constData(), points.size(), 10), points);
+    QCOMPARE(SeriesDecimator::largestTriangleThreeBuckets(points.constData(), points.size(), 2), points);
+    QVERIFY(SeriesDecimator::largestTriangleThreeBuckets(points.constData(), 0, 5).isEmpty());
+}
+
+void TestSeriesDecimator::testLttbKeepsSpike()
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < 10000; ++i) {
+        points.append(QPointF(i, i == 4321 ? 100.0 : 0.0));
+    }
+
+    const QVector<QPointF> result = SeriesDecimator::largestTriangleThreeBuckets(points.constData(), points.size(), 50);
+    QVERIFY(result.contains(QPointF(4321, 100.0)));
+}
+
+void TestSeriesDecimator::testMinMaxBoundedByColumns()
+{
+    // 一年的15分钟桶降到800列
+    const TimeBucketer bucketer(BaseTime, BaseTime + 365 * MsPerDay, TimeWidget::Minutes15);
+    const QVector<BucketAggregate> buckets = makeBuckets(bucketer);
+    const int columns = 800;
+
+    const QVector<QPointF> points = SeriesDecimator::decimate(SeriesDecimator::MinMaxPerPixel, bucketer, buckets,
+                                                              bucketer.startMs(), bucketer.endMs(), columns);
+    QVERIFY(!points.isEmpty());
+    QVERIFY(points.size() <= 4 * columns);
+
+    // 每列的包络保留了全局极值
+    BucketAggregate total;
+    for (const BucketAggregate &bucket : buckets) {
+        total.merge(bucket);
+    }
+    double minValue = points.first().y();
+    double maxValue = points.first().y();
+    for (int i = 1; i < points.size(); ++i) {
+        QVERIFY(points.at(i).x() >= points.at(i - 1).x());
+        minValue = qMin(minValue, points.at(i).y());
+        maxValue = qMax(maxValue, points.at(i).y());
+    }
+    QCOMPARE(minValue, total.min);
+    QCOMPARE(maxValue, total.max);
+
+    // LTTB不超过列数
+    QVERIFY(SeriesDecimator::decimate(SeriesDecimator::Lttb, bucketer, buckets,
+                                      bucketer.startMs(), bucketer.endMs(), columns).size() <= columns);
+}
+
+void TestSeriesDecimator::testMinMaxWideBuckets()
+{
+    // 桶比像素宽时每个桶一个平均值点
+    const TimeBucketer bucketer(BaseTime, BaseTime + MsPerDay, TimeWidget::Hour1);
+    const QVector<BucketAggregate> buckets = makeBuckets(bucketer);
+
+    const QVector<QPointF> points = SeriesDecimator::decimate(SeriesDecimator::MinMaxPerPixel, bucketer, buckets,
+                                                              bucketer.startMs(), bucketer.endMs(), 800);
+    QCOMPARE(points.size(), bucketer.bucketCount());
+    QCOMPARE(points.at(3).x(), (bucketer.bucketStart(3) + bucketer.bucketEnd(3)) / 2.0);
+    QCOMPARE(points.at(3).y(), buckets.at(3).average());
+}
+
+void TestSeriesDecimator::testRangeClipping()
+{
+    const TimeBucketer bucketer(BaseTime, BaseTime + MsPerDay, TimeWidget::Hour1);
+    QVector<BucketAggregate> buckets = makeBuckets(bucketer);
+    buckets[5] = BucketAggregate();
+
+    // 只输出与范围相交的非空桶
+    const QVector<QPointF> points = SeriesDecimator::decimate(SeriesDecimator::MinMaxPerPixel, bucketer, buckets,
+                                                              bucketer.bucketStart(4), bucketer.bucketStart(8), 100);
+    QCOMPARE(points.size(), 3);
+    QVERIFY(points.first().x() > bucketer.bucketStart(4));
+    QVERIFY(points.last().x() < bucketer.bucketStart(8));
+
+    // 范围外或无效参数返回空
+    QVERIFY(SeriesDecimator::decimate(SeriesDecimator::Lttb, bucketer, buckets,
+                                      bucketer.endMs(), bucketer.endMs() + MsPerDay, 100).isEmpty());
+    QVERIFY(SeriesDecimator::decimate(SeriesDecimator::MinMaxPerPixel, bucketer, buckets,
+                                      bucketer.startMs(), bucketer.endMs(), 0).isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestSeriesDecimator test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_seriesdecimator_unit.moc"
@@ -0,0 +1,241 @@
+#include <QApplication>
+#include <QTest>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTreeView>
+#include <QPainter>
+#include <QtNumeric>
+#include <QDebug>
+#include "SparklineBuffer.h"
+#include "SparklineDelegate.h"
+
+/**
+ * @brief SparklineBuffer与SparklineDelegate单元测试类
+ *
+ * 测试环形缓冲区的覆盖与尾部替换、修订号，以及绘制代理只在修订号
+ * 变化时重新绘制位图
+ */
+class TestSparklineBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 环形缓冲区测试
+    void testAppendWrapsAround();
+    void testReplaceLast();
+    void testAssignKeepsNewest();
+    void testRevisionAndSignal();
+
+    // 绘制代理测试
+    void testDelegateCachesPixmap();
+    void testDelegateRedrawsOnNewSamples();
+
+private:
+    /**
+     * @brief 把一个单元格绘制到位图上
+     */
+    void paintCell(SparklineDelegate &delegate, const QModelIndex &index, bool selected = false) const;
+};
+
+void TestSparklineBuffer::initTestCase()
+{
+    qDebug() << "Starting SparklineBuffer unit tests...";
+}
+
+void TestSparklineBuffer::cleanupTestCase()
+{
+    qDebug() << "SparklineBuffer unit tests completed.";
+}
+
+void TestSparklineBuffer::paintCell(SparklineDelegate &delegate, const QModelIndex &index, bool selected) const
+{
+    QPixmap target(100, 24);
+    QPainter painter(&target);
+    QStyleOptionViewItem option;
+    option.rect = QRect(0, 0, 80, 20);
+    option.state = QStyle::State_Enabled;
+    if (selected) {
+        option.state |= QStyle::State_Selected;
+    }
+    delegate.paint(&painter, option, index);
+}
+
+void TestSparklineBuffer::testAppendWrapsAround()
+{
+    SparklineBuffer buffer(4);
+    QCOMPARE(buffer.capacity(), 4);
+    QVERIFY(buffer.values("sensor_001").isEmpty());
+
+    for (int i = 1; i <= 6; ++i) {
+        buffer.append("sensor_001", i);
+    }
+    QCOMPARE(buffer.values("sensor_001"), QVector<double>({3, 4, 5, 6}));
+    QCOMPARE(buffer.deviceCount(), 1);
+
+    // 一次追加超过容量时只保留最后的值
+    const double values[] = {10, 11, 12, 13, 14, 15};
+    buffer.appendValues("sensor_002", values, 6);
+    QCOMPARE(buffer.values("sensor_002"), QVector<double>({12, 13, 14, 15}));
+}
+
+void TestSparklineBuffer::testReplaceLast()
+{
+    SparklineBuffer buffer(4);
+    const double initial[] = {1, 2, 3, 4};
+    buffer.appendValues("sensor_001", initial, 4);
+
+    // 替换仍在累积的最后一个桶并追加一个新桶
+    const double tail[] = {40, 5};
+    buffer.appendValues("sensor_001", tail, 2, 1);
+    QCOMPARE(buffer.values("sensor_001"), QVector<double>({2, 3, 40, 5}));
+
+    // 空桶以NaN保存
+    const double gap[] = {qQNaN()};
+    buffer.appendValues("sensor_001", gap, 1);
+    const QVector<double> values = buffer.values("sensor_001");
+    QCOMPARE(values.size(), 4);
+    QVERIFY(qIsNaN(values.last()));
+}
+
+void TestSparklineBuffer::testAssignKeepsNewest()
+{
+    SparklineBuffer buffer(3);
+    buffer.append("sensor_001", 99);
+    buffer.assign("sensor_001", QVector<double>({1, 2, 3, 4, 5}));
+    QCOMPARE(buffer.values("sensor_001"), QVector<double>({3, 4, 5}));
+
+    buffer.assign("sensor_001", QVector<double>());
+    QVERIFY(buffer.contains("sensor_001"));
+    QVERIFY(buffer.values("sensor_001").isEmpty());
+}
+
+void TestSparklineBuffer::testRevisionAndSignal()
+{
+    SparklineBuffer buffer(4);
+    QSignalSpy spy(&buffer, &SparklineBuffer::samplesAppended);
+    QCOMPARE(buffer.revision("sensor_001"), quint64(0));
+
+    buffer.append("sensor_001", 1.0);
+    const quint64 first = buffer.revision("sensor_001");
+    QVERIFY(first > 0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toStringList(), QStringList("sensor_001"));
+
+    // 批量写入由调用方统一通知
+    const double values[] = {2.0, 3.0};
+    buffer.appendValues("sensor_001", values, 2);
+    buffer.appendValues("sensor_002", values, 2);
+    QVERIFY(buffer.revision("sensor_001") > first);
+    QCOMPARE(spy.count(), 1);
+    buffer.notifyAppended(QStringList() << "sensor_001" << "sensor_002");
+    QCOMPARE(spy.count(), 2);
+
+    // 其他设备的写入不改变修订号
+    const quint64 second = buffer.revision("sensor_001");
+    buffer.append("sensor_002", 4.0);
+    QCOMPARE(buffer.revision("sensor_001"), second);
+
+    buffer.clear();
+    QCOMPARE(buffer.deviceCount(), 0);
+    QCOMPARE(buffer.revision("sensor_001"), quint64(0));
+}
+
+void TestSparklineBuffer::testDelegateCachesPixmap()
+{
+    SparklineBuffer buffer(16);
+    QStandardItemModel model;
+    for (int i = 0; i < 3; ++i) {
+        const QString deviceId = QString("sensor_%1").arg(i);
+        QStandardItem *item = new QStandardItem();
+        item->setData(deviceId, Qt::UserRole);
+        model.appendRow(item);
+        buffer.assign(deviceId, QVector<double>({1.0 * i, 2.0, 3.0, 2.0}));
+    }
+
+    SparklineDelegate delegate(&buffer);
+    QCOMPARE(delegate.sizeHint(QStyleOptionViewItem(), model.index(0, 0)).width(), 80);
+
+    // 重复绘制（滚动）只复制缓存的位图
+    for (int pass = 0; pass < 5; ++pass) {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            paintCell(delegate, model.index(row, 0));
+        }
+    }
+    QCOMPARE(delegate.renderCount(), 3);
+    QCOMPARE(delegate.cachedCount(), 3);
+
+    // 选中状态改变颜色，需要重新绘制
+    paintCell(delegate, model.index(0, 0), true);
+    QCOMPARE(delegate.renderCount(), 4);
+
+    // 没有数值的设备不绘制
+    QStandardItem *empty = new QStandardItem();
+    empty->setData("sensor_none", Qt::UserRole);
+    model.appendRow(empty);
+    paintCell(delegate, model.index(3, 0));
+    QCOMPARE(delegate.renderCount(), 4);
+
+    // 缓存容量有限时淘汰旧位图
+    delegate.setCacheCapacity(1);
+    QVERIFY(delegate.cachedCount() <= 1);
+    delegate.invalidate();
+    QCOMPARE(delegate.cachedCount(), 0);
+}
+
+void TestSparklineBuffer::testDelegateRedrawsOnNewSamples()
+{
+    SparklineBuffer buffer(16);
+    QStandardItemModel model;
+    for (int i = 0; i < 2; ++i) {
+        QStandardItem *item = new QStandardItem();
+        item->setData(QString("sensor_%1").arg(i), Qt::UserRole);
+        model.appendRow(item);
+        buffer.append(QString("sensor_%1").arg(i), i);
+    }
+
+    SparklineDelegate delegate(&buffer);
+    paintCell(delegate, model.index(0, 0));
+    paintCell(delegate, model.index(1, 0));
+    QCOMPARE(delegate.renderCount(), 2);
+
+    // 只有收到新数值的设备重新绘制
+    buffer.append("sensor_1", 5.0);
+    paintCell(delegate, model.index(0, 0));
+    paintCell(delegate, model.index(1, 0));
+    QCOMPARE(delegate.renderCount(), 3);
+
+    // 视图只为可见行调用代理：一万行中只绘制一屏
+    SparklineBuffer manyBuffer(16);
+    QStandardItemModel manyModel;
+    for (int i = 0; i < 10000; ++i) {
+        const QString deviceId = QString("device_%1").arg(i);
+        QStandardItem *item = new QStandardItem(deviceId);
+        item->setData(deviceId, Qt::UserRole);
+        manyModel.appendRow(item);
+        manyBuffer.append(deviceId, i % 7);
+    }
+    SparklineDelegate viewDelegate(&manyBuffer);
+    QTreeView view;
+    view.setUniformRowHeights(true);
+    view.setModel(&manyModel);
+    view.setItemDelegateForColumn(0, &viewDelegate);
+    view.resize(200, 200);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    QCoreApplication::processEvents();
+    QVERIFY(viewDelegate.renderCount() > 0);
+    QVERIFY(viewDelegate.renderCount() < 100);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestSparklineBuffer test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_sparklinebuffer_unit.moc"
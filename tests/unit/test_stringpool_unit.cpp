@@ -0,0 +1,163 @@
+#include <QApplication>
+#include <QTest>
+#include <QThread>
+#include <QDebug>
+#include "StringPool.h"
+#include "DeviceManager.h"
+
+/**
+ * @brief StringPool单元测试类
+ *
+ * 测试字符串驻留、多线程并发驻留，以及多个目录共用字符串池时的
+ * 数据共享和按目录统计的内存占用
+ */
+class TestStringPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 驻留测试
+    void testIntern();
+    void testConcurrentIntern();
+
+    // 多目录测试
+    void testCatalogsShareStrings();
+    void testParentIdsNotPooled();
+    void testMemoryUsage();
+};
+
+void TestStringPool::initTestCase()
+{
+    qDebug() << "Starting StringPool unit tests...";
+}
+
+void TestStringPool::cleanupTestCase()
+{
+    qDebug() << "StringPool unit tests completed.";
+}
+
+void TestStringPool::testIntern()
+{
+    StringPool pool;
+    const QString first = pool.intern(QString("传感器"));
+    const QString second = pool.intern(QString("传感") + QString("器"));
+
+    // 内容相同的字符串共享池中的一份数据
+    QCOMPARE(first, second);
+    QCOMPARE(first.constData(), second.constData());
+    QCOMPARE(pool.size(), 1);
+    QVERIFY(pool.owns(second));
+    QVERIFY(!pool.owns(QString("传感") + QString("器")));
+    QVERIFY(pool.memoryUsage() >= StringPool::stringBytes(first));
+
+    // 空字符串不进入池
+    QVERIFY(pool.intern(QString()).isEmpty());
+    QCOMPARE(pool.size(), 1);
+}
+
+void TestStringPool::testConcurrentIntern()
+{
+    StringPool pool;
+    const int threadCount = 4;
+    const int distinct = 100;
+
+    QList<QThread *> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.append(QThread::create([&pool]() {
+            for (int round = 0; round < 10; ++round) {
+                for (int i = 0; i < distinct; ++i) {
+                    pool.intern(QString("type_%1").arg(i));
+                }
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        QVERIFY(thread->wait(10000));
+        delete thread;
+    }
+
+    QCOMPARE(pool.size(), distinct);
+    QCOMPARE(pool.intern(QString("type_7")).constData(), pool.intern(QString("type_%1").arg(7)).constData());
+}
+
+void TestStringPool::testCatalogsShareStrings()
+{
+    StringPool pool;
+    DeviceManager plantA(&pool);
+    DeviceManager plantB(&pool);
+    plantA.loadDeviceData();
+    plantB.loadDeviceData();
+    QVERIFY(plantA.isDataLoaded());
+    QVERIFY(plantB.isDataLoaded());
+
+    // 两个目录相互独立，但类型共用同一份数据
+    QVERIFY(plantA.addDevice(DeviceInfo("plant_a_only", "A厂设备", "传感器", "sensor_group")));
+    QVERIFY(!plantB.getDevice("plant_a_only").isValid());
+    QVERIFY(!DeviceManager::instance().getDevice("plant_a_only").isValid());
+
+    const DeviceInfo a = plantA.getDevice("sensor_001");
+    const DeviceInfo b = plantB.getDevice("sensor_001");
+    QCOMPARE(a.type.constData(), b.type.constData());
+    QVERIFY(pool.owns(a.type));
+    QCOMPARE(plantA.getDevice("plant_a_only").type.constData(), a.type.constData());
+
+    // 父设备ID只在各自目录的原子表中共享
+    const DeviceInfo sibling = plantA.getDevice("plant_a_only");
+    QCOMPARE(sibling.parentId.constData(), a.parentId.constData());
+    QVERIFY(!pool.owns(a.parentId));
+    QCOMPARE(plantA.stringPool(), &pool);
+}
+
+void TestStringPool::testParentIdsNotPooled()
+{
+    StringPool pool;
+    DeviceManager plant(&pool);
+    plant.loadDeviceData();
+    const int poolSize = pool.size();
+
+    // 反复增删设备组时池的大小不变，只有新类型才进入池
+    for (int i = 0; i < 50; ++i) {
+        const QString groupId = QString("temp_group_%1").arg(i);
+        QVERIFY(plant.addDevice(DeviceInfo(groupId, "临时分组", "传感器", "", true)));
+        QVERIFY(plant.addDevice(DeviceInfo(groupId + "_child", "临时设备", "传感器", groupId)));
+        QVERIFY(plant.removeDevice(groupId));
+    }
+    QCOMPARE(pool.size(), poolSize);
+
+    QVERIFY(plant.addDevice(DeviceInfo("new_type_device", "新类型设备", "流量计", "")));
+    QCOMPARE(pool.size(), poolSize + 1);
+}
+
+void TestStringPool::testMemoryUsage()
+{
+    StringPool pool;
+    DeviceManager interned(&pool);
+    DeviceManager plain(static_cast<StringPool *>(nullptr));
+    interned.loadDeviceData();
+    plain.loadDeviceData();
+
+    const CatalogMemoryUsage withPool = interned.memoryUsage();
+    const CatalogMemoryUsage withoutPool = plain.memoryUsage();
+    qDebug() << "Catalog memory without pool:" << withoutPool.total() << "bytes, with pool:"
+             << withPool.total() << "bytes +" << withPool.sharedStringBytes << "shared";
+
+    // 驻留后类型计入共享部分，目录独占的字符串减少
+    QVERIFY(withPool.sharedStringBytes > 0);
+    QCOMPARE(withoutPool.sharedStringBytes, qint64(0));
+    QVERIFY(withPool.stringBytes < withoutPool.stringBytes);
+    QVERIFY(withPool.total() < withoutPool.total());
+    QVERIFY(withPool.structureBytes > 0);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    TestStringPool test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_stringpool_unit.moc"
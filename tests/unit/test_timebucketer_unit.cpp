@@ -0,0 +1,169 @@
+#include <QApplication>
+#include <QTest>
+#include <QDebug>
+#include <QDateTime>
+#include <QTimeZone>
+#include "TimeBucketer.h"
+
+/**
+ * @brief TimeBucketer单元测试类
+ *
+ * 测试时间桶对齐、桶序号与时间戳的转换以及夏令时日期的处理
+ */
+class TestTimeBucketer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 对齐与转换测试
+    void testFixedWidthAlignment();
+    void testIndexRoundTrip();
+    void testOutOfRange();
+    void testInvalidRange();
+
+    // 夏令时测试
+    void testDstDayBuckets();
+    void testOrdinalAcrossDst();
+
+    // 性能测试
+    void benchmarkYearOf15MinuteBuckets();
+
+private:
+    static qint64 utcMs(int year, int month, int day, int hour, int minute);
+};
+
+void TestTimeBucketer::initTestCase()
+{
+    qDebug() << "Starting TimeBucketer unit tests...";
+}
+
+void TestTimeBucketer::cleanupTestCase()
+{
+    qDebug() << "TimeBucketer unit tests completed.";
+}
+
+qint64 TestTimeBucketer::utcMs(int year, int month, int day, int hour, int minute)
+{
+    return QDateTime(QDate(year, month, day), QTime(hour, minute), Qt::UTC).toMSecsSinceEpoch();
+}
+
+void TestTimeBucketer::testFixedWidthAlignment()
+{
+    // 10:07 - 11:01 按15分钟划分，应对齐为 10:00 - 11:15 共5个桶
+    TimeBucketer bucketer(utcMs(2024, 5, 1, 10, 7), utcMs(2024, 5, 1, 11, 1),
+                          TimeWidget::Minutes15, QTimeZone::utc());
+
+    QVERIFY(bucketer.isValid());
+    QCOMPARE(bucketer.bucketCount(), 5);
+    QCOMPARE(bucketer.startMs(), utcMs(2024, 5, 1, 10, 0));
+    QCOMPARE(bucketer.endMs(), utcMs(2024, 5, 1, 11, 15));
+    QCOMPARE(bucketer.boundaries().size(), 6);
+}
+
+void TestTimeBucketer::testIndexRoundTrip()
+{
+    TimeBucketer bucketer(utcMs(2024, 1, 1, 0, 0), utcMs(2024, 1, 8, 0, 0),
+                          TimeWidget::Hour1, QTimeZone::utc());
+    QCOMPARE(bucketer.bucketCount(), 7 * 24);
+
+    for (int i = 0; i < bucketer.bucketCount(); ++i) {
+        QCOMPARE(bucketer.bucketIndex(bucketer.bucketStart(i)), i);
+        QCOMPARE(bucketer.bucketIndex(bucketer.bucketEnd(i) - 1), i);
+    }
+}
+
+void TestTimeBucketer::testOutOfRange()
+{
+    TimeBucketer bucketer(utcMs(2024, 1, 1, 0, 0), utcMs(2024, 1, 2, 0, 0),
+                          TimeWidget::Hour1, QTimeZone::utc());
+
+    QCOMPARE(bucketer.bucketIndex(bucketer.startMs() - 1), -1);
+    QCOMPARE(bucketer.bucketIndex(bucketer.endMs()), -1);
+}
+
+void TestTimeBucketer::testInvalidRange()
+{
+    TimeBucketer bucketer(utcMs(2024, 1, 2, 0, 0), utcMs(2024, 1, 1, 0, 0),
+                          TimeWidget::Day1, QTimeZone::utc());
+
+    QVERIFY(!bucketer.isValid());
+    QCOMPARE(bucketer.bucketCount(), 0);
+    QVERIFY(bucketer.boundaries().isEmpty());
+}
+
+void TestTimeBucketer::testDstDayBuckets()
+{
+    QTimeZone berlin("Europe/Berlin");
+    if (!berlin.isValid()) {
+        QSKIP("Time zone database not available");
+    }
+
+    const qint64 start = QDateTime(QDate(2024, 3, 30), QTime(12, 0), berlin).toMSecsSinceEpoch();
+    const qint64 end = QDateTime(QDate(2024, 4, 1), QTime(12, 0), berlin).toMSecsSinceEpoch();
+    TimeBucketer bucketer(start, end, TimeWidget::Day1, berlin);
+
+    QCOMPARE(bucketer.bucketCount(), 3);
+    QCOMPARE(bucketer.bucketStart(1),
+             QDateTime(QDate(2024, 3, 31), QTime(0, 0), berlin).toMSecsSinceEpoch());
+
+    // 3月31日切换为夏令时，只有23小时
+    QCOMPARE(bucketer.bucketEnd(1) - bucketer.bucketStart(1), 23 * 3600 * 1000LL);
+    QCOMPARE(bucketer.bucketEnd(0) - bucketer.bucketStart(0), 24 * 3600 * 1000LL);
+
+    // 跳变后的时间仍然落在同一天
+    const qint64 afterShift = QDateTime(QDate(2024, 3, 31), QTime(23, 30), berlin).toMSecsSinceEpoch();
+    QCOMPARE(bucketer.bucketIndex(afterShift), 1);
+
+    // 10月27日结束夏令时，有25小时
+    const qint64 autumnStart = QDateTime(QDate(2024, 10, 27), QTime(0, 0), berlin).toMSecsSinceEpoch();
+    TimeBucketer autumn(autumnStart, autumnStart + 1, TimeWidget::Day1, berlin);
+    QCOMPARE(autumn.bucketCount(), 1);
+    QCOMPARE(autumn.bucketEnd(0) - autumn.bucketStart(0), 25 * 3600 * 1000LL);
+}
+
+void TestTimeBucketer::testOrdinalAcrossDst()
+{
+    QTimeZone berlin("Europe/Berlin");
+    if (!berlin.isValid()) {
+        QSKIP("Time zone database not available");
+    }
+
+    // 两个查询的起点分别在夏令时切换前后（本地偏移不同）
+    const qint64 winterStart = QDateTime(QDate(2024, 3, 30), QTime(12, 0), berlin).toMSecsSinceEpoch();
+    const qint64 summerStart = QDateTime(QDate(2024, 4, 1), QTime(0, 0), berlin).toMSecsSinceEpoch();
+    const qint64 end = QDateTime(QDate(2024, 4, 2), QTime(0, 0), berlin).toMSecsSinceEpoch();
+    TimeBucketer winter(winterStart, end, TimeWidget::Hour1, berlin);
+    TimeBucketer summer(summerStart, end, TimeWidget::Hour1, berlin);
+
+    // 同一个UTC桶在两个查询中的全局序号相同
+    const qint64 sample = QDateTime(QDate(2024, 4, 1), QTime(12, 30), berlin).toMSecsSinceEpoch();
+    QCOMPARE(winter.firstOrdinal() + winter.bucketIndex(sample),
+             summer.firstOrdinal() + summer.bucketIndex(sample));
+}
+
+void TestTimeBucketer::benchmarkYearOf15MinuteBuckets()
+{
+    const qint64 start = utcMs(2024, 1, 1, 0, 0);
+    const qint64 end = utcMs(2025, 1, 1, 0, 0);
+    int count = 0;
+
+    QBENCHMARK {
+        TimeBucketer bucketer(start, end, TimeWidget::Minutes15, QTimeZone::systemTimeZone());
+        count = bucketer.boundaries().size();
+    }
+
+    QVERIFY(count >= 366 * 96);
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestTimeBucketer test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_timebucketer_unit.moc"
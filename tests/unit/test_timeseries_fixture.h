@@ -0,0 +1,58 @@
+#ifndef TEST_TIMESERIES_FIXTURE_H
+#define TEST_TIMESERIES_FIXTURE_H
+
+#include <QString>
+#include <QVector>
+#include "TimeSeriesStore.h"
+
+/**
+ * @brief 单元测试共用的合成时间序列数据
+ *
+ * 写入函数返回是否成功而不在内部断言：QVERIFY只会从所在的函数返回，
+ * 调用方须用QVERIFY包住调用，写入失败时测试才会停止。
+ */
+namespace TestSeries {
+
+const qint64 MsPerMinute = 60 * 1000LL;
+const qint64 MsPerHour = 60 * MsPerMinute;
+const qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+/**
+ * @brief 写入等间隔的合成样本，第i个样本的时间为fromMs + i × intervalMs
+ * @param store 时间序列存储
+ * @param deviceId 设备ID
+ * @param fromMs 第一个样本的时间
+ * @param intervalMs 样本间隔
+ * @param count 样本数
+ * @param value 由样本序号计算样本值的函数
+ * @return 写入成功返回true
+ */
+template <typename ValueFunction>
+bool appendSamples(TimeSeriesStore &store, const QString &deviceId, qint64 fromMs, qint64 intervalMs, int count,
+                   ValueFunction value)
+{
+    QVector<qint64> timestamps(count);
+    QVector<double> values(count);
+    for (int i = 0; i < count; ++i) {
+        timestamps[i] = fromMs + i * intervalMs;
+        values[i] = value(i);
+    }
+    return store.append(deviceId, timestamps.constData(), values.constData(), count);
+}
+
+/**
+ * @brief 从BaseTime起写入每分钟一个样本，第i个样本的值为i × scale
+ * @param store 时间序列存储
+ * @param deviceId 设备ID
+ * @param minutes 样本数
+ * @param scale 样本值的比例
+ * @return 写入成功返回true
+ */
+inline bool appendMinutes(TimeSeriesStore &store, const QString &deviceId, int minutes, double scale = 1.0)
+{
+    return appendSamples(store, deviceId, BaseTime, MsPerMinute, minutes, [scale](int i) { return i * scale; });
+}
+
+} // namespace TestSeries
+
+#endif // TEST_TIMESERIES_FIXTURE_H
@@ -0,0 +1,389 @@
+#include <QApplication>
+#include <QDir>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDebug>
+#include "QueryResultCache.h"
+#include "TimeSeriesStore.h"
+#include "test_timeseries_fixture.h"
+
+/**
+ * @brief TimeSeriesStore单元测试类
+ *
+ * 测试本地时间序列存储的写入、分块、分桶聚合查询、预聚合层以及端到端查询延迟
+ */
+class TestTimeSeriesStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 写入测试
+    void testAppendAcrossChunks();
+    void testRejectOutOfOrder();
+
+    // 查询测试
+    void testBucketAggregation();
+    void testUnknownDevice();
+    void testPartialBucketRange();
+    void testScanSamples();
+
+    // 预聚合层测试
+    void testRollupMatchesRawSamples();
+    void testSelectCoarsestTier();
+    void testYearQueryWithoutRawSamples();
+    void testRollupBackfill();
+    void testPartialAppendFailure();
+
+    // 性能测试
+    void benchmarkSelectToData();
+
+private:
+    static constexpr qint64 MsPerMinute = 60 * 1000LL;
+    static constexpr qint64 BaseTime = 1704067200000LL;  // 2024-01-01T00:00:00Z
+
+    void compareWithRawSamples(TimeSeriesStore &store, const TimeSeriesQuery &query);
+};
+
+void TestTimeSeriesStore::initTestCase()
+{
+    qDebug() << "Starting TimeSeriesStore unit tests...";
+}
+
+void TestTimeSeriesStore::cleanupTestCase()
+{
+    qDebug() << "TimeSeriesStore unit tests completed.";
+}
+
+void TestTimeSeriesStore::testAppendAcrossChunks()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TimeSeriesStore store(dir.path());
+
+    // 3天的分钟数据应分布在3个数据块中
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 3 * 24 * 60));
+    QCOMPARE(store.chunkStarts("sensor_001").size(), 3);
+
+    // 新建的存储实例从磁盘重建块索引
+    TimeSeriesStore reopened(dir.path());
+    QCOMPARE(reopened.chunkStarts("sensor_001"), store.chunkStarts("sensor_001"));
+}
+
+void TestTimeSeriesStore::testRejectOutOfOrder()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+
+    QVERIFY(store.append("sensor_001", BaseTime + 10, 1.0));
+    QVERIFY(!store.append("sensor_001", BaseTime + 5, 2.0));
+    QVERIFY(!store.getLastError().isEmpty());
+}
+
+void TestTimeSeriesStore::testBucketAggregation()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 60));
+
+    TimeSeriesQuery query(QStringList() << "sensor_001", BaseTime, BaseTime + 2 * 60 * MsPerMinute,
+                          TimeWidget::Hour1);
+    TimeSeriesQueryResult result = store.query(query);
+
+    QCOMPARE(result.series.size(), 1);
+    QCOMPARE(result.samplesScanned, qint64(120));
+
+    // 结果按本地时区对齐，找到包含第一个样本的桶
+    const int firstIndex = result.bucketer.bucketIndex(BaseTime);
+    QVERIFY(firstIndex >= 0);
+
+    qint64 total = 0;
+    double sum = 0.0;
+    for (const BucketAggregate &bucket : result.series.first().buckets) {
+        total += bucket.count;
+        sum += bucket.sum;
+    }
+    QCOMPARE(total, qint64(120));
+    QCOMPARE(sum, 119.0 * 120.0 / 2.0);
+
+    const BucketAggregate &first = result.series.first().buckets.at(firstIndex);
+    QCOMPARE(first.first, 0.0);
+    QVERIFY(first.min <= first.max);
+}
+
+void TestTimeSeriesStore::testUnknownDevice()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+
+    TimeSeriesQuery query(QStringList() << "missing", BaseTime, BaseTime + MsPerMinute * 60,
+                          TimeWidget::Minutes15);
+    TimeSeriesQueryResult result = store.query(query);
+
+    QCOMPARE(result.series.size(), 1);
+    QCOMPARE(result.series.first().buckets.size(), result.bucketer.bucketCount());
+    for (const BucketAggregate &bucket : result.series.first().buckets) {
+        QVERIFY(bucket.isEmpty());
+    }
+}
+
+void TestTimeSeriesStore::testPartialBucketRange()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 24 * 60));
+
+    TimeBucketer bucketer(BaseTime, BaseTime + 24 * 60 * MsPerMinute, TimeWidget::Hour1, QTimeZone::utc());
+    QVector<BucketAggregate> part = store.aggregateDevice("sensor_001", bucketer, 5, 3);
+
+    QCOMPARE(part.size(), 3);
+    QCOMPARE(part.at(0).count, qint64(60));
+    QCOMPARE(part.at(0).first, 300.0);
+    QCOMPARE(part.at(2).last, 479.0);
+}
+
+void TestTimeSeriesStore::testScanSamples()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 3 * 24 * 60));
+
+    // 从第一天中午到第三天凌晨1点：跨三个数据块，每块回调一次
+    const qint64 start = BaseTime + 12 * 60 * MsPerMinute;
+    const qint64 end = BaseTime + (2 * 24 + 1) * 60 * MsPerMinute;
+    int calls = 0;
+    qint64 expected = start;
+    const qint64 visited = store.scanSamples("sensor_001", start, end,
+                                             [&](const qint64 *timestamps, const double *values, qint64 count) {
+        ++calls;
+        for (qint64 i = 0; i < count; ++i) {
+            if (timestamps[i] != expected || values[i] != (expected - BaseTime) / MsPerMinute) {
+                return false;
+            }
+            expected += MsPerMinute;
+        }
+        return true;
+    });
+
+    QCOMPARE(calls, 3);
+    QCOMPARE(visited, (end - start) / MsPerMinute);
+    QCOMPARE(expected, end);
+
+    // 回调返回false时停止
+    calls = 0;
+    store.scanSamples("sensor_001", start, end, [&](const qint64 *, const double *, qint64) {
+        ++calls;
+        return false;
+    });
+    QCOMPARE(calls, 1);
+
+    // 中间的数据块无法读取：报告错误并停止，不跳过后面的数据块
+    const qint64 secondChunk = store.chunkStarts("sensor_001").at(1);
+    const QString valPath = dir.path() + "/sensor_001/" + QString::number(secondChunk) + ".val";
+    QVERIFY(QFile::remove(valPath));
+    QVERIFY(QDir().mkpath(valPath));
+    calls = 0;
+    QString error;
+    store.scanSamples("sensor_001", start, end, [&](const qint64 *, const double *, qint64) {
+        ++calls;
+        return true;
+    }, &error);
+    QCOMPARE(calls, 1);
+    QVERIFY(error.contains(QString::number(secondChunk)));
+}
+
+void TestTimeSeriesStore::compareWithRawSamples(TimeSeriesStore &store, const TimeSeriesQuery &query)
+{
+    store.setRollupsEnabled(true);
+    const TimeSeriesQueryResult rollup = store.query(query);
+    store.setRollupsEnabled(false);
+    const TimeSeriesQueryResult raw = store.query(query);
+    store.setRollupsEnabled(true);
+
+    QCOMPARE(rollup.samplesScanned, raw.samplesScanned);
+    QCOMPARE(raw.bucketsScanned, static_cast<qint64>(raw.series.size()) * raw.bucketer.bucketCount());
+    QCOMPARE(rollup.series.size(), raw.series.size());
+    for (int s = 0; s < raw.series.size(); ++s) {
+        const QVector<BucketAggregate> &expected = raw.series.at(s).buckets;
+        const QVector<BucketAggregate> &actual = rollup.series.at(s).buckets;
+        QCOMPARE(actual.size(), expected.size());
+        for (int i = 0; i < expected.size(); ++i) {
+            QCOMPARE(actual.at(i).count, expected.at(i).count);
+            QCOMPARE(actual.at(i).sum, expected.at(i).sum);
+            QCOMPARE(actual.at(i).min, expected.at(i).min);
+            QCOMPARE(actual.at(i).max, expected.at(i).max);
+            QCOMPARE(actual.at(i).first, expected.at(i).first);
+            QCOMPARE(actual.at(i).last, expected.at(i).last);
+        }
+    }
+}
+
+void TestTimeSeriesStore::testRollupMatchesRawSamples()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+
+    // 分两批写入，分界落在15分钟和1小时桶的中间，验证增量合并
+    const int minutes = 3 * 24 * 60;
+    const int split = 1000;
+    QVector<qint64> timestamps(minutes);
+    QVector<double> values(minutes);
+    for (int i = 0; i < minutes; ++i) {
+        timestamps[i] = BaseTime + i * MsPerMinute;
+        values[i] = (i * 37) % 101;
+    }
+    QVERIFY(store.append("sensor_001", timestamps.constData(), values.constData(), split));
+    QVERIFY(store.append("sensor_001", timestamps.constData() + split, values.constData() + split, minutes - split));
+    QVERIFY(store.append("sensor_001", BaseTime + minutes * MsPerMinute, -1.0));
+
+    const qint64 endMs = BaseTime + (minutes + 1) * MsPerMinute;
+    compareWithRawSamples(store, TimeSeriesQuery(QStringList() << "sensor_001", BaseTime, endMs,
+                                                 TimeWidget::Minutes15));
+    compareWithRawSamples(store, TimeSeriesQuery(QStringList() << "sensor_001", BaseTime, endMs,
+                                                 TimeWidget::Hour1));
+    compareWithRawSamples(store, TimeSeriesQuery(QStringList() << "sensor_001", BaseTime, endMs,
+                                                 TimeWidget::Day1));
+}
+
+void TestTimeSeriesStore::testSelectCoarsestTier()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 3 * 24 * 60));
+
+    const qint64 endMs = BaseTime + 3 * 24 * 60 * MsPerMinute;
+    const TimeBucketer days(BaseTime, endMs, TimeWidget::Day1);
+    const TimeBucketer hours(BaseTime, endMs, TimeWidget::Hour1);
+    const TimeBucketer quarters(BaseTime, endMs, TimeWidget::Minutes15);
+
+    QCOMPARE(store.selectTier("sensor_001", days, 0, days.bucketCount()), TimeSeriesStore::Day1Rollup);
+    QCOMPARE(store.selectTier("sensor_001", hours, 0, hours.bucketCount()), TimeSeriesStore::Hour1Rollup);
+    QCOMPARE(store.selectTier("sensor_001", quarters, 0, quarters.bucketCount()),
+             TimeSeriesStore::Minutes15Rollup);
+
+    // 没有预聚合层或关闭预聚合层时扫描原始样本
+    QCOMPARE(store.selectTier("missing", days, 0, days.bucketCount()), TimeSeriesStore::RawSamples);
+    store.setRollupsEnabled(false);
+    QCOMPARE(store.selectTier("sensor_001", days, 0, days.bucketCount()), TimeSeriesStore::RawSamples);
+}
+
+void TestTimeSeriesStore::testYearQueryWithoutRawSamples()
+{
+    QTemporaryDir dir;
+    const int hours = 365 * 24;
+    {
+        TimeSeriesStore store(dir.path());
+        QVERIFY(TestSeries::appendSamples(store, "sensor_001", BaseTime, TestSeries::MsPerHour, hours,
+                                          [](int) { return 1.0; }));
+    }
+
+    // 删除全部原始数据块，1天颗粒度的全年查询仍能从预聚合层得到结果
+    QDir deviceDir(dir.path() + "/sensor_001");
+    for (const QString &fileName : deviceDir.entryList(QStringList() << "*.ts" << "*.val", QDir::Files)) {
+        QVERIFY(deviceDir.remove(fileName));
+    }
+
+    TimeSeriesStore store(dir.path());
+    QVERIFY(store.chunkStarts("sensor_001").isEmpty());
+
+    const TimeSeriesQuery query(QStringList() << "sensor_001", BaseTime, BaseTime + hours * 60 * MsPerMinute,
+                                TimeWidget::Day1);
+    const TimeSeriesQueryResult result = store.query(query);
+    QCOMPARE(store.selectTier("sensor_001", result.bucketer, 0, result.bucketer.bucketCount()),
+             TimeSeriesStore::Day1Rollup);
+
+    qint64 total = 0;
+    for (const BucketAggregate &bucket : result.series.first().buckets) {
+        total += bucket.count;
+    }
+    QCOMPARE(total, qint64(hours));
+    QCOMPARE(result.samplesScanned, qint64(hours));
+}
+
+void TestTimeSeriesStore::testRollupBackfill()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 2 * 24 * 60));
+
+    // 模拟升级前写入的数据：没有预聚合层时回退到原始样本
+    QDir deviceDir(dir.path() + "/sensor_001");
+    for (const QString &fileName : deviceDir.entryList(QStringList() << "rollup-*", QDir::Files)) {
+        QVERIFY(deviceDir.remove(fileName));
+    }
+    const TimeBucketer days(BaseTime, BaseTime + 5 * 24 * 60 * MsPerMinute, TimeWidget::Day1);
+    QCOMPARE(store.selectTier("sensor_001", days, 0, days.bucketCount()), TimeSeriesStore::RawSamples);
+
+    // 下一次写入时从原始样本重建
+    QVERIFY(store.append("sensor_001", BaseTime + 4 * 24 * 60 * MsPerMinute, 7.0));
+    QCOMPARE(store.selectTier("sensor_001", days, 0, days.bucketCount()), TimeSeriesStore::Day1Rollup);
+
+    // 写入更早的数据块无法增量更新，同样触发重建
+    QVERIFY(store.append("sensor_001", BaseTime + 3 * 24 * 60 * MsPerMinute, 3.0));
+    compareWithRawSamples(store, TimeSeriesQuery(QStringList() << "sensor_001", days.startMs(), days.endMs(),
+                                                 TimeWidget::Hour1));
+    compareWithRawSamples(store, TimeSeriesQuery(QStringList() << "sensor_001", days.startMs(), days.endMs(),
+                                                 TimeWidget::Day1));
+}
+
+void TestTimeSeriesStore::testPartialAppendFailure()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+    QueryResultCache cache;
+    store.setResultCache(&cache);
+    QVERIFY(TestSeries::appendMinutes(store, "sensor_001", 60));
+
+    const TimeSeriesQuery query(QStringList() << "sensor_001", BaseTime, BaseTime + 2 * 24 * 60 * MsPerMinute,
+                                TimeWidget::Hour1);
+    QCOMPARE(store.query(query).samplesScanned, qint64(60));
+
+    // 第二天的数据块无法打开：第一天的样本已落盘，写入整体失败
+    const qint64 nextChunk = BaseTime + store.chunkSpanMs();
+    QVERIFY(QDir().mkpath(dir.path() + "/sensor_001/" + QString::number(nextChunk) + ".ts"));
+    const qint64 timestamps[] = { BaseTime + 90 * MsPerMinute, nextChunk + MsPerMinute };
+    const double values[] = { 5.0, 6.0 };
+    QVERIFY(!store.append("sensor_001", timestamps, values, 2));
+    QVERIFY(store.getLastError().contains(QString::number(nextChunk)));
+
+    // 预聚合层和缓存都包含已落盘的样本
+    const TimeSeriesQueryResult result = store.query(query);
+    QCOMPARE(result.series.first().buckets.at(1).count, qint64(1));
+    QCOMPARE(result.series.first().buckets.at(1).sum, 5.0);
+    compareWithRawSamples(store, query);
+}
+
+void TestTimeSeriesStore::benchmarkSelectToData()
+{
+    QTemporaryDir dir;
+    TimeSeriesStore store(dir.path());
+
+    QStringList deviceIds;
+    for (int i = 0; i < 50; ++i) {
+        const QString id = QString("sensor_%1").arg(i, 3, 10, QChar('0'));
+        QVERIFY(TestSeries::appendMinutes(store, id, 3 * 24 * 60));
+        deviceIds << id;
+    }
+
+    TimeSeriesQuery query(deviceIds, BaseTime, BaseTime + 3 * 24 * 60 * MsPerMinute, TimeWidget::Minutes15);
+    TimeSeriesQueryResult result;
+
+    QBENCHMARK {
+        result = store.query(query);
+    }
+
+    QCOMPARE(result.series.size(), deviceIds.size());
+    QCOMPARE(result.samplesScanned, qint64(50 * 3 * 24 * 60));
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    TestTimeSeriesStore test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_timeseriesstore_unit.moc"
@@ -53,6 +53,10 @@ private slots:
     // 信号槽机制测试
     void testSignalSlotConnections();
     void testMultipleSignalEmissions();
+    
+    // 实时模式测试
+    void testLiveModeAdvancesWindow();
+    void testSetGranularity();
 
 private:
     TimeWidget *m_timeWidget;
@@ -344,6 +348,52 @@ void TestTimeWidget::testMultipleSignalEmissions()
     QCOMPARE(spy.count(), 3);
 }
 
+void TestTimeWidget::testLiveModeAdvancesWindow()
+{
+    QSignalSpy rangeSpy(m_timeWidget, &TimeWidget::timeRangeChanged);
+    QSignalSpy liveSpy(m_timeWidget, &TimeWidget::liveModeChanged);
+    QSignalSpy advanceSpy(m_timeWidget, &TimeWidget::liveWindowAdvanced);
+    
+    QDateTime now = QDateTime::currentDateTime();
+    m_timeWidget->setTimeRange(now.addSecs(-6 * 3600), now.addSecs(-3600));
+    rangeSpy.clear();
+    
+    // 开启时窗口长度保持6小时，终点对齐到当前时间
+    m_timeWidget->setLiveInterval(20);
+    m_timeWidget->setLiveMode(true);
+    QVERIFY(m_timeWidget->isLiveMode());
+    QCOMPARE(liveSpy.count(), 1);
+    QCOMPARE(rangeSpy.count(), 1);
+    QVERIFY(qAbs(m_timeWidget->getEndTime().secsTo(QDateTime::currentDateTime())) < 60);
+    
+    // 定时滚动只发出liveWindowAdvanced
+    QVERIFY(advanceSpy.wait(1000));
+    QCOMPARE(rangeSpy.count(), 1);
+    const QDateTime start = advanceSpy.last().at(0).toDateTime();
+    const QDateTime end = advanceSpy.last().at(1).toDateTime();
+    QVERIFY(qAbs(start.secsTo(end) - 6 * 3600) <= 60); // 编辑器精确到分钟
+    
+    m_timeWidget->setLiveMode(false);
+    QVERIFY(!m_timeWidget->isLiveMode());
+    QCOMPARE(liveSpy.count(), 2);
+    advanceSpy.clear();
+    QTest::qWait(60);
+    QCOMPARE(advanceSpy.count(), 0);
+}
+
+void TestTimeWidget::testSetGranularity()
+{
+    QSignalSpy spy(m_timeWidget, &TimeWidget::granularityChanged);
+    
+    m_timeWidget->setGranularity(TimeWidget::Day1);
+    QCOMPARE(m_timeWidget->getGranularity(), TimeWidget::Day1);
+    QCOMPARE(spy.count(), 1);
+    
+    // 设置相同的颗粒度不发出信号
+    m_timeWidget->setGranularity(TimeWidget::Day1);
+    QCOMPARE(spy.count(), 1);
+}
+
 // 主函数
 int main(int argc, char *argv[])
 {